@@ -0,0 +1,98 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <core/config.h>
+
+#ifdef H2CORE_HAVE_LIBARCHIVE
+
+#include <core/Helpers/Archive.h>
+#include <core/Helpers/Filesystem.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <vector>
+
+using namespace H2Core;
+
+/** All files of the GMRockKit as they would be exported. */
+static std::vector<Archive::Entry> drumkitEntries( int64_t* pnBytes ) {
+	const QDir kitDir( Filesystem::sys_drumkits_dir() + "GMRockKit" );
+	std::vector<Archive::Entry> entries;
+	*pnBytes = 0;
+	for ( const auto& sFile : kitDir.entryList( QDir::Files ) ) {
+		entries.push_back( { kitDir.filePath( sFile ), "GMRockKit/" + sFile } );
+		*pnBytes += QFileInfo( kitDir.filePath( sFile ) ).size();
+	}
+	return entries;
+}
+
+/** Exports GMRockKit compressing with range(0) threads. */
+static void BM_ArchiveCreate( benchmark::State& state ) {
+	int64_t nBytes;
+	const auto entries = drumkitEntries( &nBytes );
+	const QString sPath = Filesystem::tmp_file_path( "benchmark.h2drumkit" );
+
+	for ( auto _ : state ) {
+		benchmark::DoNotOptimize( Archive::create( sPath, entries, nullptr,
+												   state.range( 0 ) ) );
+	}
+	state.SetBytesProcessed( state.iterations() * nBytes );
+
+	QFile::remove( sPath );
+}
+BENCHMARK( BM_ArchiveCreate )
+	->ArgNames( { "threads" } )
+	->RangeMultiplier( 2 )->Range( 1, 8 )
+	->UseRealTime()
+	->Unit( benchmark::kMillisecond );
+
+/** Installs GMRockKit into a temporary folder. */
+static void BM_ArchiveExtract( benchmark::State& state ) {
+	int64_t nBytes;
+	const auto entries = drumkitEntries( &nBytes );
+	const QString sPath = Filesystem::tmp_file_path( "benchmark.h2drumkit" );
+	Archive::create( sPath, entries );
+
+	for ( auto _ : state ) {
+		state.PauseTiming();
+		QTemporaryDir targetDir( Filesystem::tmp_dir() + "-XXXXXX" );
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize( Archive::extract( sPath, targetDir.path() ) );
+
+		state.PauseTiming();
+		targetDir.remove();
+		state.ResumeTiming();
+	}
+	state.SetBytesProcessed( state.iterations() * nBytes );
+
+	QFile::remove( sPath );
+}
+BENCHMARK( BM_ArchiveExtract )
+	->UseRealTime()
+	->Unit( benchmark::kMillisecond );
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <core/Basics/Adsr.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/Note.h>
+#include <core/Basics/WaveformPeaks.h>
+#include <core/Sampler/Interpolation.h>
+#include <core/Sampler/PanLawTable.h>
+#include <core/Sampler/Sampler.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace H2Core;
+
+/** Some sample data with a bit more structure than a constant. */
+static std::vector<float> createSample( int nFrames ) {
+	std::vector<float> data( nFrames );
+	for ( int ii = 0; ii < nFrames; ++ii ) {
+		data[ ii ] = std::sin( 0.05f * ii ) + 0.25f * std::sin( 0.31f * ii );
+	}
+	return data;
+}
+
+/**
+ * Resamples a buffer of range(1) frames using the interpolation
+ * mode range(0) and a step which is not an integer.
+ */
+static void BM_Interpolate( benchmark::State& state ) {
+	using Mode = Interpolation::InterpolateMode;
+	const auto mode = static_cast<Mode>( state.range( 0 ) );
+	const int nFrames = state.range( 1 );
+	const double fStep = 1.0594630943593;
+	const auto sample = createSample( static_cast<int>( nFrames * fStep ) + 4 );
+	std::vector<float> out( nFrames );
+
+	for ( auto _ : state ) {
+		double fPos = 1.0;
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			const int nPos = static_cast<int>( fPos );
+			const float fDiff = fPos - nPos;
+			const float* p = &sample[ nPos ];
+			switch ( mode ) {
+			case Mode::Linear:
+				out[ ii ] = Interpolation::linear_Interpolate( p[ 0 ], p[ 1 ], fDiff );
+				break;
+			case Mode::Cosine:
+				out[ ii ] = Interpolation::cosine_Interpolate( p[ 0 ], p[ 1 ], fDiff );
+				break;
+			case Mode::Third:
+				out[ ii ] = Interpolation::third_Interpolate( p[ -1 ], p[ 0 ], p[ 1 ], p[ 2 ], fDiff );
+				break;
+			case Mode::Cubic:
+				out[ ii ] = Interpolation::cubic_Interpolate( p[ -1 ], p[ 0 ], p[ 1 ], p[ 2 ], fDiff );
+				break;
+			case Mode::Hermite:
+			default:
+				out[ ii ] = Interpolation::hermite_Interpolate( p[ -1 ], p[ 0 ], p[ 1 ], p[ 2 ], fDiff );
+				break;
+			}
+			fPos += fStep;
+		}
+		benchmark::DoNotOptimize( out.data() );
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed( state.iterations() * nFrames );
+}
+BENCHMARK( BM_Interpolate )
+	->ArgNames( { "mode", "frames" } )
+	->ArgsProduct( { { 0, 1, 2, 3, 4 }, { 64, 512, 4096 } } );
+
+typedef float (*PanLaw)( float );
+
+static const PanLaw panLaws[] = {
+	Sampler::ratioStraightPolygonalPanLaw,
+	Sampler::ratioConstPowerPanLaw,
+	Sampler::ratioConstSumPanLaw,
+	Sampler::linearStraightPolygonalPanLaw,
+	Sampler::linearConstPowerPanLaw,
+	Sampler::linearConstSumPanLaw,
+	Sampler::polarStraightPolygonalPanLaw,
+	Sampler::polarConstPowerPanLaw,
+	Sampler::polarConstSumPanLaw,
+	Sampler::quadraticStraightPolygonalPanLaw,
+	Sampler::quadraticConstPowerPanLaw,
+	Sampler::quadraticConstSumPanLaw
+};
+
+/** Evaluates pan law range(0), in the order of the #Sampler
+ * declarations, for range(1) pan positions. */
+static void BM_PanLaw( benchmark::State& state ) {
+	const auto panLaw = panLaws[ state.range( 0 ) ];
+	const int nPans = state.range( 1 );
+
+	for ( auto _ : state ) {
+		float fSum = 0;
+		for ( int ii = 0; ii < nPans; ++ii ) {
+			const float fPan = -1.f + 2.f * ii / nPans;
+			fSum += panLaw( fPan ) + panLaw( -fPan );
+		}
+		benchmark::DoNotOptimize( fSum );
+	}
+	state.SetItemsProcessed( state.iterations() * nPans );
+}
+BENCHMARK( BM_PanLaw )
+	->ArgNames( { "law", "pans" } )
+	->ArgsProduct( { benchmark::CreateDenseRange( 0, 11, 1 ), { 256 } } );
+
+typedef float (*KNormPanLaw)( float, float );
+
+static const KNormPanLaw kNormPanLaws[] = {
+	Sampler::ratioConstKNormPanLaw,
+	Sampler::linearConstKNormPanLaw,
+	Sampler::polarConstKNormPanLaw,
+	Sampler::quadraticConstKNormPanLaw
+};
+
+static void BM_KNormPanLaw( benchmark::State& state ) {
+	const auto panLaw = kNormPanLaws[ state.range( 0 ) ];
+	const int nPans = state.range( 1 );
+
+	for ( auto _ : state ) {
+		float fSum = 0;
+		for ( int ii = 0; ii < nPans; ++ii ) {
+			const float fPan = -1.f + 2.f * ii / nPans;
+			fSum += panLaw( fPan, Sampler::K_NORM_DEFAULT ) +
+				panLaw( -fPan, Sampler::K_NORM_DEFAULT );
+		}
+		benchmark::DoNotOptimize( fSum );
+	}
+	state.SetItemsProcessed( state.iterations() * nPans );
+}
+BENCHMARK( BM_KNormPanLaw )
+	->ArgNames( { "law", "pans" } )
+	->ArgsProduct( { { 0, 1, 2, 3 }, { 256 } } );
+
+/** Tabulated version of pan law range(0), in the order of
+ * Sampler::PAN_LAW_TYPES, for range(1) pan positions. */
+static void BM_PanLawTable( benchmark::State& state ) {
+	const PanLawTable table( state.range( 0 ), Sampler::K_NORM_DEFAULT );
+	const int nPans = state.range( 1 );
+
+	for ( auto _ : state ) {
+		float fSum = 0;
+		for ( int ii = 0; ii < nPans; ++ii ) {
+			const float fPan = -1.f + 2.f * ii / nPans;
+			fSum += table.getGain( fPan ) + table.getGain( -fPan );
+		}
+		benchmark::DoNotOptimize( fSum );
+	}
+	state.SetItemsProcessed( state.iterations() * nPans );
+}
+BENCHMARK( BM_PanLawTable )
+	->ArgNames( { "law", "pans" } )
+	->ArgsProduct( { benchmark::CreateDenseRange( 0, 15, 1 ), { 256 } } );
+
+/** Per-frame resonant filter of a Note over range(0) frames. */
+static void BM_ComputeLrValues( benchmark::State& state ) {
+	const int nFrames = state.range( 0 );
+	auto pInstrument = std::make_shared<Instrument>();
+	pInstrument->set_filter_active( true );
+	pInstrument->set_filter_cutoff( 0.3 );
+	pInstrument->set_filter_resonance( 0.8 );
+	Note note( pInstrument, 0, 1.0, 0.f, -1, 0 );
+	auto data_L = createSample( nFrames );
+	auto data_R = createSample( nFrames );
+
+	for ( auto _ : state ) {
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			note.compute_lr_values( &data_L[ ii ], &data_R[ ii ] );
+		}
+		benchmark::DoNotOptimize( data_L.data() );
+		benchmark::DoNotOptimize( data_R.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * nFrames );
+}
+BENCHMARK( BM_ComputeLrValues )->RangeMultiplier( 4 )->Range( 64, 4096 );
+
+/** Full envelope, attack to release, applied to range(0) frames. */
+static void BM_ApplyADSR( benchmark::State& state ) {
+	const int nFrames = state.range( 0 );
+	std::vector<float> data_L( nFrames ), data_R( nFrames );
+
+	for ( auto _ : state ) {
+		state.PauseTiming();
+		std::fill( data_L.begin(), data_L.end(), 1.0f );
+		std::fill( data_R.begin(), data_R.end(), 1.0f );
+		ADSR adsr( nFrames / 4, nFrames / 4, 0.5, nFrames / 4 );
+		state.ResumeTiming();
+
+		adsr.applyADSR( data_L.data(), data_R.data(), nFrames, 3 * nFrames / 4, 1.0 );
+		benchmark::DoNotOptimize( data_L.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * nFrames );
+}
+BENCHMARK( BM_ApplyADSR )->RangeMultiplier( 4 )->Range( 64, 4096 );
+
+/** Peaks of 1024 pixels covering a sample of range(0) frames. */
+static void BM_WaveformPeaksQuery( benchmark::State& state ) {
+	const int nFrames = state.range( 0 );
+	const auto data = createSample( nFrames );
+	const WaveformPeaks peaks( data.data(), data.data(), nFrames );
+	const int nPixels = 1024;
+	const int nBlocksPerPixel = std::max( peaks.getBlocks() / nPixels, 1 );
+
+	for ( auto _ : state ) {
+		float fSum = 0;
+		for ( int ii = 0; ii < nPixels; ++ii ) {
+			fSum += peaks.query( 0, ii * nBlocksPerPixel,
+								 ( ii + 1 ) * nBlocksPerPixel ).fMax;
+		}
+		benchmark::DoNotOptimize( fSum );
+	}
+	state.SetItemsProcessed( state.iterations() * nPixels );
+}
+BENCHMARK( BM_WaveformPeaksQuery )->RangeMultiplier( 16 )->Range( 1 << 16, 1 << 24 );
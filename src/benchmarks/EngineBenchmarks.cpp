@@ -0,0 +1,154 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <core/Hydrogen.h>
+#include <core/Timeline.h>
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/AudioEngine/TransportPosition.h>
+#include <core/Basics/AutomationPath.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentList.h>
+#include <core/Basics/Note.h>
+#include <core/Basics/Pattern.h>
+#include <core/Basics/PatternList.h>
+#include <core/Basics/Song.h>
+
+#include <memory>
+#include <vector>
+
+using namespace H2Core;
+
+/** Evaluates a path of range(0) points at 1024 positions. */
+static void BM_AutomationPathGetValue( benchmark::State& state ) {
+	const int nPoints = state.range( 0 );
+	AutomationPath path( 0.0f, 1.0f, 0.5f );
+	for ( int ii = 0; ii < nPoints; ++ii ) {
+		path.add_point( static_cast<float>( ii ), ( ii % 3 ) / 2.0f );
+	}
+
+	const int nLookups = 1024;
+	for ( auto _ : state ) {
+		float fSum = 0;
+		for ( int ii = 0; ii < nLookups; ++ii ) {
+			fSum += path.get_value( static_cast<float>( ii ) * nPoints / nLookups );
+		}
+		benchmark::DoNotOptimize( fSum );
+	}
+	state.SetItemsProcessed( state.iterations() * nLookups );
+}
+BENCHMARK( BM_AutomationPathGetValue )->RangeMultiplier( 4 )->Range( 2, 1024 );
+
+/**
+ * Converts ticks spread over a song of 64 columns into frames. The
+ * Timeline holds range(0) tempo markers.
+ */
+static void BM_ComputeFrameFromTick( benchmark::State& state ) {
+	const int nTempoMarkers = state.range( 0 );
+	const int nColumns = 64;
+
+	auto pHydrogen = Hydrogen::get_instance();
+	auto pSong = Song::getEmptySong();
+	auto pPattern = pSong->getPatternList()->get( 0 );
+	auto pColumns = pSong->getPatternGroupVector();
+	while ( static_cast<int>( pColumns->size() ) < nColumns ) {
+		auto pColumn = new PatternList();
+		pColumn->add( pPattern );
+		pColumns->push_back( pColumn );
+	}
+	pSong->setMode( Song::Mode::Song );
+	pSong->setIsTimelineActivated( nTempoMarkers > 0 );
+	pHydrogen->setSong( pSong );
+
+	auto pTimeline = pHydrogen->getTimeline();
+	pTimeline->deleteAllTempoMarkers();
+	for ( int ii = 0; ii < nTempoMarkers; ++ii ) {
+		pTimeline->addTempoMarker( ii * nColumns / nTempoMarkers, 80 + ii % 7 * 10 );
+	}
+
+	const double fSongSize = pHydrogen->getAudioEngine()->getSongSizeInTicks();
+	const int nLookups = 256;
+	for ( auto _ : state ) {
+		long long nSum = 0;
+		double fTickMismatch;
+		for ( int ii = 0; ii < nLookups; ++ii ) {
+			nSum += TransportPosition::computeFrameFromTick(
+				fSongSize * ii / nLookups, &fTickMismatch );
+		}
+		benchmark::DoNotOptimize( nSum );
+	}
+	state.SetItemsProcessed( state.iterations() * nLookups );
+
+	pTimeline->deleteAllTempoMarkers();
+	pHydrogen->setSong( Song::getEmptySong() );
+}
+BENCHMARK( BM_ComputeFrameFromTick )->Arg( 0 )->Arg( 4 )->Arg( 16 )->Arg( 64 );
+
+/**
+ * Looks up the note of every instrument at every position of a
+ * pattern holding a note of range(0) instruments on each 16th.
+ */
+static void BM_PatternFindNote( benchmark::State& state ) {
+	const int nInstruments = state.range( 0 );
+	std::vector<std::shared_ptr<Instrument>> instruments;
+	for ( int ii = 0; ii < nInstruments; ++ii ) {
+		instruments.push_back( std::make_shared<Instrument>( ii ) );
+	}
+
+	Pattern pattern( "benchmark", "", "", 192 );
+	for ( int nPos = 0; nPos < pattern.get_length(); nPos += 12 ) {
+		for ( const auto& pInstrument : instruments ) {
+			pattern.insert_note( new Note( pInstrument, nPos, 0.8f, 0.f, -1, 0 ) );
+		}
+	}
+
+	for ( auto _ : state ) {
+		int nFound = 0;
+		for ( int nPos = 0; nPos < pattern.get_length(); nPos += 12 ) {
+			for ( const auto& pInstrument : instruments ) {
+				if ( pattern.find_note( nPos, nPos, pInstrument ) != nullptr ) {
+					++nFound;
+				}
+			}
+		}
+		benchmark::DoNotOptimize( nFound );
+	}
+	state.SetItemsProcessed( state.iterations() * 16 * nInstruments );
+}
+BENCHMARK( BM_PatternFindNote )->RangeMultiplier( 4 )->Range( 1, 64 );
+
+/** Longest pattern of a list of range(0) patterns of varying
+ * length. */
+static void BM_LongestPatternLength( benchmark::State& state ) {
+	const int nPatterns = state.range( 0 );
+	PatternList patternList;
+	for ( int ii = 0; ii < nPatterns; ++ii ) {
+		patternList.add( new Pattern( QString( "p%1" ).arg( ii ), "", "",
+									  48 * ( 1 + ii % 8 ) ) );
+	}
+
+	for ( auto _ : state ) {
+		benchmark::DoNotOptimize( patternList.longest_pattern_length() );
+	}
+	state.SetItemsProcessed( state.iterations() * nPatterns );
+}
+BENCHMARK( BM_LongestPatternLength )->RangeMultiplier( 4 )->Range( 1, 256 );
@@ -0,0 +1,200 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentList.h>
+#include <core/Basics/Note.h>
+#include <core/Basics/Pattern.h>
+#include <core/Basics/PatternList.h>
+#include <core/Basics/Song.h>
+#include <core/Helpers/Filesystem.h>
+#include <core/Helpers/Xml.h>
+
+#include <QFile>
+
+#include <memory>
+
+using namespace H2Core;
+
+/** A song holding @a nNotes notes spread over 64 patterns of 16
+ * instruments. */
+static std::shared_ptr<Song> createSong( int nNotes ) {
+	const int nInstruments = 16;
+	const int nPatterns = 64;
+
+	auto pSong = Song::getEmptySong();
+	auto pInstrumentList = std::make_shared<InstrumentList>();
+	for ( int ii = 0; ii < nInstruments; ++ii ) {
+		pInstrumentList->add( std::make_shared<Instrument>( ii, QString( "i%1" ).arg( ii ) ) );
+	}
+	pSong->setInstrumentList( pInstrumentList );
+
+	auto pPatternList = new PatternList();
+	for ( int nn = 0; nn < nPatterns; ++nn ) {
+		auto pPattern = new Pattern( QString( "p%1" ).arg( nn ), "", "benchmark", 192 );
+		const int nPatternNotes = nNotes / nPatterns;
+		for ( int ii = 0; ii < nPatternNotes; ++ii ) {
+			auto pNote = new Note( pInstrumentList->get( ii % nInstruments ),
+								   ii * 192 / nPatternNotes, 0.1f + 0.8f * ( ii % 7 ) / 7,
+								   -1.f + 2.f * ( ii % 5 ) / 5, -1, ii % 3 );
+			pPattern->insert_note( pNote );
+		}
+		pPatternList->add( pPattern );
+	}
+	pSong->setPatternList( pPatternList );
+
+	return pSong;
+}
+
+/**
+ * Writes the song of createSong() to a temporary file.
+ *
+ * \return Path of the song file.
+ */
+static QString createSongFile( int nNotes, std::shared_ptr<InstrumentList>* ppInstrumentList,
+							   bool bBinary = false ) {
+	auto pSong = createSong( nNotes );
+	const QString sPath = Filesystem::tmp_file_path( "benchmark.h2song" );
+	pSong->save( sPath, true, bBinary );
+
+	*ppInstrumentList = pSong->getInstrumentList();
+	return sPath;
+}
+
+/** Reads the patterns of a song with range(0) notes into a
+ * QDomDocument first and from the DOM into objects. */
+static void BM_PatternListLoadDom( benchmark::State& state ) {
+	std::shared_ptr<InstrumentList> pInstrumentList;
+	const QString sPath = createSongFile( state.range( 0 ), &pInstrumentList );
+
+	for ( auto _ : state ) {
+		XMLDoc doc;
+		doc.read( sPath, nullptr, true );
+		XMLNode songNode = doc.firstChildElement( "song" );
+		auto pPatternList = PatternList::load_from( &songNode, pInstrumentList, true );
+		benchmark::DoNotOptimize( pPatternList );
+		delete pPatternList;
+	}
+	state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+
+	QFile::remove( sPath );
+}
+BENCHMARK( BM_PatternListLoadDom )->RangeMultiplier( 10 )->Range( 1000, 100000 )
+	->Unit( benchmark::kMillisecond );
+
+/** Same as #BM_PatternListLoadDom but the pattern list is read using
+ * XMLDoc::readStreamed(). */
+static void BM_PatternListLoadStreamed( benchmark::State& state ) {
+	std::shared_ptr<InstrumentList> pInstrumentList;
+	const QString sPath = createSongFile( state.range( 0 ), &pInstrumentList );
+
+	for ( auto _ : state ) {
+		XMLDoc doc;
+		PatternList* pPatternList = nullptr;
+		doc.readStreamed( sPath, "song/patternList", [&]( QXmlStreamReader& reader ) {
+			pPatternList = PatternList::load_from( reader, nullptr, true );
+			return pPatternList != nullptr;
+		}, true );
+		pPatternList->mapInstruments( pInstrumentList );
+		benchmark::DoNotOptimize( pPatternList );
+		delete pPatternList;
+	}
+	state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+
+	QFile::remove( sPath );
+}
+BENCHMARK( BM_PatternListLoadStreamed )->RangeMultiplier( 10 )->Range( 1000, 100000 )
+	->Unit( benchmark::kMillisecond );
+
+/** Song::load() of a song with range(0) notes stored in the XML
+ * (range(1) = 0) or binary (range(1) = 1) format. */
+static void BM_SongLoad( benchmark::State& state ) {
+	std::shared_ptr<InstrumentList> pInstrumentList;
+	const QString sPath = createSongFile( state.range( 0 ), &pInstrumentList,
+										  state.range( 1 ) != 0 );
+
+	for ( auto _ : state ) {
+		auto pSong = Song::load( sPath, true );
+		benchmark::DoNotOptimize( pSong );
+	}
+	state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+
+	QFile::remove( sPath );
+}
+BENCHMARK( BM_SongLoad )
+	->ArgNames( { "notes", "binary" } )
+	->ArgsProduct( { { 1000, 10000, 100000 }, { 0, 1 } } )
+	->Unit( benchmark::kMillisecond );
+
+/** Song::save() of a song with range(0) notes in the XML (range(1) =
+ * 0) or binary (range(1) = 1) format. */
+static void BM_SongSave( benchmark::State& state ) {
+	auto pSong = createSong( state.range( 0 ) );
+	const QString sPath = Filesystem::tmp_file_path( "benchmark.h2song" );
+
+	for ( auto _ : state ) {
+		pSong->save( sPath, true, state.range( 1 ) != 0 );
+	}
+	state.SetItemsProcessed( state.iterations() * state.range( 0 ) );
+
+	QFile::remove( sPath );
+}
+BENCHMARK( BM_SongSave )
+	->ArgNames( { "notes", "binary" } )
+	->ArgsProduct( { { 1000, 10000, 100000 }, { 0, 1 } } )
+	->Unit( benchmark::kMillisecond );
+
+/**
+ * Reads the drumkit.xml of GMRockKit validating it against the
+ * drumkit XSD
+ * - range(0) = 0: for every read
+ * - range(0) = 1: once. Afterwards it is recognized by its hash.
+ * - range(0) = 2: in the background (XMLDoc::Validation::Deferred).
+ *   Only the time spent in XMLDoc::read() is measured.
+ * - range(0) = 3: not at all.
+ */
+static void BM_XmlDocReadValidated( benchmark::State& state ) {
+	const QString sPath = Filesystem::drumkit_file(
+		Filesystem::sys_drumkits_dir() + "GMRockKit" );
+	const QString sSchemaPath = state.range( 0 ) == 3 ? "" : Filesystem::drumkit_xsd_path();
+	const auto validation = state.range( 0 ) == 2 ?
+		XMLDoc::Validation::Deferred : XMLDoc::Validation::Immediate;
+	XMLDoc::clearValidationCache();
+
+	for ( auto _ : state ) {
+		if ( state.range( 0 ) == 0 || state.range( 0 ) == 2 ) {
+			state.PauseTiming();
+			XMLDoc::waitForDeferredValidation();
+			XMLDoc::clearValidationCache();
+			state.ResumeTiming();
+		}
+		XMLDoc doc;
+		benchmark::DoNotOptimize( doc.read( sPath, sSchemaPath, true, validation ) );
+	}
+
+	XMLDoc::waitForDeferredValidation();
+}
+BENCHMARK( BM_XmlDocReadValidated )
+	->ArgNames( { "validation" } )
+	->DenseRange( 0, 3 )
+	->Unit( benchmark::kMillisecond );
@@ -0,0 +1,297 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <QtGui>
+#include <QtWidgets>
+
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/Basics/InstrumentList.h>
+#include <core/Basics/Note.h>
+#include <core/Basics/Pattern.h>
+#include <core/Basics/PatternList.h>
+#include <core/Basics/Song.h>
+#include <core/CoreActionController.h>
+#include <core/Helpers/Filesystem.h>
+#include <core/Hydrogen.h>
+#include <core/MidiMap.h>
+#include <core/Preferences/Preferences.h>
+
+#include "HydrogenApp.h"
+#include "MainForm.h"
+#include "PatternEditor/DrumPatternEditor.h"
+#include "PatternEditor/PatternEditorPanel.h"
+#include "Skin.h"
+#include "SongEditor/SongEditor.h"
+#include "SongEditor/SongEditorPanel.h"
+
+#include <algorithm>
+
+/*
+ * Repaint costs of the GUI editors.
+ *
+ * The benchmarks run within a complete MainForm using the offscreen
+ * Qt platform. Every iteration applies an edit through the same
+ * calls the GUI uses and renders the region of the editor a user
+ * would see into a QImage via QWidget::render(), which goes through
+ * the regular paintEvent().
+ */
+
+/** Size of the region rendered per iteration, roughly what is
+ * visible of an editor in a maximized main window. */
+static const QSize viewportSize( 1024, 512 );
+
+/** Lets the GUI pick up pending events, e.g. the EVENT_UPDATE_SONG
+ * pushed when setting a new song. */
+static void processGuiEvents() {
+	QEventLoop loop;
+	QTimer::singleShot( 200, &loop, &QEventLoop::quit );
+	loop.exec();
+}
+
+/** Region of @a pWidget of #viewportSize centred at @a center. */
+static QRect viewportAround( const QWidget* pWidget, const QPoint& center ) {
+	QRect rect( QPoint(), viewportSize );
+	rect.moveCenter( center );
+	rect.moveLeft( std::max( std::min( rect.left(), pWidget->width() - rect.width() ), 0 ) );
+	rect.moveTop( std::max( std::min( rect.top(), pWidget->height() - rect.height() ), 0 ) );
+	return rect.intersected( pWidget->rect() );
+}
+
+static constexpr int nSongEditorPatterns = 32;
+
+/** Song of @a nColumns columns and #nSongEditorPatterns patterns
+ * with every third cell active. */
+static std::shared_ptr<H2Core::Song> createSongEditorSong( int nColumns ) {
+	auto pSong = H2Core::Song::getEmptySong();
+
+	auto pPatternList = new H2Core::PatternList();
+	for ( int nRow = 0; nRow < nSongEditorPatterns; ++nRow ) {
+		pPatternList->add( new H2Core::Pattern( QString( "Pattern %1" ).arg( nRow + 1 ) ) );
+	}
+
+	auto pColumns = new std::vector<H2Core::PatternList*>;
+	for ( int nColumn = 0; nColumn < nColumns; ++nColumn ) {
+		auto pColumn = new H2Core::PatternList();
+		for ( int nRow = 0; nRow < nSongEditorPatterns; ++nRow ) {
+			if ( ( nColumn + 2 * nRow ) % 3 == 0 ) {
+				pColumn->add( pPatternList->get( nRow ) );
+			}
+		}
+		pColumns->push_back( pColumn );
+	}
+
+	// The columns only reference the patterns owned by the pattern list.
+	for ( auto pColumn : *pSong->getPatternGroupVector() ) {
+		pColumn->clear();
+		delete pColumn;
+	}
+	delete pSong->getPatternGroupVector();
+	pSong->setPatternGroupVector( pColumns );
+	delete pSong->getPatternList();
+	pSong->setPatternList( pPatternList );
+
+	return pSong;
+}
+
+/**
+ * Repaint of the visible part of the Song Editor after toggling a
+ * single cell in the middle of a song of range(1) columns.
+ *
+ * - range(0) = 0: all tiles are dropped before painting, as any
+ *   change to the sequence did before the tile cache.
+ * - range(0) = 1: only the tiles covering the cell are rendered again.
+ */
+static void BM_SongEditorRepaint( benchmark::State& state ) {
+	const bool bCached = state.range( 0 ) == 1;
+	const int nColumns = state.range( 1 );
+
+	auto pHydrogen = H2Core::Hydrogen::get_instance();
+	pHydrogen->getCoreActionController()->openSong( createSongEditorSong( nColumns ) );
+	processGuiEvents();
+
+	auto pSongEditor = HydrogenApp::get_instance()->getSongEditorPanel()->getSongEditor();
+	const int nColumn = nColumns / 2;
+	const int nRow = nSongEditorPatterns / 2;
+	const QPoint cell( SongEditor::nMargin + nColumn * pSongEditor->getGridWidth(),
+					   nRow * pSongEditor->getGridHeight() );
+	const QRect rect = viewportAround( pSongEditor, cell );
+
+	QImage image( rect.size(), QImage::Format_ARGB32_Premultiplied );
+	// Fill the tile cache.
+	pSongEditor->render( &image, QPoint(), QRegion( rect ) );
+
+	for ( auto _ : state ) {
+		pHydrogen->getCoreActionController()->toggleGridCell( nColumn, nRow );
+		pSongEditor->updateEditorandSetTrue();
+		if ( ! bCached ) {
+			pSongEditor->invalidateBackground();
+		}
+		pSongEditor->render( &image, QPoint(), QRegion( rect ) );
+		benchmark::DoNotOptimize( image.constBits() );
+	}
+}
+BENCHMARK( BM_SongEditorRepaint )
+	->ArgNames( { "cached", "columns" } )
+	->ArgsProduct( { { 0, 1 }, { 64, 256 } } )
+	->Unit( benchmark::kMicrosecond );
+
+static constexpr int nPatternEditorInstruments = 16;
+static constexpr int nPatternEditorLength = 4 * MAX_NOTES;
+
+/** Song of @a nPatterns patterns of four bars each. Every pattern
+ * holds sixteenth notes distributed differently over the first
+ * #nPatternEditorInstruments instruments. */
+static std::shared_ptr<H2Core::Song> createPatternEditorSong( int nPatterns ) {
+	auto pSong = H2Core::Song::getEmptySong();
+	auto pInstrumentList = pSong->getInstrumentList();
+	const int nInstruments = std::min( pInstrumentList->size(), nPatternEditorInstruments );
+
+	auto pPatternList = new H2Core::PatternList();
+	for ( int nPattern = 0; nPattern < nPatterns; ++nPattern ) {
+		auto pPattern = new H2Core::Pattern( QString( "Pattern %1" ).arg( nPattern + 1 ),
+											 "", "not_categorized", nPatternEditorLength );
+		for ( int nPos = 0; nPos < nPatternEditorLength; nPos += 12 ) {
+			for ( int nInstrument = 0; nInstrument < nInstruments; ++nInstrument ) {
+				if ( ( nPos / 12 + nInstrument + nPattern ) % 4 == 0 ) {
+					pPattern->insert_note( new H2Core::Note( pInstrumentList->get( nInstrument ),
+															 nPos, 0.8, 0.f, -1, 0 ) );
+				}
+			}
+		}
+		pPatternList->add( pPattern );
+	}
+
+	auto pColumn = new H2Core::PatternList();
+	pColumn->add( pPatternList->get( 0 ) );
+	for ( auto pOldColumn : *pSong->getPatternGroupVector() ) {
+		pOldColumn->clear();
+		delete pOldColumn;
+	}
+	pSong->getPatternGroupVector()->clear();
+	pSong->getPatternGroupVector()->push_back( pColumn );
+	delete pSong->getPatternList();
+	pSong->setPatternList( pPatternList );
+
+	return pSong;
+}
+
+/**
+ * Repaint of the visible part of the DrumPatternEditor showing
+ * range(1) stacked patterns after changing the velocity of a note
+ * of the selected one.
+ *
+ * - range(0) = 0: the notes of all patterns are drawn, as before the
+ *   note layers were cached.
+ * - range(0) = 1: only the layer of the edited pattern is redrawn and
+ *   the others are composited.
+ */
+static void BM_DrumPatternEditorRepaint( benchmark::State& state ) {
+	const bool bCached = state.range( 0 ) == 1;
+	const int nPatterns = state.range( 1 );
+
+	auto pHydrogen = H2Core::Hydrogen::get_instance();
+	auto pAudioEngine = pHydrogen->getAudioEngine();
+	pHydrogen->getCoreActionController()->openSong( createPatternEditorSong( nPatterns ) );
+	processGuiEvents();
+
+	pHydrogen->setPatternMode( H2Core::Song::PatternMode::Stacked );
+	pHydrogen->setSelectedPatternNumber( 0 );
+	for ( int nPattern = 1; nPattern < nPatterns; ++nPattern ) {
+		pHydrogen->toggleNextPattern( nPattern );
+	}
+	processGuiEvents();
+
+	auto pEditor = HydrogenApp::get_instance()->getPatternEditorPanel()->getDrumPatternEditor();
+	const QRect rect = viewportAround( pEditor, QPoint() );
+	auto pNote = pHydrogen->getSong()->getPatternList()->get( 0 )->get_notes()->begin()->second;
+
+	QImage image( rect.size(), QImage::Format_ARGB32_Premultiplied );
+	pEditor->updateEditor( true );
+	pEditor->render( &image, QPoint(), QRegion( rect ) );
+
+	for ( auto _ : state ) {
+		pAudioEngine->lock( RIGHT_HERE );
+		pNote->set_velocity( pNote->get_velocity() == 0.8f ? 0.5f : 0.8f );
+		pAudioEngine->unlock();
+		if ( ! bCached ) {
+			// Drops all note layers.
+			pEditor->PatternEditor::onPreferencesChanged( H2Core::Preferences::Changes::Font );
+		}
+		pEditor->updateEditor( true );
+		pEditor->render( &image, QPoint(), QRegion( rect ) );
+		benchmark::DoNotOptimize( image.constBits() );
+	}
+
+	pHydrogen->setPatternMode( H2Core::Song::PatternMode::Selected );
+}
+BENCHMARK( BM_DrumPatternEditorRepaint )
+	->ArgNames( { "cached", "patterns" } )
+	->ArgsProduct( { { 0, 1 }, { 1, 4, 16 } } )
+	->Unit( benchmark::kMicrosecond );
+
+/**
+ * Repaint benchmarks of the GUI editors.
+ *
+ * Supports the options of Google Benchmark, e.g.
+ * --benchmark_filter=<regex>. Unless QT_QPA_PLATFORM is set, the
+ * offscreen platform is used, so no display is required.
+ */
+int main( int argc, char** argv )
+{
+	if ( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) ) {
+		qputenv( "QT_QPA_PLATFORM", "offscreen" );
+	}
+
+	H2Core::Logger* pLogger = H2Core::Logger::bootstrap( H2Core::Logger::None );
+	H2Core::Base::bootstrap( pLogger, false );
+	H2Core::Filesystem::bootstrap( pLogger, H2_BENCHMARK_DATA_DIR );
+	MidiMap::create_instance();
+	H2Core::Preferences::create_instance();
+	auto pPref = H2Core::Preferences::get_instance();
+	pPref->m_sAudioDriver = "Fake";
+	pPref->m_nBufferSize = 1024;
+
+	QApplication app( argc, argv );
+	app.setFont( QFont( pPref->getApplicationFontFamily(), 10 ) );
+	Skin::setPalette( &app );
+
+	H2Core::Hydrogen::create_instance();
+	auto pHydrogen = H2Core::Hydrogen::get_instance();
+	pHydrogen->setGUIState( H2Core::Hydrogen::GUIState::notReady );
+
+	auto pMainForm = new MainForm( &app, "" );
+	pMainForm->show();
+	pHydrogen->setGUIState( H2Core::Hydrogen::GUIState::ready );
+	processGuiEvents();
+
+	benchmark::Initialize( &argc, argv );
+	if ( benchmark::ReportUnrecognizedArguments( argc, argv ) ) {
+		return 1;
+	}
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	delete pMainForm;
+
+	return 0;
+}
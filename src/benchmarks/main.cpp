@@ -0,0 +1,63 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <core/EventQueue.h>
+#include <core/Helpers/Filesystem.h>
+#include <core/Hydrogen.h>
+#include <core/Preferences/Preferences.h>
+
+#include <QCoreApplication>
+
+/**
+ * Microbenchmarks of individual DSP and engine primitives.
+ *
+ * In addition to the options of Google Benchmark, e.g.
+ * --benchmark_filter=<regex> and --benchmark_format=json, the
+ * environment is set up the same way as for the unit tests: a
+ * Hydrogen instance using the FakeDriver and an empty song.
+ */
+int main( int argc, char** argv )
+{
+	QCoreApplication app( argc, argv );
+
+	H2Core::Logger* pLogger = H2Core::Logger::bootstrap( H2Core::Logger::None );
+	H2Core::Base::bootstrap( pLogger, true );
+	H2Core::Filesystem::bootstrap( pLogger, H2_BENCHMARK_DATA_DIR );
+
+	H2Core::Preferences::create_instance();
+	auto pPref = H2Core::Preferences::get_instance();
+	pPref->m_sAudioDriver = "Fake";
+	pPref->m_nBufferSize = 1024;
+
+	H2Core::Hydrogen::create_instance();
+	H2Core::EventQueue::get_instance()->setSilent( true );
+
+	benchmark::Initialize( &argc, argv );
+	if ( benchmark::ReportUnrecognizedArguments( argc, argv ) ) {
+		return 1;
+	}
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+}
@@ -20,6 +20,9 @@
  *
  */
 
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QLibraryInfo>
 #include <QStringList>
 #include <QThread>
@@ -31,6 +34,7 @@
 #include <core/Lash/LashClient.h>
 #endif
 
+#include <core/Basics/Drumkit.h>
 #include <core/Basics/Song.h>
 #include <core/MidiMap.h>
 #include <core/AudioEngine/AudioEngine.h>
@@ -43,7 +47,10 @@
 #include <core/H2Exception.h>
 #include <core/Basics/Playlist.h>
 #include <core/Sampler/Interpolation.h>
+#include <core/Helpers/BinaryDoc.h>
 #include <core/Helpers/Filesystem.h>
+#include <core/Smf/SMF.h>
+#include <core/SoundLibrary/DrumkitBatch.h>
 
 #include <iostream>
 #include <signal.h>
@@ -71,6 +78,14 @@ static struct option long_opts[] = {
 	{"extract", required_argument, nullptr, 'x'},
 	{"target", required_argument, nullptr, 't'},
 	{"drumkit", required_argument, nullptr, 'k'},
+	{"convert", required_argument, nullptr, 'C'},
+	{"format", required_argument, nullptr, 'F'},
+	{"batch", 0, nullptr, 'B'},
+	{"jobs", required_argument, nullptr, 'j'},
+	{"samples", 0, nullptr, 'S'},
+	{"report", required_argument, nullptr, 'R'},
+	{"midi", required_argument, nullptr, 'm'},
+	{"quantize", required_argument, nullptr, 'q'},
 	{nullptr, 0, nullptr, 0},
 };
 
@@ -91,6 +106,17 @@ void signal_handler ( int signum )
 	}
 }
 
+/** Prints the progress of a drumkit installation or extraction. A
+ * caught SIGINT cancels it. */
+bool printArchiveProgress( float fProgress )
+{
+	std::cout << "\rProgress ... " << static_cast<int>( fProgress * 100 ) << "%" << std::flush;
+	if ( fProgress >= 1 ) {
+		std::cout << std::endl;
+	}
+	return ! quit;
+}
+
 void show_playlist (uint active )
 {
 	/* Display playlist members */
@@ -157,8 +183,22 @@ int main(int argc, char *argv[])
 		bool bValidateDrumkit = false;
 		QString sDrumkitToUpgrade;
 		bool bUpgradeDrumkit = false;
+		// All kits passed via -c and -u. Processed at once in batch
+		// mode.
+		QStringList drumkitsToValidate;
+		QStringList drumkitsToUpgrade;
+		bool bBatch = false;
+		int nJobs = 0;
+		bool bLoadSamples = false;
+		QString sReport;
 		QString sDrumkitToExtract;
 		bool bExtractDrumkit = false;
+		QString sFileToConvert;
+		bool bConvertFile = false;
+		QString sFormat = "binary";
+		bool bFormatSet = false;
+		QStringList midiFiles;
+		int nQuantize = 1;
 		QString sTarget = "";
 		short bits = 16;
 		int rate = 44100;
@@ -188,11 +228,13 @@ int main(int argc, char *argv[])
 			case 'c':
 				//validate h2drumkit
 				sDrumkitToValidate = makePathAbsolute( optarg );
+				drumkitsToValidate << sDrumkitToValidate;
 				bValidateDrumkit = true;
 				break;
 			case 'u':
 				//upgrade h2drumkit
 				sDrumkitToUpgrade = makePathAbsolute( optarg );
+				drumkitsToUpgrade << sDrumkitToUpgrade;
 				bUpgradeDrumkit = true;
 				break;
 			case 'x':
@@ -200,9 +242,40 @@ int main(int argc, char *argv[])
 				sDrumkitToExtract = makePathAbsolute( optarg );
 				bExtractDrumkit = true;
 				break;
+			case 'C':
+				//convert between XML and binary format
+				sFileToConvert = makePathAbsolute( optarg );
+				bConvertFile = true;
+				break;
+			case 'F':
+				sFormat = QString::fromLocal8Bit( optarg ).toLower();
+				bFormatSet = true;
+				break;
 			case 't':
 				sTarget = makePathAbsolute( optarg );
 				break;
+			case 'B':
+				bBatch = true;
+				break;
+			case 'j':
+				nJobs = strtol(optarg, nullptr, 10);
+				break;
+			case 'S':
+				bLoadSamples = true;
+				break;
+			case 'R':
+				sReport = QString::fromLocal8Bit( optarg );
+				if ( sReport != "-" ) {
+					sReport = makePathAbsolute( optarg );
+				}
+				break;
+			case 'm':
+				//import Standard MIDI Files
+				midiFiles << makePathAbsolute( optarg );
+				break;
+			case 'q':
+				nQuantize = strtol(optarg, nullptr, 10);
+				break;
 			case 'k':
 				//load Drumkit
 				drumkitToLoad = QString::fromLocal8Bit(optarg);
@@ -258,10 +331,162 @@ int main(int argc, char *argv[])
 #endif
 
 		if ( ! drumkitName.isEmpty() ){
-			Drumkit::install( drumkitName );
+			signal( SIGINT, signal_handler );
+			if ( ! Drumkit::install( drumkitName, "", false, printArchiveProgress ) ) {
+				std::cout << std::endl << "Unable to install drumkit [" <<
+					drumkitName.toLocal8Bit().data() << "]" << std::endl;
+				exit( -1 );
+			}
 			exit(0);
 		}
 
+		if ( bBatch && ( bValidateDrumkit || bUpgradeDrumkit ) ) {
+			// Neither audio nor a Hydrogen instance is required.
+			const auto action = bUpgradeDrumkit ?
+				DrumkitBatch::Action::Upgrade : DrumkitBatch::Action::Validate;
+			const QStringList drumkits = DrumkitBatch::findDrumkits(
+				bUpgradeDrumkit ? drumkitsToUpgrade : drumkitsToValidate );
+
+			DrumkitBatch::Options options;
+			options.nThreads = nJobs;
+			options.bLoadSamples = bLoadSamples;
+			options.sTargetDir = sTarget;
+
+			auto printResult = []( const DrumkitBatch::Result& result ) {
+				std::cout << ( result.bSuccess ? "OK     " : "FAILED " ) <<
+					result.sPath.toLocal8Bit().data();
+				if ( ! result.sName.isEmpty() ) {
+					std::cout << " [" << result.sName.toLocal8Bit().data() << "]";
+				}
+				std::cout << " (" << static_cast<int>( result.fElapsedMs ) << " ms)";
+				if ( ! result.sError.isEmpty() ) {
+					std::cout << ": " << result.sError.toLocal8Bit().data();
+				} else if ( ! result.bSuccess && ! result.bValid &&
+							! result.bUpgraded ) {
+					std::cout << ": does not comply with the XSD";
+				}
+				if ( ! result.missingSamples.isEmpty() ) {
+					std::cout << ": missing samples: " <<
+						result.missingSamples.join( ", " ).toLocal8Bit().data();
+				}
+				if ( ! result.brokenSamples.isEmpty() ) {
+					std::cout << ": broken samples: " <<
+						result.brokenSamples.join( ", " ).toLocal8Bit().data();
+				}
+				std::cout << std::endl;
+			};
+
+			QElapsedTimer timer;
+			timer.start();
+			const auto results = DrumkitBatch::run( action, drumkits, options,
+													printResult );
+			const double fElapsedMs = timer.nsecsElapsed() / 1000000.0;
+
+			int nFailed = 0;
+			for ( const auto& result : results ) {
+				if ( ! result.bSuccess ) {
+					++nFailed;
+				}
+			}
+			std::cout << results.size() - nFailed << " of " << results.size() <<
+				" drumkits " << ( bUpgradeDrumkit ? "upgraded" : "valid" ) <<
+				" in " << static_cast<int>( fElapsedMs ) << " ms" << std::endl;
+
+			if ( ! sReport.isEmpty() ) {
+				const QByteArray report = DrumkitBatch::toJson( action, results,
+																fElapsedMs );
+				if ( sReport == "-" ) {
+					std::cout << report.data();
+				} else {
+					QFile file( sReport );
+					if ( ! file.open( QIODevice::WriteOnly ) ||
+						 file.write( report ) != report.size() ) {
+						std::cout << "Unable to write report [" <<
+							sReport.toLocal8Bit().data() << "]" << std::endl;
+						exit( -1 );
+					}
+				}
+			}
+
+			exit( nFailed == 0 ? 0 : -1 );
+		}
+
+		if ( ! midiFiles.isEmpty() ) {
+			// Drumkit the MIDI notes are mapped onto.
+			const QString sDrumkit = drumkitToLoad.isEmpty() ? "GMRockKit" : drumkitToLoad;
+			QString sDrumkitPath = sDrumkit;
+			if ( ! Filesystem::drumkit_valid( sDrumkitPath ) ) {
+				sDrumkitPath = Filesystem::drumkit_path_search( sDrumkitPath,
+																Filesystem::Lookup::stacked,
+																true );
+			}
+			auto pDrumkit = sDrumkitPath.isEmpty() ? nullptr :
+				Drumkit::load( sDrumkitPath, false, true );
+			if ( pDrumkit == nullptr ) {
+				std::cout << "Unable to load drumkit [" <<
+					sDrumkit.toLocal8Bit().data() << "]" << std::endl;
+				exit( -1 );
+			}
+			if ( bFormatSet && sFormat != "xml" && sFormat != "binary" ) {
+				std::cout << "Unsupported format [" <<
+					sFormat.toLocal8Bit().data() << "]. Use either 'xml' or 'binary'" << std::endl;
+				exit( -1 );
+			}
+			if ( sTarget.isEmpty() ) {
+				sTarget = Filesystem::patterns_dir( pDrumkit->get_name() );
+			}
+
+			QStringList files;
+			for ( const auto& sPath : midiFiles ) {
+				if ( Filesystem::dir_exists( sPath, true ) ) {
+					const QDir dir( sPath );
+					for ( const auto& sFile : dir.entryList( { "*.mid", "*.midi" },
+															 QDir::Files, QDir::Name ) ) {
+						files << dir.filePath( sFile );
+					}
+				} else {
+					files << sPath;
+				}
+			}
+
+			QElapsedTimer timer;
+			timer.start();
+			const auto results = SMFReader::convertFiles(
+				files, sTarget, pDrumkit, nQuantize, bFormatSet && sFormat == "binary", nJobs );
+			const double fElapsedSeconds = timer.nsecsElapsed() / 1000000000.0;
+
+			int nFailed = 0;
+			int nNotes = 0;
+			for ( const auto& result : results ) {
+				if ( result.bSuccess ) {
+					std::cout << "OK     " << result.sSourceFile.toLocal8Bit().data() <<
+						" -> " << result.sPatternFile.toLocal8Bit().data() <<
+						" (" << result.nNotes << " notes";
+					if ( result.nUnmapped > 0 ) {
+						std::cout << ", " << result.nUnmapped << " without instrument";
+					}
+					std::cout << ")" << std::endl;
+					nNotes += result.nNotes;
+				} else {
+					std::cout << "FAILED " << result.sSourceFile.toLocal8Bit().data() <<
+						std::endl;
+					++nFailed;
+				}
+			}
+			std::cout << results.size() - nFailed << " of " << results.size() <<
+				" MIDI files converted into patterns for [" <<
+				pDrumkit->get_name().toLocal8Bit().data() << "] in " <<
+				static_cast<int>( fElapsedSeconds * 1000 ) << " ms";
+			if ( fElapsedSeconds > 0 ) {
+				std::cout << " (" << static_cast<int>( results.size() / fElapsedSeconds ) <<
+					" files/s, " << static_cast<int>( nNotes / fElapsedSeconds ) <<
+					" notes/s)";
+			}
+			std::cout << std::endl;
+
+			exit( nFailed == 0 ? 0 : -1 );
+		}
+
 		if (sSelectedDriver == "auto") {
 			preferences->m_sAudioDriver = "Auto";
 		}
@@ -374,6 +599,9 @@ int main(int argc, char *argv[])
 			case 4:
 					pSampler->setInterpolateMode( Interpolation::InterpolateMode::Hermite );
 					break;
+			case 5:
+					pSampler->setInterpolateMode( Interpolation::InterpolateMode::Sinc );
+					break;
 			case 0:
 			default:
 					pSampler->setInterpolateMode( Interpolation::InterpolateMode::Linear );
@@ -412,8 +640,10 @@ int main(int argc, char *argv[])
 
 		} else if ( bExtractDrumkit ) {
 			if ( ! pCoreActionController->extractDrumkit( sDrumkitToExtract,
-														  sTarget ) ) {
+														  sTarget,
+														  printArchiveProgress ) ) {
 				nReturnCode = -1;
+				std::cout << std::endl;
 
 				if ( sTarget.isEmpty() ) {
 					std::cout << "Unable to install drumkit [" <<
@@ -455,6 +685,33 @@ int main(int argc, char *argv[])
 				}
 				std::cout << std::endl;
 			}
+		} else if ( bConvertFile ) {
+			// Drumkits can be specified by their folder.
+			if ( Filesystem::dir_exists( sFileToConvert, true ) ) {
+				sFileToConvert = Filesystem::drumkit_file( sFileToConvert );
+			}
+			if ( sTarget.isEmpty() ) {
+				sTarget = sFileToConvert;
+			}
+
+			if ( sFormat != "xml" && sFormat != "binary" ) {
+				nReturnCode = -1;
+
+				std::cout << "Unknown format [" <<
+					sFormat.toLocal8Bit().data() << "]. Use either 'xml' or 'binary'" << std::endl;
+				
+			} else if ( ! BinaryDoc::convert( sFileToConvert, sTarget,
+											  sFormat == "binary" ) ) {
+				nReturnCode = -1;
+
+				std::cout << "Unable to convert [" <<
+					sFileToConvert.toLocal8Bit().data() << "]!" << std::endl;
+				
+			} else {
+				std::cout << "[" << sFileToConvert.toLocal8Bit().data() <<
+					"] converted into " << sFormat.toLocal8Bit().data() <<
+					" format [" << sTarget.toLocal8Bit().data() << "]" << std::endl;
+			}
 		} else {
 
 			// Interactive mode
@@ -596,7 +853,7 @@ void showUsage()
 	std::cout << "   -b, --bits BITS - Set bits depth while exporting file" << std::endl;
 	std::cout << "   -k, --kit drumkit_name - Load a drumkit at startup" << std::endl;
 	std::cout << "   -I, --interpolate INT - Interpolation" << std::endl;
-	std::cout << "       [0:linear (default), 1:cosine, 2:third, 3:cubic, 4:hermite]" << std::endl;
+	std::cout << "       [0:linear (default), 1:cosine, 2:third, 3:cubic, 4:hermite, 5:sinc]" << std::endl;
 
 #ifdef H2CORE_HAVE_LASH
 	std::cout << "   --lash-no-start-server - If LASH server not running, don't start" << std::endl
@@ -625,11 +882,56 @@ void showUsage()
 	std::cout << "   -x, --extract FILE - extracts the content of a drumkit (.h2drumkit)" << std::endl;
 	std::cout << "                        If no target is specified using the -t option" << std::endl;
 	std::cout << "                        this command behaves like --install." << std::endl;
+	std::cout << "                        Both --install and --extract report their" << std::endl;
+	std::cout << "                        progress and can be cancelled using Ctrl+C." << std::endl;
 	std::cout << "   -t, --target FOLDER - target folder the extracted (-x) or upgraded (-u)" << std::endl;
 	std::cout << "                         drumkit will be stored in. The folder is created" << std::endl;
 	std::cout << "                         if it not exists yet." << std::endl;
+	std::cout << "   -B, --batch - validates (-c) or upgrades (-u) whole drumkit libraries" << std::endl;
+	std::cout << "                 in parallel. Both options can be given multiple times" << std::endl;
+	std::cout << "                 and accept folders, which are searched recursively" << std::endl;
+	std::cout << "                 for drumkits. Only the drumkit.xml files are checked" << std::endl;
+	std::cout << "                 and the presence of the samples they reference. Using" << std::endl;
+	std::cout << "                 -t each upgraded drumkit is stored in a subfolder of" << std::endl;
+	std::cout << "                 FOLDER. Kits already valid are not upgraded in place." << std::endl;
+	std::cout << "   -j, --jobs N - number of drumkits processed at once (-B, -m)" << std::endl;
+	std::cout << "                  [number of CPU cores (default)]" << std::endl;
+	std::cout << "   -S, --samples - loads all samples to check they can be decoded (-B)" << std::endl;
+	std::cout << "   -R, --report FILE - writes a JSON report containing the results and" << std::endl;
+	std::cout << "                       timing of each drumkit (-B). Use '-' for stdout." << std::endl;
 	std::cout << std::endl;
 	std::cout << "Example: h2cli -c /usr/share/hydrogen/data/drumkits/GMRockKit" << std::endl;
+	std::cout << "         h2cli -B -c ~/.hydrogen/data/drumkits -R report.json" << std::endl;
+
+	std::cout << std::endl;
+	std::cout << "File formats:" << std::endl;
+	std::cout << "   -C, --convert FILE - converts a song (*.h2song), pattern (*.h2pattern)," << std::endl;
+	std::cout << "                        or drumkit (folder or drumkit.xml) between" << std::endl;
+	std::cout << "                        the XML and the binary format. If no target file" << std::endl;
+	std::cout << "                        was specified using the -t option, FILE is" << std::endl;
+	std::cout << "                        converted in place." << std::endl;
+	std::cout << "   -F, --format FORMAT - format to convert into (-C)" << std::endl;
+	std::cout << "       [xml, binary (default)]" << std::endl;
+	std::cout << std::endl;
+	std::cout << "Example: h2cli -C ./example.h2song -F binary -t ./example_binary.h2song" << std::endl;
+
+	std::cout << std::endl;
+	std::cout << "MIDI import:" << std::endl;
+	std::cout << "   -m, --midi FILE - converts a Standard MIDI File (format 0 or 1) into" << std::endl;
+	std::cout << "                     a pattern (*.h2pattern). FILE can also be a folder" << std::endl;
+	std::cout << "                     of which all *.mid and *.midi files are converted." << std::endl;
+	std::cout << "                     The option can be given multiple times. MIDI" << std::endl;
+	std::cout << "                     notes are mapped onto the instruments of the" << std::endl;
+	std::cout << "                     drumkit selected using -k (GMRockKit by default)" << std::endl;
+	std::cout << "                     by their MIDI out note. The patterns are stored" << std::endl;
+	std::cout << "                     in the folder specified using -t or in the" << std::endl;
+	std::cout << "                     pattern folder of the drumkit. Files are converted" << std::endl;
+	std::cout << "                     in parallel (-j) and stored as XML unless -F binary" << std::endl;
+	std::cout << "                     is given." << std::endl;
+	std::cout << "   -q, --quantize TICKS - grid the notes are quantized to (-m). A quarter" << std::endl;
+	std::cout << "                          has 48 ticks [1 (default)]" << std::endl;
+	std::cout << std::endl;
+	std::cout << "Example: h2cli -m ./grooves -k GMRockKit -q 6 -t ./patterns" << std::endl;
 
 	std::cout << std::endl;
 	std::cout << "Miscellaneous:" << std::endl;
@@ -52,6 +52,7 @@
 #include <core/IO/CoreMidiDriver.h>
 #include <core/IO/OssDriver.h>
 #include <core/IO/FakeDriver.h>
+#include <core/IO/BenchmarkDriver.h>
 #include <core/IO/AlsaAudioDriver.h>
 #include <core/IO/PortAudioDriver.h>
 #include <core/IO/DiskWriterDriver.h>
@@ -64,6 +65,7 @@
 #include <core/Hydrogen.h>
 #include <core/Preferences/Preferences.h>
 
+#include <algorithm>
 #include <limits>
 #include <random>
 
@@ -72,25 +74,6 @@ namespace H2Core
 
 const int AudioEngine::nMaxTimeHumanize = 2000;
 
-inline int randomValue( int max )
-{
-	return rand() % max;
-}
-
-inline float getGaussian( float z )
-{
-	// gaussian distribution -- dimss
-	float x1, x2, w;
-	do {
-		x1 = 2.0 * ( ( ( float ) rand() ) / static_cast<float>(RAND_MAX) ) - 1.0;
-		x2 = 2.0 * ( ( ( float ) rand() ) / static_cast<float>(RAND_MAX) ) - 1.0;
-		w = x1 * x1 + x2 * x2;
-	} while ( w >= 1.0 );
-
-	w = sqrtf( ( -2.0 * logf( w ) ) / w );
-	return x1 * w * z + 0.0; // tunable
-}
-
 
 /** Gets the current time.
  * \return Current time obtained by gettimeofday()*/
@@ -111,6 +94,7 @@ AudioEngine::AudioEngine()
 		, m_pMetronomeInstrument( nullptr )
 		, m_fSongSizeInTicks( 0 )
 		, m_nRealtimeFrame( 0 )
+		, m_nSubBlockOffset( 0 )
 		, m_fMasterPeak_L( 0.0f )
 		, m_fMasterPeak_R( 0.0f )
 		, m_nextState( State::Ready )
@@ -121,6 +105,7 @@ AudioEngine::AudioEngine()
 		, m_pLocker({nullptr, 0, nullptr})
 		, m_fLastTickEnd( 0 )
 		, m_bLookaheadApplied( false )
+		, m_random( Random::createSeed() )
 {
 	m_pTransportPosition = std::make_shared<TransportPosition>( "Transport" );
 	m_pQueuingPosition = std::make_shared<TransportPosition>( "Queuing" );
@@ -130,8 +115,6 @@ AudioEngine::AudioEngine()
 	
 	m_pEventQueue = EventQueue::get_instance();
 	
-	srand( time( nullptr ) );
-
 	// Create metronome instrument
 	// Get the path to the file of the metronome sound.
 	QString sMetronomeFilename = Filesystem::click_file_path();
@@ -302,6 +285,10 @@ void AudioEngine::stopPlayback()
 	}
 
 	setState( State::Ready );
+
+	if ( Hydrogen::get_instance()->getMidiOutput() != nullptr ) {
+		Hydrogen::get_instance()->getMidiOutput()->clearQueue();
+	}
 }
 
 void AudioEngine::reset( bool bWithJackBroadcast ) {
@@ -431,6 +418,12 @@ void AudioEngine::locateToFrame( const long long nFrame ) {
 void AudioEngine::resetOffsets() {
 	clearNoteQueues();
 
+	// Notes of the former position already handed over to the MIDI
+	// driver must not be sent anymore.
+	if ( Hydrogen::get_instance()->getMidiOutput() != nullptr ) {
+		Hydrogen::get_instance()->getMidiOutput()->clearQueue();
+	}
+
 	m_fLastTickEnd = 0;
 	m_bLookaheadApplied = false;
 
@@ -727,6 +720,11 @@ void AudioEngine::clearAudioBuffers( uint32_t nFrames )
 
 	mx.unlock();
 
+	clearFXBuffers( nFrames );
+}
+
+void AudioEngine::clearFXBuffers( uint32_t nFrames )
+{
 #ifdef H2CORE_HAVE_LADSPA
 	if ( getState() == State::Ready ||
 		 getState() == State::Playing ||
@@ -782,6 +780,10 @@ AudioOutput* AudioEngine::createAudioDriver( const QString& sDriver )
 		WARNINGLOG( "*** Using FAKE audio driver ***" );
 		pAudioDriver = new FakeDriver( m_AudioProcessCallback );
 	}
+	else if ( sDriver == "Benchmark" ) {
+		WARNINGLOG( "*** Using BENCHMARK audio driver ***" );
+		pAudioDriver = new BenchmarkDriver( m_AudioProcessCallback );
+	}
 	else if ( sDriver == "DiskWriterDriver" ) {
 		pAudioDriver = new DiskWriterDriver( m_AudioProcessCallback );
 	}
@@ -1148,7 +1150,7 @@ void AudioEngine::processPlayNotes( unsigned long nframes )
 			float fNoteProbability = pNote->get_probability();
 			if ( fNoteProbability != 1. ) {
 				// Current note is skipped with a certain probability.
-				if ( fNoteProbability < (float) rand() / (float) RAND_MAX ) {
+				if ( fNoteProbability < m_random.uniform() ) {
 					m_songNoteQueue.pop();
 					pNote->get_instrument()->dequeue();
 					continue;
@@ -1156,7 +1158,7 @@ void AudioEngine::processPlayNotes( unsigned long nframes )
 			}
 
 			if ( pSong->getHumanizeVelocityValue() != 0 ) {
-				const float fRandom = pSong->getHumanizeVelocityValue() * getGaussian( 0.2 );
+				const float fRandom = pSong->getHumanizeVelocityValue() * m_random.gaussian() * 0.2;
 				pNote->set_velocity(
 							pNote->get_velocity()
 							+ ( fRandom
@@ -1172,7 +1174,7 @@ void AudioEngine::processPlayNotes( unsigned long nframes )
 			float fPitch = pNote->get_pitch() + pNote->get_instrument()->get_pitch_offset();
 			const float fRandomPitchFactor = pNote->get_instrument()->get_random_pitch_factor();
 			if ( fRandomPitchFactor != 0. ) {
-				fPitch += getGaussian( 0.4 ) * fRandomPitchFactor;
+				fPitch += m_random.gaussian() * 0.4 * fRandomPitchFactor;
 			}
 			pNote->set_pitch( fPitch );
 
@@ -1257,12 +1259,19 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 	 * (like shutting down drivers). In such cases, it seems to be ok to interrupt
 	 * audio processing. Returning the special return value "2" enables the disk 
 	 * writer driver to repeat the processing of the current data.
+	 *
+	 * A deterministic export does not depend on the wall clock and
+	 * just waits for the lock.
 	 */
-	if ( !pAudioEngine->tryLockFor( std::chrono::microseconds( (int)(1000.0*fSlackTime) ),
+	auto pDiskWriterDriver = dynamic_cast<DiskWriterDriver*>(pAudioEngine->m_pAudioDriver);
+	if ( pDiskWriterDriver != nullptr && pDiskWriterDriver->isDeterministic() ) {
+		pAudioEngine->lock( RIGHT_HERE );
+	}
+	else if ( !pAudioEngine->tryLockFor( std::chrono::microseconds( (int)(1000.0*fSlackTime) ),
 							  RIGHT_HERE ) ) {
 		___ERRORLOG( QString( "Failed to lock audioEngine in allowed %1 ms, missed buffer" ).arg( fSlackTime ) );
 
-		if ( dynamic_cast<DiskWriterDriver*>(pAudioEngine->m_pAudioDriver) != nullptr ) {
+		if ( pDiskWriterDriver != nullptr ) {
 			return 2;	// inform the caller that we could not acquire the lock
 		}
 
@@ -1271,6 +1280,7 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 
 	if ( ! ( pAudioEngine->getState() == AudioEngine::State::Ready ||
 			 pAudioEngine->getState() == AudioEngine::State::Playing ) ) {
+		pAudioEngine->publishSnapshot();
 		pAudioEngine->unlock();
 		return 0;
 	}
@@ -1329,10 +1339,16 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 		}
 	}
 
-	pAudioEngine->processAudio( nframes );
+	if ( pAudioEngine->getState() == AudioEngine::State::Playing &&
+		 Preferences::get_instance()->m_bSubBlockRendering ) {
+		pAudioEngine->processSubBlocks( nframes );
+	}
+	else {
+		pAudioEngine->processAudio( nframes );
 
-	if ( pAudioEngine->getState() == AudioEngine::State::Playing ) {
-		pAudioEngine->incrementTransportPosition( nframes );
+		if ( pAudioEngine->getState() == AudioEngine::State::Playing ) {
+			pAudioEngine->incrementTransportPosition( nframes );
+		}
 	}
 
 	timeval finishTimeval = currentTime2();
@@ -1355,22 +1371,114 @@ int AudioEngine::audioEngine_process( uint32_t nframes, void* /*arg*/ )
 	}
 #endif
 
+	pAudioEngine->publishSnapshot();
 	pAudioEngine->unlock();
 
 	return 0;
 }
 
-void AudioEngine::processAudio( uint32_t nFrames ) {
+void AudioEngine::publishSnapshot() {
+	Snapshot snapshot;
+	snapshot.state = m_state;
+	snapshot.nFrame = m_pTransportPosition->getFrame();
+	snapshot.nTick = m_pTransportPosition->getTick();
+	snapshot.nPatternTickPosition = m_pTransportPosition->getPatternTickPosition();
+	snapshot.nColumn = m_pTransportPosition->getColumn();
+	snapshot.fBpm = m_pTransportPosition->getBpm();
+	snapshot.fElapsedTime = getElapsedTime();
+	snapshot.nRealtimeFrame = m_nRealtimeFrame;
+	snapshot.fProcessTime = m_fProcessTime;
+	snapshot.fMaxProcessTime = m_fMaxProcessTime;
+	snapshot.fMasterPeak_L = m_fMasterPeak_L;
+	snapshot.fMasterPeak_R = m_fMasterPeak_R;
+	m_snapshot.store( snapshot );
+}
+
+void AudioEngine::processSubBlocks( uint32_t nFrames ) {
+	const uint32_t nMinSize = static_cast<uint32_t>(
+		std::clamp( Preferences::get_instance()->m_nMinSubBlockSize,
+					1, static_cast<int>( nFrames ) ) );
+
+	uint32_t nOffset = 0;
+	while ( nOffset < nFrames ) {
+		const uint32_t nRemaining = nFrames - nOffset;
+
+		// Start all notes due at the current frame. Afterwards the
+		// top of the note queue is the next note to start.
+		processPlayNotes( 1 );
+
+		uint32_t nSize = computeSubBlockSize( nRemaining );
+		if ( nSize < nMinSize ) {
+			nSize = std::min( nMinSize, nRemaining );
+		}
+
+		// The LADSPA plugins process their buffers in place and can
+		// not be pointed to an offset.
+		if ( nOffset > 0 ) {
+			clearFXBuffers( nSize );
+		}
+
+		m_nSubBlockOffset = nOffset;
+		processAudio( nSize, nOffset );
+		incrementTransportPosition( nSize );
+
+		nOffset += nSize;
+	}
+	m_nSubBlockOffset = 0;
+}
+
+long long AudioEngine::computeFrameOffsetInPeriod( long long nFrame ) const {
+	long long nPeriodStart;
+	if ( m_state == State::Playing || m_state == State::Testing ) {
+		// Within processSubBlocks() transport was already moved to
+		// the start of the current sub-block.
+		nPeriodStart = m_pTransportPosition->getFrame() -
+			static_cast<long long>( m_nSubBlockOffset );
+	} else {
+		nPeriodStart = m_nRealtimeFrame;
+	}
+
+	return std::max( nFrame - nPeriodStart, 0LL );
+}
+
+uint32_t AudioEngine::computeSubBlockSize( uint32_t nMaxFrames ) {
+	auto pHydrogen = Hydrogen::get_instance();
+	auto pSong = pHydrogen->getSong();
+
+	const long long nFrame = m_pTransportPosition->getFrame();
+	long long nBoundary = nFrame + static_cast<long long>( nMaxFrames );
+
+	if ( ! m_songNoteQueue.empty() ) {
+		nBoundary = std::min( nBoundary, m_songNoteQueue.top()->getNoteStart() );
+	}
+
+	// Tempo changes of the Timeline are tied to columns.
+	if ( pHydrogen->isTimelineEnabled() ) {
+		const int nNextColumn = m_pTransportPosition->getColumn() + 1;
+		if ( nNextColumn > 0 &&
+			 nNextColumn < static_cast<int>( pSong->getPatternGroupVector()->size() ) &&
+			 getBpmAtColumn( nNextColumn ) != m_pTransportPosition->getBpm() ) {
+			double fTickMismatch;
+			nBoundary = std::min(
+				nBoundary, TransportPosition::computeFrameFromTick(
+					pHydrogen->getTickForColumn( nNextColumn ), &fTickMismatch ) );
+		}
+	}
+
+	return static_cast<uint32_t>( std::max( nBoundary - nFrame, 1LL ) );
+}
+
+void AudioEngine::processAudio( uint32_t nFrames, uint32_t nOffset ) {
 
 	auto pSong = Hydrogen::get_instance()->getSong();
 
 	processPlayNotes( nFrames );
 
-	float *pBuffer_L = m_pAudioDriver->getOut_L(),
-		*pBuffer_R = m_pAudioDriver->getOut_R();
+	float *pBuffer_L = m_pAudioDriver->getOut_L() + nOffset,
+		*pBuffer_R = m_pAudioDriver->getOut_R() + nOffset;
 	assert( pBuffer_L != nullptr && pBuffer_R != nullptr );
 
-	getSampler()->process( nFrames, pSong );
+	getSampler()->process( nFrames, pSong, nOffset );
 	float* out_L = getSampler()->m_pMainOut_L;
 	float* out_R = getSampler()->m_pMainOut_R;
 	for ( unsigned i = 0; i < nFrames; ++i ) {
@@ -2249,7 +2357,7 @@ int AudioEngine::updateNoteQueue( unsigned nIntervalLengthInFrames )
 				INFOLOG( "End of song reached." );
 
 				if( pHydrogen->getMidiOutput() != nullptr ){
-					pHydrogen->getMidiOutput()->handleQueueAllNoteOff();
+					pHydrogen->getMidiOutput()->handleQueueAllNoteOffAt( nNewFrame );
 				}
 
 				return -1;
@@ -2388,7 +2496,7 @@ int AudioEngine::updateNoteQueue( unsigned nIntervalLengthInFrames )
 						*/
 						if ( pSong->getHumanizeTimeValue() != 0 ) {
 							nOffset += ( int )(
-										getGaussian( 0.3 )
+										m_random.gaussian() * 0.3
 										* pSong->getHumanizeTimeValue()
 										* AudioEngine::nMaxTimeHumanize
 										);
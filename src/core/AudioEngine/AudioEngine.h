@@ -31,6 +31,8 @@
 #include <core/Sampler/Sampler.h>
 #include <core/Synth/Synth.h>
 #include <core/Basics/Note.h>
+#include <core/Helpers/Random.h>
+#include <core/Helpers/SeqLock.h>
 #include <core/CoreActionController.h>
 
 #include <core/IO/AudioOutput.h>
@@ -237,6 +239,18 @@ public:
 	Sampler*		getSampler() const;
 	Synth*			getSynth() const;
 
+	/**
+	 * Random number generator used for humanization, note
+	 * probabilities, and random layer selection.
+	 *
+	 * It must only be used by the thread holding the audio engine
+	 * lock, usually the one of the audio driver.
+	 */
+	Random&			getRandom();
+	/** Reseeds getRandom(). Used at the start of an export to make
+	 * it reproducible. */
+	void			seedRandom( uint64_t nSeed );
+
 	/** \return Time passed since the beginning of the song*/
 	float			getElapsedTime() const;	
 
@@ -303,6 +317,49 @@ public:
 	const PatternList*	getPlayingPatterns() const;
 	
 	long long		getRealtimeFrame() const;
+	/**
+	 * \return Number of frames between the start of the period
+	 * currently processed and @a nFrame, given in the frame domain of
+	 * Note::getNoteStart(). Frames prior to the period yield 0.
+	 *
+	 * Takes into account that the transport position already
+	 * advanced to the start of the current sub-block in
+	 * processSubBlocks(). Intended to be used by MIDI drivers in the
+	 * audio thread to place outgoing messages.
+	 */
+	long long		computeFrameOffsetInPeriod( long long nFrame ) const;
+
+	/**
+	 * Transport position and engine statistics as of the end of
+	 * the last process cycle.
+	 *
+	 * Published by audioEngine_process() and readable from any
+	 * thread without locking the AudioEngine. Intended for
+	 * displays, like the ones of the GUI, which would otherwise
+	 * query the members of the engine and its
+	 * #TransportPosition while the audio thread is writing them.
+	 */
+	struct Snapshot {
+		State state = State::Uninitialized;
+		long long nFrame = 0;
+		long nTick = 0;
+		long nPatternTickPosition = 0;
+		int nColumn = -1;
+		float fBpm = 120;
+		/** In seconds. */
+		float fElapsedTime = 0;
+		long long nRealtimeFrame = 0;
+		/** In milliseconds. */
+		float fProcessTime = 0;
+		/** In milliseconds. */
+		float fMaxProcessTime = 0;
+		float fMasterPeak_L = 0;
+		float fMasterPeak_R = 0;
+	};
+	Snapshot		getSnapshot() const;
+	/** \return Counter increased with every published
+	 * #Snapshot. */
+	size_t			getSnapshotVersion() const;
 
 	/** Maximum lead lag factor in ticks.
 	 *
@@ -449,6 +506,9 @@ private:
 	/** Clear all audio buffers.
 	 */
 	void			clearAudioBuffers( uint32_t nFrames );
+	/** Clears the first @a nFrames frames of the buffers of all
+	 * LADSPA effects. */
+	void			clearFXBuffers( uint32_t nFrames );
 	/**
 	 * Takes all notes from the currently playing patterns, from the
 	 * MIDI queue #m_midiNoteQueue, and those triggered by the
@@ -460,7 +520,33 @@ private:
 	 * deactivated, and the end of the song was reached.
 	 */
 	int				updateNoteQueue( unsigned nIntervalLengthInFrames );
-	void 			processAudio( uint32_t nFrames );
+	/**
+	 * Renders @a nFrames frames into the buffers of the audio driver
+	 * starting at @a nOffset.
+	 */
+	void 			processAudio( uint32_t nFrames, uint32_t nOffset = 0 );
+	/**
+	 * Renders a period of @a nFrames frames in consecutive sub-blocks
+	 * and advances the transport position accordingly.
+	 *
+	 * The period is split at the start of each note as well as at
+	 * tempo changes of the Timeline. This way all notes start at the
+	 * first frame of a sub-block and the new tempo is applied at the
+	 * exact frame it is set at instead of at the start of the next
+	 * period. Sub-blocks are never shorter than
+	 * Preferences::m_nMinSubBlockSize frames, apart from the last one
+	 * of a period. Notes starting within a sub-block are delayed by
+	 * the Sampler as in unsplit periods.
+	 *
+	 * Only used while transport is rolling and
+	 * Preferences::m_bSubBlockRendering is set.
+	 */
+	void			processSubBlocks( uint32_t nFrames );
+	/**
+	 * \return Number of frames till the next note start or tempo
+	 * change, but at most @a nMaxFrames. At least 1.
+	 */
+	uint32_t		computeSubBlockSize( uint32_t nMaxFrames );
 	long long 		computeTickInterval( double* fTickStart, double* fTickEnd, unsigned nIntervalLengthInFrames );
 	void			updateBpmAndTickSize( std::shared_ptr<TransportPosition> pTransportPosition );
 	void			calculateTransportOffsetOnBpmChange( std::shared_ptr<TransportPosition> pTransportPosition );
@@ -582,6 +668,11 @@ private:
 	float				m_fMaxProcessTime;
 	float				m_fLadspaTime;
 
+	/** Stores the current state in #m_snapshot. Called by the
+	 * audio thread while holding the lock of the engine. */
+	void publishSnapshot();
+	SeqLock<Snapshot>	m_snapshot;
+
 	std::shared_ptr<TransportPosition> m_pTransportPosition;
 	std::shared_ptr<TransportPosition> m_pQueuingPosition;
 
@@ -597,6 +688,9 @@ private:
 	 * timing.
 	 */
 	long long		m_nRealtimeFrame;
+	/** Position of the sub-block currently rendered by
+	 * processSubBlocks() within the period. 0 outside of it. */
+	uint32_t		m_nSubBlockOffset;
 
 	/**
 	 * Current state of the H2Core::AudioEngine.
@@ -632,6 +726,8 @@ private:
 	float 			m_fNextBpm;
 	double m_fLastTickEnd;
 	bool m_bLookaheadApplied;
+
+	Random				m_random;
 };
 
 
@@ -677,6 +773,12 @@ public:
 };
 
 
+inline Random& AudioEngine::getRandom() {
+	return m_random;
+}
+inline void AudioEngine::seedRandom( uint64_t nSeed ) {
+	m_random.seed( nSeed );
+}
 inline void AudioEngine::assertLocked( ) {
 #ifndef NDEBUG
 	assert( m_LockingThread == std::this_thread::get_id() );
@@ -730,6 +832,12 @@ inline MidiOutput*	AudioEngine::getMidiOutDriver() const {
 	return m_pMidiDriverOut;
 }
 
+inline AudioEngine::Snapshot AudioEngine::getSnapshot() const {
+	return m_snapshot.load();
+}
+inline size_t AudioEngine::getSnapshotVersion() const {
+	return m_snapshot.getVersion();
+}
 inline long long AudioEngine::getRealtimeFrame() const {
 	return m_nRealtimeFrame;
 }
@@ -34,6 +34,7 @@
 #include <core/Basics/Sample.h>
 #include <core/Basics/Song.h>
 #include <core/Sampler/Sampler.h>
+#include <core/IO/MidiOutput.h>
 #include <core/Hydrogen.h>
 #include <core/CoreActionController.h>
 #include <core/Preferences/Preferences.h>
@@ -1563,6 +1564,128 @@ void AudioEngineTests::toggleAndCheckConsistency( int nToggleColumn, int nToggle
 	toggleAndCheck( sContext + " : 2. toggle" );
 }
 
+/** Records the offsets within the period assigned to outgoing note
+ * ons. */
+class MidiTimingRecorder : public Object<MidiTimingRecorder>, public virtual MidiOutput
+{
+	H2_OBJECT(MidiTimingRecorder)
+public:
+	struct Event {
+		long long nNoteStart;
+		long long nOffset;
+	};
+
+	virtual std::vector<QString> getInputPortList() override {
+		return std::vector<QString>();
+	}
+	virtual void handleQueueNote( Note* pNote ) override {
+		const long long nNoteStart = pNote->getNoteStart();
+		m_events.push_back(
+			{ nNoteStart, Hydrogen::get_instance()->getAudioEngine()->
+			  computeFrameOffsetInPeriod( nNoteStart ) } );
+	}
+	virtual void handleQueueNoteOff( int, int, int ) override {}
+	virtual void handleQueueAllNoteOff() override {}
+	virtual void handleOutgoingControlChange( int, int, int ) override {}
+
+	std::vector<Event> m_events;
+};
+
+void AudioEngineTests::testSubBlockMidiTiming() {
+	auto pHydrogen = Hydrogen::get_instance();
+	auto pAE = pHydrogen->getAudioEngine();
+	auto pTransportPos = pAE->getTransportPosition();
+	auto pPref = Preferences::get_instance();
+
+	const bool bOldSubBlockRendering = pPref->m_bSubBlockRendering;
+	const int nOldMinSubBlockSize = pPref->m_nMinSubBlockSize;
+	pPref->m_bSubBlockRendering = true;
+	pPref->m_nMinSubBlockSize = 1;
+
+	pAE->lock( RIGHT_HERE );
+
+	pAE->reset( false );
+	pAE->setState( AudioEngine::State::Testing );
+	AudioEngineTests::resetSampler( __PRETTY_FUNCTION__ );
+
+	MidiTimingRecorder recorder;
+	MidiOutput* pOldMidiOut = pAE->m_pMidiDriverOut;
+	pAE->m_pMidiDriverOut = &recorder;
+
+	auto fail = [&]( const QString& sMsg ) {
+		pAE->m_pMidiDriverOut = pOldMidiOut;
+		pPref->m_bSubBlockRendering = bOldSubBlockRendering;
+		pPref->m_nMinSubBlockSize = nOldMinSubBlockSize;
+		AudioEngineTests::throwException( sMsg );
+	};
+
+	const uint32_t nFrames = pPref->m_nBufferSize;
+	const int nMaxCycles =
+		std::max( std::ceil( static_cast<double>(pAE->m_fSongSizeInTicks) /
+							 static_cast<double>(nFrames) *
+							 static_cast<double>(pTransportPos->getTickSize()) * 4.0 ),
+				  static_cast<double>(pAE->m_fSongSizeInTicks) );
+
+	int nNotes = 0;
+	int nNotesWithinPeriod = 0;
+	int nTempoChanges = 0;
+	int nn = 0;
+	bool bEndOfSongReached = false;
+	while ( pTransportPos->getDoubleTick() < pAE->m_fSongSizeInTicks ) {
+		const long long nPeriodStart = pTransportPos->getFrame();
+		const float fBpm = pTransportPos->getBpm();
+		recorder.m_events.clear();
+
+		if ( ! bEndOfSongReached ) {
+			if ( pAE->updateNoteQueue( nFrames ) == -1 ) {
+				bEndOfSongReached = true;
+			}
+		}
+		pAE->processSubBlocks( nFrames );
+
+		if ( pTransportPos->getFrame() != nPeriodStart + nFrames ) {
+			fail( QString( "[testSubBlockMidiTiming] transport at [%1] instead of [%2]" )
+				  .arg( pTransportPos->getFrame() ).arg( nPeriodStart + nFrames ) );
+		}
+		if ( pTransportPos->getBpm() != fBpm ) {
+			++nTempoChanges;
+		}
+
+		for ( const auto& event : recorder.m_events ) {
+			const long long nExpected = std::max( event.nNoteStart - nPeriodStart, 0LL );
+			if ( event.nOffset != nExpected || event.nOffset >= nFrames ) {
+				fail( QString( "[testSubBlockMidiTiming] note starting at frame [%1] got offset [%2] instead of [%3] in period starting at [%4]" )
+					  .arg( event.nNoteStart ).arg( event.nOffset )
+					  .arg( nExpected ).arg( nPeriodStart ) );
+			}
+			if ( event.nOffset > 0 ) {
+				++nNotesWithinPeriod;
+			}
+			++nNotes;
+		}
+
+		++nn;
+		if ( nn > nMaxCycles ) {
+			fail( QString( "[testSubBlockMidiTiming] end of the song wasn't reached in time. pTransportPos->getDoubleTick(): %1, pAE->m_fSongSizeInTicks: %2" )
+				  .arg( pTransportPos->getDoubleTick(), 0, 'f' )
+				  .arg( pAE->m_fSongSizeInTicks, 0, 'f' ) );
+		}
+	}
+
+	// Ensure the song did cover what this test is about.
+	if ( nTempoChanges == 0 || nNotesWithinPeriod == 0 ) {
+		fail( QString( "[testSubBlockMidiTiming] insufficient coverage. tempo changes: %1, notes: %2, notes within period: %3" )
+			  .arg( nTempoChanges ).arg( nNotes ).arg( nNotesWithinPeriod ) );
+	}
+
+	pAE->m_pMidiDriverOut = pOldMidiOut;
+	pPref->m_bSubBlockRendering = bOldSubBlockRendering;
+	pPref->m_nMinSubBlockSize = nOldMinSubBlockSize;
+
+	pAE->setState( AudioEngine::State::Ready );
+	pAE->unlock();
+}
+
 void AudioEngineTests::resetSampler( const QString& sContext ) {
 	auto pHydrogen = Hydrogen::get_instance();
 	auto pAE = pHydrogen->getAudioEngine();
@@ -89,6 +89,14 @@ public:
 	 * Sampler is consistent on tempo change.
 	 */
 	static void testNoteEnqueuingTimeline();
+
+	/**
+	 * Checks whether notes rendered in sub-blocks (see
+	 * AudioEngine::processSubBlocks()) are handed to the MIDI output
+	 * along with their offset within the period, even if the tempo
+	 * changes within a period.
+	 */
+	static void testSubBlockMidiTiming();
 	
 private:
 	static int processTransport( const QString& sContext,
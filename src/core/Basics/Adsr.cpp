@@ -273,6 +273,26 @@ bool ADSR::applyADSR( float *pLeft, float *pRight, int nFrames, int nReleaseFram
 	return false;
 }
 
+bool ADSR::applyConstant( int nFrames, int nReleaseFrame, float* pfValue )
+{
+	const bool bSustains = __state == SUSTAIN ||
+		( __state == ATTACK && __attack == 0 && __decay == 0 ) ||
+		( __state == DECAY && __decay == 0 );
+	if ( ! bSustains || nFrames <= 0 || nReleaseFrame <= nFrames ) {
+		return false;
+	}
+
+	if ( __state != SUSTAIN ) {
+		__state = SUSTAIN;
+		__ticks = 0;
+		m_fQ = fDecayInit;
+	}
+	__value = __sustain;
+	*pfValue = __sustain;
+
+	return true;
+}
+
 void ADSR::attack()
 {
 	__state = ATTACK;
@@ -291,6 +311,26 @@ float ADSR::release()
 	return __release_value;
 }
 
+float ADSR::fadeOut( unsigned int nFrames )
+{
+	if ( __state == IDLE ) {
+		return 0;
+	}
+	if ( nFrames == 0 ) {
+		nFrames = 1;
+	}
+	if ( __state == RELEASE && __release - __ticks <= nFrames ) {
+		// Already fading out fast enough.
+		return __value;
+	}
+	__release_value = __value;
+	__release = nFrames;
+	__state = RELEASE;
+	__ticks = 0;
+	m_fQ = fDecayInit;
+	return __release_value;
+}
+
 QString ADSR::toQString( const QString& sPrefix, bool bShort ) const {
 	QString s = Base::sPrintIndention;
 	QString sOutput;
@@ -94,6 +94,29 @@ class ADSR : public Object<ADSR>
 		 * set state to RELEASE, save __release_value and return it.
 		 * */
 		float release();
+		/**
+		 * Like release() but the release phase will last at most
+		 * @a nFrames frames (at a step size of 1). This is used to
+		 * quickly fade out a voice stolen by the VoiceManager without
+		 * introducing clicks.
+		 *
+		 * In contrast to the regular release, the length of the fade
+		 * out is not normalised and can be shorter than the minimum
+		 * release of 256 ticks. It only affects this very instance of
+		 * the envelope (each Note holds its own copy).
+		 *
+		 * \return value of the envelope when the fade out was started.
+		 */
+		float fadeOut( unsigned int nFrames );
+
+		/** \return current value of the envelope */
+		float getValue() const;
+		/** \return whether the envelope is in release or already idle */
+		bool isReleased() const;
+		/** \return whether the envelope is still rising. Only
+		 * afterwards getValue() is guaranteed to not increase
+		 * anymore. */
+		bool isAttacking() const;
 
 		/**
 		 * Compute and apply successive ADSR values to stereo buffers.
@@ -106,6 +129,26 @@ class ADSR : public Object<ADSR>
 
 		bool applyADSR( float *pLeft, float *pRight, int nFrames, int nReleaseFrame, float fStep );
 
+		/**
+		 * Checks whether the envelope stays constant for the next
+		 * @a nFrames frames, i.e. whether it is in its sustain
+		 * phase (or attack and decay are of zero length) and the
+		 * release does not start within them.
+		 *
+		 * If so, the envelope is advanced the same way applyADSR()
+		 * would have done (with a step size of 1) and its value is
+		 * stored in @a pfValue. This allows the #Sampler to fold the
+		 * envelope into the gain of a voice. Otherwise, the envelope
+		 * is left untouched.
+		 *
+		 * \param nFrames number of frames of audio
+		 * \param nReleaseFrame frame number of the release point
+		 * \param pfValue value of the envelope during those frames
+		 *
+		 * \return whether the envelope is constant.
+		 */
+		bool applyConstant( int nFrames, int nReleaseFrame, float* pfValue );
+
 		/** Formatted string version for debugging purposes.
 		 * \param sPrefix String prefix which will be added in front of
 		 * every new line
@@ -180,6 +223,21 @@ inline unsigned int ADSR::get_release()
 	return __release;
 }
 
+inline float ADSR::getValue() const
+{
+	return __value;
+}
+
+inline bool ADSR::isReleased() const
+{
+	return __state == RELEASE || __state == IDLE;
+}
+
+inline bool ADSR::isAttacking() const
+{
+	return __state == ATTACK;
+}
+
 };
 
 #endif // H2C_ADRS_H
@@ -22,10 +22,7 @@
 
 #include <core/Basics/Drumkit.h>
 #include <core/config.h>
-#ifdef H2CORE_HAVE_LIBARCHIVE
-#include <archive.h>
-#include <archive_entry.h>
-#else
+#ifndef H2CORE_HAVE_LIBARCHIVE
 #ifndef WIN32
 #include <fcntl.h>
 #include <errno.h>
@@ -41,6 +38,7 @@
 #include <core/Basics/InstrumentComponent.h>
 #include <core/Basics/InstrumentLayer.h>
 
+#include <core/Helpers/BinaryDoc.h>
 #include <core/Helpers/Xml.h>
 #include <core/Helpers/Legacy.h>
 
@@ -85,7 +83,8 @@ Drumkit::~Drumkit()
 {
 }
 
-std::shared_ptr<Drumkit> Drumkit::load( const QString& sDrumkitPath, bool bUpgrade, bool bSilent )
+std::shared_ptr<Drumkit> Drumkit::load( const QString& sDrumkitPath, bool bUpgrade, bool bSilent,
+										bool bDeferValidation )
 {
 	if ( ! Filesystem::drumkit_valid( sDrumkitPath ) ) {
 		ERRORLOG( QString( "[%1] is not valid drumkit folder" ).arg( sDrumkitPath ) );
@@ -97,7 +96,9 @@ std::shared_ptr<Drumkit> Drumkit::load( const QString& sDrumkitPath, bool bUpgra
 	bool bReadingSuccessful = true;
 	
 	XMLDoc doc;
-	if ( !doc.read( sDrumkitFile, Filesystem::drumkit_xsd_path(), true ) ) {
+	if ( !doc.read( sDrumkitFile, Filesystem::drumkit_xsd_path(), true,
+					bDeferValidation ? XMLDoc::Validation::Deferred :
+					XMLDoc::Validation::Immediate ) ) {
 		// Drumkit does not comply with the XSD schema
 		// definition. It's probably an old one. load_from() will try
 		// to handle it regardlessly but we should upgrade it in order
@@ -354,7 +355,7 @@ QString Drumkit::getExportName( const QString& sComponentName, bool bRecentVersi
 	return sExportName;
 }
 
-bool Drumkit::save( const QString& sDrumkitPath, int nComponentID, bool bRecentVersion, bool bSilent )
+bool Drumkit::save( const QString& sDrumkitPath, int nComponentID, bool bRecentVersion, bool bSilent, bool bBinary )
 {
 	QString sDrumkitFolder( sDrumkitPath );
 	if ( sDrumkitPath.isEmpty() ) {
@@ -401,15 +402,20 @@ bool Drumkit::save( const QString& sDrumkitPath, int nComponentID, bool bRecentV
 
 	// Save drumkit.xml
 	XMLDoc doc;
-	XMLNode root = doc.set_root( "drumkit_info", "drumkit" );
+	BinaryDoc binaryDoc;
+	XMLDoc* pDoc = bBinary ? binaryDoc.getDocument() : &doc;
+	XMLNode root = pDoc->set_root( "drumkit_info", "drumkit" );
 	
 	// In order to comply with the GPL license we have to add a
 	// license notice to the file.
 	if ( __license.getType() == License::GPL ) {
-		root.appendChild( doc.createComment( License::getGPLLicenseNotice( __author ) ) );
+		root.appendChild( pDoc->createComment( License::getGPLLicenseNotice( __author ) ) );
 	}
 	
 	save_to( &root, nComponentID, bRecentVersion, bSilent );
+	if ( bBinary ) {
+		return binaryDoc.write( Filesystem::drumkit_file( sDrumkitFolder ) );
+	}
 	return doc.write( Filesystem::drumkit_file( sDrumkitFolder ) );
 }
 
@@ -596,7 +602,8 @@ bool Drumkit::isUserDrumkit() const {
 	return true;
 }
 	
-bool Drumkit::install( const QString& sSourcePath, const QString& sTargetPath, bool bSilent )
+bool Drumkit::install( const QString& sSourcePath, const QString& sTargetPath, bool bSilent,
+						Archive::ProgressCallback progress )
 {
 	if ( sTargetPath.isEmpty() ) {
 		if ( ! bSilent ) {
@@ -615,82 +622,14 @@ bool Drumkit::install( const QString& sSourcePath, const QString& sTargetPath, b
 	}
 	
 #ifdef H2CORE_HAVE_LIBARCHIVE
-	int r;
-	struct archive* arch;
-	struct archive_entry* entry;
-
-	arch = archive_read_new();
-
-#if ARCHIVE_VERSION_NUMBER < 3000000
-	archive_read_support_compression_all( arch );
-#else
-	archive_read_support_filter_all( arch );
-#endif
-
-	archive_read_support_format_all( arch );
-
-#if ARCHIVE_VERSION_NUMBER < 3000000
-	if ( archive_read_open_file( arch, sSourcePath.toLocal8Bit(), 10240 ) ) {
-#else
-	if ( archive_read_open_filename( arch, sSourcePath.toLocal8Bit(), 10240 ) ) {
-#endif
-		_ERRORLOG( QString( "archive_read_open_file() [%1] %2" )
-				   .arg( archive_errno( arch ) )
-				   .arg( archive_error_string( arch ) ) );
-		archive_read_close( arch );
-
-#if ARCHIVE_VERSION_NUMBER < 3000000
-		archive_read_finish( arch );
-#else
-		archive_read_free( arch );
-#endif
-
-		return false;
-	}
-	bool ret = true;
-
 	QString dk_dir;
 	if ( ! sTargetPath.isEmpty() ) {
-		dk_dir = sTargetPath + "/";
+		dk_dir = sTargetPath;
 	} else {
-		dk_dir = Filesystem::usr_drumkits_dir() + "/";
+		dk_dir = Filesystem::usr_drumkits_dir();
 	}
-		
-	while ( ( r = archive_read_next_header( arch, &entry ) ) != ARCHIVE_EOF ) {
-		if ( r != ARCHIVE_OK ) {
-			_ERRORLOG( QString( "archive_read_next_header() [%1] %2" )
-					   .arg( archive_errno( arch ) )
-					   .arg( archive_error_string( arch ) ) );
-			ret = false;
-			break;
-		}
-		QString np = dk_dir + archive_entry_pathname( entry );
-
-		QByteArray newpath = np.toLocal8Bit();
-
-		archive_entry_set_pathname( entry, newpath.data() );
-		r = archive_read_extract( arch, entry, 0 );
-		if ( r == ARCHIVE_WARN ) {
-			_WARNINGLOG( QString( "archive_read_extract() [%1] %2" )
-						 .arg( archive_errno( arch ) )
-						 .arg( archive_error_string( arch ) ) );
-		} else if ( r != ARCHIVE_OK ) {
-			_ERRORLOG( QString( "archive_read_extract() [%1] %2" )
-					   .arg( archive_errno( arch ) )
-					   .arg( archive_error_string( arch ) ) );
-			ret = false;
-			break;
-		}
-	}
-	archive_read_close( arch );
 
-#if ARCHIVE_VERSION_NUMBER < 3000000
-	archive_read_finish( arch );
-#else
-	archive_read_free( arch );
-#endif
-
-	return ret;
+	return Archive::extract( sSourcePath, dk_dir, progress );
 #else // H2CORE_HAVE_LIBARCHIVE
 #ifndef WIN32
 	// GUNZIP
@@ -749,7 +688,8 @@ bool Drumkit::install( const QString& sSourcePath, const QString& sTargetPath, b
 #endif
 }
 
-bool Drumkit::exportTo( const QString& sTargetDir, const QString& sComponentName, bool bRecentVersion, bool bSilent ) {
+bool Drumkit::exportTo( const QString& sTargetDir, const QString& sComponentName, bool bRecentVersion, bool bSilent,
+						Archive::ProgressCallback progress ) {
 
 	if ( ! Filesystem::path_usable( sTargetDir, true, false ) ) {
 		ERRORLOG( QString( "Provided destination folder [%1] is not valid" )
@@ -915,39 +855,10 @@ bool Drumkit::exportTo( const QString& sTargetDir, const QString& sComponentName
 
 #if defined(H2CORE_HAVE_LIBARCHIVE)
 
-	struct archive *a;
-	struct archive_entry *entry;
-	struct stat st;
-	char buff[8192];
-	int len;
-	FILE *f;
-
-	a = archive_write_new();
-
-	#if ARCHIVE_VERSION_NUMBER < 3000000
-		archive_write_set_compression_gzip(a);
-	#else
-		archive_write_add_filter_gzip(a);
-	#endif
-
-	archive_write_set_format_pax_restricted(a);
-	
-	int ret = archive_write_open_filename(a, sTargetName.toUtf8().constData());
-	if ( ret != ARCHIVE_OK ) {
-		ERRORLOG( QString("Couldn't create archive [%0]" )
-			.arg( sTargetName ) );
-		set_name( sOldDrumkitName );
-		return false;
-	}
-
-	bool bFoundFileInRightComponent;
+	std::vector<Archive::Entry> entries;
 	for ( const auto& sFilename : filesUsed ) {
 		QFileInfo ffileInfo( sFilename );
-		QString sTargetFilename = sDrumkitName + "/" + ffileInfo.fileName();
 
-		// Small sanity check since the libarchive code won't fail
-		// gracefully but segfaults if the provided file does not
-		// exist.
 		if ( ! Filesystem::file_readable( sFilename, true ) ) {
 			ERRORLOG( QString( "Unable to export drumkit. File [%1] does not exists or is not readable." )
 					  .arg( sFilename ) );
@@ -955,29 +866,15 @@ bool Drumkit::exportTo( const QString& sTargetDir, const QString& sComponentName
 			return false;
 		}
 
-		stat( sFilename.toUtf8().constData(), &st );
-		entry = archive_entry_new();
-		archive_entry_set_pathname(entry, sTargetFilename.toUtf8().constData());
-		archive_entry_set_size(entry, st.st_size);
-		archive_entry_set_filetype(entry, AE_IFREG);
-		archive_entry_set_perm(entry, 0644);
-		archive_write_header(a, entry);
-		f = fopen( sFilename.toUtf8().constData(), "rb" );
-		len = fread(buff, sizeof(char), sizeof(buff), f);
-		while ( len > 0 ) {
-				archive_write_data(a, buff, len);
-				len = fread(buff, sizeof(char), sizeof(buff), f);
-		}
-		fclose(f);
-		archive_entry_free(entry);
+		entries.push_back( { sFilename, sDrumkitName + "/" + ffileInfo.fileName() } );
 	}
-	archive_write_close(a);
 
-	#if ARCHIVE_VERSION_NUMBER < 3000000
-		archive_write_finish(a);
-	#else
-		archive_write_free(a);
-	#endif
+	if ( ! Archive::create( sTargetName, entries, progress ) ) {
+		ERRORLOG( QString( "Couldn't create archive [%1]" )
+				  .arg( sTargetName ) );
+		set_name( sOldDrumkitName );
+		return false;
+	}
 
 	sourceFilesList.clear();
 
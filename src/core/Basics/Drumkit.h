@@ -26,6 +26,7 @@
 #include <memory>
 
 #include <core/Object.h>
+#include <core/Helpers/Archive.h>
 #include <core/Helpers/Filesystem.h>
 #include <core/License.h>
 #include <core/Basics/InstrumentList.h>
@@ -63,12 +64,16 @@ class Drumkit : public H2Core::Object<Drumkit>
 		 * with the current XSD file.
 		 * \param bSilent if set to true, all log messages except of
 		 * errors and warnings are suppressed.
+		 * \param bDeferValidation Whether the drumkit.xml is validated
+		 * in the background (XMLDoc::Validation::Deferred). It is
+		 * then never considered invalid and not upgraded.
 		 *
 		 * \return A Drumkit on success, nullptr otherwise.
 		 */
 		static std::shared_ptr<Drumkit> load( const QString& dk_dir,
 											  bool bUpgrade = true,
-											  bool bSilent = false );
+											  bool bSilent = false,
+											  bool bDeferValidation = false );
 		/** Calls the InstrumentList::load_samples() member
 		 * function of #__instruments.
 		 */
@@ -140,13 +145,17 @@ class Drumkit : public H2Core::Object<Drumkit>
 		 * \param nComponentID to chose the component to save or -1 for all
 		 * \param bSilent if set to true, all log messages except of
 		 * errors and warnings are suppressed.
+		 * \param bBinary whether drumkit.xml should be written as a
+		 * BinaryDoc. Since XMLDoc::read() accepts those as well, the
+		 * drumkit can still be loaded and validated like any other.
 		 *
 		 * \return true on success
 		 */
 		bool save( const QString& sDrumkitPath = "",
 				   int nComponentID = -1,
 				   bool bRecentVersion = true,
-				   bool bSilent = false );
+				   bool bSilent = false,
+				   bool bBinary = false );
 
 		/**
 		 * Extract a .h2drumkit file.
@@ -157,10 +166,13 @@ class Drumkit : public H2Core::Object<Drumkit>
 		 * folder will be used.
 		 * \param bSilent Whether debug and info messages should be
 		 * logged.
+		 * \param progress Reports the progress and allows to cancel
+		 * the extraction. Only supported when built with libarchive.
 		 *
 		 * \return true on success
 		 */
-	static bool install( const QString& sSourcePath, const QString& sTargetPath = "", bool bSilent = false );
+	static bool install( const QString& sSourcePath, const QString& sTargetPath = "", bool bSilent = false,
+						 Archive::ProgressCallback progress = nullptr );
 
 	/**
 	 * Compresses the drumkit into a .h2drumkit file.
@@ -180,10 +192,13 @@ class Drumkit : public H2Core::Object<Drumkit>
 	 * composed of DrumkitComponents).
 	 * \param bSilent Whether debug and info messages should be
 	 * logged.
+	 * \param progress Reports the progress and allows to cancel
+	 * the export. Only supported when built with libarchive.
 	 *
 	 * \return true on success 
 	 */
-	bool exportTo( const QString& sTargetDir, const QString& sComponentName = "", bool bRecentVersion = true, bool bSilent = false );
+	bool exportTo( const QString& sTargetDir, const QString& sComponentName = "", bool bRecentVersion = true, bool bSilent = false,
+				   Archive::ProgressCallback progress = nullptr );
 		/**
 		 * remove a drumkit from the disk
 		 *
@@ -27,6 +27,7 @@
 
 #include <core/Hydrogen.h>
 
+#include <core/Helpers/AudioBufferArena.h>
 #include <core/Helpers/Xml.h>
 #include <core/Helpers/Filesystem.h>
 
@@ -52,8 +53,8 @@ DrumkitComponent::DrumkitComponent( const int id, const QString& name )
 	, __peak_l( 0.0 )
 	, __peak_r( 0.0 )
 {
-	__out_L = new float[ MAX_BUFFER_SIZE ];
-	__out_R = new float[ MAX_BUFFER_SIZE ];
+	__out_L = AudioBufferArena::get_instance()->allocate( MAX_BUFFER_SIZE, 2 );
+	__out_R = __out_L + AudioBufferArena::stride( MAX_BUFFER_SIZE );
 }
 
 DrumkitComponent::DrumkitComponent( std::shared_ptr<DrumkitComponent> other )
@@ -67,14 +68,13 @@ DrumkitComponent::DrumkitComponent( std::shared_ptr<DrumkitComponent> other )
 	, __peak_l( 0.0 )
 	, __peak_r( 0.0 )
 {
-	__out_L = new float[ MAX_BUFFER_SIZE ];
-	__out_R = new float[ MAX_BUFFER_SIZE ];
+	__out_L = AudioBufferArena::get_instance()->allocate( MAX_BUFFER_SIZE, 2 );
+	__out_R = __out_L + AudioBufferArena::stride( MAX_BUFFER_SIZE );
 }
 
 DrumkitComponent::~DrumkitComponent()
 {
-	delete[] __out_L;
-	delete[] __out_R;
+	AudioBufferArena::get_instance()->release( __out_L );
 }
 
 void DrumkitComponent::reset_outs( uint32_t nFrames )
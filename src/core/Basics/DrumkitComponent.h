@@ -74,6 +74,11 @@ class DrumkitComponent : public H2Core::Object<DrumkitComponent>
 		void						set_outs( int nBufferPos, float valL, float valR );
 		float						get_out_L( int nBufferPos );
 		float						get_out_R( int nBufferPos );
+		/** \return #__out_L. Used by the #Sampler to accumulate
+		 * whole blocks at once. */
+		float*						get_out_L_buffer() const;
+		/** \return #__out_R */
+		float*						get_out_R_buffer() const;
 		/** Formatted string version for debugging purposes.
 		 * \param sPrefix String prefix which will be added in front of
 		 * every new line
@@ -179,6 +184,16 @@ inline void DrumkitComponent::set_outs( int nBufferPos, float valL, float valR )
 	__out_R[nBufferPos] += valR;
 }
 
+inline float* DrumkitComponent::get_out_L_buffer() const
+{
+	return __out_L;
+}
+
+inline float* DrumkitComponent::get_out_R_buffer() const
+{
+	return __out_R;
+}
+
 };
 
 #endif
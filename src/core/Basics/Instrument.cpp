@@ -54,6 +54,7 @@ Instrument::Instrument( const int id, const QString& name, std::shared_ptr<ADSR>
 	, __filter_active( false )
 	, __filter_cutoff( 1.0 )
 	, __filter_resonance( 0.0 )
+	, m_filterType( Filter::Type::Legacy )
 	, __pitch_offset( 0.0 )
 	, __random_pitch_factor( 0.0 )
 	, __midi_out_note( 36 + id )
@@ -64,6 +65,7 @@ Instrument::Instrument( const int id, const QString& name, std::shared_ptr<ADSR>
 	, __soloed( false )
 	, __muted( false )
 	, __mute_group( -1 )
+	, m_nMaxVoices( 0 )
 	, __queued( 0 )
 	, __hihat_grp( -1 )
 	, __lower_cc( 0 )
@@ -105,6 +107,7 @@ Instrument::Instrument( std::shared_ptr<Instrument> other )
 	, __filter_active( other->is_filter_active() )
 	, __filter_cutoff( other->get_filter_cutoff() )
 	, __filter_resonance( other->get_filter_resonance() )
+	, m_filterType( other->getFilterType() )
 	, __pitch_offset( other->get_pitch_offset() )
 	, __random_pitch_factor( other->get_random_pitch_factor() )
 	, __midi_out_note( other->get_midi_out_note() )
@@ -115,6 +118,7 @@ Instrument::Instrument( std::shared_ptr<Instrument> other )
 	, __soloed( other->is_soloed() )
 	, __muted( other->is_muted() )
 	, __mute_group( other->get_mute_group() )
+	, m_nMaxVoices( other->get_max_voices() )
 	, __queued( other->is_queued() )
 	, __hihat_grp( other->get_hihat_grp() )
 	, __lower_cc( other->get_lower_cc() )
@@ -211,9 +215,11 @@ void Instrument::load_from( std::shared_ptr<Drumkit> pDrumkit, std::shared_ptr<I
 	this->set_filter_active( pInstrument->is_filter_active() );
 	this->set_filter_cutoff( pInstrument->get_filter_cutoff() );
 	this->set_filter_resonance( pInstrument->get_filter_resonance() );
+	this->setFilterType( pInstrument->getFilterType() );
 	this->set_pitch_offset( pInstrument->get_pitch_offset() );
 	this->set_random_pitch_factor( pInstrument->get_random_pitch_factor() );
 	this->set_mute_group( pInstrument->get_mute_group() );
+	this->set_max_voices( pInstrument->get_max_voices() );
 	this->set_midi_out_channel( pInstrument->get_midi_out_channel() );
 	this->set_midi_out_note( pInstrument->get_midi_out_note() );
 	this->set_stop_notes( pInstrument->is_stop_notes() );
@@ -407,6 +413,16 @@ std::shared_ptr<Instrument> Instrument::load_from( XMLNode* pNode, const QString
 													  true, false, bSilent ) );
 	pInstrument->set_filter_resonance( pNode->read_float( "filterResonance", 0.0f,
 														 true, false, bSilent ) );
+	const int nFilterType = pNode->read_int( "filterType",
+											 static_cast<int>(Filter::Type::Legacy),
+											 true, true, true );
+	if ( nFilterType >= static_cast<int>(Filter::Type::Legacy) &&
+		 nFilterType <= static_cast<int>(Filter::Type::BandPass) ) {
+		pInstrument->setFilterType( static_cast<Filter::Type>(nFilterType) );
+	} else {
+		WARNINGLOG( QString( "Unknown filter type [%1]. Using legacy filter instead." )
+					.arg( nFilterType ) );
+	}
 	pInstrument->set_pitch_offset( pNode->read_float( "pitchOffset", 0.0f,
 													 true, false, bSilent ) );
 	pInstrument->set_random_pitch_factor( pNode->read_float( "randomPitchFactor", 0.0f,
@@ -421,6 +437,8 @@ std::shared_ptr<Instrument> Instrument::load_from( XMLNode* pNode, const QString
 													true, false, bSilent ) );
 	pInstrument->set_stop_notes( pNode->read_bool( "isStopNote", true,
 												  false, true, bSilent ) );
+	pInstrument->set_max_voices( pNode->read_int( "maxVoices", 0,
+												 true, true, true ) );
 
 	QString sRead_sample_select_algo = pNode->read_string( "sampleSelectionAlgo", "VELOCITY",
 														  true, true, bSilent  );
@@ -601,6 +619,9 @@ void Instrument::save_to( XMLNode* node, int component_id, bool bRecentVersion,
 	InstrumentNode.write_bool( "filterActive", __filter_active );
 	InstrumentNode.write_float( "filterCutoff", __filter_cutoff );
 	InstrumentNode.write_float( "filterResonance", __filter_resonance );
+	if ( m_filterType != Filter::Type::Legacy ) {
+		InstrumentNode.write_int( "filterType", static_cast<int>(m_filterType) );
+	}
 	InstrumentNode.write_int( "Attack", __adsr->get_attack() );
 	InstrumentNode.write_int( "Decay", __adsr->get_decay() );
 	InstrumentNode.write_float( "Sustain", __adsr->get_sustain() );
@@ -609,6 +630,9 @@ void Instrument::save_to( XMLNode* node, int component_id, bool bRecentVersion,
 	InstrumentNode.write_int( "midiOutChannel", __midi_out_channel );
 	InstrumentNode.write_int( "midiOutNote", __midi_out_note );
 	InstrumentNode.write_bool( "isStopNote", __stop_notes );
+	if ( m_nMaxVoices > 0 ) {
+		InstrumentNode.write_int( "maxVoices", m_nMaxVoices );
+	}
 
 	switch ( __sample_selection_alg ) {
 	case VELOCITY:
@@ -677,6 +701,7 @@ QString Instrument::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( "%1%2filter_active: %3\n" ).arg( sPrefix ).arg( s ).arg( __filter_active ) )
 			.append( QString( "%1%2filter_cutoff: %3\n" ).arg( sPrefix ).arg( s ).arg( __filter_cutoff ) )
 			.append( QString( "%1%2filter_resonance: %3\n" ).arg( sPrefix ).arg( s ).arg( __filter_resonance ) )
+			.append( QString( "%1%2filter_type: %3\n" ).arg( sPrefix ).arg( s ).arg( Filter::TypeToQString( m_filterType ) ) )
 			.append( QString( "%1%2random_pitch_factor: %3\n" ).arg( sPrefix ).arg( s ).arg( __random_pitch_factor ) )
 			.append( QString( "%1%2pitch_offset: %3\n" ).arg( sPrefix ).arg( s ).arg( __pitch_offset ) )
 			.append( QString( "%1%2midi_out_note: %3\n" ).arg( sPrefix ).arg( s ).arg( __midi_out_note ) )
@@ -687,6 +712,7 @@ QString Instrument::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( "%1%2soloed: %3\n" ).arg( sPrefix ).arg( s ).arg( __soloed ) )
 			.append( QString( "%1%2muted: %3\n" ).arg( sPrefix ).arg( s ).arg( __muted ) )
 			.append( QString( "%1%2mute_group: %3\n" ).arg( sPrefix ).arg( s ).arg( __mute_group ) )
+			.append( QString( "%1%2max_voices: %3\n" ).arg( sPrefix ).arg( s ).arg( m_nMaxVoices ) )
 			.append( QString( "%1%2queued: %3\n" ).arg( sPrefix ).arg( s ).arg( __queued ) ) ;
 		sOutput.append( QString( "%1%2fx_level: [ " ).arg( sPrefix ).arg( s ) );
 		for ( auto ff : __fx_level ) {
@@ -723,6 +749,7 @@ QString Instrument::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( ", filter_active: %1" ).arg( __filter_active ) )
 			.append( QString( ", filter_cutoff: %1" ).arg( __filter_cutoff ) )
 			.append( QString( ", filter_resonance: %1" ).arg( __filter_resonance ) )
+			.append( QString( ", filter_type: %1" ).arg( Filter::TypeToQString( m_filterType ) ) )
 			.append( QString( ", random_pitch_factor: %1" ).arg( __random_pitch_factor ) )
 			.append( QString( ", pitch_offset: %1" ).arg( __pitch_offset ) )
 			.append( QString( ", midi_out_note: %1" ).arg( __midi_out_note ) )
@@ -733,6 +760,7 @@ QString Instrument::toQString( const QString& sPrefix, bool bShort ) const {
 			.append( QString( ", soloed: %1" ).arg( __soloed ) )
 			.append( QString( ", muted: %1" ).arg( __muted ) )
 			.append( QString( ", mute_group: %1" ).arg( __mute_group ) )
+			.append( QString( ", max_voices: %1" ).arg( m_nMaxVoices ) )
 			.append( QString( ", queued: %1" ).arg( __queued ) ) ;
 		sOutput.append( QString( ", fx_level: [ " ) );
 		for ( auto ff : __fx_level ) {
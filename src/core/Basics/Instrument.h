@@ -23,11 +23,13 @@
 #ifndef H2C_INSTRUMENT_H
 #define H2C_INSTRUMENT_H
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
 
 #include <core/Object.h>
 #include <core/Basics/Adsr.h>
+#include <core/Sampler/Filter.h>
 #include <core/Helpers/Filesystem.h>
 #include <core/License.h>
 
@@ -168,6 +170,11 @@ class Instrument : public H2Core::Object<Instrument>
 		/** get the mute group of the instrument */
 		int get_mute_group() const;
 
+		/** \param nMaxVoices Sets #m_nMaxVoices. 0 disables the limit. */
+		void set_max_voices( int nMaxVoices );
+		/** \return #m_nMaxVoices */
+		int get_max_voices() const;
+
 		/** set the midi out channel of the instrument */
 		void set_midi_out_channel( int channel );
 		/** get the midi out channel of the instrument */
@@ -221,6 +228,11 @@ class Instrument : public H2Core::Object<Instrument>
 		/** get the filter cutoff of the instrument */
 		float get_filter_cutoff() const;
 
+		/** \param type Sets #m_filterType. */
+		void setFilterType( Filter::Type type );
+		/** \return #m_filterType */
+		Filter::Type getFilterType() const;
+
 		/** set the left peak of the instrument */
 		void set_peak_l( float val );
 		/** get the left peak of the instrument */
@@ -350,6 +362,7 @@ class Instrument : public H2Core::Object<Instrument>
 		bool					__filter_active;		///< is filter active?
 		float					__filter_cutoff;		///< filter cutoff (0..1)
 		float					__filter_resonance;		///< filter resonant frequency (0..1)
+		Filter::Type			m_filterType;			///< response of the filter
 		float					__random_pitch_factor;	///< random pitch factor
 		float					__pitch_offset;	///< instrument main pitch offset
 		int						__midi_out_note;		///< midi out note
@@ -360,6 +373,10 @@ class Instrument : public H2Core::Object<Instrument>
 		bool					__soloed;				///< is the instrument in solo mode?
 		bool					__muted;				///< is the instrument muted?
 		int						__mute_group;			///< mute group of the instrument
+		/** Maximum number of voices of this instrument rendered by
+		 * the #Sampler at the same time. Older ones will be stolen
+		 * by the VoiceManager. 0 means no limit. */
+		int						m_nMaxVoices;
 		int						__queued;				///< count the number of notes queued within Sampler::__playing_notes_queue or std::priority_queue m_songNoteQueue
 		float					__fx_level[MAX_FX];		///< Ladspa FX level array
 		int						__hihat_grp;			///< the instrument is part of a hihat
@@ -527,6 +544,16 @@ inline float Instrument::get_filter_cutoff() const
 	return __filter_cutoff;
 }
 
+inline void Instrument::setFilterType( Filter::Type type )
+{
+	m_filterType = type;
+}
+
+inline Filter::Type Instrument::getFilterType() const
+{
+	return m_filterType;
+}
+
 inline void Instrument::set_peak_l( float val )
 {
 	__peak_l = val;
@@ -608,6 +635,16 @@ inline void Instrument::dequeue()
 	__queued--;
 }
 
+inline void Instrument::set_max_voices( int nMaxVoices )
+{
+	m_nMaxVoices = std::max( nMaxVoices, 0 );
+}
+
+inline int Instrument::get_max_voices() const
+{
+	return m_nMaxVoices;
+}
+
 inline bool Instrument::is_queued() const
 {
 	return ( __queued > 0 );
@@ -73,6 +73,16 @@ void InstrumentLayer::load_sample( float fBpm )
 {
 	if ( __sample != nullptr ) {
 		__sample->load( fBpm );
+
+		auto pPref = Preferences::get_instance();
+		if ( pPref->m_bResampleSamplesOnLoad ) {
+			int nSampleRate = pPref->m_nSampleRate;
+			auto pHydrogen = Hydrogen::get_instance();
+			if ( pHydrogen != nullptr && pHydrogen->getAudioOutput() != nullptr ) {
+				nSampleRate = pHydrogen->getAudioOutput()->getSampleRate();
+			}
+			__sample->convertSampleRate( nSampleRate );
+		}
 	}
 }
 
@@ -94,7 +104,7 @@ std::shared_ptr<InstrumentLayer> InstrumentLayer::load_from( XMLNode* pNode, con
 		 ! sFilename.startsWith( "/" ) ) {
 
 #ifdef H2CORE_HAVE_OSC
-		if ( pHydrogen->isUnderSessionManagement() ) {
+		if ( pHydrogen != nullptr && pHydrogen->isUnderSessionManagement() ) {
 			// If we use the NSM support and the sample files to save
 			// are corresponding to the drumkit linked/located in the
 			// session folder, we have to ensure the relative paths
@@ -213,7 +223,7 @@ void InstrumentLayer::save_to( XMLNode* node, bool bFull )
 	QString sFilename;
 	if ( bFull ) {
 
-		if ( pHydrogen->isUnderSessionManagement() ) {
+		if ( pHydrogen != nullptr && pHydrogen->isUnderSessionManagement() ) {
 			// If we use the NSM support and the sample files to save
 			// are corresponding to the drumkit linked/located in the
 			// session folder, we have to ensure the relative paths
@@ -24,6 +24,8 @@
 
 #include <cassert>
 
+#include <QLocale>
+
 #include <core/Helpers/Xml.h>
 #include <core/AudioEngine/AudioEngine.h>
 #include <core/AudioEngine/TransportPosition.h>
@@ -123,6 +125,8 @@ Note::Note( Note* other, std::shared_ptr<Instrument> instrument )
 		std::shared_ptr<SelectedLayerInfo> pSampleInfo = std::make_shared<SelectedLayerInfo>();
 		pSampleInfo->SelectedLayer = mm.second->SelectedLayer;
 		pSampleInfo->SamplePosition = mm.second->SamplePosition;
+		pSampleInfo->fFilterCutoff = mm.second->fFilterCutoff;
+		pSampleInfo->fFilterResonance = mm.second->fFilterResonance;
 		
 		__layers_selected[ mm.first ] = pSampleInfo;
 	}
@@ -216,6 +220,32 @@ bool Note::isPartiallyRendered() const {
 	return bRes;
 }
 
+void Note::applyFilter( float* pLeft, float* pRight, int nFrames,
+						std::shared_ptr<SelectedLayerInfo> pSelectedLayer ) {
+	const float fCutoff = __instrument->get_filter_cutoff();
+	const float fResonance = __instrument->get_filter_resonance();
+	if ( pSelectedLayer->fFilterCutoff < 0 ) {
+		// First block of this component. Nothing to ramp from.
+		pSelectedLayer->fFilterCutoff = fCutoff;
+		pSelectedLayer->fFilterResonance = fResonance;
+	}
+
+	float fBand[ 2 ] = { __bpfb_l, __bpfb_r };
+	float fLow[ 2 ] = { __lpfb_l, __lpfb_r };
+
+	Filter::process( __instrument->getFilterType(), pLeft, pRight, nFrames,
+					 pSelectedLayer->fFilterCutoff, pSelectedLayer->fFilterResonance,
+					 fCutoff, fResonance,
+					 fBand, fLow );
+
+	__bpfb_l = fBand[ 0 ];
+	__bpfb_r = fBand[ 1 ];
+	__lpfb_l = fLow[ 0 ];
+	__lpfb_r = fLow[ 1 ];
+	pSelectedLayer->fFilterCutoff = fCutoff;
+	pSelectedLayer->fFilterResonance = fResonance;
+}
+
 void Note::computeNoteStart() {
 	// Notes not inserted via the audio engine but directly, using
 	// e.g. the GUI, will be insert at position 0 and don't require a
@@ -376,8 +406,9 @@ std::shared_ptr<Sample> Note::getSample( int nComponentID, int nSelectedLayer )
 				break;
 				
 			case Instrument::RANDOM:
-				nLayerPicked = possibleLayersVector[ rand() %
-													 possibleLayersVector.size() ];
+				nLayerPicked = possibleLayersVector[
+					Hydrogen::get_instance()->getAudioEngine()->getRandom()
+					.uniformInt( possibleLayersVector.size() ) ];
 				break;
 
 			case Instrument::ROUND_ROBIN: {
@@ -420,7 +451,8 @@ void Note::save_to( XMLNode* node )
 	node->write_float( "pitch", __pitch );
 	node->write_string( "key", key_to_string() );
 	node->write_int( "length", __length );
-	node->write_int( "instrument", get_instrument()->get_id() );
+	node->write_int( "instrument", __instrument != nullptr ?
+					 __instrument->get_id() : __instrument_id );
 	node->write_bool( "note_off", __note_off );
 	node->write_float( "probability", __probability );
 }
@@ -451,12 +483,116 @@ Note* Note::load_from( XMLNode* node, std::shared_ptr<InstrumentList> instrument
 	note->set_key_octave( node->read_string( "key", "C0", false, false, bSilent ) );
 	note->set_note_off( node->read_bool( "note_off", false, false, false, bSilent ) );
 	note->set_instrument_id( node->read_int( "instrument", EMPTY_INSTR_ID, false, false, bSilent ) );
-	note->map_instrument( instruments );
+	if ( instruments != nullptr ) {
+		note->map_instrument( instruments );
+	}
 	note->set_probability( node->read_float( "probability", 1.0f, false, false, bSilent ));
 
 	return note;
 }
 
+Note* Note::load_from( QXmlStreamReader& reader, std::shared_ptr<InstrumentList> instruments, bool bSilent )
+{
+	// Same defaults as in the XMLNode version.
+	int nPosition = 0;
+	float fVelocity = 0.8f;
+	float fPan = 0.f;
+	bool bPanFound = false;
+	float fPanL = 1.f;
+	float fPanR = 1.f;
+	bool bPanLFound = false;
+	bool bPanRFound = false;
+	int nLength = -1;
+	float fPitch = 0.0f;
+	float fLeadLag = 0;
+	QString sKey( "C0" );
+	bool bNoteOff = false;
+	int nInstrumentId = EMPTY_INSTR_ID;
+	float fProbability = 1.0f;
+
+	// Empty nodes are treated as missing ones and leave the default
+	// in place.
+	const QLocale cLocale = QLocale::c();
+	auto readText = [&]( QString* pValue ) {
+		const QString sText = reader.readElementText( QXmlStreamReader::SkipChildElements );
+		if ( sText.isEmpty() ) {
+			return false;
+		}
+		*pValue = sText;
+		return true;
+	};
+	auto readInt = [&]( int* pValue ) {
+		QString sText;
+		if ( ! readText( &sText ) ) {
+			return false;
+		}
+		*pValue = cLocale.toInt( sText );
+		return true;
+	};
+	auto readFloat = [&]( float* pValue ) {
+		QString sText;
+		if ( ! readText( &sText ) ) {
+			return false;
+		}
+		*pValue = cLocale.toFloat( sText );
+		return true;
+	};
+
+	// The name has to be compared before reading the text since it
+	// refers to the internal buffer of the reader.
+	while ( reader.readNextStartElement() ) {
+		const auto name = reader.name();
+		if ( name == QLatin1String( "position" ) ) {
+			readInt( &nPosition );
+		} else if ( name == QLatin1String( "leadlag" ) ) {
+			readFloat( &fLeadLag );
+		} else if ( name == QLatin1String( "velocity" ) ) {
+			readFloat( &fVelocity );
+		} else if ( name == QLatin1String( "pan" ) ) {
+			bPanFound = readFloat( &fPan );
+		} else if ( name == QLatin1String( "pitch" ) ) {
+			readFloat( &fPitch );
+		} else if ( name == QLatin1String( "key" ) ) {
+			readText( &sKey );
+		} else if ( name == QLatin1String( "length" ) ) {
+			readInt( &nLength );
+		} else if ( name == QLatin1String( "instrument" ) ) {
+			readInt( &nInstrumentId );
+		} else if ( name == QLatin1String( "note_off" ) ) {
+			QString sNoteOff;
+			if ( readText( &sNoteOff ) ) {
+				bNoteOff = sNoteOff == "true";
+			}
+		} else if ( name == QLatin1String( "probability" ) ) {
+			readFloat( &fProbability );
+		} else if ( name == QLatin1String( "pan_L" ) ) {
+			bPanLFound = readFloat( &fPanL );
+		} else if ( name == QLatin1String( "pan_R" ) ) {
+			bPanRFound = readFloat( &fPanR );
+		} else {
+			reader.skipCurrentElement();
+		}
+	}
+
+	if ( ! bPanFound && bPanLFound && bPanRFound ) {
+		// pan is expressed in the old fashion (version <= 1.1 ) with
+		// the pair (pan_L, pan_R)
+		fPan = Sampler::getRatioPan( fPanL, fPanR );
+	}
+
+	Note* pNote = new Note( nullptr, nPosition, fVelocity, fPan, nLength, fPitch );
+	pNote->set_lead_lag( fLeadLag );
+	pNote->set_key_octave( sKey );
+	pNote->set_note_off( bNoteOff );
+	pNote->set_instrument_id( nInstrumentId );
+	if ( instruments != nullptr ) {
+		pNote->map_instrument( instruments );
+	}
+	pNote->set_probability( fProbability );
+
+	return pNote;
+}
+
 QString Note::toQString( const QString& sPrefix, bool bShort ) const {
 	QString s = Base::sPrintIndention;
 	QString sOutput;
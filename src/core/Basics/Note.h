@@ -29,6 +29,8 @@
 #include <core/Basics/Instrument.h>
 #include <core/Basics/Sample.h>
 
+class QXmlStreamReader;
+
 #define KEY_MIN                 0
 #define KEY_MAX                 11
 #define OCTAVE_MIN              -3
@@ -67,6 +69,12 @@ struct SelectedLayerInfo {
 	 */
 	int SelectedLayer;
 	float SamplePosition;	///< place marker for overlapping process() cycles
+	/** Filter cutoff used in the last call to Note::applyFilter()
+	 * for this component. -1 if it was not called yet. */
+	float fFilterCutoff = -1;
+	/** Filter resonance used in the last call to
+	 * Note::applyFilter() for this component. */
+	float fFilterResonance = -1;
 };
 
 /**
@@ -112,12 +120,32 @@ class Note : public H2Core::Object<Note>
 		/**
 		 * load a note from an XMLNode
 		 * \param node the XMLDode to read from
-		 * \param instruments the current instrument list to search instrument into
+		 * \param instruments the current instrument list to search
+		 *   instrument into. In case it is nullptr, only the ID of
+		 *   the instrument is set and map_instrument() has to be
+		 *   called later on.
 		 * \param bSilent Whether infos, warnings, and errors should
 		 * be logged.
 		 * \return a new Note instance
 		 */
 	static Note* load_from( XMLNode* node, std::shared_ptr<InstrumentList> instruments, bool bSilent = false );
+		/**
+		 * load a note from a QXmlStreamReader positioned at the
+		 * start of a "note" element. The reader is left at its end.
+		 *
+		 * Yields the same note as the XMLNode version without
+		 * looking up each child by name.
+		 *
+		 * \param reader the reader to read from
+		 * \param instruments the current instrument list to search
+		 *   instrument into. In case it is nullptr, only the ID of
+		 *   the instrument is set and map_instrument() has to be
+		 *   called later on.
+		 * \param bSilent Whether infos, warnings, and errors should
+		 * be logged.
+		 * \return a new Note instance
+		 */
+	static Note* load_from( QXmlStreamReader& reader, std::shared_ptr<InstrumentList> instruments, bool bSilent = false );
 
 		/**
 		 * find the corresponding instrument and point to it, or an empty instrument
@@ -312,6 +340,23 @@ class Note : public H2Core::Object<Note>
 		 * \param val_r the right channel value
 		 */
 		void compute_lr_values( float* val_l, float* val_r );
+		/**
+		 * Applies the filter of the instrument to a whole block of
+		 * frames in place.
+		 *
+		 * In contrast to compute_lr_values() the cutoff and resonance
+		 * of the instrument are read only once per block. If they
+		 * changed since the previous block of the same component,
+		 * they are ramped linearly across the current one.
+		 *
+		 * \param pLeft left channel buffer
+		 * \param pRight right channel buffer
+		 * \param nFrames number of frames to process
+		 * \param pSelectedLayer state of the component rendered,
+		 * which holds the coefficients used in its previous block.
+		 */
+		void applyFilter( float* pLeft, float* pRight, int nFrames,
+						  std::shared_ptr<SelectedLayerInfo> pSelectedLayer );
 
 	long long getNoteStart() const;
 	float getUsedTickSize() const;
@@ -23,12 +23,16 @@
 #include <core/Basics/Pattern.h>
 
 #include <cassert>
+#include <vector>
+
+#include <QLocale>
 
 #include <core/Basics/Note.h>
 #include <core/Basics/PatternList.h>
 #include <core/AudioEngine/AudioEngine.h>
 #include <core/Hydrogen.h>
 
+#include <core/Helpers/BinaryDoc.h>
 #include <core/Helpers/Filesystem.h>
 #include <core/Helpers/Legacy.h>
 
@@ -107,6 +111,23 @@ Pattern* Pattern::load_file( const QString& sPatternPath, std::shared_ptr<Instru
 {
 	INFOLOG( QString( "Load pattern %1" ).arg( sPatternPath ) );
 
+	if ( BinaryDoc::isBinary( sPatternPath ) ) {
+		BinaryDoc binaryDoc;
+		if ( ! binaryDoc.read( sPatternPath ) ) {
+			return nullptr;
+		}
+		XMLNode root = binaryDoc.getDocument()->firstChildElement( "drumkit_pattern" );
+		XMLNode pattern_node = root.firstChildElement( "pattern" );
+		if ( pattern_node.isNull() ) {
+			ERRORLOG( QString( "'pattern' node not found in [%1]" )
+					  .arg( sPatternPath ) );
+			return nullptr;
+		}
+		Pattern* pPattern = load_from( &pattern_node, pInstrumentList );
+		binaryDoc.loadNotes( 0, pPattern, pInstrumentList );
+		return pPattern;
+	}
+
 	XMLDoc doc;
 	if ( ! loadDoc( sPatternPath, pInstrumentList, &doc, false ) ) {
 		// Try former pattern version
@@ -149,7 +170,66 @@ Pattern* Pattern::load_from( XMLNode* node, std::shared_ptr<InstrumentList> pIns
 	return pPattern;
 }
 
-bool Pattern::save_file( const QString& drumkit_name, const QString& author, const License& license, const QString& pattern_path, bool overwrite ) const
+Pattern* Pattern::load_from( QXmlStreamReader& reader, std::shared_ptr<InstrumentList> pInstrumentList, bool bSilent )
+{
+	QString sName, sInfo;
+	QString sCategory( "unknown" );
+	int nSize = -1;
+	int nDenominator = 4;
+	std::vector<Note*> notes;
+
+	// Empty nodes are treated as missing ones and leave the default
+	// in place.
+	auto readText = [&]( QString* pValue ) {
+		const QString sText = reader.readElementText( QXmlStreamReader::SkipChildElements );
+		if ( ! sText.isEmpty() ) {
+			*pValue = sText;
+		}
+	};
+	auto readInt = [&]( int* pValue ) {
+		const QString sText = reader.readElementText( QXmlStreamReader::SkipChildElements );
+		if ( ! sText.isEmpty() ) {
+			*pValue = QLocale::c().toInt( sText );
+		}
+	};
+
+	while ( reader.readNextStartElement() ) {
+		const auto name = reader.name();
+		if ( name == QLatin1String( "noteList" ) ) {
+			while ( reader.readNextStartElement() ) {
+				if ( reader.name() == QLatin1String( "note" ) ) {
+					notes.push_back( Note::load_from( reader, pInstrumentList, bSilent ) );
+				} else {
+					reader.skipCurrentElement();
+				}
+			}
+		} else if ( name == QLatin1String( "name" ) ) {
+			readText( &sName );
+		} else if ( name == QLatin1String( "info" ) ) {
+			readText( &sInfo );
+		} else if ( name == QLatin1String( "category" ) ) {
+			readText( &sCategory );
+		} else if ( name == QLatin1String( "size" ) ) {
+			readInt( &nSize );
+		} else if ( name == QLatin1String( "denominator" ) ) {
+			readInt( &nDenominator );
+		} else {
+			reader.skipCurrentElement();
+		}
+	}
+
+	Pattern* pPattern = new Pattern( sName, sInfo, sCategory, nSize, nDenominator );
+	// Notes are stored ordered by position. Hinting the insertion
+	// makes it amortized constant time.
+	for ( auto& pNote : notes ) {
+		pPattern->__notes.emplace_hint( pPattern->__notes.end(),
+										pNote->get_position(), pNote );
+	}
+
+	return pPattern;
+}
+
+bool Pattern::save_file( const QString& drumkit_name, const QString& author, const License& license, const QString& pattern_path, bool overwrite, bool bBinary ) const
 {
 	INFOLOG( QString( "Saving pattern into %1" ).arg( pattern_path ) );
 	if( !overwrite && Filesystem::file_exists( pattern_path, true ) ) {
@@ -157,16 +237,23 @@ bool Pattern::save_file( const QString& drumkit_name, const QString& author, con
 		return false;
 	}
 	XMLDoc doc;
-	XMLNode root = doc.set_root( "drumkit_pattern", "drumkit_pattern" );
+	BinaryDoc binaryDoc;
+	XMLDoc* pDoc = bBinary ? binaryDoc.getDocument() : &doc;
+	XMLNode root = pDoc->set_root( "drumkit_pattern", "drumkit_pattern" );
 	root.write_string( "drumkit_name", drumkit_name );
 	root.write_string( "author", author );							// FIXME this is never loaded back
 	root.write_string( "license", license.toQString() );
 	// FIXME this is never loaded back
-	save_to( &root );
+	save_to( &root, nullptr, ! bBinary );
+	if ( bBinary ) {
+		binaryDoc.addPattern( this );
+		return binaryDoc.write( pattern_path );
+	}
 	return doc.write( pattern_path );
 }
 
-void Pattern::save_to( XMLNode* node, const std::shared_ptr<Instrument> pInstrumentOnly ) const
+void Pattern::save_to( XMLNode* node, const std::shared_ptr<Instrument> pInstrumentOnly,
+					   bool bWriteNotes ) const
 {
 	XMLNode pattern_node =  node->createNode( "pattern" );
 	pattern_node.write_string( "name", __name );
@@ -174,6 +261,10 @@ void Pattern::save_to( XMLNode* node, const std::shared_ptr<Instrument> pInstrum
 	pattern_node.write_string( "category", __category );
 	pattern_node.write_int( "size", __length );
 	pattern_node.write_int( "denominator", __denominator );
+
+	if ( ! bWriteNotes ) {
+		return;
+	}
 	
 	int nId = ( pInstrumentOnly == nullptr ? -1 : pInstrumentOnly->get_id() );
 	
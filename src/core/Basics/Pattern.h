@@ -88,6 +88,20 @@ class Pattern : public H2Core::Object<Pattern>
 		 * \return a new Pattern instance
 		 */
 	static Pattern* load_from( XMLNode* node, std::shared_ptr<InstrumentList> instruments, bool bSilent = false );
+		/**
+		 * load a pattern from a QXmlStreamReader positioned at the
+		 * start of a "pattern" element. The reader is left at its
+		 * end.
+		 * \param reader the reader to read from
+		 * \param instruments the current instrument list to search
+		 * instrument into. In case it is nullptr, the notes are
+		 * loaded without being mapped to their instruments (see
+		 * Note::map_instrument()).
+		 * \param bSilent Whether infos, warnings, and errors should
+		 * be logged.
+		 * \return a new Pattern instance
+		 */
+	static Pattern* load_from( QXmlStreamReader& reader, std::shared_ptr<InstrumentList> instruments, bool bSilent = false );
 		/**
 		 * save a pattern into an xml file
 		 * \param drumkit_name the name of the drumkit it is supposed to play with
@@ -95,9 +109,11 @@ class Pattern : public H2Core::Object<Pattern>
 		 * \param license the license that applies to it
 		 * \param pattern_path the path to save the pattern into
 		 * \param overwrite allows to write over existing pattern file
+		 * \param bBinary whether to write a BinaryDoc instead of an
+		 *   XML file. Both are accepted by load_file().
 		 * \return true on success
 		 */
-		bool save_file( const QString& drumkit_name, const QString& author, const License& license, const QString& pattern_path, bool overwrite=false ) const;
+		bool save_file( const QString& drumkit_name, const QString& author, const License& license, const QString& pattern_path, bool overwrite=false, bool bBinary=false ) const;
 
 	/**
 	 * Retrieves the name of the associated drumkit contained in the
@@ -219,8 +235,11 @@ class Pattern : public H2Core::Object<Pattern>
 		 * save the pattern within the given XMLNode
 		 * \param node the XMLNode to feed
 		 * \param instrumentOnly export only the notes of that instrument if given
+		 * \param bWriteNotes whether to write the "noteList". It is
+		 *   omitted by a BinaryDoc which stores the notes separately.
 		 */
-		void save_to( XMLNode* node, const std::shared_ptr<Instrument> instrumentOnly = nullptr ) const;
+		void save_to( XMLNode* node, const std::shared_ptr<Instrument> instrumentOnly = nullptr,
+					  bool bWriteNotes = true ) const;
 		/** Formatted string version for debugging purposes.
 		 * \param sPrefix String prefix which will be added in front of
 		 * every new line
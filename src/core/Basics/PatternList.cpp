@@ -84,12 +84,56 @@ PatternList* PatternList::load_from( XMLNode* pNode, std::shared_ptr<InstrumentL
 	return pPatternList;
 }
 
-void PatternList::save_to( XMLNode* pNode, const std::shared_ptr<Instrument> pInstrumentOnly ) const {
+PatternList* PatternList::load_from( QXmlStreamReader& reader, std::shared_ptr<InstrumentList> pInstrumentList, bool bSilent ) {
+	PatternList* pPatternList = new PatternList();
+	int nPatternCount = 0;
+
+	while ( reader.readNextStartElement() ) {
+		if ( reader.name() != QLatin1String( "pattern" ) ) {
+			reader.skipCurrentElement();
+			continue;
+		}
+
+		nPatternCount++;
+		Pattern* pPattern = Pattern::load_from( reader, pInstrumentList, bSilent );
+		if ( pPattern != nullptr ) {
+			pPatternList->add( pPattern );
+		}
+		else {
+			ERRORLOG( "Error loading pattern" );
+			delete pPatternList;
+			return nullptr;
+		}
+	}
+
+	if ( reader.hasError() ) {
+		ERRORLOG( QString( "Unable to read pattern list: %1" )
+				  .arg( reader.errorString() ) );
+		delete pPatternList;
+		return nullptr;
+	}
+	if ( nPatternCount == 0 && ! bSilent ) {
+		WARNINGLOG( "0 patterns?" );
+	}
+
+	return pPatternList;
+}
+
+void PatternList::mapInstruments( std::shared_ptr<InstrumentList> pInstrumentList ) {
+	for ( const auto& pPattern : __patterns ) {
+		for ( const auto& it : *pPattern->get_notes() ) {
+			it.second->map_instrument( pInstrumentList );
+		}
+	}
+}
+
+void PatternList::save_to( XMLNode* pNode, const std::shared_ptr<Instrument> pInstrumentOnly,
+						   bool bWriteNotes ) const {
 	XMLNode patternListNode = pNode->createNode( "patternList" );
 	
 	for ( const auto& pPattern : __patterns ) {
 		if ( pPattern != nullptr ) {
-			pPattern->save_to( &patternListNode, pInstrumentOnly );
+			pPattern->save_to( &patternListNode, pInstrumentOnly, bWriteNotes );
 		}
 	}
 }
@@ -27,6 +27,8 @@
 #include <core/Object.h>
 #include <core/AudioEngine/AudioEngine.h>
 
+class QXmlStreamReader;
+
 namespace H2Core
 {
 
@@ -62,7 +64,29 @@ class XMLNode;
 		 * \return a new Pattern instance
 		 */
 	static PatternList* load_from( XMLNode* pNode, std::shared_ptr<InstrumentList> pInstrumentList, bool bSilent = false );
-	void save_to( XMLNode* pNode, const std::shared_ptr<Instrument> pInstrumentOnly = nullptr ) const;
+		/**
+		 * load a #PatternList from a QXmlStreamReader positioned at
+		 * the start of a "patternList" element. The reader is left
+		 * at its end.
+		 *
+		 * Intended to be used as XMLDoc::StreamHandler.
+		 *
+		 * \param reader the reader to read from
+		 * \param pInstrumentList the current instrument list to
+		 * search instrument into. Might be nullptr in case the list
+		 * is not known yet. mapInstruments() has to be called once
+		 * it is.
+		 * \param bSilent Whether infos, warnings, and errors should
+		 * be logged.
+		 * \return a new PatternList instance
+		 */
+	static PatternList* load_from( QXmlStreamReader& reader, std::shared_ptr<InstrumentList> pInstrumentList, bool bSilent = false );
+	/** See Pattern::save_to() */
+	void save_to( XMLNode* pNode, const std::shared_ptr<Instrument> pInstrumentOnly = nullptr,
+				  bool bWriteNotes = true ) const;
+	/** Maps the notes of all contained patterns to the instruments
+	 * of @a pInstrumentList (see Note::map_instrument()). */
+	void mapInstruments( std::shared_ptr<InstrumentList> pInstrumentList );
 
 		/** returns the numbers of patterns */
 		int size() const;
@@ -22,6 +22,8 @@
 
 
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <memory>
 
@@ -30,6 +32,7 @@
 #include <core/Helpers/Filesystem.h>
 #include <core/Basics/Sample.h>
 #include <core/Basics/Note.h>
+#include <core/Sampler/Resampler.h>
 
 #if defined(H2CORE_HAVE_RUBBERBAND) || _DOXYGEN_
 #include <rubberband/RubberBandStretcher.h>
@@ -73,6 +76,10 @@ Sample::Sample( const QString& filepath, const License& license, int frames, int
 	m_license( license )
 {
 	assert( filepath.lastIndexOf( "/" ) >0 );
+
+	if ( __data_l != nullptr && __data_r != nullptr ) {
+		computeLevelEnvelopes();
+	}
 }
 
 Sample::Sample( std::shared_ptr<Sample> pOther ): Object( *pOther ),
@@ -84,8 +91,16 @@ Sample::Sample( std::shared_ptr<Sample> pOther ): Object( *pOther ),
 	__is_modified( pOther->get_is_modified() ),
 	__loops( pOther->__loops ),
 	__rubberband( pOther->__rubberband ),
-	m_license( pOther->m_license )
+	m_license( pOther->m_license ),
+	m_peakEnvelope( pOther->m_peakEnvelope ),
+	m_rmsEnvelope( pOther->m_rmsEnvelope ),
+	m_remainingPeakEnvelope( pOther->m_remainingPeakEnvelope )
 {
+	{
+		// Only an already built pyramid is shared.
+		std::lock_guard<std::mutex> lock( pOther->m_waveformPeaksMutex );
+		m_pWaveformPeaks = pOther->m_pWaveformPeaks;
+	}
 
 	__data_l = new float[__frames];
 	__data_r = new float[__frames];
@@ -233,6 +248,138 @@ bool Sample::load( float fBpm )
 	}
 #endif
 
+	computeLevelEnvelopes();
+
+	return true;
+}
+
+void Sample::computeLevelEnvelopes()
+{
+	invalidateWaveformPeaks();
+	m_peakEnvelope.clear();
+	m_rmsEnvelope.clear();
+	m_remainingPeakEnvelope.clear();
+
+	if ( __data_l == nullptr || __data_r == nullptr || __frames <= 0 ) {
+		return;
+	}
+
+	const int nBlocks = ( __frames + nLevelEnvelopeBlockSize - 1 ) /
+		nLevelEnvelopeBlockSize;
+	m_peakEnvelope.resize( nBlocks );
+	m_rmsEnvelope.resize( nBlocks );
+	m_remainingPeakEnvelope.resize( nBlocks );
+
+	for ( int nBlock = 0; nBlock < nBlocks; ++nBlock ) {
+		const int nStart = nBlock * nLevelEnvelopeBlockSize;
+		const int nEnd = std::min( nStart + nLevelEnvelopeBlockSize, __frames );
+		float fPeak = 0;
+		double fSumSquares = 0;
+		for ( int i = nStart; i < nEnd; ++i ) {
+			fPeak = std::max( fPeak, std::max( std::fabs( __data_l[ i ] ),
+											   std::fabs( __data_r[ i ] ) ) );
+			fSumSquares += __data_l[ i ] * __data_l[ i ] +
+				__data_r[ i ] * __data_r[ i ];
+		}
+		m_peakEnvelope[ nBlock ] = fPeak;
+		m_rmsEnvelope[ nBlock ] =
+			std::sqrt( fSumSquares / ( 2 * ( nEnd - nStart ) ) );
+	}
+
+	float fRemainingPeak = 0;
+	for ( int nBlock = nBlocks - 1; nBlock >= 0; --nBlock ) {
+		fRemainingPeak = std::max( fRemainingPeak, m_peakEnvelope[ nBlock ] );
+		m_remainingPeakEnvelope[ nBlock ] = fRemainingPeak;
+	}
+}
+
+std::shared_ptr<const WaveformPeaks> Sample::getWaveformPeaks() const
+{
+	// The pyramid is only needed for drawing. Building it on demand
+	// spares loading kits and songs a pass over all sample data.
+	std::lock_guard<std::mutex> lock( m_waveformPeaksMutex );
+	if ( m_pWaveformPeaks == nullptr && __data_l != nullptr &&
+		 __data_r != nullptr && __frames > 0 ) {
+		m_pWaveformPeaks =
+			std::make_shared<const WaveformPeaks>( __data_l, __data_r, __frames );
+	}
+	return m_pWaveformPeaks;
+}
+
+void Sample::invalidateWaveformPeaks()
+{
+	// Also waits for a pyramid being built in another thread.
+	std::lock_guard<std::mutex> lock( m_waveformPeaksMutex );
+	m_pWaveformPeaks = nullptr;
+}
+
+WaveformPeaks::Range Sample::getWaveformRange( int nChannel, int nStartFrame, int nEndFrame ) const
+{
+	WaveformPeaks::Range range;
+	const float* pData = nChannel == 0 ? __data_l :
+		( nChannel == 1 ? __data_r : nullptr );
+	nStartFrame = std::max( nStartFrame, 0 );
+	nEndFrame = std::min( nEndFrame, __frames );
+	if ( pData == nullptr || nStartFrame >= nEndFrame ) {
+		return range;
+	}
+
+	const int nBlockSize = WaveformPeaks::nBlockSize;
+	const int nFirstBlock = ( nStartFrame + nBlockSize - 1 ) / nBlockSize;
+	// The last block of the sample may be a partial one.
+	const int nEndBlock = nEndFrame == __frames ?
+		( __frames + nBlockSize - 1 ) / nBlockSize : nEndFrame / nBlockSize;
+	const auto pPeaks = getWaveformPeaks();
+	if ( pPeaks == nullptr || nFirstBlock >= nEndBlock ) {
+		range.scan( pData, nStartFrame, nEndFrame );
+		return range;
+	}
+
+	range.scan( pData, nStartFrame, nFirstBlock * nBlockSize );
+	range.merge( pPeaks->query( nChannel, nFirstBlock, nEndBlock ) );
+	range.scan( pData, std::min( nEndBlock * nBlockSize, nEndFrame ), nEndFrame );
+
+	return range;
+}
+
+bool Sample::convertSampleRate( int nSampleRate )
+{
+	if ( nSampleRate <= 0 || __sample_rate <= 0 || nSampleRate == __sample_rate ||
+		 __data_l == nullptr || __data_r == nullptr ) {
+		return false;
+	}
+
+	const double fStep = static_cast<double>( __sample_rate ) / nSampleRate;
+	const long long nNewFrames =
+		static_cast<long long>( std::ceil( __frames / fStep ) );
+	if ( nNewFrames <= 0 || nNewFrames > std::numeric_limits<int>::max() ) {
+		ERRORLOG( QString( "Unable to convert [%1] from %2 to %3 Hz" )
+				  .arg( get_filepath() ).arg( __sample_rate ).arg( nSampleRate ) );
+		return false;
+	}
+
+	invalidateWaveformPeaks();
+
+	float* pNewData_L = new float[ nNewFrames ];
+	float* pNewData_R = new float[ nNewFrames ];
+	for ( int i = 0; i < nNewFrames; ++i ) {
+		Resampler::sincInterpolate( __data_l, __data_r, __frames, i * fStep,
+									static_cast<float>( fStep ),
+									&pNewData_L[ i ], &pNewData_R[ i ] );
+	}
+
+	INFOLOG( QString( "Converted [%1] from %2 to %3 Hz" )
+			 .arg( get_filename() ).arg( __sample_rate ).arg( nSampleRate ) );
+
+	delete[] __data_l;
+	delete[] __data_r;
+	__data_l = pNewData_L;
+	__data_r = pNewData_R;
+	__frames = static_cast<int>( nNewFrames );
+	__sample_rate = nSampleRate;
+
+	computeLevelEnvelopes();
+
 	return true;
 }
 
@@ -649,6 +796,7 @@ bool Sample::exec_rubberband_cli( float fBpm )
 
 	__frames = p_Rubberbanded->get_frames();
 
+	p_Rubberbanded->invalidateWaveformPeaks();
 	__data_l = p_Rubberbanded->get_data_l();
 	__data_r = p_Rubberbanded->get_data_r();
 	p_Rubberbanded->__data_l = nullptr;
@@ -24,11 +24,13 @@
 #define H2C_SAMPLE_H
 
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <sndfile.h>
 
 #include <core/License.h>
 #include <core/Object.h>
+#include <core/Basics/WaveformPeaks.h>
 
 namespace H2Core
 {
@@ -261,6 +263,73 @@ class Sample : public H2Core::Object<Sample>
 
 	License getLicense() const;
 	void setLicense( const License& license );
+
+		/**
+		 * Converts the sample data to @a nSampleRate using the
+		 * band-limited windowed sinc of the #Resampler.
+		 *
+		 * Used to perform the resampling once when loading a
+		 * drumkit instead of in every process cycle (see
+		 * Preferences::m_bResampleSamplesOnLoad). Afterwards,
+		 * #__sample_rate and #__frames refer to the converted
+		 * data.
+		 *
+		 * \return true if the data was converted.
+		 */
+		bool convertSampleRate( int nSampleRate );
+
+		/** Number of frames summarized by a single entry of the
+		 * level envelopes. */
+		static constexpr int nLevelEnvelopeBlockSize = 256;
+		/**
+		 * Computes the block-wise level envelopes of the sample
+		 * data (#m_peakEnvelope, #m_rmsEnvelope, and
+		 * #m_remainingPeakEnvelope).
+		 *
+		 * This is done automatically when loading the sample and
+		 * has to be called again whenever #__data_l or #__data_r are
+		 * altered by other means. It also discards the waveform
+		 * pyramid (see getWaveformPeaks()), which is rebuilt on
+		 * next use.
+		 */
+		void computeLevelEnvelopes();
+		/** \return whether the level envelopes were computed for
+		 * the current sample data. */
+		bool hasLevelEnvelopes() const;
+		/** \return maximum absolute amplitude of both channels
+		 * within the block containing @a nFrame. */
+		float getPeak( int nFrame ) const;
+		/** \return RMS of both channels within the block
+		 * containing @a nFrame. */
+		float getRms( int nFrame ) const;
+		/** \return maximum absolute amplitude of both channels from
+		 * the block containing @a nFrame till the end of the
+		 * sample. Used to decide whether the remainder of a voice
+		 * can still be heard. */
+		float getRemainingPeak( int nFrame ) const;
+
+		/** \return min/max pyramid of the current sample data used
+		 * to draw waveforms. It is computed on first use, which
+		 * takes a single pass over the data. nullptr if no data is
+		 * loaded. */
+		std::shared_ptr<const WaveformPeaks> getWaveformPeaks() const;
+		/**
+		 * Amplitude statistics of a range of frames for drawing
+		 * waveforms.
+		 *
+		 * The whole blocks within the range are taken from
+		 * getWaveformPeaks(), only the partial blocks at both ends
+		 * are read from the sample data. The costs do thus hardly
+		 * depend on the length of the range.
+		 *
+		 * \param nChannel 0 for #__data_l, 1 for #__data_r
+		 * \param nStartFrame first frame of the range
+		 * \param nEndFrame frame after the last one of the range
+		 *
+		 * \return statistics of the range clamped to the
+		 * available frames.
+		 */
+		WaveformPeaks::Range getWaveformRange( int nChannel, int nStartFrame, int nEndFrame ) const;
 	
 		/**
 		 * parse the given string and rturn the corresponding loop_mode
@@ -279,6 +348,9 @@ class Sample : public H2Core::Object<Sample>
 		 * \return String presentation of current object.*/
 		QString toQString( const QString& sPrefix, bool bShort = true ) const override;
 	private:
+		/** Discards the waveform pyramid. Has to be called before
+		 * #__data_l or #__data_r are altered or freed. */
+		void invalidateWaveformPeaks();
 		/**
 		 * apply #__loops transformation to the sample
 		 */
@@ -329,12 +401,25 @@ class Sample : public H2Core::Object<Sample>
 	 * the Pattern Editor, it does not have to be specified.
 	 */
 	License m_license;
+
+		/** Per block maximum absolute amplitude. */
+		std::vector<float> m_peakEnvelope;
+		/** Per block root mean square. */
+		std::vector<float> m_rmsEnvelope;
+		/** Maximum of #m_peakEnvelope from each block onwards. */
+		std::vector<float> m_remainingPeakEnvelope;
+
+		/** Guards #m_pWaveformPeaks. */
+		mutable std::mutex m_waveformPeaksMutex;
+		/** Built by getWaveformPeaks() on first use. */
+		mutable std::shared_ptr<const WaveformPeaks> m_pWaveformPeaks;
 };
 
 // DEFINITIONS
 
 inline void Sample::unload()
 {
+	invalidateWaveformPeaks();
 	if ( __data_l != nullptr ) {
 		delete [] __data_l;
 	}
@@ -347,6 +432,10 @@ inline void Sample::unload()
 	    velocity, loop and rubberband are kept unchanged */
 
 	__data_l = __data_r = nullptr;
+
+	m_peakEnvelope.clear();
+	m_rmsEnvelope.clear();
+	m_remainingPeakEnvelope.clear();
 }
 
 inline bool Sample::is_empty() const
@@ -399,6 +488,38 @@ inline int Sample::get_size() const
 	return __frames * sizeof( float ) * 2;
 }
 
+inline bool Sample::hasLevelEnvelopes() const
+{
+	return ! m_remainingPeakEnvelope.empty();
+}
+
+inline float Sample::getPeak( int nFrame ) const
+{
+	const int nBlock = nFrame / nLevelEnvelopeBlockSize;
+	if ( nFrame < 0 || nBlock >= static_cast<int>(m_peakEnvelope.size()) ) {
+		return 0;
+	}
+	return m_peakEnvelope[ nBlock ];
+}
+
+inline float Sample::getRms( int nFrame ) const
+{
+	const int nBlock = nFrame / nLevelEnvelopeBlockSize;
+	if ( nFrame < 0 || nBlock >= static_cast<int>(m_rmsEnvelope.size()) ) {
+		return 0;
+	}
+	return m_rmsEnvelope[ nBlock ];
+}
+
+inline float Sample::getRemainingPeak( int nFrame ) const
+{
+	const int nBlock = nFrame / nLevelEnvelopeBlockSize;
+	if ( nFrame < 0 || nBlock >= static_cast<int>(m_remainingPeakEnvelope.size()) ) {
+		return 0;
+	}
+	return m_remainingPeakEnvelope[ nBlock ];
+}
+
 inline float* Sample::get_data_l() const
 {
 	return __data_l;
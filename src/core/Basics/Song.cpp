@@ -46,8 +46,10 @@
 #include <core/Basics/AutomationPath.h>
 #include <core/AutomationPathSerializer.h>
 #include <core/Hydrogen.h>
+#include <core/Helpers/BinaryDoc.h>
 #include <core/Helpers/Legacy.h>
 #include <core/Sampler/Sampler.h>
+#include <core/Sampler/PanLawTable.h>
 #include <core/SoundLibrary/SoundLibraryDatabase.h>
 
 #ifdef H2CORE_HAVE_OSC
@@ -92,6 +94,8 @@ Song::Song( const QString& sName, const QString& sAuthor, float fBpm, float fVol
 	, m_bIsPatternEditorLocked( false )
 	, m_nPanLawType ( Sampler::RATIO_STRAIGHT_POLYGONAL )
 	, m_fPanLawKNorm ( Sampler::K_NORM_DEFAULT )
+	, m_pPanLawTable( nullptr )
+	, m_pPanLawTableInUse( nullptr )
 	, m_sLastLoadedDrumkitName( "" )
 	, m_sLastLoadedDrumkitPath( "" )
 {
@@ -103,6 +107,8 @@ Song::Song( const QString& sName, const QString& sAuthor, float fBpm, float fVol
 	m_pVelocityAutomationPath = new AutomationPath(0.0f, 1.5f,  1.0f);
 
 	m_pTimeline = std::make_shared<Timeline>();
+
+	updatePanLawTable();
 }
 
 Song::~Song()
@@ -125,6 +131,11 @@ Song::~Song()
 
 	delete m_pVelocityAutomationPath;
 
+	for ( auto pTable : m_retiredPanLawTables ) {
+		delete pTable;
+	}
+	delete m_pPanLawTable.load();
+
 	INFOLOG( QString( "DESTROY '%1'" ).arg( m_sName ) );
 }
 
@@ -194,16 +205,37 @@ std::shared_ptr<Song> Song::load( const QString& sFilename, bool bSilent )
 		INFOLOG( "Reading " + sPath );
 	}
 
+	// The pattern list holds the bulk of a song. It is parsed
+	// straight into its objects instead of being added to the DOM.
 	XMLDoc doc;
-	if ( ! doc.read( sFilename ) && ! bSilent ) {
+	PatternList* pPatternList = nullptr;
+	auto readPatternList = [&]( QXmlStreamReader& reader ) {
+		delete pPatternList;
+		pPatternList = PatternList::load_from( reader, nullptr, bSilent );
+		return pPatternList != nullptr;
+	};
+
+	// In a binary document the notes are not part of the XML and are
+	// added once the patterns were created.
+	BinaryDoc binaryDoc;
+	const bool bBinary = BinaryDoc::isBinary( sFilename );
+	
+	if ( bBinary ? ! binaryDoc.read( sFilename ) :
+		 ! doc.readStreamed( sFilename, "song/patternList", readPatternList,
+							 bSilent ) ) {
+		// Do not continue with a partially read document.
 		ERRORLOG( QString( "Something went wrong while loading song [%1]" )
 				  .arg( sFilename ) );
+		delete pPatternList;
+		return nullptr;
 	}
 				  
-	XMLNode songNode = doc.firstChildElement( "song" );
+	XMLNode songNode = ( bBinary ? binaryDoc.getDocument() : &doc )
+		->firstChildElement( "song" );
 
 	if ( songNode.isNull() ) {
 		ERRORLOG( "Error reading song: 'song' node not found" );
+		delete pPatternList;
 		return nullptr;
 	}
 
@@ -217,7 +249,14 @@ std::shared_ptr<Song> Song::load( const QString& sFilename, bool bSilent )
 		}
 	}
 
-	auto pSong = Song::loadFrom( &songNode, sFilename, bSilent );
+	auto pSong = Song::loadFrom( &songNode, sFilename, bSilent, pPatternList );
+	if ( pSong != nullptr && bBinary ) {
+		auto pSongPatternList = pSong->getPatternList();
+		for ( int ii = 0; ii < pSongPatternList->size(); ++ii ) {
+			binaryDoc.loadNotes( ii, pSongPatternList->get( ii ),
+								 pSong->getInstrumentList() );
+		}
+	}
 	if ( pSong != nullptr ) {
 		pSong->setFilename( sFilename );
 	}
@@ -225,7 +264,8 @@ std::shared_ptr<Song> Song::load( const QString& sFilename, bool bSilent )
 	return pSong;
 }
 
-std::shared_ptr<Song> Song::loadFrom( XMLNode* pRootNode, const QString& sFilename, bool bSilent )
+std::shared_ptr<Song> Song::loadFrom( XMLNode* pRootNode, const QString& sFilename, bool bSilent,
+									  PatternList* pPatternList )
 {
 	auto pPreferences = Preferences::get_instance();
 	
@@ -396,6 +436,7 @@ std::shared_ptr<Song> Song::loadFrom( XMLNode* pRootNode, const QString& sFilena
 													  License(), // per-instrument licenses
 													  bSilent );
 	if ( pInstrumentList == nullptr ) {
+		delete pPatternList;
 		return nullptr;
 	}
 
@@ -448,9 +489,14 @@ std::shared_ptr<Song> Song::loadFrom( XMLNode* pRootNode, const QString& sFilena
 	pSong->setLastLoadedDrumkitName( sLastLoadedDrumkitName );
 
 	// Pattern list
-	pSong->setPatternList( PatternList::load_from( pRootNode,
-												   pSong->getInstrumentList(),
-												   bSilent ) );
+	if ( pPatternList != nullptr ) {
+		pPatternList->mapInstruments( pSong->getInstrumentList() );
+		pSong->setPatternList( pPatternList );
+	} else {
+		pSong->setPatternList( PatternList::load_from( pRootNode,
+													   pSong->getInstrumentList(),
+													   bSilent ) );
+	}
 
 	// Virtual Patterns
 	pSong->loadVirtualPatternsFrom( pRootNode, bSilent );
@@ -560,7 +606,7 @@ std::shared_ptr<Song> Song::loadFrom( XMLNode* pRootNode, const QString& sFilena
 }
 
 /// Save a song to file
-bool Song::save( const QString& sFilename, bool bSilent )
+bool Song::save( const QString& sFilename, bool bSilent, bool bBinary )
 {
 	QFileInfo fi( sFilename );
 	if ( ( Filesystem::file_exists( sFilename, true ) &&
@@ -579,20 +625,30 @@ bool Song::save( const QString& sFilename, bool bSilent )
 	}
 
 	XMLDoc doc;
-	XMLNode rootNode = doc.set_root( "song" );
+	BinaryDoc binaryDoc;
+	XMLDoc* pDoc = bBinary ? binaryDoc.getDocument() : &doc;
+	XMLNode rootNode = pDoc->set_root( "song" );
 	
 	// In order to comply with the GPL license we have to add a
 	// license notice to the file.
 	if ( getLicense().getType() == License::GPL ) {
-		doc.appendChild( doc.createComment( License::getGPLLicenseNotice( getAuthor() ) ) );
+		pDoc->appendChild( pDoc->createComment( License::getGPLLicenseNotice( getAuthor() ) ) );
 	}
 
-	writeTo( &rootNode, bSilent );
+	writeTo( &rootNode, bSilent, ! bBinary );
+	if ( bBinary ) {
+		// Same order as in PatternList::save_to().
+		for ( const auto& pPattern : *m_pPatternList ) {
+			if ( pPattern != nullptr ) {
+				binaryDoc.addPattern( pPattern );
+			}
+		}
+	}
 	
 	setFilename( sFilename );
 	setIsModified( false );
 
-	if ( ! doc.write( sFilename ) ) {
+	if ( ! ( bBinary ? binaryDoc.write( sFilename ) : doc.write( sFilename ) ) ) {
 		ERRORLOG( QString( "Error writing song to [%1]" ).arg( sFilename ) );
 		return false;
 	}
@@ -740,7 +796,7 @@ void Song::writePatternGroupVectorTo( XMLNode* pNode, bool bSilent ) {
 	}
 }
 	
-void Song::writeTo( XMLNode* pRootNode, bool bSilent ) {
+void Song::writeTo( XMLNode* pRootNode, bool bSilent, bool bWriteNotes ) {
 	pRootNode->write_string( "version", QString( get_version().c_str() ) );
 	pRootNode->write_float( "bpm", m_fBpm );
 	pRootNode->write_float( "volume", m_fVolume );
@@ -830,7 +886,7 @@ void Song::writeTo( XMLNode* pRootNode, bool bSilent ) {
 
 	m_pInstrumentList->save_to( pRootNode, -1, true, true );
 	
-	m_pPatternList->save_to( pRootNode, nullptr );
+	m_pPatternList->save_to( pRootNode, nullptr, bWriteNotes );
 
 	writeVirtualPatternsTo( pRootNode, bSilent );
 	
@@ -1202,6 +1258,17 @@ bool Song::pasteInstrumentLineFromString( const QString& sSerialized, int nSelec
 }
 
 
+void Song::setPanLawType( int nPanLawType ) {
+	if ( nPanLawType >= Sampler::RATIO_STRAIGHT_POLYGONAL &&
+		 nPanLawType <= Sampler::QUADRATIC_CONST_K_NORM ) {
+		m_nPanLawType = nPanLawType;
+	} else {
+		WARNINGLOG( "Unknown pan law type. Set default." );
+		m_nPanLawType = Sampler::RATIO_STRAIGHT_POLYGONAL;
+	}
+	updatePanLawTable();
+}
+
 void Song::setPanLawKNorm( float fKNorm ) {
 	if ( fKNorm >= 0. ) {
 		m_fPanLawKNorm = fKNorm;
@@ -1209,6 +1276,39 @@ void Song::setPanLawKNorm( float fKNorm ) {
 		WARNINGLOG("negative kNorm. Set default" );
 		m_fPanLawKNorm = Sampler::K_NORM_DEFAULT;
 	}
+	updatePanLawTable();
+}
+
+void Song::updatePanLawTable() {
+	const PanLawTable* pTable = m_pPanLawTable.load();
+	if ( pTable != nullptr && pTable->getPanLawType() == m_nPanLawType &&
+		 pTable->getKNorm() == m_fPanLawKNorm ) {
+		return;
+	}
+
+	// The table is built before publishing it to keep the
+	// allocation out of the audio thread.
+	const PanLawTable* pOldTable =
+		m_pPanLawTable.exchange( new PanLawTable( m_nPanLawType, m_fPanLawKNorm ) );
+	if ( pOldTable != nullptr ) {
+		m_retiredPanLawTables.push_back( pOldTable );
+	}
+	deleteRetiredPanLawTables();
+}
+
+void Song::deleteRetiredPanLawTables() {
+	// A retired table still in use will be deleted on the next
+	// change of the pan law or along with the song.
+	const PanLawTable* pInUse = m_pPanLawTableInUse.load();
+	auto it = m_retiredPanLawTables.begin();
+	while ( it != m_retiredPanLawTables.end() ) {
+		if ( *it != pInUse ) {
+			delete *it;
+			it = m_retiredPanLawTables.erase( it );
+		} else {
+			++it;
+		}
+	}
 }
 
 void Song::setDrumkit( std::shared_ptr<Drumkit> pDrumkit, bool bConditional ) {
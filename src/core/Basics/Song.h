@@ -29,6 +29,7 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <atomic>
 
 #include <core/License.h>
 #include <core/Object.h>
@@ -51,6 +52,7 @@ class DrumkitComponent;
 class PatternList;
 class AutomationPath;
 class Timeline;
+class PanLawTable;
 
 /**
 \ingroup H2CORE
@@ -130,7 +132,10 @@ class Song : public H2Core::Object<Song>, public std::enable_shared_from_this<So
 		static std::shared_ptr<Song> getEmptySong();
 
 	static std::shared_ptr<Song> 	load( const QString& sFilename, bool bSilent = false );
-	bool 			save( const QString& sFilename, bool bSilent = false );
+	/** \param bBinary Whether to write a BinaryDoc instead of an
+	 *   XML file. Both are accepted by load(). */
+	bool 			save( const QString& sFilename, bool bSilent = false,
+						  bool bBinary = false );
 
 	bool getIsTimelineActivated() const;
 	void setIsTimelineActivated( bool bIsTimelineActivated );
@@ -260,6 +265,21 @@ class Song : public H2Core::Object<Song>, public std::enable_shared_from_this<So
 		int getPanLawType() const;
 		void setPanLawKNorm( float fKNorm );
 		float getPanLawKNorm() const;
+		/**
+		 * \return Table of the current pan law.
+		 *
+		 * Lock-free and meant to be called by the audio thread once
+		 * per cycle. The table stays valid until the next call, even
+		 * if another thread changes the pan law meanwhile.
+		 *
+		 * There is only a single reader allowed, Sampler::process().
+		 * The table in use is announced in #m_pPanLawTableInUse,
+		 * which holds just one pointer. A second reader would
+		 * overwrite the announcement of the first one and its table
+		 * could be deleted while still being used. All other code
+		 * has to stick to getPanLawType() and getPanLawKNorm().
+		 */
+		const PanLawTable* getPanLawTable() const;
 
 		bool isPatternActive( int nColumn, int nRow ) const;
 
@@ -299,8 +319,17 @@ class Song : public H2Core::Object<Song>, public std::enable_shared_from_this<So
 	
 private:
 
-	static std::shared_ptr<Song> loadFrom( XMLNode* pNode, const QString& sFilename, bool bSilent = false );
-	void writeTo( XMLNode* pNode, bool bSilent = false );
+	/**
+	 * \param pPatternList Patterns already read from the
+	 *   "patternList" node in a streaming fashion (see
+	 *   PatternList::load_from( QXmlStreamReader&, ... )). Its notes
+	 *   are mapped to the instruments of the song and ownership is
+	 *   transferred. If nullptr, the patterns are read from @a pNode.
+	 */
+	static std::shared_ptr<Song> loadFrom( XMLNode* pNode, const QString& sFilename, bool bSilent = false,
+										   PatternList* pPatternList = nullptr );
+	/** \param bWriteNotes See Pattern::save_to() */
+	void writeTo( XMLNode* pNode, bool bSilent = false, bool bWriteNotes = true );
 
 	void loadVirtualPatternsFrom( XMLNode* pNode, bool bSilent = false );
 	void loadPatternGroupVectorFrom( XMLNode* pNode, bool bSilent = false );
@@ -405,6 +434,19 @@ private:
 		int m_nPanLawType;
 		// k such that L^k+R^k = 1. Used in constant k-Norm pan law
 		float m_fPanLawKNorm;
+		/** Rebuilt whenever #m_nPanLawType or #m_fPanLawKNorm
+		 * changes. */
+		std::atomic<const PanLawTable*> m_pPanLawTable;
+		/** Table last handed out by getPanLawTable(). It must not be
+		 * deleted. Since this is a single slot, there must not be
+		 * more than one reader of the tables. */
+		mutable std::atomic<const PanLawTable*> m_pPanLawTableInUse;
+		/** Former tables which might still be in use by the audio
+		 * thread. They are deleted by the thread changing the pan
+		 * law, never by the audio thread. */
+		std::vector<const PanLawTable*> m_retiredPanLawTables;
+		void updatePanLawTable();
+		void deleteRetiredPanLawTables();
 
 	void setTimeline( std::shared_ptr<Timeline> pTimeline );
 	std::shared_ptr<Timeline> m_pTimeline;
@@ -711,10 +753,6 @@ inline Song::ActionMode Song::getActionMode() const {
 	return m_actionMode;
 }
 
-inline void Song::setPanLawType( int nPanLawType ) {
-	m_nPanLawType = nPanLawType;
-}
-
 inline int Song::getPanLawType() const {
 	return m_nPanLawType;
 } 
@@ -723,6 +761,21 @@ inline float Song::getPanLawKNorm() const {
 	return m_fPanLawKNorm;
 }
 
+inline const PanLawTable* Song::getPanLawTable() const {
+	// The table is announced before checking it was not replaced in
+	// the meantime. Otherwise updatePanLawTable() could have already
+	// deleted it.
+	const PanLawTable* pTable = m_pPanLawTable.load();
+	const PanLawTable* pAnnounced;
+	do {
+		pAnnounced = pTable;
+		m_pPanLawTableInUse.store( pAnnounced );
+		pTable = m_pPanLawTable.load();
+	} while ( pTable != pAnnounced );
+
+	return pTable;
+}
+
 inline const QString& Song::getLastLoadedDrumkitName() const
 {
 	return m_sLastLoadedDrumkitName;
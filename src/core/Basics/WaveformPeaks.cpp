@@ -0,0 +1,147 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Basics/WaveformPeaks.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace H2Core
+{
+
+void WaveformPeaks::Range::merge( const Range& other ) {
+	if ( other.nFrames == 0 ) {
+		return;
+	}
+	if ( nFrames == 0 ) {
+		*this = other;
+		return;
+	}
+	fMin = std::min( fMin, other.fMin );
+	fMax = std::max( fMax, other.fMax );
+	fSumSquares += other.fSumSquares;
+	nFrames += other.nFrames;
+}
+
+void WaveformPeaks::Range::scan( const float* pData, int nStart, int nEnd ) {
+	if ( nEnd <= nStart ) {
+		return;
+	}
+	Range range;
+	range.fMin = pData[ nStart ];
+	range.fMax = pData[ nStart ];
+	range.nFrames = nEnd - nStart;
+	for ( int i = nStart; i < nEnd; ++i ) {
+		range.fMin = std::min( range.fMin, pData[ i ] );
+		range.fMax = std::max( range.fMax, pData[ i ] );
+		range.fSumSquares += pData[ i ] * pData[ i ];
+	}
+	merge( range );
+}
+
+float WaveformPeaks::Range::getRms() const {
+	if ( nFrames == 0 ) {
+		return 0;
+	}
+	return std::sqrt( fSumSquares / nFrames );
+}
+
+WaveformPeaks::WaveformPeaks( const float* pData_L, const float* pData_R, int nFrames )
+	: m_nFrames( std::max( nFrames, 0 ) )
+{
+	const int nBlocks = ( m_nFrames + nBlockSize - 1 ) / nBlockSize;
+	const float* data[ 2 ] = { pData_L, pData_R };
+
+	for ( int nChannel = 0; nChannel < 2; ++nChannel ) {
+		const float* pData = data[ nChannel ];
+		std::vector<MinMax> base( nBlocks );
+		auto& sumSquares = m_sumSquares[ nChannel ];
+		sumSquares.resize( nBlocks + 1 );
+		sumSquares[ 0 ] = 0;
+
+		for ( int nBlock = 0; nBlock < nBlocks; ++nBlock ) {
+			Range range;
+			range.scan( pData, nBlock * nBlockSize,
+						std::min( ( nBlock + 1 ) * nBlockSize, m_nFrames ) );
+			base[ nBlock ] = { range.fMin, range.fMax };
+			sumSquares[ nBlock + 1 ] = sumSquares[ nBlock ] + range.fSumSquares;
+		}
+
+		auto& levels = m_levels[ nChannel ];
+		levels.push_back( std::move( base ) );
+		while ( levels.back().size() > 1 ) {
+			const auto& below = levels.back();
+			std::vector<MinMax> level( ( below.size() + 1 ) / 2 );
+			for ( size_t i = 0; i < level.size(); ++i ) {
+				level[ i ] = below[ 2 * i ];
+				if ( 2 * i + 1 < below.size() ) {
+					level[ i ].fMin = std::min( level[ i ].fMin, below[ 2 * i + 1 ].fMin );
+					level[ i ].fMax = std::max( level[ i ].fMax, below[ 2 * i + 1 ].fMax );
+				}
+			}
+			levels.push_back( std::move( level ) );
+		}
+	}
+}
+
+WaveformPeaks::Range WaveformPeaks::query( int nChannel, int nStartBlock, int nEndBlock ) const {
+	Range range;
+	if ( nChannel < 0 || nChannel > 1 ) {
+		return range;
+	}
+	const auto& levels = m_levels[ nChannel ];
+	nStartBlock = std::max( nStartBlock, 0 );
+	nEndBlock = std::min( nEndBlock, getBlocks() );
+	if ( nStartBlock >= nEndBlock ) {
+		return range;
+	}
+
+	range.fMin = levels[ 0 ][ nStartBlock ].fMin;
+	range.fMax = levels[ 0 ][ nStartBlock ].fMax;
+	range.fSumSquares = m_sumSquares[ nChannel ][ nEndBlock ] -
+		m_sumSquares[ nChannel ][ nStartBlock ];
+	range.nFrames = std::min( nEndBlock * nBlockSize, m_nFrames ) -
+		nStartBlock * nBlockSize;
+
+	// Bottom-up traversal: an index which is not aligned to the next
+	// level is consumed at the current one.
+	int nLo = nStartBlock;
+	int nHi = nEndBlock;
+	for ( size_t nLevel = 0; nLo < nHi; ++nLevel ) {
+		const auto& level = levels[ nLevel ];
+		if ( nLo & 1 ) {
+			range.fMin = std::min( range.fMin, level[ nLo ].fMin );
+			range.fMax = std::max( range.fMax, level[ nLo ].fMax );
+			++nLo;
+		}
+		if ( nHi & 1 ) {
+			--nHi;
+			range.fMin = std::min( range.fMin, level[ nHi ].fMin );
+			range.fMax = std::max( range.fMax, level[ nHi ].fMax );
+		}
+		nLo >>= 1;
+		nHi >>= 1;
+	}
+
+	return range;
+}
+
+};
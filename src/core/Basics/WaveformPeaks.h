@@ -0,0 +1,111 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_WAVEFORM_PEAKS_H
+#define H2C_WAVEFORM_PEAKS_H
+
+#include <vector>
+
+namespace H2Core
+{
+
+/**
+ * Min/max pyramid of the data of a #Sample used to draw waveforms.
+ *
+ * The data of each channel is split into blocks of #nBlockSize
+ * frames. Level 0 holds the minimum and maximum of every block, each
+ * further level merges two neighbouring entries of the level below.
+ * The minimum and maximum of an arbitrary range of blocks is
+ * therefore assembled from at most two entries per level, no matter
+ * how long the range is. For the RMS the sums of squares are stored
+ * as prefix sums and a range costs two lookups.
+ *
+ * The pyramid only resolves whole blocks. Sample::getWaveformRange()
+ * adds the partial blocks at both ends of a range from the raw data.
+ *
+ * A pyramid is immutable. Sample creates a new one whenever its data
+ * changes.
+ */
+class WaveformPeaks
+{
+public:
+	/** Number of frames summarized by a single entry of level 0. */
+	static constexpr int nBlockSize = 64;
+
+	/** Amplitude statistics of a range of frames. */
+	struct Range {
+		float fMin = 0;
+		float fMax = 0;
+		/** Sum of the squared amplitudes. */
+		double fSumSquares = 0;
+		/** Number of frames contributing. */
+		int nFrames = 0;
+
+		/** Adds the statistics of @a other. */
+		void merge( const Range& other );
+		/** Adds the frames [@a nStart, @a nEnd) of @a pData. */
+		void scan( const float* pData, int nStart, int nEnd );
+		/** \return root mean square of the range. 0 if it is
+		 * empty. */
+		float getRms() const;
+	};
+
+	WaveformPeaks( const float* pData_L, const float* pData_R, int nFrames );
+
+	int getFrames() const {
+		return m_nFrames;
+	}
+	int getBlocks() const {
+		return static_cast<int>( m_levels[ 0 ][ 0 ].size() );
+	}
+	/** \return number of levels, including level 0. */
+	int getLevels() const {
+		return static_cast<int>( m_levels[ 0 ].size() );
+	}
+
+	/**
+	 * \param nChannel 0 for left, 1 for right
+	 * \param nStartBlock first block of the range
+	 * \param nEndBlock block after the last one of the range
+	 *
+	 * \return statistics of the blocks [@a nStartBlock, @a
+	 * nEndBlock). The range is clamped to the available blocks.
+	 */
+	Range query( int nChannel, int nStartBlock, int nEndBlock ) const;
+
+private:
+	struct MinMax {
+		float fMin;
+		float fMax;
+	};
+
+	int m_nFrames;
+	/** Per channel the levels of the pyramid. Each level holds half
+	 * as many entries (rounded up) as the one below. */
+	std::vector<std::vector<MinMax>> m_levels[ 2 ];
+	/** Per channel the sum of squares of all frames before the
+	 * start of each block. Has getBlocks() + 1 entries. */
+	std::vector<double> m_sumSquares[ 2 ];
+};
+
+};
+
+#endif // H2C_WAVEFORM_PEAKS_H
@@ -28,6 +28,7 @@
 
 #include <core/Object.h>
 #include <core/Basics/Song.h>
+#include <core/Helpers/Archive.h>
 
 namespace H2Core
 {
@@ -315,8 +316,11 @@ class CoreActionController : public H2Core::Object<CoreActionController> {
 	 * \param sTargetDir Folder to extract the drumkit to. If the
 	 * folder is not present yet, it will be created. If left empty,
 	 * the drumkit will be installed to the users drumkit data folder.
+	 * \param progress Reports the progress and allows to cancel the
+	 * extraction.
 	 */
-	bool extractDrumkit( const QString& sDrumkitPath, const QString& sTargetDir = "" );
+	bool extractDrumkit( const QString& sDrumkitPath, const QString& sTargetDir = "",
+						 Archive::ProgressCallback progress = nullptr );
 		/** Relocates transport to the beginning of a particular
 		 * column/Pattern group.
 		 * 
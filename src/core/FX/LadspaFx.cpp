@@ -26,6 +26,7 @@
 #include <core/Preferences/Preferences.h>
 #include <core/Hydrogen.h>
 #include <core/Basics/Song.h>
+#include <core/Helpers/AudioBufferArena.h>
 
 #include <QDir>
 
@@ -140,8 +141,8 @@ LadspaFX::LadspaFX( const QString& sLibraryPath, const QString& sPluginLabel )
 	INFOLOG( QString( "INIT - %1 - %2" ).arg( sLibraryPath ).arg( sPluginLabel ) );
 
 
-	m_pBuffer_L = new float[MAX_BUFFER_SIZE];
-	m_pBuffer_R = new float[MAX_BUFFER_SIZE];
+	m_pBuffer_L = AudioBufferArena::get_instance()->allocate( MAX_BUFFER_SIZE, 2 );
+	m_pBuffer_R = m_pBuffer_L + AudioBufferArena::stride( MAX_BUFFER_SIZE );
 
 
 	// Touch all the memory (is this really necessary?)
@@ -186,8 +187,7 @@ LadspaFX::~LadspaFX()
 		delete outputControlPorts[i];
 	}
 
-	delete[] m_pBuffer_L;
-	delete[] m_pBuffer_R;
+	AudioBufferArena::get_instance()->release( m_pBuffer_L );
 }
 
 
@@ -0,0 +1,757 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Helpers/Archive.h>
+#include <core/config.h>
+
+#ifdef H2CORE_HAVE_LIBARCHIVE
+
+#include <archive.h>
+#include <archive_entry.h>
+#ifdef H2CORE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace H2Core
+{
+
+namespace {
+
+/** Return type of the write callback. It differs between libarchive
+ * versions. */
+using ArchiveSize = decltype( std::declval<archive_write_callback*>()(
+								  nullptr, nullptr, nullptr, 0 ) );
+
+#if ARCHIVE_VERSION_NUMBER < 3000000
+using ArchiveOffset = off_t;
+#else
+using ArchiveOffset = int64_t;
+#endif
+
+void freeReadArchive( struct archive* pArchive )
+{
+	archive_read_close( pArchive );
+#if ARCHIVE_VERSION_NUMBER < 3000000
+	archive_read_finish( pArchive );
+#else
+	archive_read_free( pArchive );
+#endif
+}
+
+void freeWriteArchive( struct archive* pArchive )
+{
+	archive_write_close( pArchive );
+#if ARCHIVE_VERSION_NUMBER < 3000000
+	archive_write_finish( pArchive );
+#else
+	archive_write_free( pArchive );
+#endif
+}
+
+/** Number of bytes of the compressed archive consumed so far. */
+int64_t compressedBytesRead( struct archive* pArchive )
+{
+#if ARCHIVE_VERSION_NUMBER < 3000000
+	return archive_position_compressed( pArchive );
+#else
+	return archive_filter_bytes( pArchive, -1 );
+#endif
+}
+
+/** Forwards the progress to the user-provided callback whenever it
+ * advanced by at least one percent. */
+class Progress
+{
+public:
+	explicit Progress( Archive::ProgressCallback callback )
+		: m_callback( callback )
+		, m_nLastPercent( -1 ) {
+	}
+
+	/** \return false in case the operation was cancelled. */
+	bool update( int64_t nDone, int64_t nTotal ) {
+		if ( ! m_callback ) {
+			return true;
+		}
+		const int nPercent = nTotal > 0 ?
+			static_cast<int>( std::min( nDone, nTotal ) * 100 / nTotal ) : 100;
+		if ( nPercent == m_nLastPercent ) {
+			return true;
+		}
+		m_nLastPercent = nPercent;
+		return m_callback( nPercent / 100.0 );
+	}
+
+private:
+	Archive::ProgressCallback m_callback;
+	int m_nLastPercent;
+};
+
+/** Queue handing over items from one thread to another. Blocks the
+ * producer while full and the consumer while empty. */
+template <typename T>
+class BoundedQueue
+{
+public:
+	explicit BoundedQueue( size_t nCapacity )
+		: m_nCapacity( nCapacity )
+		, m_bClosed( false ) {
+	}
+
+	/** \return false if the queue was closed. */
+	bool push( T&& item ) {
+		std::unique_lock<std::mutex> lock( m_mutex );
+		m_notFull.wait( lock, [&]() {
+			return m_bClosed || m_queue.size() < m_nCapacity; } );
+		if ( m_bClosed ) {
+			return false;
+		}
+		m_queue.push_back( std::move( item ) );
+		m_notEmpty.notify_one();
+		return true;
+	}
+
+	/** \return false as soon as the queue is closed and empty. */
+	bool pop( T& item ) {
+		std::unique_lock<std::mutex> lock( m_mutex );
+		m_notEmpty.wait( lock, [&]() {
+			return m_bClosed || ! m_queue.empty(); } );
+		if ( m_queue.empty() ) {
+			return false;
+		}
+		item = std::move( m_queue.front() );
+		m_queue.pop_front();
+		m_notFull.notify_one();
+		return true;
+	}
+
+	/** Wakes up both sides. Items still queued can be popped. */
+	void close() {
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_bClosed = true;
+		m_notEmpty.notify_all();
+		m_notFull.notify_all();
+	}
+
+private:
+	const size_t m_nCapacity;
+	bool m_bClosed;
+	std::deque<T> m_queue;
+	std::mutex m_mutex;
+	std::condition_variable m_notEmpty;
+	std::condition_variable m_notFull;
+};
+
+/** Part of an archive entry to be written to disk. */
+struct Chunk {
+	/** Only set for the first chunk of an entry. */
+	QString sPath;
+	bool bDirectory = false;
+	qint64 nOffset = 0;
+	QByteArray data;
+};
+
+/** Writes the chunks of the extracted entries on a thread of its
+ * own. */
+class EntryWriter
+{
+public:
+	explicit EntryWriter( BoundedQueue<Chunk>* pQueue )
+		: m_pQueue( pQueue )
+		, m_bFailed( false ) {
+	}
+
+	void run() {
+		Chunk chunk;
+		while ( m_pQueue->pop( chunk ) ) {
+			if ( ! write( chunk ) ) {
+				m_bFailed = true;
+				// Stops the extraction.
+				m_pQueue->close();
+				break;
+			}
+		}
+		m_file.close();
+	}
+
+	bool failed() const {
+		return m_bFailed;
+	}
+
+	/** Removes all files and folders created so far. Must not be
+	 * called before the thread running run() was joined. */
+	void removeCreated() {
+		for ( const auto& sFile : m_createdFiles ) {
+			QFile::remove( sFile );
+		}
+		for ( auto it = m_createdDirs.rbegin(); it != m_createdDirs.rend(); ++it ) {
+			QDir().rmdir( *it );
+		}
+	}
+
+private:
+	bool write( const Chunk& chunk ) {
+		if ( ! chunk.sPath.isEmpty() ) {
+			m_file.close();
+			if ( chunk.bDirectory ) {
+				return makePath( chunk.sPath );
+			}
+			if ( ! makePath( QFileInfo( chunk.sPath ).absolutePath() ) ) {
+				return false;
+			}
+
+			m_file.setFileName( chunk.sPath );
+			const bool bExisted = m_file.exists();
+			if ( ! m_file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+				___ERRORLOG( QString( "Unable to open [%1] for writing" )
+							 .arg( chunk.sPath ) );
+				return false;
+			}
+			if ( ! bExisted ) {
+				m_createdFiles << chunk.sPath;
+			}
+		}
+
+		if ( chunk.data.isEmpty() ) {
+			return true;
+		}
+		if ( chunk.nOffset != m_file.pos() && ! m_file.seek( chunk.nOffset ) ) {
+			___ERRORLOG( QString( "Unable to seek to [%1] in [%2]" )
+						 .arg( chunk.nOffset ).arg( m_file.fileName() ) );
+			return false;
+		}
+		if ( m_file.write( chunk.data ) != chunk.data.size() ) {
+			___ERRORLOG( QString( "Unable to write to [%1]: %2" )
+						 .arg( m_file.fileName() ).arg( m_file.errorString() ) );
+			return false;
+		}
+		return true;
+	}
+
+	bool makePath( const QString& sPath ) {
+		QStringList missingDirs;
+		QString sDir = QDir::cleanPath( sPath );
+		while ( ! QFileInfo::exists( sDir ) ) {
+			missingDirs.prepend( sDir );
+			const QString sParent = QFileInfo( sDir ).path();
+			if ( sParent == sDir ) {
+				break;
+			}
+			sDir = sParent;
+		}
+
+		for ( const auto& sMissingDir : missingDirs ) {
+			if ( ! QDir().mkdir( sMissingDir ) ) {
+				___ERRORLOG( QString( "Unable to create folder [%1]" )
+							 .arg( sMissingDir ) );
+				return false;
+			}
+			m_createdDirs << sMissingDir;
+		}
+		return true;
+	}
+
+	BoundedQueue<Chunk>* m_pQueue;
+	bool m_bFailed;
+	QFile m_file;
+	QStringList m_createdFiles;
+	QStringList m_createdDirs;
+};
+
+#ifdef H2CORE_HAVE_ZLIB
+/**
+ * Compresses a stream in blocks of Archive::nBlockSize using several
+ * threads and writes the resulting gzip members in order.
+ */
+class ParallelGzip
+{
+public:
+	ParallelGzip( QFile* pFile, int nThreads )
+		: m_pFile( pFile )
+		, m_bStop( false ) {
+		if ( nThreads <= 0 ) {
+			nThreads = std::max( QThread::idealThreadCount(), 1 );
+		}
+		// Enough blocks to keep all threads busy while the oldest
+		// one is written.
+		m_nMaxPending = 2 * nThreads;
+		m_current.reserve( Archive::nBlockSize );
+		for ( int ii = 0; ii < nThreads; ++ii ) {
+			m_threads.emplace_back( &ParallelGzip::work, this );
+		}
+	}
+
+	~ParallelGzip() {
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_bStop = true;
+		}
+		m_cv.notify_all();
+		for ( auto& thread : m_threads ) {
+			thread.join();
+		}
+	}
+
+	bool write( const char* pData, size_t nSize ) {
+		while ( nSize > 0 ) {
+			const size_t nCopy = std::min(
+				nSize, static_cast<size_t>( Archive::nBlockSize - m_current.size() ) );
+			m_current.append( pData, static_cast<int>( nCopy ) );
+			pData += nCopy;
+			nSize -= nCopy;
+
+			if ( m_current.size() == Archive::nBlockSize ) {
+				submit();
+				if ( ! writeCompressed( m_nMaxPending ) ) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	/** Compresses and writes all remaining data. */
+	bool finish() {
+		if ( ! m_current.isEmpty() ) {
+			submit();
+		}
+		return writeCompressed( 0 );
+	}
+
+private:
+	struct Block {
+		QByteArray input;
+		/** Empty if compression failed. */
+		QByteArray output;
+		bool bDone = false;
+	};
+
+	void submit() {
+		auto pBlock = std::make_shared<Block>();
+		pBlock->input.swap( m_current );
+		m_current.reserve( Archive::nBlockSize );
+		{
+			std::lock_guard<std::mutex> lock( m_mutex );
+			m_jobs.push_back( pBlock );
+			m_pending.push_back( pBlock );
+		}
+		m_cv.notify_all();
+	}
+
+	/** Writes compressed blocks, in order, until no more than @a
+	 * nMaxPending are left. */
+	bool writeCompressed( size_t nMaxPending ) {
+		while ( true ) {
+			std::shared_ptr<Block> pBlock;
+			{
+				std::unique_lock<std::mutex> lock( m_mutex );
+				if ( m_pending.size() <= nMaxPending ) {
+					return true;
+				}
+				m_cv.wait( lock, [&]() { return m_pending.front()->bDone; } );
+				pBlock = m_pending.front();
+				m_pending.pop_front();
+			}
+
+			if ( pBlock->output.isEmpty() ) {
+				___ERRORLOG( "Unable to compress block" );
+				return false;
+			}
+			if ( m_pFile->write( pBlock->output ) != pBlock->output.size() ) {
+				___ERRORLOG( QString( "Unable to write to [%1]: %2" )
+							 .arg( m_pFile->fileName() )
+							 .arg( m_pFile->errorString() ) );
+				return false;
+			}
+		}
+	}
+
+	void work() {
+		while ( true ) {
+			std::shared_ptr<Block> pBlock;
+			{
+				std::unique_lock<std::mutex> lock( m_mutex );
+				m_cv.wait( lock, [&]() { return m_bStop || ! m_jobs.empty(); } );
+				if ( m_bStop ) {
+					return;
+				}
+				pBlock = m_jobs.front();
+				m_jobs.pop_front();
+			}
+
+			QByteArray output = compress( pBlock->input );
+			{
+				std::lock_guard<std::mutex> lock( m_mutex );
+				pBlock->input.clear();
+				pBlock->output.swap( output );
+				pBlock->bDone = true;
+			}
+			m_cv.notify_all();
+		}
+	}
+
+	/** \return @a input as a complete gzip member. */
+	static QByteArray compress( const QByteArray& input ) {
+		z_stream stream = {};
+		// 16 added to the window bits selects the gzip wrapper.
+		if ( deflateInit2( &stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+						   15 + 16, 8, Z_DEFAULT_STRATEGY ) != Z_OK ) {
+			return QByteArray();
+		}
+
+		QByteArray output( static_cast<int>( deflateBound( &stream, input.size() ) ),
+						   Qt::Uninitialized );
+		stream.next_in = reinterpret_cast<Bytef*>( const_cast<char*>( input.constData() ) );
+		stream.avail_in = input.size();
+		stream.next_out = reinterpret_cast<Bytef*>( output.data() );
+		stream.avail_out = output.size();
+
+		if ( deflate( &stream, Z_FINISH ) == Z_STREAM_END ) {
+			output.resize( static_cast<int>( stream.total_out ) );
+		} else {
+			output.clear();
+		}
+		deflateEnd( &stream );
+
+		return output;
+	}
+
+	QFile* m_pFile;
+	QByteArray m_current;
+	size_t m_nMaxPending;
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_bStop;
+	/** Blocks not compressed yet. */
+	std::deque<std::shared_ptr<Block>> m_jobs;
+	/** Blocks not written yet, in order. */
+	std::deque<std::shared_ptr<Block>> m_pending;
+};
+
+ArchiveSize writeToGzip( struct archive*, void* pClientData,
+						 const void* pBuffer, size_t nSize )
+{
+	auto pGzip = static_cast<ParallelGzip*>( pClientData );
+	if ( ! pGzip->write( static_cast<const char*>( pBuffer ), nSize ) ) {
+		return -1;
+	}
+	return nSize;
+}
+#else
+ArchiveSize writeToFile( struct archive*, void* pClientData,
+						 const void* pBuffer, size_t nSize )
+{
+	auto pFile = static_cast<QFile*>( pClientData );
+	return pFile->write( static_cast<const char*>( pBuffer ), nSize );
+}
+#endif
+
+};
+
+bool Archive::extract( const QString& sArchivePath, const QString& sTargetDir,
+					   ProgressCallback progressCallback, EntryFilter filter )
+{
+	struct archive* pArchive = archive_read_new();
+
+#if ARCHIVE_VERSION_NUMBER < 3000000
+	archive_read_support_compression_all( pArchive );
+#else
+	archive_read_support_filter_all( pArchive );
+#endif
+
+	archive_read_support_format_all( pArchive );
+
+#if ARCHIVE_VERSION_NUMBER < 3000000
+	if ( archive_read_open_file( pArchive, sArchivePath.toLocal8Bit(), 10240 ) ) {
+#else
+	if ( archive_read_open_filename( pArchive, sArchivePath.toLocal8Bit(), 10240 ) ) {
+#endif
+		_ERRORLOG( QString( "archive_read_open_file() [%1] %2" )
+				   .arg( archive_errno( pArchive ) )
+				   .arg( archive_error_string( pArchive ) ) );
+		freeReadArchive( pArchive );
+		return false;
+	}
+
+	const int64_t nArchiveSize = QFileInfo( sArchivePath ).size();
+	Progress progress( progressCallback );
+	const QDir targetDir( sTargetDir );
+
+	// Decompression happens on this thread. Writing to disk on the
+	// one of the writer.
+	BoundedQueue<Chunk> queue( 16 );
+	EntryWriter writer( &queue );
+	std::thread writerThread( &EntryWriter::run, &writer );
+
+	bool bSuccess = true;
+	bool bCancelled = false;
+	struct archive_entry* pEntry;
+	int nResult;
+	while ( bSuccess &&
+			( nResult = archive_read_next_header( pArchive, &pEntry ) ) != ARCHIVE_EOF ) {
+		if ( nResult == ARCHIVE_WARN ) {
+			_WARNINGLOG( QString( "archive_read_next_header() [%1] %2" )
+						 .arg( archive_errno( pArchive ) )
+						 .arg( archive_error_string( pArchive ) ) );
+		}
+		else if ( nResult != ARCHIVE_OK ) {
+			_ERRORLOG( QString( "archive_read_next_header() [%1] %2" )
+					   .arg( archive_errno( pArchive ) )
+					   .arg( archive_error_string( pArchive ) ) );
+			bSuccess = false;
+			break;
+		}
+
+		const char* sEntryPathName = archive_entry_pathname( pEntry );
+		const QString sEntryPath = QDir::cleanPath(
+			QString::fromUtf8( sEntryPathName != nullptr ? sEntryPathName : "" ) );
+		if ( sEntryPath.isEmpty() || sEntryPath == "." ) {
+			continue;
+		}
+		if ( QDir::isAbsolutePath( sEntryPath ) || sEntryPath == ".." ||
+			 sEntryPath.startsWith( "../" ) ) {
+			_ERRORLOG( QString( "Entry [%1] of [%2] points outside of the target folder" )
+					   .arg( sEntryPath ).arg( sArchivePath ) );
+			bSuccess = false;
+			break;
+		}
+		if ( filter && ! filter( sEntryPath ) ) {
+			continue;
+		}
+
+		Chunk chunk;
+		chunk.sPath = targetDir.filePath( sEntryPath );
+
+		const auto fileType = archive_entry_filetype( pEntry );
+		if ( fileType == AE_IFDIR ) {
+			chunk.bDirectory = true;
+			bSuccess = queue.push( std::move( chunk ) );
+			continue;
+		}
+		else if ( fileType != AE_IFREG ) {
+			_WARNINGLOG( QString( "Skipping entry [%1] of [%2]. Only regular files and folders are supported" )
+						 .arg( sEntryPath ).arg( sArchivePath ) );
+			continue;
+		}
+
+		const void* pBuffer;
+		size_t nSize;
+		ArchiveOffset nOffset;
+		while ( ( nResult = archive_read_data_block( pArchive, &pBuffer, &nSize,
+													 &nOffset ) ) == ARCHIVE_OK ) {
+			// Collect the blocks of the decompressor into larger
+			// chunks to keep the overhead of the queue low.
+			if ( nOffset != chunk.nOffset + chunk.data.size() ||
+				 chunk.data.size() >= Archive::nBlockSize ) {
+				if ( ! queue.push( std::move( chunk ) ) ) {
+					bSuccess = false;
+					break;
+				}
+				chunk = Chunk();
+				chunk.nOffset = nOffset;
+			}
+			chunk.data.append( static_cast<const char*>( pBuffer ),
+							   static_cast<int>( nSize ) );
+
+			if ( ! progress.update( compressedBytesRead( pArchive ), nArchiveSize ) ) {
+				bCancelled = true;
+				bSuccess = false;
+				break;
+			}
+		}
+		if ( ! bSuccess ) {
+			break;
+		}
+		if ( nResult != ARCHIVE_EOF ) {
+			_ERRORLOG( QString( "archive_read_data_block() [%1] %2" )
+					   .arg( archive_errno( pArchive ) )
+					   .arg( archive_error_string( pArchive ) ) );
+			bSuccess = false;
+			break;
+		}
+
+		if ( ! chunk.sPath.isEmpty() || ! chunk.data.isEmpty() ) {
+			bSuccess = queue.push( std::move( chunk ) );
+		}
+	}
+	freeReadArchive( pArchive );
+
+	queue.close();
+	writerThread.join();
+
+	if ( writer.failed() ) {
+		bSuccess = false;
+	}
+	if ( ! bSuccess ) {
+		if ( bCancelled ) {
+			_INFOLOG( QString( "Extraction of [%1] cancelled" ).arg( sArchivePath ) );
+		}
+		writer.removeCreated();
+		return false;
+	}
+
+	progress.update( nArchiveSize, nArchiveSize );
+
+	return true;
+}
+
+bool Archive::create( const QString& sArchivePath, const std::vector<Entry>& entries,
+					  ProgressCallback progressCallback, int nThreads )
+{
+	int64_t nTotalSize = 0;
+	for ( const auto& entry : entries ) {
+		nTotalSize += QFileInfo( entry.sFilePath ).size();
+	}
+
+	QFile file( sArchivePath );
+	if ( ! file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+		_ERRORLOG( QString( "Couldn't create archive [%1]" ).arg( sArchivePath ) );
+		return false;
+	}
+
+	struct archive* pArchive = archive_write_new();
+	archive_write_set_format_pax_restricted( pArchive );
+
+#ifdef H2CORE_HAVE_ZLIB
+	// The tar stream is handed over uncompressed and compressed by
+	// several threads.
+	ParallelGzip gzip( &file, nThreads );
+	archive_write_set_bytes_in_last_block( pArchive, 1 );
+	int nResult = archive_write_open( pArchive, &gzip, nullptr, writeToGzip, nullptr );
+#else
+	Q_UNUSED( nThreads );
+#if ARCHIVE_VERSION_NUMBER < 3000000
+	archive_write_set_compression_gzip( pArchive );
+#else
+	archive_write_add_filter_gzip( pArchive );
+#endif
+	int nResult = archive_write_open( pArchive, &file, nullptr, writeToFile, nullptr );
+#endif
+	if ( nResult != ARCHIVE_OK ) {
+		_ERRORLOG( QString( "Couldn't create archive [%1]: %2" )
+				   .arg( sArchivePath ).arg( archive_error_string( pArchive ) ) );
+		freeWriteArchive( pArchive );
+		file.remove();
+		return false;
+	}
+
+	Progress progress( progressCallback );
+	std::vector<char> buffer( 64 * 1024 );
+	int64_t nBytesDone = 0;
+	bool bSuccess = true;
+	bool bCancelled = false;
+	for ( const auto& entry : entries ) {
+		QFile input( entry.sFilePath );
+		if ( ! input.open( QIODevice::ReadOnly ) ) {
+			_ERRORLOG( QString( "Unable to open [%1] for reading" )
+					   .arg( entry.sFilePath ) );
+			bSuccess = false;
+			break;
+		}
+
+		struct archive_entry* pEntry = archive_entry_new();
+		archive_entry_set_pathname( pEntry, entry.sArchivePath.toUtf8().constData() );
+		archive_entry_set_size( pEntry, input.size() );
+		archive_entry_set_filetype( pEntry, AE_IFREG );
+		archive_entry_set_perm( pEntry, 0644 );
+		nResult = archive_write_header( pArchive, pEntry );
+		archive_entry_free( pEntry );
+		if ( nResult != ARCHIVE_OK ) {
+			_ERRORLOG( QString( "archive_write_header() [%1]: %2" )
+					   .arg( entry.sArchivePath )
+					   .arg( archive_error_string( pArchive ) ) );
+			bSuccess = false;
+			break;
+		}
+
+		qint64 nRead;
+		while ( ( nRead = input.read( buffer.data(), buffer.size() ) ) > 0 ) {
+			if ( archive_write_data( pArchive, buffer.data(), nRead ) != nRead ) {
+				_ERRORLOG( QString( "archive_write_data() [%1]: %2" )
+						   .arg( entry.sArchivePath )
+						   .arg( archive_error_string( pArchive ) ) );
+				bSuccess = false;
+				break;
+			}
+			nBytesDone += nRead;
+
+			if ( ! progress.update( nBytesDone, nTotalSize ) ) {
+				bCancelled = true;
+				bSuccess = false;
+				break;
+			}
+		}
+		if ( nRead < 0 ) {
+			_ERRORLOG( QString( "Unable to read [%1]: %2" )
+					   .arg( entry.sFilePath ).arg( input.errorString() ) );
+			bSuccess = false;
+		}
+		if ( ! bSuccess ) {
+			break;
+		}
+	}
+
+	if ( bSuccess && archive_write_close( pArchive ) != ARCHIVE_OK ) {
+		_ERRORLOG( QString( "archive_write_close() [%1]: %2" )
+				   .arg( sArchivePath ).arg( archive_error_string( pArchive ) ) );
+		bSuccess = false;
+	}
+	freeWriteArchive( pArchive );
+
+#ifdef H2CORE_HAVE_ZLIB
+	if ( bSuccess ) {
+		bSuccess = gzip.finish();
+	}
+#endif
+	file.close();
+
+	if ( ! bSuccess ) {
+		if ( bCancelled ) {
+			_INFOLOG( QString( "Creation of [%1] cancelled" ).arg( sArchivePath ) );
+		}
+		file.remove();
+		return false;
+	}
+
+	progress.update( nTotalSize, nTotalSize );
+
+	return true;
+}
+
+};
+
+#endif // H2CORE_HAVE_LIBARCHIVE
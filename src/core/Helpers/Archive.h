@@ -0,0 +1,112 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_ARCHIVE_H
+#define H2C_ARCHIVE_H
+
+#include <core/Object.h>
+
+#include <QtCore/QString>
+
+#include <functional>
+#include <vector>
+
+namespace H2Core
+{
+
+/**
+ * Streaming creation and extraction of the gzip-compressed tar
+ * archives used for .h2drumkit files.
+ *
+ * Both directions are pipelined so that drumkits of several GB do
+ * not keep the calling thread busy for longer than necessary:
+ * - extract() decompresses on the calling thread while a second one
+ *   writes the entries to disk.
+ * - create() reads the files on the calling thread and compresses
+ *   the resulting tar stream in blocks of #nBlockSize using several
+ *   threads. Each block becomes a gzip member of its own. The
+ *   concatenation of those is a valid gzip file all versions of
+ *   Hydrogen (libarchive and zlib/libtar alike) are able to read.
+ *   Without zlib the stream is compressed on the calling thread
+ *   using libarchive.
+ *
+ * Only available if Hydrogen was built with libarchive support.
+ */
+/** \ingroup docCore*/
+class Archive : public H2Core::Object<Archive>
+{
+		H2_OBJECT(Archive)
+	public:
+		/**
+		 * Called regularly with the fraction, [0,1], of the work
+		 * done so far.
+		 *
+		 * \return false to cancel the operation.
+		 */
+		typedef std::function<bool(float)> ProgressCallback;
+
+		/** Decides whether the entry at the provided path, relative
+		 * to the root of the archive, should be extracted. */
+		typedef std::function<bool(const QString&)> EntryFilter;
+
+		/** Uncompressed size of the blocks compressed in parallel by
+		 * create(). */
+		static constexpr int nBlockSize = 1024 * 1024;
+
+		struct Entry {
+			/** Absolute path of the file to add. */
+			QString sFilePath;
+			/** Path of the file within the archive. */
+			QString sArchivePath;
+		};
+
+		/**
+		 * Extracts all entries of the archive @a sArchivePath into
+		 * the folder @a sTargetDir.
+		 *
+		 * Entries pointing outside of @a sTargetDir are rejected. In
+		 * case of an error or cancellation all files created so far
+		 * are removed again.
+		 *
+		 * \param filter If set, only entries it accepts are
+		 *   written. The others are still decompressed but skipped.
+		 */
+		static bool extract( const QString& sArchivePath, const QString& sTargetDir,
+							 ProgressCallback progress = nullptr,
+							 EntryFilter filter = nullptr );
+
+		/**
+		 * Writes all @a entries into a new archive @a sArchivePath.
+		 *
+		 * \param nThreads Number of threads used for compression. If
+		 *   0, QThread::idealThreadCount() is used.
+		 *
+		 * In case of an error or cancellation @a sArchivePath is
+		 * removed.
+		 */
+		static bool create( const QString& sArchivePath,
+							const std::vector<Entry>& entries,
+							ProgressCallback progress = nullptr, int nThreads = 0 );
+};
+
+};
+
+#endif // H2C_ARCHIVE_H
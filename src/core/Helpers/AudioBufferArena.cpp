@@ -0,0 +1,138 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Helpers/AudioBufferArena.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <new>
+
+namespace H2Core
+{
+
+AudioBufferArena* AudioBufferArena::get_instance()
+{
+	// Never destroyed. Buffers might still be released by objects
+	// torn down during static destruction.
+	static AudioBufferArena* pInstance = new AudioBufferArena;
+	return pInstance;
+}
+
+float* AudioBufferArena::allocate( size_t nFrames, int nChannels )
+{
+	const size_t nSize = std::max<size_t>( 1, nChannels * stride( nFrames ) ) *
+		sizeof( float );
+
+	std::lock_guard<std::mutex> lock( m_mutex );
+
+	// First fit.
+	size_t nSlab = 0;
+	char* pData = nullptr;
+	for ( ; nSlab < m_slabs.size(); ++nSlab ) {
+		auto& freeRanges = m_slabs[ nSlab ].freeRanges;
+		auto it = std::find_if( freeRanges.begin(), freeRanges.end(),
+								[&]( const auto& range ) { return range.second >= nSize; } );
+		if ( it != freeRanges.end() ) {
+			const size_t nOffset = it->first;
+			const size_t nRemaining = it->second - nSize;
+			freeRanges.erase( it );
+			if ( nRemaining > 0 ) {
+				freeRanges[ nOffset + nSize ] = nRemaining;
+			}
+			pData = m_slabs[ nSlab ].pData + nOffset;
+			break;
+		}
+	}
+
+	if ( pData == nullptr ) {
+		Slab slab;
+		slab.nSize = std::max( nSize, nSlabSize );
+		slab.pData = static_cast<char*>(
+			::operator new( slab.nSize, std::align_val_t( nAlignment ) ) );
+		if ( slab.nSize > nSize ) {
+			slab.freeRanges[ nSize ] = slab.nSize - nSize;
+		}
+		pData = slab.pData;
+		nSlab = m_slabs.size();
+		m_slabs.push_back( std::move( slab ) );
+	}
+
+	std::memset( pData, 0, nSize );
+
+	float* pBuffer = reinterpret_cast<float*>( pData );
+	m_allocations[ pBuffer ] = { nSlab, nSize };
+	m_nAllocatedBytes += nSize;
+
+	return pBuffer;
+}
+
+void AudioBufferArena::release( float* pBuffer )
+{
+	if ( pBuffer == nullptr ) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock( m_mutex );
+
+	auto allocationIt = m_allocations.find( pBuffer );
+	if ( allocationIt == m_allocations.end() ) {
+		assert( false );
+		return;
+	}
+	const Allocation allocation = allocationIt->second;
+	m_allocations.erase( allocationIt );
+	m_nAllocatedBytes -= allocation.nSize;
+
+	auto& slab = m_slabs[ allocation.nSlab ];
+	size_t nOffset = reinterpret_cast<char*>( pBuffer ) - slab.pData;
+	size_t nSize = allocation.nSize;
+
+	// Merge with the adjacent free ranges.
+	auto nextIt = slab.freeRanges.lower_bound( nOffset );
+	if ( nextIt != slab.freeRanges.end() && nextIt->first == nOffset + nSize ) {
+		nSize += nextIt->second;
+		nextIt = slab.freeRanges.erase( nextIt );
+	}
+	if ( nextIt != slab.freeRanges.begin() ) {
+		auto prevIt = std::prev( nextIt );
+		if ( prevIt->first + prevIt->second == nOffset ) {
+			nOffset = prevIt->first;
+			nSize += prevIt->second;
+			slab.freeRanges.erase( prevIt );
+		}
+	}
+	slab.freeRanges[ nOffset ] = nSize;
+}
+
+size_t AudioBufferArena::getAllocatedBytes() const
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	return m_nAllocatedBytes;
+}
+
+size_t AudioBufferArena::getSlabCount() const
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	return m_slabs.size();
+}
+
+};
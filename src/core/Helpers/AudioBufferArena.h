@@ -0,0 +1,134 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_AUDIO_BUFFER_ARENA_H
+#define H2C_AUDIO_BUFFER_ARENA_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace H2Core
+{
+
+/**
+ * Allocator of the audio buffers used during the process cycle.
+ *
+ * The output buffers of the audio drivers, the #Sampler, the
+ * #Synth, the DrumkitComponents, and the LADSPA effects are all
+ * taken from large, #nAlignment aligned slabs. Channels are padded
+ * to a multiple of #nAlignment bytes, so every channel of a buffer
+ * starts at an aligned address as well and vectorized loops can use
+ * aligned loads and stores (see assumeAligned()). Buffers allocated
+ * one after another are adjacent in memory instead of being
+ * scattered across the heap.
+ *
+ * Released buffers are returned to the slab they were taken from
+ * and merged with adjacent free ranges. Slabs themselves are kept
+ * till the application exits.
+ *
+ * Allocating and releasing buffers locks a mutex and must not be
+ * done within the realtime thread.
+ */
+class AudioBufferArena
+{
+public:
+	/** Alignment in bytes of all buffers and channels. Matches the
+	 * size of a cache line and of an AVX-512 register. */
+	static constexpr size_t nAlignment = 64;
+	/** Size in bytes of a single slab. Larger buffers get a slab of
+	 * their own. */
+	static constexpr size_t nSlabSize = 1 << 20;
+
+	static AudioBufferArena* get_instance();
+
+	/** \return Distance in floats between the beginnings of two
+	 * consecutive channels of @a nFrames frames. */
+	static constexpr size_t stride( size_t nFrames ) {
+		return ( nFrames * sizeof( float ) + nAlignment - 1 ) /
+			nAlignment * nAlignment / sizeof( float );
+	}
+
+	/**
+	 * Allocates @a nChannels channels of @a nFrames frames each.
+	 *
+	 * The channels are contiguous and zero-initialized. Channel @a
+	 * i begins at the returned address plus `i * stride( nFrames )`.
+	 *
+	 * \return Beginning of the first channel. Has to be handed back
+	 *   using release().
+	 */
+	float* allocate( size_t nFrames, int nChannels = 1 );
+	/** Returns a buffer obtained by allocate(). nullptr is ignored. */
+	void release( float* pBuffer );
+
+	/** \return Number of bytes currently handed out. */
+	size_t getAllocatedBytes() const;
+	/** \return Number of slabs the buffers are taken from. */
+	size_t getSlabCount() const;
+
+	static bool isAligned( const void* p ) {
+		return reinterpret_cast<uintptr_t>( p ) % nAlignment == 0;
+	}
+
+	/** Tells the compiler @a p is aligned to #nAlignment bytes in
+	 * case @a bAligned is true. */
+	template <bool bAligned = true, typename T>
+	static T* assumeAligned( T* p ) {
+		if constexpr ( bAligned ) {
+			assert( isAligned( p ) );
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<T*>( __builtin_assume_aligned( p, nAlignment ) );
+#endif
+		}
+		return p;
+	}
+
+private:
+	AudioBufferArena() = default;
+	~AudioBufferArena() = default;
+	AudioBufferArena( const AudioBufferArena& ) = delete;
+	AudioBufferArena& operator=( const AudioBufferArena& ) = delete;
+
+	struct Slab {
+		char* pData;
+		size_t nSize;
+		/** Offset and size in bytes of all free ranges. */
+		std::map<size_t, size_t> freeRanges;
+	};
+
+	struct Allocation {
+		size_t nSlab;
+		size_t nSize;
+	};
+
+	mutable std::mutex m_mutex;
+	std::vector<Slab> m_slabs;
+	std::map<const float*, Allocation> m_allocations;
+	size_t m_nAllocatedBytes = 0;
+};
+
+};
+
+#endif // H2C_AUDIO_BUFFER_ARENA_H
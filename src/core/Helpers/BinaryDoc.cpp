@@ -0,0 +1,388 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Helpers/BinaryDoc.h>
+
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentList.h>
+#include <core/Basics/Note.h>
+#include <core/Basics/Pattern.h>
+
+#include <QtCore/QFile>
+
+#include <algorithm>
+#include <cstring>
+
+namespace H2Core
+{
+
+static const char magic[ 8 ] = { 'H', '2', 'B', 'I', 'N', 'D', 'O', 'C' };
+static const uint32_t nByteOrderMark = 0x01020304;
+
+static uint64_t align( uint64_t nOffset ) {
+	return ( nOffset + 7 ) & ~static_cast<uint64_t>( 7 );
+}
+
+BinaryDoc::BinaryDoc()
+	: m_pPatterns( nullptr )
+	, m_nPatterns( 0 )
+	, m_pNotes( nullptr )
+	, m_nNotes( 0 )
+{
+}
+
+BinaryDoc::~BinaryDoc()
+{
+	// Unmaps the file as well.
+	m_pFile.reset();
+}
+
+bool BinaryDoc::isBinary( const QString& sPath )
+{
+	QFile file( sPath );
+	if ( ! file.open( QIODevice::ReadOnly ) ) {
+		return false;
+	}
+	char buffer[ sizeof( magic ) ];
+	return file.read( buffer, sizeof( buffer ) ) == static_cast<qint64>( sizeof( buffer ) ) &&
+		std::memcmp( buffer, magic, sizeof( magic ) ) == 0;
+}
+
+XMLDoc* BinaryDoc::getDocument()
+{
+	return &m_doc;
+}
+
+BinaryDoc::NoteRecord BinaryDoc::toRecord( Note* pNote )
+{
+	NoteRecord record;
+	std::memset( &record, 0, sizeof( record ) );
+	record.nPosition = pNote->get_position();
+	record.nLength = pNote->get_length();
+	// Same as in Note::save_to().
+	record.nInstrumentId = pNote->get_instrument() != nullptr ?
+		pNote->get_instrument()->get_id() : pNote->get_instrument_id();
+	record.fVelocity = pNote->get_velocity();
+	record.fPan = pNote->getPan();
+	record.fPitch = pNote->get_pitch();
+	record.fLeadLag = pNote->get_lead_lag();
+	record.fProbability = pNote->get_probability();
+	record.nKey = static_cast<int8_t>( pNote->get_key() );
+	record.nOctave = static_cast<int8_t>( pNote->get_octave() );
+	record.bNoteOff = pNote->get_note_off() ? 1 : 0;
+	return record;
+}
+
+Note* BinaryDoc::toNote( const NoteRecord& record )
+{
+	Note* pNote = new Note( nullptr, record.nPosition, record.fVelocity,
+							record.fPan, record.nLength, record.fPitch );
+	pNote->set_lead_lag( record.fLeadLag );
+	pNote->set_key_octave( static_cast<Note::Key>( record.nKey ),
+						   static_cast<Note::Octave>( record.nOctave ) );
+	pNote->set_note_off( record.bNoteOff != 0 );
+	pNote->set_instrument_id( record.nInstrumentId );
+	pNote->set_probability( record.fProbability );
+	return pNote;
+}
+
+std::vector<XMLNode> BinaryDoc::getPatternNodes()
+{
+	std::vector<XMLNode> nodes;
+	QDomElement parent = m_doc.firstChildElement( "song" ).firstChildElement( "patternList" );
+	if ( parent.isNull() ) {
+		parent = m_doc.firstChildElement( "drumkit_pattern" );
+	}
+	for ( QDomElement node = parent.firstChildElement( "pattern" ); ! node.isNull();
+		  node = node.nextSiblingElement( "pattern" ) ) {
+		nodes.push_back( node );
+	}
+	return nodes;
+}
+
+void BinaryDoc::addPattern( const Pattern* pPattern )
+{
+	PatternRecord pattern;
+	pattern.nFirstNote = m_notes.size();
+	FOREACH_NOTE_CST_IT_BEGIN_END( pPattern->get_notes(), it ) {
+		if ( it->second != nullptr ) {
+			m_notes.push_back( toRecord( it->second ) );
+		}
+	}
+	pattern.nNotes = m_notes.size() - pattern.nFirstNote;
+	m_patterns.push_back( pattern );
+}
+
+void BinaryDoc::extractNotes()
+{
+	for ( auto& patternNode : getPatternNodes() ) {
+		PatternRecord pattern;
+		pattern.nFirstNote = m_notes.size();
+
+		QDomElement noteListNode = patternNode.firstChildElement( "noteList" );
+		for ( QDomElement node = noteListNode.firstChildElement( "note" ); ! node.isNull();
+			  node = node.nextSiblingElement( "note" ) ) {
+			XMLNode noteNode( node );
+			Note* pNote = Note::load_from( &noteNode, nullptr, true );
+			m_notes.push_back( toRecord( pNote ) );
+			delete pNote;
+		}
+		// Pattern::insert_note() orders the notes by position (and
+		// keeps the order of notes sharing one).
+		std::stable_sort( m_notes.begin() + pattern.nFirstNote, m_notes.end(),
+						  []( const NoteRecord& a, const NoteRecord& b ) {
+							  return a.nPosition < b.nPosition; } );
+		pattern.nNotes = m_notes.size() - pattern.nFirstNote;
+		m_patterns.push_back( pattern );
+
+		if ( ! noteListNode.isNull() ) {
+			patternNode.removeChild( noteListNode );
+		}
+	}
+}
+
+bool BinaryDoc::write( const QString& sPath )
+{
+	const QByteArray xml = m_doc.toString().toUtf8();
+
+	const int nSections = 3;
+	const char* sectionData[ nSections ] = {
+		xml.constData(),
+		reinterpret_cast<const char*>( m_patterns.data() ),
+		reinterpret_cast<const char*>( m_notes.data() ) };
+	Section sections[ nSections ] = {
+		{ XmlSection, 0, 0, static_cast<uint64_t>( xml.size() ) },
+		{ PatternSection, 0, 0, m_patterns.size() * sizeof( PatternRecord ) },
+		{ NoteSection, 0, 0, m_notes.size() * sizeof( NoteRecord ) } };
+
+	uint64_t nOffset = align( sizeof( Header ) + sizeof( sections ) );
+	for ( auto& section : sections ) {
+		section.nOffset = nOffset;
+		nOffset = align( nOffset + section.nSize );
+	}
+
+	Header header;
+	std::memcpy( header.magic, magic, sizeof( magic ) );
+	header.nByteOrder = nByteOrderMark;
+	header.nVersion = nVersion;
+	header.nSections = nSections;
+	header.nReserved = 0;
+
+	QFile file( sPath );
+	if ( ! file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+		ERRORLOG( QString( "Unable to open %1 for writing" ).arg( sPath ) );
+		return false;
+	}
+
+	auto writeData = [&]( const char* pData, qint64 nSize ) {
+		return nSize == 0 || file.write( pData, nSize ) == nSize;
+	};
+	const char padding[ 8 ] = { 0 };
+
+	bool bSuccess = writeData( reinterpret_cast<const char*>( &header ), sizeof( header ) ) &&
+		writeData( reinterpret_cast<const char*>( sections ), sizeof( sections ) );
+	for ( int ii = 0; ii < nSections && bSuccess; ++ii ) {
+		bSuccess = writeData( padding, sections[ ii ].nOffset - file.pos() ) &&
+			writeData( sectionData[ ii ], sections[ ii ].nSize );
+	}
+	file.close();
+
+	if ( ! bSuccess ) {
+		ERRORLOG( QString( "Error writing binary document [%1]: %2" )
+				  .arg( sPath ).arg( file.errorString() ) );
+	}
+	return bSuccess;
+}
+
+bool BinaryDoc::read( const QString& sPath )
+{
+	m_pFile = std::make_unique<QFile>( sPath );
+	if ( ! m_pFile->open( QIODevice::ReadOnly ) ) {
+		ERRORLOG( QString( "Unable to open [%1] for reading" ).arg( sPath ) );
+		return false;
+	}
+
+	const uint64_t nFileSize = m_pFile->size();
+	const uchar* pData = m_pFile->map( 0, nFileSize );
+	if ( pData == nullptr ) {
+		// Not every file system supports memory mapping.
+		m_buffer = m_pFile->readAll();
+		pData = reinterpret_cast<const uchar*>( m_buffer.constData() );
+	}
+
+	Header header;
+	if ( nFileSize < sizeof( header ) ) {
+		ERRORLOG( QString( "[%1] is too small to be a binary document" ).arg( sPath ) );
+		return false;
+	}
+	std::memcpy( &header, pData, sizeof( header ) );
+	if ( std::memcmp( header.magic, magic, sizeof( magic ) ) != 0 ) {
+		ERRORLOG( QString( "[%1] is not a binary document" ).arg( sPath ) );
+		return false;
+	}
+	if ( header.nByteOrder != nByteOrderMark ) {
+		ERRORLOG( QString( "Binary document [%1] was written using a different byte order" )
+				  .arg( sPath ) );
+		return false;
+	}
+	if ( header.nVersion > nVersion ) {
+		ERRORLOG( QString( "Binary document [%1] is of version [%2]. Only versions up to [%3] are supported" )
+				  .arg( sPath ).arg( header.nVersion ).arg( nVersion ) );
+		return false;
+	}
+	if ( ( nFileSize - sizeof( header ) ) / sizeof( Section ) < header.nSections ) {
+		ERRORLOG( QString( "Section table of binary document [%1] is truncated" )
+				  .arg( sPath ) );
+		return false;
+	}
+
+	const char* pXml = nullptr;
+	uint64_t nXmlSize = 0;
+	for ( uint32_t ii = 0; ii < header.nSections; ++ii ) {
+		Section section;
+		std::memcpy( &section, pData + sizeof( header ) + ii * sizeof( Section ),
+					 sizeof( section ) );
+		if ( section.nOffset > nFileSize || nFileSize - section.nOffset < section.nSize ||
+			 section.nOffset % 8 != 0 ) {
+			ERRORLOG( QString( "Section [%1] of binary document [%2] is out of bounds" )
+					  .arg( ii ).arg( sPath ) );
+			return false;
+		}
+
+		const uchar* pSection = pData + section.nOffset;
+		switch ( section.nId ) {
+		case XmlSection:
+			pXml = reinterpret_cast<const char*>( pSection );
+			nXmlSize = section.nSize;
+			break;
+		case PatternSection:
+			m_pPatterns = reinterpret_cast<const PatternRecord*>( pSection );
+			m_nPatterns = section.nSize / sizeof( PatternRecord );
+			break;
+		case NoteSection:
+			m_pNotes = reinterpret_cast<const NoteRecord*>( pSection );
+			m_nNotes = section.nSize / sizeof( NoteRecord );
+			break;
+		default:
+			// Written by a more recent version.
+			break;
+		}
+	}
+
+	if ( pXml == nullptr ||
+		 ! m_doc.setContent( QByteArray::fromRawData( pXml, nXmlSize ) ) ) {
+		ERRORLOG( QString( "Unable to read XML part of binary document [%1]" )
+				  .arg( sPath ) );
+		return false;
+	}
+
+	for ( uint64_t ii = 0; ii < m_nPatterns; ++ii ) {
+		if ( static_cast<uint64_t>( m_pPatterns[ ii ].nFirstNote ) +
+			 m_pPatterns[ ii ].nNotes > m_nNotes ) {
+			ERRORLOG( QString( "Notes of pattern [%1] of binary document [%2] are out of bounds" )
+					  .arg( ii ).arg( sPath ) );
+			return false;
+		}
+	}
+
+	// The records are cast to the enums of Note as they are.
+	for ( uint64_t ii = 0; ii < m_nNotes; ++ii ) {
+		const NoteRecord& note = m_pNotes[ ii ];
+		if ( note.nKey < KEY_MIN || note.nKey > KEY_MAX ||
+			 note.nOctave < OCTAVE_MIN || note.nOctave > OCTAVE_MAX ) {
+			ERRORLOG( QString( "Note [%1] of binary document [%2] has invalid key [%3] or octave [%4]" )
+					  .arg( ii ).arg( sPath ).arg( note.nKey ).arg( note.nOctave ) );
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int BinaryDoc::getPatternCount() const
+{
+	return static_cast<int>( m_nPatterns );
+}
+
+bool BinaryDoc::loadNotes( int nPattern, Pattern* pPattern,
+						   std::shared_ptr<InstrumentList> pInstrumentList ) const
+{
+	if ( nPattern < 0 || static_cast<uint64_t>( nPattern ) >= m_nPatterns ) {
+		ERRORLOG( QString( "Pattern [%1] out of bound [0,%2)" )
+				  .arg( nPattern ).arg( m_nPatterns ) );
+		return false;
+	}
+
+	const PatternRecord& pattern = m_pPatterns[ nPattern ];
+	for ( uint32_t ii = 0; ii < pattern.nNotes; ++ii ) {
+		Note* pNote = toNote( m_pNotes[ pattern.nFirstNote + ii ] );
+		if ( pInstrumentList != nullptr ) {
+			pNote->map_instrument( pInstrumentList );
+		}
+		pPattern->insert_note( pNote );
+	}
+	return true;
+}
+
+bool BinaryDoc::insertNotes()
+{
+	const auto patternNodes = getPatternNodes();
+	if ( patternNodes.size() != m_nPatterns ) {
+		ERRORLOG( QString( "Number of patterns [%1] does not match the number of pattern records [%2]" )
+				  .arg( patternNodes.size() ).arg( m_nPatterns ) );
+		return false;
+	}
+
+	for ( uint64_t nn = 0; nn < m_nPatterns; ++nn ) {
+		XMLNode patternNode = patternNodes[ nn ];
+		XMLNode noteListNode = patternNode.createNode( "noteList" );
+		const PatternRecord& pattern = m_pPatterns[ nn ];
+		for ( uint32_t ii = 0; ii < pattern.nNotes; ++ii ) {
+			Note* pNote = toNote( m_pNotes[ pattern.nFirstNote + ii ] );
+			XMLNode noteNode = noteListNode.createNode( "note" );
+			pNote->save_to( &noteNode );
+			delete pNote;
+		}
+	}
+	return true;
+}
+
+bool BinaryDoc::convert( const QString& sSourcePath, const QString& sTargetPath,
+						 bool bBinary )
+{
+	// Handles both formats and does not keep the source open. It
+	// might be the same file as the target.
+	XMLDoc doc;
+	if ( ! doc.read( sSourcePath, nullptr ) ) {
+		return false;
+	}
+
+	if ( ! bBinary ) {
+		return doc.write( sTargetPath );
+	}
+
+	BinaryDoc target;
+	target.m_doc.QDomDocument::operator=( doc );
+	target.extractNotes();
+	return target.write( sTargetPath );
+}
+
+};
@@ -0,0 +1,216 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_BINARY_DOC_H
+#define H2C_BINARY_DOC_H
+
+#include <core/Object.h>
+#include <core/Helpers/Xml.h>
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+class QFile;
+
+namespace H2Core
+{
+
+class InstrumentList;
+class Note;
+class Pattern;
+
+/**
+ * Compact binary container for songs, patterns, and drumkits.
+ *
+ * Loading a song spends most of its time creating, reading, and
+ * destroying the DOM nodes of its notes - about a dozen per
+ * note. A binary document keeps everything but the notes as a
+ * regular XML document and stores the notes as contiguous arrays of
+ * fixed size records instead. They are mapped into memory as they
+ * are and converted into #Note instances without any parsing.
+ *
+ * Layout (little-endian, all sections aligned to 8 bytes):
+ * - #Header, starting with the magic "H2BINDOC"
+ * - #Header::nSections #Section entries
+ * - the sections themselves:
+ *   - #XmlSection - UTF-8 encoded XML document. It is the same as
+ *     the one of the XML format except that the pattern nodes
+ *     (of "song/patternList" and "drumkit_pattern") lack their
+ *     "noteList".
+ *   - #PatternSection - one #PatternRecord per pattern node in
+ *     document order.
+ *   - #NoteSection - all #NoteRecord. Those of a pattern are
+ *     adjacent and ordered by position.
+ *
+ * Samples are still referenced by their path within the XML part.
+ *
+ * Unknown sections are ignored when reading. Incompatible changes
+ * of the layout have to increase #nVersion.
+ *
+ * A BinaryDoc is either filled and written using write() or read()
+ * from a file. Not both.
+ */
+/** \ingroup docCore*/
+class BinaryDoc : public H2Core::Object<BinaryDoc>
+{
+		H2_OBJECT(BinaryDoc)
+	public:
+		static constexpr uint32_t nVersion = 1;
+
+		struct Header {
+			char magic[ 8 ];
+			/** 0x01020304 in the byte order of the writing machine. */
+			uint32_t nByteOrder;
+			uint32_t nVersion;
+			uint32_t nSections;
+			uint32_t nReserved;
+		};
+
+		struct Section {
+			uint32_t nId;
+			uint32_t nReserved;
+			/** Measured from the beginning of the file. */
+			uint64_t nOffset;
+			uint64_t nSize;
+		};
+
+		static constexpr uint32_t XmlSection = 0x204c4d58; // "XML "
+		static constexpr uint32_t PatternSection = 0x4e544150; // "PATN"
+		static constexpr uint32_t NoteSection = 0x45544f4e; // "NOTE"
+
+		struct PatternRecord {
+			uint32_t nFirstNote;
+			uint32_t nNotes;
+		};
+
+		/** Everything Note::save_to() writes. */
+		struct NoteRecord {
+			int32_t nPosition;
+			int32_t nLength;
+			int32_t nInstrumentId;
+			float fVelocity;
+			float fPan;
+			float fPitch;
+			float fLeadLag;
+			float fProbability;
+			int8_t nKey;
+			int8_t nOctave;
+			uint8_t bNoteOff;
+			uint8_t reserved[ 5 ];
+		};
+		static_assert( sizeof( Header ) == 24, "Header must not be padded" );
+		static_assert( sizeof( Section ) == 24, "Section must not be padded" );
+		static_assert( sizeof( NoteRecord ) == 40, "NoteRecord must not be padded" );
+		static_assert( std::is_trivially_copyable<NoteRecord>::value,
+					   "NoteRecord is written as is" );
+
+		BinaryDoc();
+		~BinaryDoc();
+
+		/** \return Whether the file at @a sPath starts with the magic
+		 * of a binary document. */
+		static bool isBinary( const QString& sPath );
+
+		/** XML part of the document. Has to be filled before write()
+		 * and is available after read(). */
+		XMLDoc* getDocument();
+
+		/**
+		 * Appends the notes of @a pPattern as a new #PatternRecord.
+		 *
+		 * Has to be called once for each pattern node, without
+		 * "noteList", of the XML part in document order.
+		 */
+		void addPattern( const Pattern* pPattern );
+		/**
+		 * Moves the "noteList" of all pattern nodes of the XML part
+		 * into records. Used to convert an XML document.
+		 */
+		void extractNotes();
+
+		bool write( const QString& sPath );
+
+		/**
+		 * Maps the file at @a sPath into memory and reads its XML
+		 * part. The notes are not touched before loadNotes() or
+		 * insertNotes() is called. No schema validation is done.
+		 *
+		 * Fails if any record is out of bounds or a note has a key
+		 * or octave Note does not know.
+		 */
+		bool read( const QString& sPath );
+
+		/** \return Number of #PatternRecord of a read document. */
+		int getPatternCount() const;
+		/**
+		 * Adds the notes of the @a nPattern th pattern node of a read
+		 * document to @a pPattern.
+		 *
+		 * \param pInstrumentList used to map the notes. If nullptr
+		 *   only the instrument ID is set.
+		 */
+		bool loadNotes( int nPattern, Pattern* pPattern,
+						std::shared_ptr<InstrumentList> pInstrumentList ) const;
+		/**
+		 * Adds the notes of a read document as "noteList" nodes to
+		 * its XML part. Afterwards getDocument() holds the same
+		 * document the XML format would.
+		 */
+		bool insertNotes();
+
+		/**
+		 * Converts the song, pattern, or drumkit file at @a
+		 * sSourcePath - either XML or binary - into the binary
+		 * (@a bBinary) or XML format without loading its content.
+		 *
+		 * @a sTargetPath might be the same as @a sSourcePath.
+		 */
+		static bool convert( const QString& sSourcePath, const QString& sTargetPath,
+							 bool bBinary );
+
+	private:
+		std::vector<XMLNode> getPatternNodes();
+
+		static NoteRecord toRecord( Note* pNote );
+		static Note* toNote( const NoteRecord& record );
+
+		XMLDoc m_doc;
+
+		/** Records to be written. */
+		std::vector<PatternRecord> m_patterns;
+		std::vector<NoteRecord> m_notes;
+
+		/** Kept open while the document is mapped. */
+		std::unique_ptr<QFile> m_pFile;
+		/** Content of the file in case it could not be mapped. */
+		QByteArray m_buffer;
+		/** Records of a read file. They point into the mapped memory. */
+		const PatternRecord* m_pPatterns;
+		uint64_t m_nPatterns;
+		const NoteRecord* m_pNotes;
+		uint64_t m_nNotes;
+};
+
+};
+
+#endif // H2C_BINARY_DOC_H
@@ -0,0 +1,120 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Helpers/Random.h>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace H2Core
+{
+
+namespace {
+
+struct ZigguratTables {
+	uint32_t kn[ 128 ];
+	float wn[ 128 ];
+	float fn[ 128 ];
+
+	ZigguratTables() {
+		const double m1 = 2147483648.0;
+		const double vn = 9.91256303526217e-3;
+		double dn = 3.442619855899;
+		double tn = dn;
+		const double q = vn / std::exp( -0.5 * dn * dn );
+
+		kn[ 0 ] = static_cast<uint32_t>( ( dn / q ) * m1 );
+		kn[ 1 ] = 0;
+		wn[ 0 ] = static_cast<float>( q / m1 );
+		wn[ 127 ] = static_cast<float>( dn / m1 );
+		fn[ 0 ] = 1.0f;
+		fn[ 127 ] = static_cast<float>( std::exp( -0.5 * dn * dn ) );
+
+		for ( int ii = 126; ii >= 1; --ii ) {
+			dn = std::sqrt( -2.0 * std::log( vn / dn + std::exp( -0.5 * dn * dn ) ) );
+			kn[ ii + 1 ] = static_cast<uint32_t>( ( dn / tn ) * m1 );
+			tn = dn;
+			fn[ ii ] = static_cast<float>( std::exp( -0.5 * dn * dn ) );
+			wn[ ii ] = static_cast<float>( dn / m1 );
+		}
+	}
+};
+
+const ZigguratTables zigguratTables;
+
+}
+
+const uint32_t* Random::m_kn = zigguratTables.kn;
+const float* Random::m_wn = zigguratTables.wn;
+const float* Random::m_fn = zigguratTables.fn;
+
+void Random::seed( uint64_t nSeed ) {
+	// Expand the seed using splitmix64 as recommended by the authors
+	// of xoshiro. This also ensures the state is never all zero.
+	for ( auto& nState : m_state ) {
+		nSeed += 0x9e3779b97f4a7c15ULL;
+		uint64_t nZ = nSeed;
+		nZ = ( nZ ^ ( nZ >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+		nZ = ( nZ ^ ( nZ >> 27 ) ) * 0x94d049bb133111ebULL;
+		nState = nZ ^ ( nZ >> 31 );
+	}
+}
+
+uint64_t Random::createSeed() {
+	std::random_device randomDevice;
+	const uint64_t nTime = static_cast<uint64_t>(
+		std::chrono::high_resolution_clock::now().time_since_epoch().count() );
+	return ( static_cast<uint64_t>( randomDevice() ) << 32 ) ^
+		randomDevice() ^ nTime;
+}
+
+float Random::gaussianTail( int32_t nHz, int nIz ) {
+	const double r = 3.442619855899;
+
+	for ( ;; ) {
+		const double x = nHz * static_cast<double>( m_wn[ nIz ] );
+		if ( nIz == 0 ) {
+			// Base strip: sample from the tail beyond r.
+			double fX, fY;
+			do {
+				fX = -std::log( uniformOpen() ) / r;
+				fY = -std::log( uniformOpen() );
+			} while ( fY + fY < fX * fX );
+			return static_cast<float>( nHz > 0 ? r + fX : -r - fX );
+		}
+
+		// Wedge of one of the other strips.
+		if ( m_fn[ nIz ] + uniformOpen() * ( m_fn[ nIz - 1 ] - m_fn[ nIz ] ) <
+			 std::exp( -0.5 * x * x ) ) {
+			return static_cast<float>( x );
+		}
+
+		const uint64_t nBits = next();
+		nHz = static_cast<int32_t>( nBits >> 32 );
+		nIz = static_cast<int>( nBits & 127 );
+		if ( static_cast<uint32_t>( std::abs( static_cast<int64_t>( nHz ) ) ) < m_kn[ nIz ] ) {
+			return nHz * m_wn[ nIz ];
+		}
+	}
+}
+
+};
@@ -0,0 +1,119 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_RANDOM_H
+#define H2C_RANDOM_H
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace H2Core
+{
+
+/**
+ * Small and fast pseudo random number generator.
+ *
+ * Uses xoshiro256** (Blackman and Vigna) as its source and the
+ * Ziggurat method (Marsaglia and Tsang) to draw normally distributed
+ * numbers. In contrast to rand() it does not rely on hidden global
+ * state, does not lock, and produces the same sequence for the same
+ * seed on all platforms.
+ *
+ * An instance must not be shared between threads without external
+ * synchronization. The AudioEngine owns one for the audio (or
+ * export) thread, see AudioEngine::getRandom().
+ */
+class Random
+{
+public:
+	explicit Random( uint64_t nSeed = 0 ) {
+		seed( nSeed );
+	}
+
+	/** Resets the state. Instances seeded with the same value
+	 * produce identical sequences. */
+	void seed( uint64_t nSeed );
+
+	/** \return Seed based on the system's entropy source and the
+	 * current time. */
+	static uint64_t createSeed();
+
+	/** \return 64 uniformly distributed random bits. */
+	uint64_t next() {
+		const uint64_t nResult = rotl( m_state[ 1 ] * 5, 7 ) * 9;
+		const uint64_t nT = m_state[ 1 ] << 17;
+		m_state[ 2 ] ^= m_state[ 0 ];
+		m_state[ 3 ] ^= m_state[ 1 ];
+		m_state[ 1 ] ^= m_state[ 2 ];
+		m_state[ 0 ] ^= m_state[ 3 ];
+		m_state[ 2 ] ^= nT;
+		m_state[ 3 ] = rotl( m_state[ 3 ], 45 );
+		return nResult;
+	}
+
+	/** \return Uniformly distributed number in [0, 1). */
+	float uniform() {
+		// The upper 24 bits fit exactly into the mantissa.
+		return static_cast<float>( next() >> 40 ) * ( 1.0f / 16777216.0f );
+	}
+
+	/** \return Uniformly distributed integer in [0, @a nMax). @a nMax
+	 * has to be positive. */
+	int uniformInt( int nMax ) {
+		return static_cast<int>( ( ( next() >> 32 ) * static_cast<uint64_t>( nMax ) ) >> 32 );
+	}
+
+	/** \return Normally distributed number with mean 0 and standard
+	 * deviation 1. */
+	float gaussian() {
+		const uint64_t nBits = next();
+		const int32_t nHz = static_cast<int32_t>( nBits >> 32 );
+		const int nIz = static_cast<int>( nBits & 127 );
+		if ( static_cast<uint32_t>( std::abs( static_cast<int64_t>( nHz ) ) ) < m_kn[ nIz ] ) {
+			return nHz * m_wn[ nIz ];
+		}
+		return gaussianTail( nHz, nIz );
+	}
+
+private:
+	static uint64_t rotl( uint64_t nX, int nK ) {
+		return ( nX << nK ) | ( nX >> ( 64 - nK ) );
+	}
+
+	/** Uniform number in (0, 1), used for logarithms. */
+	double uniformOpen() {
+		return ( static_cast<double>( next() >> 11 ) + 0.5 ) * ( 1.0 / 9007199254740992.0 );
+	}
+
+	/** Slow path of gaussian(), taken in about 1.5% of the calls. */
+	float gaussianTail( int32_t nHz, int nIz );
+
+	uint64_t m_state[ 4 ];
+
+	/** Ziggurat tables of 128 layers. */
+	static const uint32_t* m_kn;
+	static const float* m_wn;
+	static const float* m_fn;
+};
+
+};
+
+#endif // H2C_RANDOM_H
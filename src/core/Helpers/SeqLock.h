@@ -0,0 +1,112 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_SEQ_LOCK_H
+#define H2C_SEQ_LOCK_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace H2Core
+{
+
+/**
+ * Single value shared between exactly one writer and any number of
+ * reader threads.
+ *
+ * The writer never blocks, waits, or allocates memory and can thus
+ * publish from realtime threads, like the process callback of the
+ * audio driver. Readers never block the writer either. They copy the
+ * value and retry in the rare case the writer updated it in the
+ * meantime. Each read returns a consistent copy of one single
+ * store().
+ *
+ * The value is kept in atomic words so neither side performs a
+ * data race in the sense of the C++ memory model.
+ *
+ * \tparam T Trivially copyable value type.
+ */
+template <typename T>
+class SeqLock
+{
+	static_assert( std::is_trivially_copyable<T>::value,
+				   "SeqLock requires a trivially copyable type" );
+
+public:
+	SeqLock() : m_nSequence( 0 ) {
+		store( T() );
+	}
+
+	/** Writer side. Must not be called concurrently. */
+	void store( const T& value ) {
+		std::array<uint64_t, nWords> words{};
+		std::memcpy( words.data(), &value, sizeof( T ) );
+
+		const size_t nSequence = m_nSequence.load( std::memory_order_relaxed );
+		// An odd sequence marks a write in progress.
+		m_nSequence.store( nSequence + 1, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release );
+		for ( size_t ii = 0; ii < nWords; ++ii ) {
+			m_words[ ii ].store( words[ ii ], std::memory_order_relaxed );
+		}
+		m_nSequence.store( nSequence + 2, std::memory_order_release );
+	}
+
+	/** Reader side. \return Copy of the most recently stored value. */
+	T load() const {
+		std::array<uint64_t, nWords> words;
+		size_t nBefore, nAfter;
+		do {
+			nBefore = m_nSequence.load( std::memory_order_acquire );
+			for ( size_t ii = 0; ii < nWords; ++ii ) {
+				words[ ii ] = m_words[ ii ].load( std::memory_order_relaxed );
+			}
+			std::atomic_thread_fence( std::memory_order_acquire );
+			nAfter = m_nSequence.load( std::memory_order_relaxed );
+		} while ( ( nBefore & 1 ) != 0 || nBefore != nAfter );
+
+		T value;
+		std::memcpy( &value, words.data(), sizeof( T ) );
+		return value;
+	}
+
+	/** \return Counter increased by every store(). Allows readers
+	 * to skip work in case nothing was published since their last
+	 * visit. */
+	size_t getVersion() const {
+		return m_nSequence.load( std::memory_order_acquire ) / 2;
+	}
+
+private:
+	static constexpr size_t nWords = ( sizeof( T ) + sizeof( uint64_t ) - 1 ) /
+		sizeof( uint64_t );
+
+	alignas( 64 ) std::atomic<size_t> m_nSequence;
+	std::array<std::atomic<uint64_t>, nWords> m_words;
+};
+
+};
+
+#endif // H2C_SEQ_LOCK_H
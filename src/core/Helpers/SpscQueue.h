@@ -0,0 +1,104 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_SPSC_QUEUE_H
+#define H2C_SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace H2Core
+{
+
+/**
+ * Bounded wait-free queue for exactly one producer and one consumer
+ * thread.
+ *
+ * Neither side ever blocks or allocates memory, which makes it
+ * suitable to pass data into or out of realtime threads, like the
+ * process callbacks of the audio and MIDI drivers. If more than one
+ * thread has to push (or pop) items, the callers have to serialize
+ * access on their side of the queue.
+ *
+ * \tparam T Copyable item type.
+ * \tparam nCapacity Maximum number of items. Has to be a power of
+ * two.
+ */
+template <typename T, size_t nCapacity>
+class SpscQueue
+{
+	static_assert( nCapacity > 0 && ( nCapacity & ( nCapacity - 1 ) ) == 0,
+				   "Capacity of SpscQueue has to be a power of two" );
+
+public:
+	SpscQueue() : m_nHead( 0 ), m_nTail( 0 ) {}
+
+	/** Producer side. \return false if the queue is full. */
+	bool push( const T& item ) {
+		const size_t nTail = m_nTail.load( std::memory_order_relaxed );
+		if ( nTail - m_nHead.load( std::memory_order_acquire ) >= nCapacity ) {
+			return false;
+		}
+		m_items[ nTail & ( nCapacity - 1 ) ] = item;
+		m_nTail.store( nTail + 1, std::memory_order_release );
+		return true;
+	}
+
+	/** Consumer side. \return false if the queue is empty. */
+	bool pop( T& item ) {
+		const size_t nHead = m_nHead.load( std::memory_order_relaxed );
+		if ( nHead == m_nTail.load( std::memory_order_acquire ) ) {
+			return false;
+		}
+		item = m_items[ nHead & ( nCapacity - 1 ) ];
+		m_nHead.store( nHead + 1, std::memory_order_release );
+		return true;
+	}
+
+	/** \return Approximate number of queued items. Exact only when
+	 * called by the producer or consumer thread while the other
+	 * side is idle. */
+	size_t size() const {
+		return m_nTail.load( std::memory_order_acquire ) -
+			m_nHead.load( std::memory_order_acquire );
+	}
+	bool isEmpty() const {
+		return size() == 0;
+	}
+	static constexpr size_t capacity() {
+		return nCapacity;
+	}
+
+private:
+	std::array<T, nCapacity> m_items;
+	/** Index of the next item to pop. Only written by the consumer.
+	 * Kept on a separate cache line than #m_nTail to avoid false
+	 * sharing. */
+	alignas( 64 ) std::atomic<size_t> m_nHead;
+	/** Index of the next item to push. Only written by the
+	 * producer. */
+	alignas( 64 ) std::atomic<size_t> m_nTail;
+};
+
+};
+
+#endif // H2C_SPSC_QUEUE_H
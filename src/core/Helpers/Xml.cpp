@@ -21,16 +21,25 @@
  */
 
 #include <core/Helpers/Xml.h>
+#include <core/Helpers/BinaryDoc.h>
+#include <core/Helpers/Filesystem.h>
 #include <core/Helpers/Legacy.h>
 
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QFile>
 #include <QtCore/QLocale>
+#include <QtCore/QRunnable>
 #include <QtCore/QString>
 #include <QtCore/QTextStream>
+#include <QtCore/QThreadPool>
 #include <QtXmlPatterns/QXmlSchema>
 #include <QtXmlPatterns/QXmlSchemaValidator>
 #include <QAbstractMessageHandler>
 
+#include <map>
+#include <mutex>
+#include <set>
+
 #define XMLNS_BASE "http://www.hydrogen-music.org/"
 #define XMLNS_XSI "http://www.w3.org/2001/XMLSchema-instance"
 
@@ -55,6 +64,157 @@ protected:
 
 };
 
+struct CompiledSchema {
+	SilentMessageHandler handler;
+	QXmlSchema schema;
+	/** Hash of the schema file. Part of the ones of all documents
+	 * validated against it. */
+	QByteArray hash;
+	bool bUsable = false;
+};
+
+/** \return Schema at @a sSchemaPath compiled by the calling
+ * thread. QXmlSchema is reentrant but not thread-safe. */
+static const CompiledSchema& compiledSchema( const QString& sSchemaPath )
+{
+	thread_local std::map<QString, CompiledSchema> schemas;
+
+	auto it = schemas.find( sSchemaPath );
+	if ( it != schemas.end() ) {
+		return it->second;
+	}
+
+	CompiledSchema& compiled = schemas[ sSchemaPath ];
+	QFile file( sSchemaPath );
+	if ( ! file.open( QIODevice::ReadOnly ) ) {
+		___ERRORLOG( QString( "Unable to open XML schema [%1] for reading. Files will not be validated" )
+					 .arg( sSchemaPath ) );
+		return compiled;
+	}
+	const QByteArray content = file.readAll();
+	file.close();
+
+	compiled.schema.setMessageHandler( &compiled.handler );
+	compiled.schema.load( content, QUrl::fromLocalFile( sSchemaPath ) );
+	if ( compiled.schema.isValid() ) {
+		compiled.hash = QCryptographicHash::hash( content, QCryptographicHash::Sha1 );
+		compiled.bUsable = true;
+	} else {
+		___ERRORLOG( QString( "XML schema [%1] is not valid. Files will not be validated" )
+					 .arg( sSchemaPath ) );
+	}
+
+	return compiled;
+}
+
+static QByteArray documentHash( const CompiledSchema& schema, const QByteArray& content )
+{
+	QCryptographicHash hash( QCryptographicHash::Sha1 );
+	hash.addData( schema.hash );
+	hash.addData( content );
+	return hash.result();
+}
+
+static bool validateContent( const CompiledSchema& schema, const QByteArray& content,
+							 const QString& sFilePath )
+{
+	QXmlSchemaValidator validator( schema.schema );
+	return validator.validate( content, QUrl::fromLocalFile( sFilePath ) );
+}
+
+/** Hashes of all documents, which passed validation. They are stored
+ * one per line in #validatedHashesPath() to be available in later
+ * sessions too. */
+static std::mutex validatedHashesMutex;
+static std::set<QByteArray> validatedHashes;
+static bool bValidatedHashesLoaded = false;
+
+static QString validatedHashesPath()
+{
+	return Filesystem::cache_dir() + "validated_documents";
+}
+
+/** Has to be called with #validatedHashesMutex locked. */
+static void loadValidatedHashes()
+{
+	if ( bValidatedHashesLoaded ) {
+		return;
+	}
+	bValidatedHashesLoaded = true;
+
+	QFile file( validatedHashesPath() );
+	if ( ! file.open( QIODevice::ReadOnly | QIODevice::Text ) ) {
+		return;
+	}
+	while ( ! file.atEnd() ) {
+		const QByteArray line = file.readLine().trimmed();
+		if ( ! line.isEmpty() ) {
+			validatedHashes.insert( QByteArray::fromHex( line ) );
+		}
+	}
+}
+
+static bool isValidated( const QByteArray& hash )
+{
+	std::lock_guard<std::mutex> lock( validatedHashesMutex );
+	loadValidatedHashes();
+	return validatedHashes.find( hash ) != validatedHashes.end();
+}
+
+static void addValidated( const QByteArray& hash )
+{
+	std::lock_guard<std::mutex> lock( validatedHashesMutex );
+	loadValidatedHashes();
+	if ( validatedHashes.insert( hash ).second ) {
+		QFile file( validatedHashesPath() );
+		if ( file.open( QIODevice::Append | QIODevice::Text ) ) {
+			file.write( hash.toHex() + "\n" );
+		}
+	}
+}
+
+/** Validation of a single document in #XMLDoc::Validation::Deferred
+ * mode. */
+class DeferredValidation : public QRunnable
+{
+public:
+	DeferredValidation( const QByteArray& content, const QString& sFilePath,
+						const QString& sSchemaPath )
+		: m_content( content )
+		, m_sFilePath( sFilePath )
+		, m_sSchemaPath( sSchemaPath ) {
+	}
+
+	void run() override {
+		const auto& schema = compiledSchema( m_sSchemaPath );
+		if ( ! schema.bUsable ) {
+			return;
+		}
+
+		const QByteArray hash = documentHash( schema, m_content );
+		if ( isValidated( hash ) ) {
+			return;
+		}
+		if ( validateContent( schema, m_content, m_sFilePath ) ) {
+			addValidated( hash );
+		} else {
+			___WARNINGLOG( QString( "XML document [%1] is not valid with respect to schema [%2]" )
+						   .arg( m_sFilePath ).arg( m_sSchemaPath ) );
+		}
+	}
+
+private:
+	const QByteArray m_content;
+	const QString m_sFilePath;
+	const QString m_sSchemaPath;
+};
+
+static QThreadPool& deferredValidationPool()
+{
+	static QThreadPool pool;
+	return pool;
+}
+
 
 
 XMLNode::XMLNode() { }
@@ -293,9 +453,58 @@ void XMLNode::write_bool( const QString& name, const bool value )
 
 XMLDoc::XMLDoc( ) { }
 
-bool XMLDoc::read( const QString& sFilePath, const QString& sSchemaPath, bool bSilent )
+void XMLDoc::waitForDeferredValidation()
+{
+	deferredValidationPool().waitForDone();
+}
+
+void XMLDoc::clearValidationCache()
+{
+	std::lock_guard<std::mutex> lock( validatedHashesMutex );
+	validatedHashes.clear();
+	bValidatedHashesLoaded = true;
+	QFile::remove( validatedHashesPath() );
+}
+
+bool XMLDoc::validate( const QByteArray& content, const QString& sFilePath,
+					   const QString& sSchemaPath, bool bSilent,
+					   Validation validation )
+{
+	if ( validation == Validation::Deferred ) {
+		deferredValidationPool().start(
+			new DeferredValidation( content, sFilePath, sSchemaPath ) );
+		return true;
+	}
+
+	const auto& schema = compiledSchema( sSchemaPath );
+	if ( ! schema.bUsable ) {
+		return true;
+	}
+
+	const QByteArray hash = documentHash( schema, content );
+	if ( isValidated( hash ) ) {
+		return true;
+	}
+
+	if ( ! validateContent( schema, content, sFilePath ) ) {
+		if ( ! bSilent ) {
+			WARNINGLOG( QString( "XML document [%1] is not valid with respect to schema [%2], loading may fail" )
+						.arg( sFilePath ).arg( sSchemaPath ) );
+		}
+		return false;
+	}
+	else if ( ! bSilent ) {
+		INFOLOG( QString( "XML document [%1] is valid with respect to schema [%2]" )
+				 .arg( sFilePath ).arg( sSchemaPath ) );
+	}
+	addValidated( hash );
+
+	return true;
+}
+
+bool XMLDoc::read( const QString& sFilePath, const QString& sSchemaPath, bool bSilent,
+				   Validation validation )
 {
-	
 	QFile file( sFilePath );
 	if ( !file.open( QIODevice::ReadOnly ) ) {
 		ERRORLOG( QString( "Unable to open [%1] for reading" )
@@ -303,44 +512,34 @@ bool XMLDoc::read( const QString& sFilePath, const QString& sSchemaPath, bool bS
 		return false;
 	}
 	
-	SilentMessageHandler handler;
-	QXmlSchema schema;
-	schema.setMessageHandler( &handler );
-	
-	bool bSchemaUsable = false;
-	
-	if ( ! sSchemaPath.isEmpty() ) {
-		QFile file( sSchemaPath );
-		if ( !file.open( QIODevice::ReadOnly ) ) {
-			ERRORLOG( QString( "Unable to open XML schema [%1] for reading." )
-					  .arg( sSchemaPath ) );
-		} else {
-			schema.load( &file, QUrl::fromLocalFile( file.fileName() ) );
-			file.close();
-			if ( schema.isValid() ) {
-				bSchemaUsable = true;
-			} else {
-				ERRORLOG( QString( "XML schema [%1] is not valid. File [%2] will not be validated" )
-						  .arg( sSchemaPath ).arg( sFilePath ) );
-			}
-		}
-	}
-	
-	if ( bSchemaUsable ) {
-		QXmlSchemaValidator validator( schema );
-		if ( !validator.validate( &file, QUrl::fromLocalFile( file.fileName() ) ) ) {
-			if ( ! bSilent ) {
-				WARNINGLOG( QString( "XML document [%1] is not valid with respect to schema [%2], loading may fail" )
-							.arg( sFilePath ).arg( sSchemaPath ) );
-			}
-			file.close();
+	// A binary document is turned into the one the XML format would
+	// hold and validated as such.
+	BinaryDoc binaryDoc;
+	const bool bBinary = BinaryDoc::isBinary( sFilePath );
+	QByteArray content;
+	if ( bBinary ) {
+		file.close();
+		if ( ! binaryDoc.read( sFilePath ) || ! binaryDoc.insertNotes() ) {
 			return false;
 		}
-		else if ( ! bSilent ) {
-			INFOLOG( QString( "XML document [%1] is valid with respect to schema [%2]" )
-					 .arg( sFilePath ).arg( sSchemaPath ) );
+		if ( ! sSchemaPath.isEmpty() ) {
+			content = binaryDoc.getDocument()->toByteArray();
 		}
-		file.seek( 0 );
+	}
+	else {
+		// Used for both validation and parsing.
+		content = file.readAll();
+	}
+	
+	if ( ! sSchemaPath.isEmpty() &&
+		 ! validate( content, sFilePath, sSchemaPath, bSilent, validation ) ) {
+		file.close();
+		return false;
+	}
+
+	if ( bBinary ) {
+		QDomDocument::operator=( *binaryDoc.getDocument() );
+		return true;
 	}
 
 	if ( Legacy::checkTinyXMLCompatMode( &file ) ) {
@@ -355,7 +554,7 @@ bool XMLDoc::read( const QString& sFilePath, const QString& sSchemaPath, bool bS
 	}
 	else  {
 		// File was written using current format.
-		if ( ! setContent( &file ) ) {
+		if ( ! setContent( content ) ) {
 			ERRORLOG( QString( "Unable to read XML document [%1]" )
 					  .arg( sFilePath ) );
 			file.close();
@@ -367,6 +566,90 @@ bool XMLDoc::read( const QString& sFilePath, const QString& sSchemaPath, bool bS
 	return true;
 }
 
+bool XMLDoc::readStreamed( const QString& sFilePath, const QString& sElementPath,
+						   StreamHandler handler, bool bSilent )
+{
+	QFile file( sFilePath );
+	if ( !file.open( QIODevice::ReadOnly ) ) {
+		ERRORLOG( QString( "Unable to open [%1] for reading" )
+				  .arg( sFilePath ) );
+		return false;
+	}
+
+	QXmlStreamReader reader;
+	// Keep the namespace declarations as plain attributes, just like
+	// QDomDocument::setContent() does.
+	reader.setNamespaceProcessing( false );
+
+	QByteArray convertedContent;
+	if ( Legacy::checkTinyXMLCompatMode( &file, bSilent ) ) {
+		// Document was created using TinyXML and not using QtXML. We
+		// need to convert it first.
+		convertedContent = Legacy::convertFromTinyXML( &file, bSilent );
+		reader.addData( convertedContent );
+	}
+	else {
+		file.seek( 0 );
+		reader.setDevice( &file );
+	}
+
+	const QStringList handlerPath = sElementPath.split( '/' );
+	QStringList path;
+	QDomNode parent = *this;
+
+	while ( ! reader.atEnd() ) {
+		switch ( reader.readNext() ) {
+		case QXmlStreamReader::StartElement: {
+			const QString sName = reader.qualifiedName().toString();
+			if ( path.size() == handlerPath.size() - 1 &&
+				 sName == handlerPath.last() &&
+				 path == handlerPath.mid( 0, path.size() ) ) {
+				if ( ! handler( reader ) ) {
+					ERRORLOG( QString( "Unable to read element [%1] of XML document [%2]" )
+							  .arg( sElementPath ).arg( sFilePath ) );
+					file.close();
+					return false;
+				}
+				break;
+			}
+
+			QDomElement element = createElement( sName );
+			for ( const auto& attribute : reader.attributes() ) {
+				element.setAttribute( attribute.qualifiedName().toString(),
+									  attribute.value().toString() );
+			}
+			parent.appendChild( element );
+			parent = element;
+			path << sName;
+			break;
+		}
+		case QXmlStreamReader::EndElement:
+			parent = parent.parentNode();
+			path.removeLast();
+			break;
+		case QXmlStreamReader::Characters:
+			// Whitespace-only nodes are dropped by
+			// QDomDocument::setContent() as well.
+			if ( ! reader.isWhitespace() ) {
+				parent.appendChild( createTextNode( reader.text().toString() ) );
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	file.close();
+
+	if ( reader.hasError() ) {
+		ERRORLOG( QString( "Unable to read XML document [%1]: %2 (line %3, column %4)" )
+				  .arg( sFilePath ).arg( reader.errorString() )
+				  .arg( reader.lineNumber() ).arg( reader.columnNumber() ) );
+		return false;
+	}
+
+	return true;
+}
+
 bool XMLDoc::write( const QString& filepath )
 {
 	QFile file( filepath );
@@ -25,9 +25,12 @@
 
 #include <core/Object.h>
 #include <QtCore/QString>
+#include <QtCore/QXmlStreamReader>
 #include <QColor>
 #include <QtXml/QDomDocument>
 
+#include <functional>
+
 namespace H2Core
 {
 
@@ -184,14 +187,79 @@ class XMLDoc : public H2Core::Object<XMLDoc>, public QDomDocument
 	public:
 		/** basic constructor */
 		XMLDoc( );
+
+		/** How read() treats the schema passed to it. */
+		enum class Validation {
+			/** The document is validated before it is parsed and
+			 * read() fails if it is invalid. */
+			Immediate,
+			/** The document is parsed right away and validated in a
+			 * background thread. Invalid documents are only reported
+			 * in the log. Meant for bulk loads in which the outcome
+			 * of the validation does not change how a document is
+			 * loaded. */
+			Deferred
+		};
+		/** Blocks until all documents queued in
+		 * #Validation::Deferred mode are validated. */
+		static void waitForDeferredValidation();
+		/** Forgets about all documents validated so far - including
+		 * the ones of previous sessions. */
+		static void clearValidationCache();
+
 		/**
 		 * read the content of an xml file
+		 *
+		 * In case @a filepath is a BinaryDoc, its notes are inserted
+		 * and the resulting document - the same the XML format would
+		 * hold - is validated.
+		 *
+		 * Each schema is compiled only once per thread. Documents,
+		 * which passed validation against a schema before, are
+		 * remembered by the hash of both their contents - across
+		 * sessions - and not validated again.
+		 *
 		 * \param filepath the path to the file to read from
 		 * \param schemapath the path to the XML Schema file
 		 * \param bSilent Whether debug and info messages should be logged
 		 * when anomalies are encountered while reading the XML nodes.
+		 * \param validation how the document is validated against
+		 *   @a schemapath.
 		 */
-	bool read( const QString& filepath, const QString& schemapath=nullptr, bool bSilent = false );
+	bool read( const QString& filepath, const QString& schemapath=nullptr, bool bSilent = false,
+			   Validation validation = Validation::Immediate );
+
+		/**
+		 * Called by readStreamed() with the reader positioned at the
+		 * StartElement token of the element it is registered
+		 * for. Has to consume the element up to and including its
+		 * EndElement token and returns false on failure.
+		 */
+		typedef std::function<bool(QXmlStreamReader&)> StreamHandler;
+
+		/**
+		 * Reads the content of an xml file in a single pass using a
+		 * QXmlStreamReader.
+		 *
+		 * All elements are added to the document just as read()
+		 * does except for the one at @a sElementPath (e.g.
+		 * "song/patternList"). Its subtree is handed to @a handler
+		 * instead and never becomes part of the DOM. This way the
+		 * bulky parts of a file, like the notes of a song, can be
+		 * parsed directly into their objects without building a
+		 * node - including its child text nodes - per value first.
+		 *
+		 * No schema validation is done.
+		 *
+		 * \param sFilePath the path to the file to read from
+		 * \param sElementPath '/' separated names of the element
+		 *   passed to @a handler, starting with the root element.
+		 * \param handler parser of the element at @a sElementPath
+		 * \param bSilent Whether debug and info messages should be logged
+		 * when anomalies are encountered while reading the XML nodes.
+		 */
+		bool readStreamed( const QString& sFilePath, const QString& sElementPath,
+						   StreamHandler handler, bool bSilent = false );
 		/**
 		 * write itself into a file
 		 * \param filepath the path to the file to write to
@@ -203,6 +271,14 @@ class XMLDoc : public H2Core::Object<XMLDoc>, public QDomDocument
 		 * \param xmlns the xml namespace prefix to add after XMLNS_BASE
 		 */
 		XMLNode set_root( const QString& node_name, const QString& xmlns = nullptr );
+
+	private:
+		/** Validates @a content of the file at @a sFilePath against
+		 * the schema at @a sSchemaPath according to @a
+		 * validation. */
+		static bool validate( const QByteArray& content, const QString& sFilePath,
+							  const QString& sSchemaPath, bool bSilent,
+							  Validation validation );
 };
 
 };
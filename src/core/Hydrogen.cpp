@@ -708,6 +708,13 @@ bool Hydrogen::startExportSession( int nSampleRate, int nSampleDepth )
 void Hydrogen::startExportSong( const QString& filename)
 {
 	AudioEngine* pAudioEngine = m_pAudioEngine;
+	const auto pPref = Preferences::get_instance();
+
+	// The DiskWriterDriver does not process yet. The seed is in
+	// place before the first note is queued.
+	pAudioEngine->seedRandom( pPref->m_bDeterministicExport ?
+							  static_cast<uint64_t>( pPref->m_nExportSeed ) :
+							  Random::createSeed() );
 	getCoreActionController()->locateToTick( 0 );
 	pAudioEngine->play();
 	pAudioEngine->getSampler()->stopPlayingNotes();
@@ -24,10 +24,12 @@
 
 #if defined(H2CORE_HAVE_ALSA) || _DOXYGEN_
 
+#include <algorithm>
 #include <pthread.h>
 #include <iostream>
 #include <core/Preferences/Preferences.h>
 #include <core/EventQueue.h>
+#include <core/Helpers/AudioBufferArena.h>
 
 namespace H2Core
 {
@@ -53,6 +55,162 @@ static int alsa_xrun_recovery( snd_pcm_t *handle, int err )
 	return err;
 }
 
+/** Counts an xrun and tries to bring the device back into a
+ * working state.
+ * \return true on success. */
+static bool alsaAudioDriver_recover( AlsaAudioDriver* pDriver, int err )
+{
+	pDriver->m_nXRuns++;
+	EventQueue::get_instance()->push_event( EVENT_XRUN, 0 );
+	if ( ( err = snd_pcm_recover( pDriver->m_pPlayback_handle, err, 1 ) ) < 0 ) {
+		___ERRORLOG( QString( "Can't recover from XRUN: %1" )
+					 .arg( snd_strerror( err ) ) );
+		return false;
+	}
+	return true;
+}
+
+/** Waits till the playback stream is able to take more frames.
+ * \return true if it is. */
+static bool alsaAudioDriver_wait( AlsaAudioDriver* pDriver )
+{
+	const int nTimeoutInMilliseconds = 100;
+	int err;
+	if ( ( err = snd_pcm_wait( pDriver->m_pPlayback_handle,
+							   nTimeoutInMilliseconds ) ) < 1 ) {
+		// Playback stream is not ready. Since we opened the stream
+		// in blocking mode, the call to snd_pcm_writei() may take
+		// forever and cause the audio engine to stop working
+		// entirely. In addition, this also prevents the audio
+		// driver to be stopped and thus prevents the user from
+		// selecting a different/working version.
+		if ( err == 0 ) {
+			___ERRORLOG( QString( "timeout after [%1] milliseconds" )
+						 .arg( nTimeoutInMilliseconds ) );
+			pDriver->m_nXRuns++;
+			EventQueue::get_instance()->push_event( EVENT_XRUN, 0 );
+		} else {
+			___ERRORLOG( QString( "Error while waiting for playback stream: %1" )
+						 .arg( snd_strerror( err ) ) );
+			alsaAudioDriver_recover( pDriver, err );
+		}
+		return false;
+	}
+	return true;
+}
+
+/** Converts each period into #AlsaAudioDriver::m_pBuffer and passes
+ * it to the device using snd_pcm_writei(). */
+static void alsaAudioDriver_processReadWrite( AlsaAudioDriver* pDriver )
+{
+	int nFrames = pDriver->m_nBufferSize;
+	int err;
+
+	while ( pDriver->m_bIsRunning ) {
+		// prepare the audio data
+		pDriver->m_processCallback( nFrames, nullptr );
+
+		AlsaAudioDriver::convertFrames( pDriver->m_format, pDriver->m_pOut_L,
+										pDriver->m_pOut_R, pDriver->m_pBuffer, nFrames );
+
+		if ( ! alsaAudioDriver_wait( pDriver ) ) {
+			continue;
+		}
+
+		// Playback stream is ready, let's write out the audio
+		// buffer.
+		if ( ( err = snd_pcm_writei( pDriver->m_pPlayback_handle,
+									 pDriver->m_pBuffer, nFrames ) ) < 0 ) {
+			___ERRORLOG( QString( "Error while writing playback stream: %1" )
+						 .arg( snd_strerror( err ) ) );
+
+			// Try to bring the playback device in a nice state
+			// again and retry writing the output buffer.
+			if ( alsaAudioDriver_recover( pDriver, err ) ) {
+				___INFOLOG( "Successfully recovered from error. Attempt to write buffer again." );
+				if ( ( err = snd_pcm_writei( pDriver->m_pPlayback_handle,
+											 pDriver->m_pBuffer, nFrames ) ) < 0 ) {
+					___ERRORLOG( QString( "Unable to write playback stream again: %1" )
+								 .arg( snd_strerror( err ) ) );
+					alsaAudioDriver_recover( pDriver, err );
+				}
+			}
+		}
+	}
+}
+
+/** Converts each period straight into the memory mapped ring buffer
+ * of the device. */
+static void alsaAudioDriver_processMmap( AlsaAudioDriver* pDriver )
+{
+	snd_pcm_t* pHandle = pDriver->m_pPlayback_handle;
+	int nFrames = pDriver->m_nBufferSize;
+	const snd_pcm_channel_area_t* pAreas;
+	snd_pcm_uframes_t nOffset, nChunk;
+	snd_pcm_sframes_t nAvail, nCommitted;
+	int err;
+
+	// Fill the whole ring buffer with silence. Once it is full, the
+	// stream is started by the device (see the start threshold set
+	// in AlsaAudioDriver::connect()).
+	while ( ( nAvail = snd_pcm_avail_update( pHandle ) ) > 0 ) {
+		nChunk = nAvail;
+		if ( ( err = snd_pcm_mmap_begin( pHandle, &pAreas, &nOffset, &nChunk ) ) < 0 ) {
+			___ERRORLOG( QString( "Unable to access ring buffer: %1" )
+						 .arg( snd_strerror( err ) ) );
+			break;
+		}
+		snd_pcm_areas_silence( pAreas, nOffset, 2, nChunk, pDriver->m_format );
+		if ( snd_pcm_mmap_commit( pHandle, nOffset, nChunk ) < 0 ) {
+			break;
+		}
+	}
+
+	while ( pDriver->m_bIsRunning ) {
+		pDriver->m_processCallback( nFrames, nullptr );
+
+		int nWritten = 0;
+		while ( nWritten < nFrames && pDriver->m_bIsRunning ) {
+			nAvail = snd_pcm_avail_update( pHandle );
+			if ( nAvail < 0 ) {
+				if ( ! alsaAudioDriver_recover( pDriver, nAvail ) ) {
+					break;
+				}
+				continue;
+			}
+			else if ( nAvail == 0 ) {
+				alsaAudioDriver_wait( pDriver );
+				continue;
+			}
+
+			nChunk = std::min( static_cast<snd_pcm_uframes_t>( nAvail ),
+							   static_cast<snd_pcm_uframes_t>( nFrames - nWritten ) );
+			if ( ( err = snd_pcm_mmap_begin( pHandle, &pAreas, &nOffset, &nChunk ) ) < 0 ) {
+				if ( ! alsaAudioDriver_recover( pDriver, err ) ) {
+					break;
+				}
+				continue;
+			}
+
+			// Both channels are interleaved in the first area.
+			char* pDest = static_cast<char*>( pAreas[ 0 ].addr ) +
+				pAreas[ 0 ].first / 8 + nOffset * ( pAreas[ 0 ].step / 8 );
+			AlsaAudioDriver::convertFrames( pDriver->m_format, &pDriver->m_pOut_L[ nWritten ],
+											&pDriver->m_pOut_R[ nWritten ], pDest, nChunk );
+
+			nCommitted = snd_pcm_mmap_commit( pHandle, nOffset, nChunk );
+			if ( nCommitted < 0 ||
+				 static_cast<snd_pcm_uframes_t>( nCommitted ) != nChunk ) {
+				if ( ! alsaAudioDriver_recover( pDriver, nCommitted < 0 ? nCommitted : -EPIPE ) ) {
+					break;
+				}
+				continue;
+			}
+			nWritten += nChunk;
+		}
+	}
+}
+
 void* alsaAudioDriver_processCaller( void* param )
 {
 	Base *__object = (Base*)param;
@@ -68,83 +226,72 @@ void* alsaAudioDriver_processCaller( void* param )
 	}
 	__INFOLOG( QString( "Scheduling priority = %1" ).arg( sched.sched_priority ) );
 
-	sleep( 1 );
-
 	int err;
 	if ( ( err = snd_pcm_prepare( pDriver->m_pPlayback_handle ) ) < 0 ) {
 		__ERRORLOG( QString( "Cannot prepare audio interface for use: %1" )
 					.arg( snd_strerror ( err ) ) );
 	}
 
-	int nFrames = pDriver->m_nBufferSize;
-	__INFOLOG( QString( "nFrames: %1" ).arg( nFrames ) );
-	short pBuffer[ nFrames * 2 ];
+	__INFOLOG( QString( "nFrames: %1" ).arg( pDriver->m_nBufferSize ) );
 
-	float *pOut_L = pDriver->m_pOut_L;
-	float *pOut_R = pDriver->m_pOut_R;
+	if ( pDriver->m_bUseMmap ) {
+		alsaAudioDriver_processMmap( pDriver );
+	} else {
+		alsaAudioDriver_processReadWrite( pDriver );
+	}
 
-	int nTimeoutInMilliseconds = 100;
+	return nullptr;
+}
 
-	while ( pDriver->m_bIsRunning ) {
-		// prepare the audio data
-		pDriver->m_processCallback( nFrames, nullptr );
+/** Clips the frames to [-1,1], scales them by @a fScale, shifts the
+ * result by @a nShift bits, and interleaves them into @a pDest. Kept
+ * free of branches so the compiler is able to vectorize it. */
+template <typename T, int nShift>
+static void convertFramesToInteger( const float* __restrict__ pOut_L,
+									const float* __restrict__ pOut_R,
+									T* __restrict__ pDest, int nFrames, float fScale )
+{
+	for ( int i = 0; i < nFrames; ++i ) {
+		// The argument order maps NaNs onto -1.
+		const float fL = std::min( 1.0f, std::max( -1.0f, pOut_L[ i ] ) );
+		const float fR = std::min( 1.0f, std::max( -1.0f, pOut_R[ i ] ) );
+		pDest[ 2 * i ] = static_cast<T>( static_cast<int32_t>( fL * fScale ) * ( 1 << nShift ) );
+		pDest[ 2 * i + 1 ] = static_cast<T>( static_cast<int32_t>( fR * fScale ) * ( 1 << nShift ) );
+	}
+}
 
+bool AlsaAudioDriver::convertFrames( snd_pcm_format_t format, const float* pOut_L,
+									 const float* pOut_R, void* pDest, int nFrames )
+{
+	switch ( format ) {
+	case SND_PCM_FORMAT_FLOAT: {
+		// No clipping required. Values exceeding the unit range are
+		// handled by the device or the ALSA plugin layer.
+		float* pFloatDest = static_cast<float*>( pDest );
 		for ( int i = 0; i < nFrames; ++i ) {
-			pBuffer[ i * 2 ] = ( short )( pOut_L[ i ] * 32768.0 );
-			pBuffer[ i * 2 + 1 ] = ( short )( pOut_R[ i ] * 32768.0 );
-		}
-
-		// Check whether the playback stream is ready to process
-		// input.
-		if ( ( err = snd_pcm_wait( pDriver->m_pPlayback_handle,
-								   nTimeoutInMilliseconds ) ) < 1 ) {
-			// Playback stream is not ready. Since we opened the stream
-			// in blocking mode, the call to snd_pcm_writei() may take
-			// forever and cause the audio engine to stop working
-			// entirely. In addition, this also prevents the audio
-			// driver to be stopped and thus prevents the user from
-			// selecting a different/working version.
-			if ( err == 0 ) {
-				___ERRORLOG( QString( "timeout after [%1] milliseconds" )
-							 .arg( nTimeoutInMilliseconds ) );
-			} else {
-				___ERRORLOG( QString( "Error while waiting for playback stream: %1" )
-							 .arg( snd_strerror( err ) ) );
-			}
-			pDriver->m_nXRuns++;
-			EventQueue::get_instance()->push_event( EVENT_XRUN, 0 );
-		} else {
-
-			// Playback stream is ready, let's write out the audio
-			// buffer.
-			if ( ( err = snd_pcm_writei( pDriver->m_pPlayback_handle, pBuffer, nFrames ) ) < 0 ) {
-				___ERRORLOG( QString( "Error while writing playback stream: %1" )
-							 .arg( snd_strerror( err ) ) );
-
-				// Try to bring the playback device in a nice state
-				// again and retry writing the output buffer.
-				if ( ( err = snd_pcm_recover( pDriver->m_pPlayback_handle, err, 0 ) ) == 0 ) {
-					___INFOLOG( "Successfully recovered from error. Attempt to write buffer again." );
-					if ( ( err = snd_pcm_writei( pDriver->m_pPlayback_handle, pBuffer, nFrames ) ) < 0 ) {
-						___ERRORLOG( QString( "Unable to write playback stream again: %1" )
-									 .arg( snd_strerror( err ) ) );
-						pDriver->m_nXRuns++;
-						EventQueue::get_instance()->push_event( EVENT_XRUN, 0 );
-						if ( ( err = snd_pcm_recover( pDriver->m_pPlayback_handle, err, 0 ) ) < 0 ) {
-							__ERRORLOG( QString( "Can't recover from XRUN: %1" )
-										.arg( snd_strerror( err ) ) );
-						}
-					}
-				} else {
-					__ERRORLOG( QString( "Can't recover from XRUN: %1" )
-								.arg( snd_strerror( err ) ) );
-					pDriver->m_nXRuns++;
-					EventQueue::get_instance()->push_event( EVENT_XRUN, 0 );
-				}
-			}
+			pFloatDest[ 2 * i ] = pOut_L[ i ];
+			pFloatDest[ 2 * i + 1 ] = pOut_R[ i ];
 		}
+		break;
 	}
-	return nullptr;
+	case SND_PCM_FORMAT_S32:
+		// Floats do not provide more than 24 bits of precision.
+		convertFramesToInteger<int32_t, 8>( pOut_L, pOut_R, static_cast<int32_t*>( pDest ),
+											nFrames, 8388607.0f );
+		break;
+	case SND_PCM_FORMAT_S24:
+		// 24 bit stored in the lower three bytes of 32 bit.
+		convertFramesToInteger<int32_t, 0>( pOut_L, pOut_R, static_cast<int32_t*>( pDest ),
+											nFrames, 8388607.0f );
+		break;
+	case SND_PCM_FORMAT_S16:
+		convertFramesToInteger<int16_t, 0>( pOut_L, pOut_R, static_cast<int16_t*>( pDest ),
+											nFrames, 32767.0f );
+		break;
+	default:
+		return false;
+	}
+	return true;
 }
 
 
@@ -189,6 +336,11 @@ AlsaAudioDriver::AlsaAudioDriver( audioProcessCallback processCallback )
 		, m_nBufferSize( 0 )
 		, m_pPlayback_handle( nullptr )
 		, m_processCallback( processCallback )
+		, m_format( SND_PCM_FORMAT_UNKNOWN )
+		, m_bUseMmap( false )
+		, m_nPeriods( 0 )
+		, m_nLatency( 0 )
+		, m_pBuffer( nullptr )
 {
 	m_nSampleRate = Preferences::get_instance()->m_nSampleRate;
 	m_sAlsaAudioDevice = Preferences::get_instance()->m_sAlsaAudioDevice;
@@ -271,9 +423,19 @@ int AlsaAudioDriver::connect()
 				  .arg( QString::fromLocal8Bit(snd_strerror(err)) ) );
 		return 1;
 	}
-//	snd_pcm_hw_params_set_access( m_pPlayback_handle, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED  );
+	m_bUseMmap = Preferences::get_instance()->m_bAlsaMmap;
+	if ( m_bUseMmap &&
+		 ( err = snd_pcm_hw_params_set_access( m_pPlayback_handle,
+											   hw_params,
+											   SND_PCM_ACCESS_MMAP_INTERLEAVED ) ) < 0 ) {
+		WARNINGLOG( QString( "mmap access not supported by audio device [%1]: %2. Falling back to read/write access." )
+					.arg( m_sAlsaAudioDevice )
+					.arg( QString::fromLocal8Bit(snd_strerror(err)) ) );
+		m_bUseMmap = false;
+	}
 
-	if ( ( err = snd_pcm_hw_params_set_access( m_pPlayback_handle,
+	if ( ! m_bUseMmap &&
+		 ( err = snd_pcm_hw_params_set_access( m_pPlayback_handle,
 											   hw_params,
 											   SND_PCM_ACCESS_RW_INTERLEAVED ) ) < 0 ) {
 		ERRORLOG( QString( "error in snd_pcm_hw_params_set_access: %1" )
@@ -281,9 +443,26 @@ int AlsaAudioDriver::connect()
 		return 1;
 	}
 
+	// Use the most accurate sample format supported by the device
+	// natively. This way the ALSA plugin layer does not have to
+	// convert it once again.
+	m_format = SND_PCM_FORMAT_UNKNOWN;
+	for ( const auto& format : { SND_PCM_FORMAT_FLOAT, SND_PCM_FORMAT_S32,
+								 SND_PCM_FORMAT_S24, SND_PCM_FORMAT_S16 } ) {
+		if ( snd_pcm_hw_params_test_format( m_pPlayback_handle, hw_params, format ) == 0 ) {
+			m_format = format;
+			break;
+		}
+	}
+	if ( m_format == SND_PCM_FORMAT_UNKNOWN ) {
+		ERRORLOG( QString( "Audio device [%1] does not support any of the float, 32, 24, or 16 bit formats" )
+				  .arg( m_sAlsaAudioDevice ) );
+		return 1;
+	}
+
 	if ( ( err = snd_pcm_hw_params_set_format( m_pPlayback_handle,
 											   hw_params,
-											   SND_PCM_FORMAT_S16_LE ) ) < 0 ) {
+											   m_format ) ) < 0 ) {
 		ERRORLOG( QString( "error in snd_pcm_hw_params_set_format: %1" )
 				  .arg( QString::fromLocal8Bit(snd_strerror(err)) ) );
 		return 1;
@@ -306,9 +485,10 @@ int AlsaAudioDriver::connect()
 	// number of frames processed in a callback period. In ALSA, this
 	// is the "period", whereas the actual buffer (as reported by
 	// *_get_buffer_size) is sized to keep at least 2 periods' worth
-	// of data.
+	// of data. Low latency setups are served by either 2 or 3
+	// periods.
 	//
-	unsigned nPeriods = 2;
+	unsigned nPeriods = Preferences::get_instance()->m_nAlsaPeriods;
 	if ( ( err = snd_pcm_hw_params_set_periods_near( m_pPlayback_handle,
 													 hw_params,
 													 &nPeriods,
@@ -318,6 +498,7 @@ int AlsaAudioDriver::connect()
 		return 1;
 	}
 	INFOLOG( QString( "nPeriods: %1" ).arg( nPeriods ) );
+	m_nPeriods = nPeriods;
 
 	snd_pcm_uframes_t period_size = m_nBufferSize;
 
@@ -338,15 +519,47 @@ int AlsaAudioDriver::connect()
 	}
 
 	snd_pcm_hw_params_get_rate( hw_params, &m_nSampleRate, nullptr );
+	snd_pcm_hw_params_get_periods( hw_params, &m_nPeriods, nullptr );
+
+	snd_pcm_uframes_t buffer_size = nPeriods * m_nBufferSize;
+	snd_pcm_hw_params_get_buffer_size( hw_params, &buffer_size );
+	m_nLatency = buffer_size;
 
 	INFOLOG( QString( "*** PERIOD SIZE: %1" ).arg( period_size ) );
+	INFOLOG( QString( "*** PERIODS: %1" ).arg( m_nPeriods ) );
 	INFOLOG( QString( "*** SAMPLE RATE: %1" ).arg( m_nSampleRate ) );
-	INFOLOG( QString( "*** BUFFER SIZE: %1" ).arg( nPeriods * m_nBufferSize ) );
+	INFOLOG( QString( "*** BUFFER SIZE: %1" ).arg( buffer_size ) );
+	INFOLOG( QString( "*** LATENCY: %1 ms" )
+			 .arg( 1000.0 * buffer_size / m_nSampleRate, 0, 'f', 2 ) );
+	INFOLOG( QString( "*** FORMAT: %1 (%2)" )
+			 .arg( snd_pcm_format_name( m_format ) )
+			 .arg( m_bUseMmap ? "mmap" : "read/write" ) );
 
 	//snd_pcm_hw_params_free( hw_params );
 
-	m_pOut_L = new float[ m_nBufferSize ];
-	m_pOut_R = new float[ m_nBufferSize ];
+	// Start the stream as soon as the ring buffer was filled
+	// completely and wake up the driver thread once a whole period
+	// can be written.
+	snd_pcm_sw_params_t *sw_params;
+	snd_pcm_sw_params_alloca( &sw_params );
+	if ( ( err = snd_pcm_sw_params_current( m_pPlayback_handle, sw_params ) ) < 0 ||
+		 ( err = snd_pcm_sw_params_set_start_threshold(
+			 m_pPlayback_handle, sw_params,
+			 ( buffer_size / m_nBufferSize ) * m_nBufferSize ) ) < 0 ||
+		 ( err = snd_pcm_sw_params_set_avail_min( m_pPlayback_handle, sw_params,
+												  m_nBufferSize ) ) < 0 ||
+		 ( err = snd_pcm_sw_params( m_pPlayback_handle, sw_params ) ) < 0 ) {
+		WARNINGLOG( QString( "Unable to set software parameters: %1" )
+					.arg( QString::fromLocal8Bit(snd_strerror(err)) ) );
+	}
+
+	m_pOut_L = AudioBufferArena::get_instance()->allocate( m_nBufferSize, 2 );
+	m_pOut_R = m_pOut_L + AudioBufferArena::stride( m_nBufferSize );
+
+	if ( ! m_bUseMmap ) {
+		m_pBuffer = new char[ m_nBufferSize * 2 *
+							  snd_pcm_format_physical_width( m_format ) / 8 ];
+	}
 
 	memset( m_pOut_L, 0, m_nBufferSize * sizeof( float ) );
 	memset( m_pOut_R, 0, m_nBufferSize * sizeof( float ) );
@@ -374,11 +587,12 @@ void AlsaAudioDriver::disconnect()
 
 	snd_pcm_close( m_pPlayback_handle );
 
-	delete[] m_pOut_L;
+	AudioBufferArena::get_instance()->release( m_pOut_L );
 	m_pOut_L = nullptr;
-
-	delete[] m_pOut_R;
 	m_pOut_R = nullptr;
+
+	delete[] m_pBuffer;
+	m_pBuffer = nullptr;
 }
 
 unsigned AlsaAudioDriver::getBufferSize()
@@ -46,6 +46,18 @@ public:
 	QString m_sAlsaAudioDevice;
 	audioProcessCallback m_processCallback;
 	int m_nXRuns;
+	/** Sample format negotiated with the device. */
+	snd_pcm_format_t m_format;
+	/** Whether the driver renders directly into the ring buffer of
+	 * the device (see Preferences::m_bAlsaMmap). */
+	bool m_bUseMmap;
+	/** Number of periods in the ring buffer of the device. */
+	unsigned m_nPeriods;
+	/** Size of the ring buffer of the device in frames. */
+	int m_nLatency;
+	/** Interleaved buffer in #m_format used to pass a period to
+	 * snd_pcm_writei() in case mmap access is not used. */
+	char* m_pBuffer;
 
 	AlsaAudioDriver( audioProcessCallback processCallback );
 	~AlsaAudioDriver();
@@ -60,6 +72,20 @@ public:
 	static QStringList getDevices();
 
 	virtual int getXRuns() const override { return m_nXRuns; }
+	/** \return Size of the ring buffer of the device, which is
+	 * about the time it takes for a frame rendered by the audio
+	 * engine to become audible. */
+	virtual int getLatency() override { return m_nLatency; }
+
+	/**
+	 * Converts @a nFrames frames of the float buffers of the audio
+	 * engine into @a format and interleaves them into @a pDest.
+	 * Integer formats are clipped to their range.
+	 *
+	 * \return false if @a format is not supported.
+	 */
+	static bool convertFrames( snd_pcm_format_t format, const float* pOut_L,
+							   const float* pOut_R, void* pDest, int nFrames );
 	
 private:
 
@@ -0,0 +1,144 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/IO/BenchmarkDriver.h>
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/Hydrogen.h>
+#include <core/Helpers/AudioBufferArena.h>
+#include <core/Preferences/Preferences.h>
+#include <core/Sampler/Sampler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace H2Core
+{
+
+BenchmarkDriver::BenchmarkDriver( audioProcessCallback processCallback )
+		: AudioOutput()
+		, m_processCallback( processCallback )
+		, m_nBufferSize( 0 )
+		, m_nSampleRate( 44100 )
+		, m_pOut_L( nullptr )
+		, m_pOut_R( nullptr )
+		, m_nDeadlineMisses( 0 ) {
+}
+
+BenchmarkDriver::~BenchmarkDriver() {
+	disconnect();
+}
+
+int BenchmarkDriver::init( unsigned nBufferSize )
+{
+	INFOLOG( QString( "Init, %1 samples" ).arg( nBufferSize ) );
+
+	m_nBufferSize = nBufferSize;
+	m_nSampleRate = Preferences::get_instance()->m_nSampleRate;
+	m_pOut_L = AudioBufferArena::get_instance()->allocate( nBufferSize, 2 );
+	m_pOut_R = m_pOut_L + AudioBufferArena::stride( nBufferSize );
+
+	return 0;
+}
+
+int BenchmarkDriver::connect()
+{
+	INFOLOG( "connect" );
+	return 0;
+}
+
+void BenchmarkDriver::disconnect()
+{
+	AudioBufferArena::get_instance()->release( m_pOut_L );
+	m_pOut_L = nullptr;
+	m_pOut_R = nullptr;
+}
+
+BenchmarkDriver::Statistics BenchmarkDriver::run( int nCycles, bool bPaced )
+{
+	using Clock = std::chrono::steady_clock;
+
+	Statistics stats;
+	stats.nBufferSize = m_nBufferSize;
+	stats.nSampleRate = m_nSampleRate;
+	stats.nCycles = nCycles;
+	stats.fDeadline = 1e6 * m_nBufferSize / m_nSampleRate;
+	stats.nVoices = 0;
+	m_nDeadlineMisses = 0;
+
+	auto pSampler = Hydrogen::get_instance()->getAudioEngine()->getSampler();
+	const auto period = std::chrono::nanoseconds(
+		static_cast<long long>( 1e9 * m_nBufferSize / m_nSampleRate ) );
+
+	std::vector<double> times;
+	times.reserve( nCycles );
+	auto nextCycle = Clock::now();
+	for ( int ii = 0; ii < nCycles; ++ii ) {
+		if ( bPaced ) {
+			std::this_thread::sleep_until( nextCycle );
+			nextCycle += period;
+		}
+
+		const auto start = Clock::now();
+		m_processCallback( m_nBufferSize, nullptr );
+		const auto end = Clock::now();
+
+		const double fTime =
+			std::chrono::duration<double, std::micro>( end - start ).count();
+		times.push_back( fTime );
+		if ( fTime > stats.fDeadline ) {
+			++m_nDeadlineMisses;
+			// A device would have dropped the periods in question
+			// and continue with the next one.
+			if ( bPaced && nextCycle < end ) {
+				nextCycle = end + period;
+			}
+		}
+		stats.nVoices += pSampler->getPlayingNotesNumber();
+	}
+
+	double fTotal = 0;
+	for ( const auto& fTime : times ) {
+		fTotal += fTime;
+	}
+	std::sort( times.begin(), times.end() );
+
+	stats.fMean = nCycles > 0 ? fTotal / nCycles : 0;
+	stats.fMedian = percentile( times, 0.5 );
+	stats.fP99 = percentile( times, 0.99 );
+	stats.fMax = times.empty() ? 0 : times.back();
+	stats.nDeadlineMisses = m_nDeadlineMisses;
+	stats.fVoicesPerSecond = fTotal > 0 ? stats.nVoices / ( fTotal * 1e-6 ) : 0;
+
+	return stats;
+}
+
+double BenchmarkDriver::percentile( const std::vector<double>& sorted, double fPercentile )
+{
+	if ( sorted.empty() ) {
+		return 0;
+	}
+	const int nRank = static_cast<int>( std::ceil( fPercentile * sorted.size() ) );
+	return sorted[ std::clamp( nRank - 1, 0, static_cast<int>( sorted.size() ) - 1 ) ];
+}
+
+};
@@ -0,0 +1,126 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef BENCHMARK_DRIVER_H
+#define BENCHMARK_DRIVER_H
+
+#include <core/IO/AudioOutput.h>
+
+#include <inttypes.h>
+#include <vector>
+
+namespace H2Core
+{
+
+/**
+ * Headless audio driver emulating the clock of a realtime audio
+ * device. Used for benchmarking only.
+ *
+ * In contrast to the FakeDriver it does not run on its own. Instead,
+ * run() processes a given number of cycles of #m_nBufferSize frames
+ * and measures the time each call of the process callback takes. If
+ * pacing is enabled, every cycle starts at the next period boundary
+ * of a virtual device clock running at #m_nSampleRate, just like the
+ * callback of a hardware driver would.
+ *
+ * The buffer size and sample rate are taken from the
+ * Preferences. Any value of the former between 32 and 2048 frames is
+ * supported.
+ */
+/** \ingroup docCore docAudioDriver */
+class BenchmarkDriver : public Object<BenchmarkDriver>, public AudioOutput
+{
+	H2_OBJECT(BenchmarkDriver)
+public:
+	/** Timing of a sequence of process cycles. */
+	struct Statistics {
+		unsigned nBufferSize;
+		unsigned nSampleRate;
+		int nCycles;
+		/** Time available to process a single cycle in
+		 * microseconds. */
+		double fDeadline;
+		/** Processing times of individual cycles in microseconds. */
+		double fMean;
+		double fMedian;
+		double fP99;
+		double fMax;
+		/** Number of cycles which took longer than #fDeadline. */
+		int nDeadlineMisses;
+		/** Sum of all voices rendered by the Sampler in each
+		 * cycle. */
+		long long nVoices;
+		/** Number of voices rendered for a whole cycle per second
+		 * of processing time. */
+		double fVoicesPerSecond;
+	};
+
+	BenchmarkDriver( audioProcessCallback processCallback );
+	~BenchmarkDriver();
+
+	virtual int init( unsigned nBufferSize ) override;
+	virtual int connect() override;
+	virtual void disconnect() override;
+	virtual unsigned getBufferSize() override {
+		return m_nBufferSize;
+	}
+	virtual unsigned getSampleRate() override {
+		return m_nSampleRate;
+	}
+	/** \return Number of deadline misses since the last call to
+	 * run(). */
+	virtual int getXRuns() const override {
+		return m_nDeadlineMisses;
+	}
+
+	virtual float* getOut_L() override {
+		return m_pOut_L;
+	}
+	virtual float* getOut_R() override {
+		return m_pOut_R;
+	}
+
+	/**
+	 * Processes @a nCycles cycles.
+	 *
+	 * \param bPaced Whether to wait for the next period of the
+	 * virtual device clock between cycles. If false, cycles are
+	 * processed back to back, which is faster but keeps the CPU
+	 * caches warmer than a real device would.
+	 */
+	Statistics run( int nCycles, bool bPaced );
+
+	/** \return @a fPercentile (0 to 1) of the sorted values @a
+	 * sorted using the nearest rank method. */
+	static double percentile( const std::vector<double>& sorted, double fPercentile );
+
+private:
+	audioProcessCallback m_processCallback;
+	unsigned m_nBufferSize;
+	unsigned m_nSampleRate;
+	float* m_pOut_L;
+	float* m_pOut_R;
+	int m_nDeadlineMisses;
+};
+
+};
+
+#endif
@@ -27,6 +27,7 @@
 #include <core/EventQueue.h>
 #include <core/CoreActionController.h>
 #include <core/Hydrogen.h>
+#include <core/Helpers/AudioBufferArena.h>
 #include <core/Basics/Pattern.h>
 #include <core/Basics/PatternList.h>
 #include <core/IO/DiskWriterDriver.h>
@@ -144,7 +145,8 @@ void* diskWriterDriver_thread( void* param )
 
 	SNDFILE* m_file = sf_open( pDriver->m_sFilename.toLocal8Bit(), SFM_WRITE, &soundInfo );
 
-	float *pData = new float[ pDriver->m_nBufferSize * 2 ];	// always stereo
+	// always stereo
+	float *pData = AudioBufferArena::get_instance()->allocate( pDriver->m_nBufferSize * 2 );
 
 	float *pData_L = pDriver->m_pOut_L;
 	float *pData_R = pDriver->m_pOut_R;
@@ -281,7 +283,7 @@ void* diskWriterDriver_thread( void* param )
 		float fPercent = ( float )(patternPosition +1) / ( float )nColumns * 100.0;
 		EventQueue::get_instance()->push_event( EVENT_PROGRESS, ( int )fPercent );
 	}
-	delete[] pData;
+	AudioBufferArena::get_instance()->release( pData );
 	pData = nullptr;
 
 	sf_close( m_file );
@@ -301,7 +303,8 @@ DiskWriterDriver::DiskWriterDriver( audioProcessCallback processCallback )
 		, m_processCallback( processCallback )
 		, m_nBufferSize( 1024 )
 		, m_pOut_L( nullptr )
-		, m_pOut_R( nullptr ) {
+		, m_pOut_R( nullptr )
+		, m_bDeterministic( false ) {
 }
 
 
@@ -313,12 +316,18 @@ DiskWriterDriver::~DiskWriterDriver() {
 
 int DiskWriterDriver::init( unsigned nBufferSize )
 {
-	INFOLOG( QString( "Init, buffer size: %1" ).arg( nBufferSize ) );
+	m_bDeterministic = Preferences::get_instance()->m_bDeterministicExport;
+	if ( m_bDeterministic ) {
+		nBufferSize = nDeterministicBufferSize;
+	}
+
+	INFOLOG( QString( "Init, buffer size: %1, deterministic: %2" )
+			 .arg( nBufferSize ).arg( m_bDeterministic ) );
 
 	m_nBufferSize = nBufferSize;
 	
-	m_pOut_L = new float[ m_nBufferSize ];
-	m_pOut_R = new float[ m_nBufferSize ];
+	m_pOut_L = AudioBufferArena::get_instance()->allocate( m_nBufferSize, 2 );
+	m_pOut_R = m_pOut_L + AudioBufferArena::stride( m_nBufferSize );
 
 	return 0;
 }
@@ -345,10 +354,8 @@ void DiskWriterDriver::disconnect()
 
 	pthread_join( diskWriterDriverThread, NULL );
 
-	delete[] m_pOut_L;
+	AudioBufferArena::get_instance()->release( m_pOut_L );
 	m_pOut_L = nullptr;
-
-	delete[] m_pOut_R;
 	m_pOut_R = nullptr;
 
 }
@@ -43,6 +43,10 @@ class DiskWriterDriver : public Object<DiskWriterDriver>, public AudioOutput
 	H2_OBJECT(DiskWriterDriver)
 	public:
 
+		/** Buffer size used in deterministic mode regardless of the
+		 * one set in the Preferences. */
+		static constexpr unsigned nDeterministicBufferSize = 1024;
+
 		unsigned				m_nSampleRate;
 		QString					m_sFilename;
 		unsigned				m_nBufferSize;
@@ -84,8 +88,20 @@ class DiskWriterDriver : public Object<DiskWriterDriver>, public AudioOutput
 			m_sFilename = sFilename;
 		}
 
-	private:
+		/**
+		 * Whether the export is rendered deterministically, see
+		 * Preferences::m_bDeterministicExport.
+		 *
+		 * In this mode #nDeterministicBufferSize is used as buffer
+		 * size and the audio engine is locked without a timeout
+		 * instead of retrying the cycle.
+		 */
+		bool isDeterministic() const {
+			return m_bDeterministic;
+		}
 
+	private:
+		bool					m_bDeterministic;
 
 };
 
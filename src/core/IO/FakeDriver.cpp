@@ -23,6 +23,7 @@
 #include <core/IO/FakeDriver.h>
 #include <core/AudioEngine/AudioEngine.h>
 #include <core/Hydrogen.h>
+#include <core/Helpers/AudioBufferArena.h>
 #include <core/Preferences/Preferences.h>
 
 namespace H2Core
@@ -48,8 +49,8 @@ int FakeDriver::init( unsigned nBufferSize )
 
 	m_nBufferSize = nBufferSize;
 	m_nSampleRate = Preferences::get_instance()->m_nSampleRate;
-	m_pOut_L = new float[nBufferSize];
-	m_pOut_R = new float[nBufferSize];
+	m_pOut_L = AudioBufferArena::get_instance()->allocate( nBufferSize, 2 );
+	m_pOut_R = m_pOut_L + AudioBufferArena::stride( nBufferSize );
 
 	return 0;
 }
@@ -70,10 +71,8 @@ void FakeDriver::disconnect()
 {
 	INFOLOG( "disconnect" );
 
-	delete[] m_pOut_L;
+	AudioBufferArena::get_instance()->release( m_pOut_L );
 	m_pOut_L = nullptr;
-
-	delete[] m_pOut_R;
 	m_pOut_R = nullptr;
 }
 
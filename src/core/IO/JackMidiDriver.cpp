@@ -30,12 +30,16 @@
 
 #include <core/Preferences/Preferences.h>
 #include <core/Hydrogen.h>
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/AudioEngine/TransportPosition.h>
 #include <core/Globals.h>
 #include <core/EventQueue.h>
 #include <core/Basics/Note.h>
 #include <core/Basics/Instrument.h>
 #include <core/Basics/InstrumentList.h>
 
+#include <algorithm>
+
 #ifdef H2CORE_HAVE_LASH
 #include <core/Lash/LashClient.h>
 #endif
@@ -43,18 +47,6 @@
 namespace H2Core
 {
 
-void
-JackMidiDriver::lock(void)
-{
-	pthread_mutex_lock(&mtx);
-}
-
-void
-JackMidiDriver::unlock(void)
-{
-	pthread_mutex_unlock(&mtx);
-}
-
 void
 JackMidiDriver::JackMidiWrite(jack_nframes_t nframes)
 {
@@ -217,22 +209,18 @@ JackMidiDriver::handleOutgoingControlChange( int param, int value, int channel )
 		return;
 	}
 
-	buffer[0] = 0xB0 | channel;	/* note off */
+	buffer[0] = 0xB0 | channel;	/* control change */
 	buffer[1] = param;
 	buffer[2] = value;
 	buffer[3] = 0;
 
-	JackMidiOutEvent(buffer, 3);
+	m_eventQueue.pushControl(buffer, 3);
 }
 
 void
 JackMidiDriver::JackMidiRead(jack_nframes_t nframes)
 {
-	uint8_t *buffer;
 	void *buf;
-	jack_nframes_t t;
-	uint8_t data[1];
-	uint8_t len;
 
 	if (output_port == nullptr) {
 		return;
@@ -249,68 +237,33 @@ JackMidiDriver::JackMidiRead(jack_nframes_t nframes)
 	jack_midi_clear_buffer(buf);
 #endif
 
-	t = 0;
-	lock();
-	while ((t < nframes) &&
-		   (rx_out_pos != rx_in_pos)) {
-
-				len = jack_buffer[4 * rx_in_pos];
-		if (len == 0) {
-			rx_in_pos++;
-			if (rx_in_pos >= JACK_MIDI_BUFFER_MAX) {
-				rx_in_pos = 0;
-			}
-			continue;
-		}
-
+	m_eventQueue.dispatch( jack_last_frame_time(jack_client), nframes,
+						   [&]( uint32_t nOffset, const uint8_t* pData, uint8_t nLength ) {
 #ifdef JACK_MIDI_NEEDS_NFRAMES
-		buffer = jack_midi_event_reserve(buf, t, len, nframes);
+		uint8_t* buffer = jack_midi_event_reserve(buf, nOffset, nLength, nframes);
 #else
-		buffer = jack_midi_event_reserve(buf, t, len);
+		uint8_t* buffer = jack_midi_event_reserve(buf, nOffset, nLength);
 #endif
 		if (buffer == nullptr) {
-			break;
+			return false;
 		}
-		t++;
-		rx_in_pos++;
-		if (rx_in_pos >= JACK_MIDI_BUFFER_MAX) {
-			rx_in_pos = 0;
-		}
-		memcpy(buffer, jack_buffer + (4 * rx_in_pos) + 1, len);
-	}
-	unlock();
+		memcpy(buffer, pData, nLength);
+		return true;
+	});
 }
 
-void
-JackMidiDriver::JackMidiOutEvent(uint8_t buf[4], uint8_t len)
+jack_nframes_t
+JackMidiDriver::frameToJackTime( long long nFrame ) const
 {
-	uint32_t next_pos;
-
-	lock();
-
-	next_pos = rx_out_pos + 1;
-	if (next_pos >= JACK_MIDI_BUFFER_MAX) {
-		next_pos = 0;
-	}
-
-	if (next_pos == rx_in_pos) {
-		/* buffer is full */
-		unlock();
-		return;
-	}
-
-	if (len > 3) {
-		len = 3;
-	}
-
-	jack_buffer[(4 * next_pos)] = len;
-	jack_buffer[(4 * next_pos) + 1] = buf[0];
-	jack_buffer[(4 * next_pos) + 2] = buf[1];
-	jack_buffer[(4 * next_pos) + 3] = buf[2];
-
-	rx_out_pos = next_pos;
-
-	unlock();
+	auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+
+	// The JACK clock is shared by all clients of the server. Within
+	// the audio thread of the JackAudioDriver this is the start of
+	// the cycle currently rendered.
+	const long long nOffset = pAudioEngine->computeFrameOffsetInPeriod( nFrame );
+	return jack_last_frame_time(jack_client) +
+		jack_get_buffer_size(jack_client) +
+		static_cast<jack_nframes_t>( nOffset );
 }
 
 static int
@@ -338,11 +291,7 @@ JackMidiShutdown(void *arg)
 JackMidiDriver::JackMidiDriver()
 	: MidiInput(), MidiOutput(), Object<JackMidiDriver>()
 {
-	pthread_mutex_init(&mtx, nullptr);
-
 	running = 0;
-	rx_in_pos = 0;
-	rx_out_pos = 0;
 	output_port = nullptr;
 	input_port = nullptr;
 
@@ -405,8 +354,6 @@ JackMidiDriver::~JackMidiDriver()
 			ERRORLOG("Failed close jack midi client");
 		}
 	}
-	pthread_mutex_destroy(&mtx);
-
 }
 
 void
@@ -477,19 +424,21 @@ void JackMidiDriver::handleQueueNote(Note* pNote)
 		return;
 	}
 
+	const jack_nframes_t nTime = frameToJackTime( pNote->getNoteStart() );
+
 	buffer[0] = 0x80 | channel;	/* note off */
 	buffer[1] = key;
 	buffer[2] = 0;
 	buffer[3] = 0;
 
-	JackMidiOutEvent(buffer, 3);
+	m_eventQueue.pushRealtime(nTime, buffer, 3);
 
 	buffer[0] = 0x90 | channel;	/* note on */
 	buffer[1] = key;
 	buffer[2] = vel;
 	buffer[3] = 0;
 
-	JackMidiOutEvent(buffer, 3);
+	m_eventQueue.pushRealtime(nTime, buffer, 3);
 }
 
 void
@@ -514,10 +463,38 @@ JackMidiDriver::handleQueueNoteOff(int channel, int key, int vel)
 	buffer[2] = 0;
 	buffer[3] = 0;
 
-	JackMidiOutEvent(buffer, 3);
+	m_eventQueue.pushControl(buffer, 3);
 }
 
-void JackMidiDriver::handleQueueAllNoteOff()
+void
+JackMidiDriver::handleQueueNoteOffAt(int channel, int key, int vel, long long nFrame)
+{
+	uint8_t buffer[4];
+
+	if (channel < 0 || channel > 15) {
+		return;
+	}
+
+	if (key < 0 || key > 127) {
+		return;
+	}
+
+	if (vel < 0 || vel > 127) {
+		return;
+	}
+
+	buffer[0] = 0x80 | channel;	/* note off */
+	buffer[1] = key;
+	buffer[2] = 0;
+	buffer[3] = 0;
+
+	m_eventQueue.pushRealtime(frameToJackTime( nFrame ), buffer, 3);
+}
+
+/** Calls @a noteOff( channel, key ) for the MIDI output note of each
+ * instrument of the current song. */
+template <typename F>
+static void forAllMidiOutNotes( F noteOff )
 {
 	auto pInstrList = Hydrogen::get_instance()->getSong()->getInstrumentList();
 	std::shared_ptr<Instrument>		pCurInstr;
@@ -539,10 +516,34 @@ void JackMidiDriver::handleQueueAllNoteOff()
 			continue;
 		}
 
-		handleQueueNoteOff(channel, key, 0);
+		noteOff(channel, key);
 	}
 }
 
+void JackMidiDriver::handleQueueAllNoteOff()
+{
+	forAllMidiOutNotes( [&]( int channel, int key ) {
+		handleQueueNoteOff(channel, key, 0);
+	});
+}
+
+void JackMidiDriver::handleQueueAllNoteOffAt( long long nFrame )
+{
+	// Scheduled like the notes rendered before so the note offs
+	// can not overtake note ons still pending.
+	const jack_nframes_t nTime = frameToJackTime( nFrame );
+	forAllMidiOutNotes( [&]( int channel, int key ) {
+		const uint8_t buffer[3] = { static_cast<uint8_t>(0x80 | channel),
+									static_cast<uint8_t>(key), 0 };
+		m_eventQueue.pushRealtime(nTime, buffer, 3);
+	});
+}
+
+void JackMidiDriver::clearQueue()
+{
+	m_eventQueue.pushClear();
+}
+
 };
 
 #endif			/* H2CORE_HAVE_JACK */
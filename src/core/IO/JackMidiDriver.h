@@ -32,17 +32,14 @@
 
 #if defined(H2CORE_HAVE_JACK) || _DOXYGEN_
 
-#include <pthread.h>
+#include <core/IO/MidiEventQueue.h>
 
 #include <jack/jack.h>
 #include <jack/midiport.h>
-#include <jack/ringbuffer.h>
 
 #include <string>
 #include <vector>
 
-#define	JACK_MIDI_BUFFER_MAX 64	/* events */
-
 namespace H2Core
 {
 
@@ -65,23 +62,31 @@ public:
 	
 	virtual void handleQueueNote(Note* pNote) override;
 	virtual void handleQueueNoteOff( int channel, int key, int velocity ) override;
+	virtual void handleQueueNoteOffAt( int channel, int key, int velocity, long long nFrame ) override;
 	virtual void handleQueueAllNoteOff() override;
+	virtual void handleQueueAllNoteOffAt( long long nFrame ) override;
+	virtual void clearQueue() override;
 	virtual void handleOutgoingControlChange( int param, int value, int channel ) override;
 
 private:
-	void JackMidiOutEvent(uint8_t *buf, uint8_t len);
-
-	void lock();
-	void unlock();
+	/**
+	 * Maps @a nFrame, given in the frame domain of
+	 * Note::getNoteStart(), onto the JACK clock.
+	 *
+	 * Messages are delayed by exactly one period. This way all notes
+	 * rendered within the current cycle of the audio engine are sent
+	 * during the next cycle of this client at the very same offsets
+	 * they have been rendered at.
+	 */
+	jack_nframes_t frameToJackTime( long long nFrame ) const;
 
 	jack_port_t *output_port;
 	jack_port_t *input_port;
 	jack_client_t *jack_client;
-	pthread_mutex_t mtx;
 	int running;
-		uint8_t jack_buffer[JACK_MIDI_BUFFER_MAX * 4];
-	uint32_t rx_in_pos;
-	uint32_t rx_out_pos;
+	/** Outgoing messages. Written by the audio engine and the GUI,
+	 * read in the JACK process callback. */
+	MidiEventQueue m_eventQueue;
 };
 
 };
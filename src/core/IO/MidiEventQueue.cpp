@@ -0,0 +1,120 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/IO/MidiEventQueue.h>
+
+#include <algorithm>
+
+namespace H2Core
+{
+
+MidiEventQueue::MidiEventQueue()
+	: m_nPending( 0 )
+	, m_nImmediate( 0 )
+	, m_nDroppedMessages( 0 )
+{
+}
+
+static TimedMidiMessage createMessage( uint32_t nFrame, const uint8_t* pData, uint8_t nLength ) {
+	TimedMidiMessage msg;
+	msg.nFrame = nFrame;
+	msg.nLength = std::min( nLength, static_cast<uint8_t>( sizeof( msg.data ) ) );
+	std::fill( msg.data, msg.data + sizeof( msg.data ), 0 );
+	std::copy( pData, pData + msg.nLength, msg.data );
+	return msg;
+}
+
+bool MidiEventQueue::pushRealtime( uint32_t nFrame, const uint8_t* pData, uint8_t nLength )
+{
+	if ( nLength == 0 ) {
+		// Reserved for pushClear().
+		return false;
+	}
+	if ( ! m_realtimeQueue.push( createMessage( nFrame, pData, nLength ) ) ) {
+		++m_nDroppedMessages;
+		return false;
+	}
+	return true;
+}
+
+bool MidiEventQueue::pushControl( const uint8_t* pData, uint8_t nLength )
+{
+	std::lock_guard<std::mutex> lock( m_controlMutex );
+	if ( ! m_controlQueue.push( createMessage( 0, pData, nLength ) ) ) {
+		++m_nDroppedMessages;
+		return false;
+	}
+	return true;
+}
+
+void MidiEventQueue::insertPending( const TimedMidiMessage& msg )
+{
+	if ( m_nPending >= nCapacity ) {
+		++m_nDroppedMessages;
+		return;
+	}
+
+	// Messages are usually pushed in chronological order. Searching
+	// from the back keeps this O(1) in the common case. Note offs
+	// retained by clear() stay in front.
+	int nIndex = m_nPending;
+	while ( nIndex > m_nImmediate && isEarlier( msg.nFrame, m_pending[ nIndex - 1 ].nFrame ) ) {
+		m_pending[ nIndex ] = m_pending[ nIndex - 1 ];
+		--nIndex;
+	}
+	m_pending[ nIndex ] = msg;
+	++m_nPending;
+}
+
+void MidiEventQueue::clear()
+{
+	TimedMidiMessage msg;
+	while ( m_realtimeQueue.pop( msg ) ) {
+		if ( ! isClearMarker( msg ) ) {
+			insertPending( msg );
+		}
+	}
+	discardPending();
+}
+
+bool MidiEventQueue::pushClear()
+{
+	if ( ! m_realtimeQueue.push( createMessage( 0, nullptr, 0 ) ) ) {
+		++m_nDroppedMessages;
+		return false;
+	}
+	return true;
+}
+
+void MidiEventQueue::discardPending()
+{
+	int nRetained = 0;
+	for ( int ii = 0; ii < m_nPending; ++ii ) {
+		if ( isNoteOff( m_pending[ ii ] ) ) {
+			m_pending[ nRetained ] = m_pending[ ii ];
+			++nRetained;
+		}
+	}
+	m_nPending = nRetained;
+	m_nImmediate = nRetained;
+}
+
+};
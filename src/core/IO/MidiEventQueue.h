@@ -0,0 +1,218 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef MIDI_EVENT_QUEUE_H
+#define MIDI_EVENT_QUEUE_H
+
+#include <core/Helpers/SpscQueue.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace H2Core
+{
+
+/** Short MIDI message due at an absolute frame of the receiving
+ * driver's clock. */
+struct TimedMidiMessage {
+	uint32_t nFrame;
+	uint8_t nLength;
+	uint8_t data[3];
+};
+
+/**
+ * Hands outgoing MIDI messages over to the process callback of a MIDI
+ * driver without locking.
+ *
+ * Messages created while rendering notes in the audio thread are
+ * pushed via pushRealtime() along with the frame they are due at. All
+ * other messages, like control changes or panic note offs triggered
+ * by the GUI or OSC, are pushed via pushControl() and will be sent at
+ * the beginning of the next cycle. Since they are not ordered with
+ * respect to the realtime messages, messages which have to follow
+ * the notes rendered so far, like the note offs at the end of the
+ * song, have to be pushed via pushRealtime() as well.
+ *
+ * The driver's process callback calls dispatch() once per cycle. It
+ * writes all messages due within the cycle in chronological order
+ * and at their exact offset and keeps later ones for subsequent
+ * cycles. When transport is stopped or relocated, the audio thread
+ * discards the notes it scheduled so far using pushClear().
+ *
+ * \ingroup docCore docMIDI
+ */
+class MidiEventQueue
+{
+public:
+	static constexpr int nCapacity = 512;
+
+	MidiEventQueue();
+
+	/** Wait-free. Must only be called by the audio thread.
+	 * \return false in case the queue is full. */
+	bool pushRealtime( uint32_t nFrame, const uint8_t* pData, uint8_t nLength );
+	/** Can be called from any thread but the consumer.
+	 * \return false in case the queue is full. */
+	bool pushControl( const uint8_t* pData, uint8_t nLength );
+
+	/**
+	 * Writes all messages due within the cycle [@a nCycleStart,
+	 * @a nCycleStart + @a nFrames).
+	 *
+	 * \param writeMessage Callable `bool( uint32_t nOffset, const
+	 * uint8_t* pData, uint8_t nLength )` storing a message at @a
+	 * nOffset frames into the cycle. If it returns false, the output
+	 * buffer is considered full and all remaining messages are
+	 * dropped.
+	 *
+	 * Messages which are overdue, e.g. since they were pushed with a
+	 * too small latency or after an xrun, are written at offset 0.
+	 *
+	 * \return Number of messages written.
+	 */
+	template <typename F>
+	int dispatch( uint32_t nCycleStart, uint32_t nFrames, F writeMessage );
+
+	/**
+	 * Drops all realtime messages not sent yet except note offs,
+	 * which will be sent at the beginning of the next cycle instead.
+	 * This way no note started before keeps hanging. Control
+	 * messages are retained.
+	 *
+	 * Must only be called by the consumer.
+	 */
+	void clear();
+	/**
+	 * Same as clear() but for all realtime messages pushed prior to
+	 * this call only. Takes effect during the next dispatch().
+	 *
+	 * Wait-free. Must only be called by the audio thread, e.g. when
+	 * transport was stopped or relocated.
+	 * \return false in case the queue is full.
+	 */
+	bool pushClear();
+
+	/** \return Number of messages which had to be dropped since
+	 * either the queue or the output buffer was full. */
+	int getDroppedMessages() const;
+
+private:
+	/** Drops all messages in #m_pending except note offs. */
+	void discardPending();
+
+	/** Inserts @a msg into #m_pending while keeping it ordered by
+	 * time. Messages of the same frame retain their order. */
+	void insertPending( const TimedMidiMessage& msg );
+
+	/** Messages of zero length mark the point pushClear() was
+	 * called at. */
+	static bool isClearMarker( const TimedMidiMessage& msg ) {
+		return msg.nLength == 0;
+	}
+	static bool isNoteOff( const TimedMidiMessage& msg ) {
+		return ( msg.data[ 0 ] & 0xF0 ) == 0x80 ||
+			( ( msg.data[ 0 ] & 0xF0 ) == 0x90 && msg.data[ 2 ] == 0 );
+	}
+
+	/** Wrap-safe comparison of two frames of a 32 bit clock. */
+	static bool isEarlier( uint32_t nFrameA, uint32_t nFrameB ) {
+		return static_cast<int32_t>( nFrameA - nFrameB ) < 0;
+	}
+
+	SpscQueue<TimedMidiMessage, nCapacity> m_realtimeQueue;
+	SpscQueue<TimedMidiMessage, nCapacity> m_controlQueue;
+	/** Serializes producers of #m_controlQueue. The consumer never
+	 * touches it. */
+	std::mutex m_controlMutex;
+
+	/** Realtime messages not yet due. Only accessed by the
+	 * consumer. */
+	TimedMidiMessage m_pending[ nCapacity ];
+	int m_nPending;
+	/** Note offs retained by clear(). They are due at the beginning
+	 * of the next cycle regardless of their frame. */
+	int m_nImmediate;
+
+	std::atomic<int> m_nDroppedMessages;
+};
+
+template <typename F>
+int MidiEventQueue::dispatch( uint32_t nCycleStart, uint32_t nFrames, F writeMessage )
+{
+	int nWritten = 0;
+	bool bFull = false;
+	TimedMidiMessage msg;
+
+	while ( m_controlQueue.pop( msg ) ) {
+		if ( ! bFull && writeMessage( 0, msg.data, msg.nLength ) ) {
+			++nWritten;
+		} else {
+			bFull = true;
+			++m_nDroppedMessages;
+		}
+	}
+
+	while ( m_realtimeQueue.pop( msg ) ) {
+		if ( isClearMarker( msg ) ) {
+			discardPending();
+		} else {
+			insertPending( msg );
+		}
+	}
+
+	int nDue = 0;
+	while ( nDue < m_nPending ) {
+		const auto& pending = m_pending[ nDue ];
+		const int32_t nDelta = nDue < m_nImmediate ? 0 :
+			static_cast<int32_t>( pending.nFrame - nCycleStart );
+		if ( nDelta >= static_cast<int32_t>( nFrames ) ) {
+			break;
+		}
+		const uint32_t nOffset = nDelta > 0 ? static_cast<uint32_t>( nDelta ) : 0;
+		if ( ! bFull && writeMessage( nOffset, pending.data, pending.nLength ) ) {
+			++nWritten;
+		} else {
+			bFull = true;
+			++m_nDroppedMessages;
+		}
+		++nDue;
+	}
+
+	if ( nDue > 0 ) {
+		for ( int ii = nDue; ii < m_nPending; ++ii ) {
+			m_pending[ ii - nDue ] = m_pending[ ii ];
+		}
+		m_nPending -= nDue;
+		m_nImmediate = std::max( m_nImmediate - nDue, 0 );
+	}
+
+	return nWritten;
+}
+
+inline int MidiEventQueue::getDroppedMessages() const {
+	return m_nDroppedMessages.load( std::memory_order_relaxed );
+}
+
+};
+
+#endif // MIDI_EVENT_QUEUE_H
@@ -48,7 +48,35 @@ public:
 
 	virtual void handleQueueNote(Note* pNote) = 0;
 	virtual void handleQueueNoteOff( int channel, int key, int velocity ) = 0;
+	/**
+	 * Note off of a voice which stopped rendering at @a nFrame (in
+	 * the frame domain of Note::getNoteStart()).
+	 *
+	 * Drivers able to schedule messages with sample accuracy use
+	 * @a nFrame to place the message. All others send it right away.
+	 */
+	virtual void handleQueueNoteOffAt( int channel, int key, int velocity, long long nFrame ) {
+		handleQueueNoteOff( channel, key, velocity );
+	}
 	virtual void handleQueueAllNoteOff() = 0;
+	/**
+	 * Note offs for all instruments of the song sent after all notes
+	 * queued so far at @a nFrame (in the frame domain of
+	 * Note::getNoteStart()).
+	 *
+	 * In contrast to handleQueueAllNoteOff() this one is called by
+	 * the audio thread and has to be realtime safe. All drivers not
+	 * scheduling messages send them right away.
+	 */
+	virtual void handleQueueAllNoteOffAt( long long nFrame ) {
+		handleQueueAllNoteOff();
+	}
+	/**
+	 * Discards all notes queued but not sent yet. Note offs are
+	 * retained. Called by the audio thread when transport is stopped
+	 * or relocated and has to be realtime safe.
+	 */
+	virtual void clearQueue() {}
 	virtual void handleOutgoingControlChange( int param, int value, int channel ) = 0;
 };
 
@@ -26,6 +26,7 @@
 #if defined(H2CORE_HAVE_OSS) || _DOXYGEN_
 
 #include <core/Preferences/Preferences.h>
+#include <core/Helpers/AudioBufferArena.h>
 
 #include <pthread.h>
 
@@ -96,8 +97,8 @@ int OssDriver::init( unsigned nBufferSize )
 
 	audioBuffer = new short[nBufferSize * 2];
 
-	out_L = new float[nBufferSize];
-	out_R = new float[nBufferSize];
+	out_L = AudioBufferArena::get_instance()->allocate( nBufferSize, 2 );
+	out_R = out_L + AudioBufferArena::stride( nBufferSize );
 
 	// clear buffers
 	memset( out_L, 0, nBufferSize * sizeof( float ) );
@@ -218,10 +219,8 @@ void OssDriver::disconnect()
 		}
 	}
 
-	delete [] out_L;
+	AudioBufferArena::get_instance()->release( out_L );
 	out_L = NULL;
-
-	delete [] out_R;
 	out_R = NULL;
 
 	delete[] audioBuffer;
@@ -26,6 +26,7 @@
 #include <iostream>
 
 #include <core/Preferences/Preferences.h>
+#include <core/Helpers/AudioBufferArena.h>
 namespace H2Core
 {
 
@@ -142,8 +143,8 @@ int PortAudioDriver::connect()
 	Preferences *pPreferences = Preferences::get_instance();
 	INFOLOG( "[connect]" );
 
-	m_pOut_L = new float[ MAX_BUFFER_SIZE ];
-	m_pOut_R = new float[ MAX_BUFFER_SIZE ];
+	m_pOut_L = AudioBufferArena::get_instance()->allocate( MAX_BUFFER_SIZE, 2 );
+	m_pOut_R = m_pOut_L + AudioBufferArena::stride( MAX_BUFFER_SIZE );
 
 	int err;
 	if ( ! m_bInitialised ) {
@@ -266,10 +267,8 @@ void PortAudioDriver::disconnect()
 	m_bInitialised = false;
 	Pa_Terminate();
 
-	delete[] m_pOut_L;
+	AudioBufferArena::get_instance()->release( m_pOut_L );
 	m_pOut_L = nullptr;
-
-	delete[] m_pOut_R;
 	m_pOut_R = nullptr;
 }
 
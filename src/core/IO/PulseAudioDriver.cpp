@@ -26,6 +26,7 @@
 
 #include <fcntl.h>
 #include <core/Preferences/Preferences.h>
+#include <core/Helpers/AudioBufferArena.h>
 
 
 namespace H2Core
@@ -50,19 +51,17 @@ PulseAudioDriver::~PulseAudioDriver()
 {
 	pthread_cond_destroy(&m_cond);
 	pthread_mutex_destroy(&m_mutex);
-	delete []m_outL;
-	delete []m_outR;
+	AudioBufferArena::get_instance()->release(m_outL);
 }
 
 
 int PulseAudioDriver::init( unsigned nBufferSize )
 {
-	delete []m_outL;
-	delete []m_outR;
+	AudioBufferArena::get_instance()->release(m_outL);
 	m_buffer_size = nBufferSize;
 	m_sample_rate = Preferences::get_instance()->m_nSampleRate;
-	m_outL = new float[m_buffer_size];
-	m_outR = new float[m_buffer_size];
+	m_outL = AudioBufferArena::get_instance()->allocate(m_buffer_size, 2);
+	m_outR = m_outL + AudioBufferArena::stride(m_buffer_size);
 	return 0;
 }
 
@@ -147,6 +147,15 @@ Preferences::Preferences()
 	m_bUseMetronome = false;
 	m_fMetronomeVolume = 0.5;
 	m_nMaxNotes = 256;
+	m_voiceStealingPolicy = VoiceManager::StealingPolicy::Oldest;
+	m_nVoiceStealingFadeOut = VoiceManager::nDefaultFadeOutFrames;
+	m_bVoiceCulling = false;
+	m_fVoiceCullingThreshold = -90;
+	m_bResampleSamplesOnLoad = false;
+	m_bDeterministicExport = false;
+	m_nExportSeed = 0;
+	m_bSubBlockRendering = false;
+	m_nMinSubBlockSize = 16;
 	m_nBufferSize = 1024;
 	m_nSampleRate = 44100;
 
@@ -205,6 +214,8 @@ Preferences::Preferences()
 #else
 	m_sAlsaAudioDevice = "hw:0";
 #endif
+	m_bAlsaMmap = false;
+	m_nAlsaPeriods = 2;
 
 	//___  jack driver properties ___
 	m_sJackPortName1 = QString("alsa_pcm:playback_1");
@@ -442,6 +453,40 @@ void Preferences::loadPreferences( bool bGlobal )
 				m_bUseMetronome = audioEngineNode.read_bool( "use_metronome", m_bUseMetronome, false, false );
 				m_fMetronomeVolume = audioEngineNode.read_float( "metronome_volume", 0.5f, false, false );
 				m_nMaxNotes = audioEngineNode.read_int( "maxNotes", m_nMaxNotes, false, false );
+				const int nVoiceStealingPolicy =
+					audioEngineNode.read_int( "voiceStealingPolicy",
+											  static_cast<int>(m_voiceStealingPolicy),
+											  true, false, true );
+				if ( nVoiceStealingPolicy >= static_cast<int>(VoiceManager::StealingPolicy::Oldest) &&
+					 nVoiceStealingPolicy <= static_cast<int>(VoiceManager::StealingPolicy::LowestVelocity) ) {
+					m_voiceStealingPolicy =
+						static_cast<VoiceManager::StealingPolicy>( nVoiceStealingPolicy );
+				} else {
+					WARNINGLOG( QString( "Unknown voice stealing policy [%1]. Using default one instead." )
+								.arg( nVoiceStealingPolicy ) );
+				}
+				m_nVoiceStealingFadeOut = audioEngineNode.read_int( "voiceStealingFadeOut",
+																	m_nVoiceStealingFadeOut,
+																	true, false, true );
+				m_bVoiceCulling = audioEngineNode.read_bool( "voiceCulling", m_bVoiceCulling,
+															 true, false, true );
+				m_fVoiceCullingThreshold = audioEngineNode.read_float( "voiceCullingThreshold",
+																	   m_fVoiceCullingThreshold,
+																	   true, false, true );
+				m_bResampleSamplesOnLoad = audioEngineNode.read_bool( "resampleSamplesOnLoad",
+																	  m_bResampleSamplesOnLoad,
+																	  true, false, true );
+				m_bDeterministicExport = audioEngineNode.read_bool( "deterministicExport",
+																	m_bDeterministicExport,
+																	true, false, true );
+				m_nExportSeed = audioEngineNode.read_int( "exportSeed", m_nExportSeed,
+														  true, false, true );
+				m_bSubBlockRendering = audioEngineNode.read_bool( "subBlockRendering",
+																  m_bSubBlockRendering,
+																  true, false, true );
+				m_nMinSubBlockSize = audioEngineNode.read_int( "minSubBlockSize",
+															   m_nMinSubBlockSize,
+															   true, false, true );
 				m_nBufferSize = audioEngineNode.read_int( "buffer_size", m_nBufferSize, false, false );
 				m_nSampleRate = audioEngineNode.read_int( "samplerate", m_nSampleRate, false, false );
 
@@ -536,6 +581,12 @@ void Preferences::loadPreferences( bool bGlobal )
 					bRecreate = true;
 				} else {
 					m_sAlsaAudioDevice = alsaAudioDriverNode.read_string( "alsa_audio_device", m_sAlsaAudioDevice, false, false );
+					m_bAlsaMmap = alsaAudioDriverNode.read_bool( "alsa_mmap", m_bAlsaMmap,
+																 true, false, true );
+					m_nAlsaPeriods = std::clamp( alsaAudioDriverNode.read_int( "alsa_periods",
+																			   m_nAlsaPeriods,
+																			   true, false, true ),
+												 2, 3 );
 				}
 
 				/// MIDI DRIVER ///
@@ -939,6 +990,15 @@ bool Preferences::savePreferences()
 		audioEngineNode.write_bool( "use_metronome", m_bUseMetronome );
 		audioEngineNode.write_float( "metronome_volume", m_fMetronomeVolume );
 		audioEngineNode.write_int( "maxNotes", m_nMaxNotes );
+		audioEngineNode.write_int( "voiceStealingPolicy", static_cast<int>(m_voiceStealingPolicy) );
+		audioEngineNode.write_int( "voiceStealingFadeOut", m_nVoiceStealingFadeOut );
+		audioEngineNode.write_bool( "voiceCulling", m_bVoiceCulling );
+		audioEngineNode.write_float( "voiceCullingThreshold", m_fVoiceCullingThreshold );
+		audioEngineNode.write_bool( "resampleSamplesOnLoad", m_bResampleSamplesOnLoad );
+		audioEngineNode.write_bool( "deterministicExport", m_bDeterministicExport );
+		audioEngineNode.write_int( "exportSeed", m_nExportSeed );
+		audioEngineNode.write_bool( "subBlockRendering", m_bSubBlockRendering );
+		audioEngineNode.write_int( "minSubBlockSize", m_nMinSubBlockSize );
 		audioEngineNode.write_int( "buffer_size", m_nBufferSize );
 		audioEngineNode.write_int( "samplerate", m_nSampleRate );
 
@@ -1016,6 +1076,8 @@ bool Preferences::savePreferences()
 		XMLNode alsaAudioDriverNode = audioEngineNode.createNode( "alsa_audio_driver" );
 		{
 			alsaAudioDriverNode.write_string( "alsa_audio_device", m_sAlsaAudioDevice );
+			alsaAudioDriverNode.write_bool( "alsa_mmap", m_bAlsaMmap );
+			alsaAudioDriverNode.write_int( "alsa_periods", m_nAlsaPeriods );
 		}
 
 		/// MIDI DRIVER ///
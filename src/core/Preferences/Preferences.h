@@ -32,6 +32,7 @@
 #include <core/MidiAction.h>
 #include <core/Globals.h>
 #include <core/Object.h>
+#include <core/Sampler/VoiceManager.h>
 
 #include <QStringList>
 #include <QDomDocument>
@@ -177,6 +178,7 @@ public:
 	 * - "Oss" : createDriver() will create a OssDriver.
 	 * - "PulseAudio" : createDriver() will create a PulseAudioDriver.
 	 * - "Fake" : createDriver() will create a FakeDriver.
+	 * - "Benchmark" : createDriver() will create a BenchmarkDriver.
 	 */
 	QString				m_sAudioDriver;
 	/** If set to true, samples of the metronome will be added to
@@ -187,6 +189,43 @@ public:
 	float				m_fMetronomeVolume;
 	/// max notes
 	unsigned			m_nMaxNotes;
+	/** Which voice will be stolen by the VoiceManager once
+	 * #m_nMaxNotes or the voice limit of an Instrument is
+	 * reached. */
+	VoiceManager::StealingPolicy	m_voiceStealingPolicy;
+	/** Number of frames a stolen voice will be faded out in. */
+	int					m_nVoiceStealingFadeOut;
+	/** Whether the Sampler retires voices which became inaudible
+	 * before their sample or envelope did end. */
+	bool				m_bVoiceCulling;
+	/** Level in dB below which a voice is considered inaudible. */
+	float				m_fVoiceCullingThreshold;
+	/** Whether samples are converted to the sample rate of the
+	 * audio driver once when being loaded. This allows the Sampler
+	 * to render unpitched notes without resampling at the cost of a
+	 * longer loading time. */
+	bool				m_bResampleSamplesOnLoad;
+	/** Whether exports are rendered deterministically.
+	 *
+	 * The random number generator of the AudioEngine is seeded with
+	 * #m_nExportSeed at the start of each export, the
+	 * DiskWriterDriver uses a fixed buffer size, and it waits for the
+	 * audio engine lock instead of timing out. Two exports of the
+	 * same song with the same seed are identical, including
+	 * humanization, note probabilities, and random layer selection.
+	 * Otherwise a fresh seed is used each time. */
+	bool				m_bDeterministicExport;
+	/** Seed used if #m_bDeterministicExport is set. */
+	int					m_nExportSeed;
+	/** Whether the AudioEngine splits each period into sub-blocks
+	 * at note starts and tempo changes while transport is rolling,
+	 * see AudioEngine::processSubBlocks(). */
+	bool				m_bSubBlockRendering;
+	/** Minimum size of a sub-block in frames. Note starts and tempo
+	 * changes closer to each other are handled within the same
+	 * sub-block. Larger values bound the overhead of rendering
+	 * dense passages. */
+	int					m_nMinSubBlockSize;
 	/** 
 	 * Buffer size of the audio.
 	 *
@@ -273,6 +312,12 @@ public:
 
 	//	alsa audio driver properties ___
 	QString				m_sAlsaAudioDevice;
+	/** Whether the AlsaAudioDriver writes directly into the ring
+	 * buffer of the device (mmap access) instead of copying each
+	 * period using snd_pcm_writei(). */
+	bool				m_bAlsaMmap;
+	/** Number of periods of the ALSA ring buffer (2 or 3). */
+	int					m_nAlsaPeriods;
 
 	// PortAudio properties
 	QString				m_sPortAudioDevice;
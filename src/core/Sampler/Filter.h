@@ -0,0 +1,233 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_FILTER_H
+#define H2C_FILTER_H
+
+#include <cmath>
+#include <QString>
+
+namespace H2Core
+{
+
+/**
+ * Resonant per-voice filters applied by the #Sampler.
+ *
+ * All filters operate on whole blocks of a stereo pair. Their
+ * coefficients are computed once per block and, in case the cutoff
+ * or resonance changed since the last block (e.g. by MIDI or OSC
+ * automation), linearly ramped across the block to avoid zipper
+ * noise. Left and right channel are stored in two-element arrays
+ * and processed in lockstep so the compiler is able to map them onto
+ * a single SIMD register.
+ *
+ * The state of a filter is made up of two values per channel, @a
+ * pBand and @a pLow, which are owned by the Note.
+ */
+namespace Filter
+{
+	enum class Type {
+		/** Two-pole low pass filter used by Hydrogen since its
+		 * early days. */
+		Legacy = 0,
+		/** Trapezoidal integrated state variable filter (see
+		 * "Linear Trapezoidal Integrated SVF" by A. Simper). */
+		LowPass = 1,
+		HighPass = 2,
+		BandPass = 3
+	};
+
+	inline QString TypeToQString( Type type ) {
+		switch ( type ) {
+		case Type::Legacy:
+			return "Legacy";
+		case Type::LowPass:
+			return "LowPass";
+		case Type::HighPass:
+			return "HighPass";
+		case Type::BandPass:
+			return "BandPass";
+		default:
+			return QString( "Unknown type [%1]" ).arg( static_cast<int>(type) );
+		}
+	}
+
+	/**
+	 * The cutoff in [0,1] is interpreted the same way as in the
+	 * legacy filter, 2 * sin( pi * f_c / f_s ), and converted into
+	 * the prewarped gain tan( pi * f_c / f_s ) of the state variable
+	 * filter.
+	 */
+	inline float svfGain( float fCutoff ) {
+		return fCutoff / std::sqrt( 4.0f - fCutoff * fCutoff );
+	}
+
+	/** Damping of the state variable filter (inverse of its Q) for a
+	 * resonance in [0,1). */
+	inline float svfDamping( float fResonance ) {
+		return std::fmax( 2.0f - 2.0f * fResonance, 0.01f );
+	}
+
+	template<bool bRamp>
+	inline void processLegacy( float* __restrict__ pLeft, float* __restrict__ pRight,
+									  int nFrames,
+									  float fCutoff, float fResonance,
+									  float fCutoffStep, float fResonanceStep,
+									  float* __restrict__ pBand, float* __restrict__ pLow ) {
+		float fBand[ 2 ] = { pBand[ 0 ], pBand[ 1 ] };
+		float fLow[ 2 ] = { pLow[ 0 ], pLow[ 1 ] };
+
+		for ( int i = 0; i < nFrames; ++i ) {
+			if ( bRamp ) {
+				fCutoff += fCutoffStep;
+				fResonance += fResonanceStep;
+			}
+			const float fIn[ 2 ] = { pLeft[ i ], pRight[ i ] };
+			for ( int c = 0; c < 2; ++c ) {
+				fBand[ c ] = fResonance * fBand[ c ] + fCutoff * ( fIn[ c ] - fLow[ c ] );
+				fLow[ c ] += fCutoff * fBand[ c ];
+			}
+			pLeft[ i ] = fLow[ 0 ];
+			pRight[ i ] = fLow[ 1 ];
+		}
+
+		pBand[ 0 ] = fBand[ 0 ];
+		pBand[ 1 ] = fBand[ 1 ];
+		pLow[ 0 ] = fLow[ 0 ];
+		pLow[ 1 ] = fLow[ 1 ];
+	}
+
+	template<Type type, bool bRamp>
+	inline void processSVF( float* __restrict__ pLeft, float* __restrict__ pRight,
+								   int nFrames,
+								   float fG, float fK,
+								   float fGStep, float fKStep,
+								   float* __restrict__ pBand, float* __restrict__ pLow ) {
+		float fIc1[ 2 ] = { pBand[ 0 ], pBand[ 1 ] };
+		float fIc2[ 2 ] = { pLow[ 0 ], pLow[ 1 ] };
+
+		float fA1 = 1.0f / ( 1.0f + fG * ( fG + fK ) );
+		float fA2 = fG * fA1;
+		float fA3 = fG * fA2;
+
+		for ( int i = 0; i < nFrames; ++i ) {
+			if ( bRamp ) {
+				fG += fGStep;
+				fK += fKStep;
+				fA1 = 1.0f / ( 1.0f + fG * ( fG + fK ) );
+				fA2 = fG * fA1;
+				fA3 = fG * fA2;
+			}
+			const float fIn[ 2 ] = { pLeft[ i ], pRight[ i ] };
+			float fOut[ 2 ];
+			for ( int c = 0; c < 2; ++c ) {
+				const float fV3 = fIn[ c ] - fIc2[ c ];
+				const float fV1 = fA1 * fIc1[ c ] + fA2 * fV3;
+				const float fV2 = fIc2[ c ] + fA2 * fIc1[ c ] + fA3 * fV3;
+				fIc1[ c ] = 2.0f * fV1 - fIc1[ c ];
+				fIc2[ c ] = 2.0f * fV2 - fIc2[ c ];
+
+				if ( type == Type::HighPass ) {
+					fOut[ c ] = fIn[ c ] - fK * fV1 - fV2;
+				} else if ( type == Type::BandPass ) {
+					fOut[ c ] = fV1;
+				} else {
+					fOut[ c ] = fV2;
+				}
+			}
+			pLeft[ i ] = fOut[ 0 ];
+			pRight[ i ] = fOut[ 1 ];
+		}
+
+		pBand[ 0 ] = fIc1[ 0 ];
+		pBand[ 1 ] = fIc1[ 1 ];
+		pLow[ 0 ] = fIc2[ 0 ];
+		pLow[ 1 ] = fIc2[ 1 ];
+	}
+
+	/**
+	 * Filters @a nFrames frames of @a pLeft and @a pRight in place.
+	 *
+	 * The coefficients are linearly ramped from the ones
+	 * corresponding to @a fCutoffStart and @a fResonanceStart to the
+	 * ones of @a fCutoffEnd and @a fResonanceEnd, which are reached
+	 * at the last frame. If start and end match, the coefficients are
+	 * constant throughout the block.
+	 *
+	 * \param pBand Band pass state of the left and right channel.
+	 * \param pLow Low pass state of the left and right channel.
+	 */
+	inline void process( Type type, float* pLeft, float* pRight, int nFrames,
+								float fCutoffStart, float fResonanceStart,
+								float fCutoffEnd, float fResonanceEnd,
+								float* pBand, float* pLow ) {
+		if ( nFrames <= 0 ) {
+			return;
+		}
+		const bool bRamp = fCutoffStart != fCutoffEnd ||
+			fResonanceStart != fResonanceEnd;
+
+		if ( type == Type::Legacy ) {
+			if ( bRamp ) {
+				const float fCutoffStep = ( fCutoffEnd - fCutoffStart ) / nFrames;
+				const float fResonanceStep = ( fResonanceEnd - fResonanceStart ) / nFrames;
+				processLegacy<true>( pLeft, pRight, nFrames, fCutoffStart, fResonanceStart,
+									 fCutoffStep, fResonanceStep, pBand, pLow );
+			} else {
+				processLegacy<false>( pLeft, pRight, nFrames, fCutoffEnd, fResonanceEnd,
+									  0, 0, pBand, pLow );
+			}
+			return;
+		}
+
+		const float fG = svfGain( fCutoffStart );
+		const float fK = svfDamping( fResonanceStart );
+		float fGStep = 0;
+		float fKStep = 0;
+		if ( bRamp ) {
+			fGStep = ( svfGain( fCutoffEnd ) - fG ) / nFrames;
+			fKStep = ( svfDamping( fResonanceEnd ) - fK ) / nFrames;
+		}
+
+#define H2_FILTER_SVF( TYPE ) \
+		if ( bRamp ) { \
+			processSVF<TYPE, true>( pLeft, pRight, nFrames, fG, fK, fGStep, fKStep, pBand, pLow ); \
+		} else { \
+			processSVF<TYPE, false>( pLeft, pRight, nFrames, fG, fK, 0, 0, pBand, pLow ); \
+		}
+
+		switch ( type ) {
+		case Type::HighPass:
+			H2_FILTER_SVF( Type::HighPass );
+			break;
+		case Type::BandPass:
+			H2_FILTER_SVF( Type::BandPass );
+			break;
+		default:
+			H2_FILTER_SVF( Type::LowPass );
+		}
+#undef H2_FILTER_SVF
+	}
+}
+
+};
+
+#endif // H2C_FILTER_H
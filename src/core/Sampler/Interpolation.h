@@ -34,7 +34,11 @@ namespace Interpolation
 								Cosine = 1,
 								Third = 2,
 								Cubic = 3,
-								Hermite = 4 };
+								Hermite = 4,
+								/** Band-limited windowed sinc (see
+								 * #Resampler). Meant for high quality
+								 * offline export. */
+								Sinc = 5 };
 
 	inline static float linear_Interpolate( float y1, float y2, float mu )
 	{
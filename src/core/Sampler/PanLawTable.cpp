@@ -0,0 +1,81 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Sampler/PanLawTable.h>
+#include <core/Sampler/Sampler.h>
+
+namespace H2Core
+{
+
+PanLawTable::PanLawTable( int nPanLawType, float fKNorm )
+	: m_nPanLawType( nPanLawType )
+	, m_fKNorm( fKNorm )
+	, m_bSquared( nPanLawType == Sampler::QUADRATIC_STRAIGHT_POLYGONAL ||
+				  nPanLawType == Sampler::QUADRATIC_CONST_POWER ||
+				  nPanLawType == Sampler::QUADRATIC_CONST_SUM ||
+				  nPanLawType == Sampler::QUADRATIC_CONST_K_NORM )
+{
+	for ( int ii = 0; ii <= nResolution; ++ii ) {
+		const float fPan = -1.0f + 2.0f * ii / nResolution;
+		const float fGain = evaluate( nPanLawType, fKNorm, fPan );
+		m_gains[ ii ] = m_bSquared ? fGain * fGain : fGain;
+	}
+}
+
+float PanLawTable::evaluate( int nPanLawType, float fKNorm, float fPan ) {
+	switch ( nPanLawType ) {
+	case Sampler::RATIO_CONST_POWER:
+		return Sampler::ratioConstPowerPanLaw( fPan );
+	case Sampler::RATIO_CONST_SUM:
+		return Sampler::ratioConstSumPanLaw( fPan );
+	case Sampler::LINEAR_STRAIGHT_POLYGONAL:
+		return Sampler::linearStraightPolygonalPanLaw( fPan );
+	case Sampler::LINEAR_CONST_POWER:
+		return Sampler::linearConstPowerPanLaw( fPan );
+	case Sampler::LINEAR_CONST_SUM:
+		return Sampler::linearConstSumPanLaw( fPan );
+	case Sampler::POLAR_STRAIGHT_POLYGONAL:
+		return Sampler::polarStraightPolygonalPanLaw( fPan );
+	case Sampler::POLAR_CONST_POWER:
+		return Sampler::polarConstPowerPanLaw( fPan );
+	case Sampler::POLAR_CONST_SUM:
+		return Sampler::polarConstSumPanLaw( fPan );
+	case Sampler::QUADRATIC_STRAIGHT_POLYGONAL:
+		return Sampler::quadraticStraightPolygonalPanLaw( fPan );
+	case Sampler::QUADRATIC_CONST_POWER:
+		return Sampler::quadraticConstPowerPanLaw( fPan );
+	case Sampler::QUADRATIC_CONST_SUM:
+		return Sampler::quadraticConstSumPanLaw( fPan );
+	case Sampler::LINEAR_CONST_K_NORM:
+		return Sampler::linearConstKNormPanLaw( fPan, fKNorm );
+	case Sampler::POLAR_CONST_K_NORM:
+		return Sampler::polarConstKNormPanLaw( fPan, fKNorm );
+	case Sampler::RATIO_CONST_K_NORM:
+		return Sampler::ratioConstKNormPanLaw( fPan, fKNorm );
+	case Sampler::QUADRATIC_CONST_K_NORM:
+		return Sampler::quadraticConstKNormPanLaw( fPan, fKNorm );
+	case Sampler::RATIO_STRAIGHT_POLYGONAL:
+	default:
+		return Sampler::ratioStraightPolygonalPanLaw( fPan );
+	}
+}
+
+};
@@ -0,0 +1,86 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef PAN_LAW_TABLE_H
+#define PAN_LAW_TABLE_H
+
+#include <algorithm>
+#include <cmath>
+
+namespace H2Core
+{
+
+/**
+ * Tabulated pan law.
+ *
+ * Most of the pan laws of the #Sampler call pow(), sqrt() or
+ * trigonometric functions. Instead of evaluating them for every
+ * voice in every cycle, the law selected in the Song is sampled once
+ * at #nResolution + 1 equidistant pan values in [-1, 1] and linearly
+ * interpolated in between. The center (fPan = 0), at which the
+ * polygonal and ratio laws have a kink, is part of the grid. The
+ * "quadratic" laws behave like a square root close to the hard
+ * panned positions. For them the squared gains are tabulated instead.
+ *
+ * A table is immutable. Song creates a new one whenever the type of
+ * the pan law or its k-norm changes.
+ */
+class PanLawTable
+{
+public:
+	/** Number of intervals in [-1, 1]. Has to be even. */
+	static constexpr int nResolution = 4096;
+
+	PanLawTable( int nPanLawType, float fKNorm );
+
+	/** \return Gain of the left channel for @a fPan in [-1, 1]. The
+	 * right channel's one is `getGain( -fPan )`. */
+	float getGain( float fPan ) const {
+		const float fPos = ( std::clamp( fPan, -1.0f, 1.0f ) + 1.0f ) * 0.5f * nResolution;
+		const int nIndex = std::min( static_cast<int>( fPos ), nResolution - 1 );
+		const float fFrac = fPos - nIndex;
+		const float fGain = m_gains[ nIndex ] + fFrac * ( m_gains[ nIndex + 1 ] - m_gains[ nIndex ] );
+		return m_bSquared ? std::sqrt( fGain ) : fGain;
+	}
+
+	int getPanLawType() const {
+		return m_nPanLawType;
+	}
+	float getKNorm() const {
+		return m_fKNorm;
+	}
+
+	/** Evaluates the pan law @a nPanLawType (one of
+	 * Sampler::PAN_LAW_TYPES) exactly. Unknown types fall back to
+	 * Sampler::RATIO_STRAIGHT_POLYGONAL. */
+	static float evaluate( int nPanLawType, float fKNorm, float fPan );
+
+private:
+	int m_nPanLawType;
+	float m_fKNorm;
+	/** Whether #m_gains holds the squared gains. */
+	bool m_bSquared;
+	float m_gains[ nResolution + 1 ];
+};
+
+};
+
+#endif // PAN_LAW_TABLE_H
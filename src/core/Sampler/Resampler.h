@@ -0,0 +1,188 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace H2Core
+{
+
+/**
+ * High quality band-limited resampling of sample data.
+ *
+ * In contrast to the short polynomial kernels in #Interpolation,
+ * which alias badly when a sample is pitched up, the windowed sinc
+ * lowers its cutoff according to the playback step and thus removes
+ * all content which would fold back below the Nyquist frequency of
+ * the output.
+ *
+ * The kernel is tabulated once in #nSincPhases phases per zero
+ * crossing. A single output frame is computed by picking the phases
+ * of all input frames within the kernel support and linearly
+ * interpolating between neighbouring phases.
+ */
+namespace Resampler
+{
+	/** Number of zero crossings on either side of the kernel's
+	 * center. */
+	static constexpr int nSincZeroCrossings = 16;
+	/** Number of tabulated phases per zero crossing. */
+	static constexpr int nSincPhases = 512;
+	/** Shape parameter of the Kaiser window. Corresponds to a stop
+	 * band attenuation of about 90dB. */
+	static constexpr double fKaiserBeta = 9.0;
+	/** Cutoff of the kernel relative to the Nyquist frequency of
+	 * the lower of both rates. Leaves room for the transition
+	 * band. */
+	static constexpr float fSincRolloff = 0.95f;
+
+	/** Zeroth order modified Bessel function of the first kind. */
+	inline static double besselI0( double fX ) {
+		double fSum = 1.0;
+		double fTerm = 1.0;
+		for ( int k = 1; k < 50; ++k ) {
+			fTerm *= ( fX / ( 2.0 * k ) ) * ( fX / ( 2.0 * k ) );
+			fSum += fTerm;
+			if ( fTerm < fSum * 1e-12 ) {
+				break;
+			}
+		}
+		return fSum;
+	}
+
+	/**
+	 * \return Right half of the Kaiser windowed sinc kernel,
+	 * sampled at #nSincPhases points per zero crossing. The table is
+	 * computed on first use and contains one additional guard entry.
+	 */
+	inline static const float* sincTable() {
+		static const std::vector<float> table = [](){
+			const int nSize = nSincZeroCrossings * nSincPhases + 1;
+			std::vector<float> values( nSize + 1, 0.0f );
+			const double fNorm = besselI0( fKaiserBeta );
+			for ( int i = 0; i < nSize; ++i ) {
+				const double fX = static_cast<double>(i) / nSincPhases;
+				const double fSinc = i == 0 ? 1.0 :
+					std::sin( M_PI * fX ) / ( M_PI * fX );
+				const double fRatio = fX / nSincZeroCrossings;
+				const double fWindow = besselI0(
+					fKaiserBeta * std::sqrt( std::max( 1.0 - fRatio * fRatio, 0.0 ) ) ) / fNorm;
+				values[ i ] = static_cast<float>( fSinc * fWindow );
+			}
+			return values;
+		}();
+		return table.data();
+	}
+
+	/**
+	 * Computes a single stereo frame at the fractional position @a
+	 * fSamplePos of a sample. Frames outside the sample are treated
+	 * as silence.
+	 *
+	 * \param fStep Number of sample frames advanced per output
+	 * frame. For values larger than 1 the cutoff of the kernel is
+	 * lowered accordingly and the number of taps grows by the same
+	 * factor.
+	 */
+	inline static void sincInterpolate( const float* pSample_data_L, const float* pSample_data_R,
+										int nSampleFrames, double fSamplePos, float fStep,
+										float* pfVal_L, float* pfVal_R ) {
+		const float* pTable = sincTable();
+		const double fScale = fSincRolloff * ( fStep > 1.0f ? 1.0 / fStep : 1.0 );
+		const double fHalfWidth = nSincZeroCrossings / fScale;
+		const double fPhaseScale = fScale * nSincPhases;
+		const int nMaxIndex = nSincZeroCrossings * nSincPhases;
+
+		const int nFirst = std::max( static_cast<int>( std::ceil( fSamplePos - fHalfWidth ) ), 0 );
+		const int nLast = std::min( static_cast<int>( std::floor( fSamplePos + fHalfWidth ) ),
+									nSampleFrames - 1 );
+
+		float fVal_L = 0.0f;
+		float fVal_R = 0.0f;
+		for ( int nFrame = nFirst; nFrame <= nLast; ++nFrame ) {
+			const double fX = std::fabs( fSamplePos - nFrame ) * fPhaseScale;
+			const int nIndex = static_cast<int>( fX );
+			if ( nIndex >= nMaxIndex ) {
+				continue;
+			}
+			const float fFrac = static_cast<float>( fX - nIndex );
+			const float fWeight = pTable[ nIndex ] +
+				fFrac * ( pTable[ nIndex + 1 ] - pTable[ nIndex ] );
+			fVal_L += fWeight * pSample_data_L[ nFrame ];
+			fVal_R += fWeight * pSample_data_R[ nFrame ];
+		}
+
+		*pfVal_L = fVal_L * static_cast<float>( fScale );
+		*pfVal_R = fVal_R * static_cast<float>( fScale );
+	}
+
+	/**
+	 * Checks whether playing back a sample with @a fStep starting at
+	 * @a fSamplePos yields a constant integer ratio between sample
+	 * and output frames, like 44.1kHz samples rendered by a 88.2kHz
+	 * driver (1:2) or 96kHz samples by a 48kHz one (2:1).
+	 *
+	 * \param pnFactor Integer ratio N, at most @a nMaxFactor.
+	 * \param pbUpsampling Whether one sample frame is stretched over
+	 * N output frames (step 1/N) or N sample frames are condensed into
+	 * one output frame (step N).
+	 * \param pnPosition Sample frame at which rendering starts.
+	 * \param pnPhase Index of the phase (in units of 1/N) between
+	 * @a pnPosition and the next frame at which rendering starts.
+	 */
+	inline static bool isIntegerRatio( float fStep, double fSamplePos, int nMaxFactor,
+									   int* pnFactor, bool* pbUpsampling,
+									   int* pnPosition, int* pnPhase ) {
+		if ( fStep <= 0 || fStep == 1.0f ) {
+			return false;
+		}
+		const bool bUpsampling = fStep < 1.0f;
+		const double fRatio = bUpsampling ? 1.0 / fStep : fStep;
+		const int nFactor = static_cast<int>( std::lround( fRatio ) );
+		if ( nFactor < 2 || nFactor > nMaxFactor ||
+			 std::fabs( fRatio - nFactor ) > 1e-5 * nFactor ) {
+			return false;
+		}
+
+		// The position is tracked in single precision by the
+		// SelectedLayerInfo. Allow for its rounding errors.
+		const int nSubFactor = bUpsampling ? nFactor : 1;
+		const double fSubPosition = fSamplePos * nSubFactor;
+		const long nSubPosition = std::lround( fSubPosition );
+		if ( std::fabs( fSubPosition - nSubPosition ) > 1e-3 ) {
+			return false;
+		}
+
+		*pnFactor = nFactor;
+		*pbUpsampling = bUpsampling;
+		*pnPosition = static_cast<int>( nSubPosition / nSubFactor );
+		*pnPhase = static_cast<int>( nSubPosition % nSubFactor );
+		return true;
+	}
+};
+
+};
+
+#endif // RESAMPLER_H
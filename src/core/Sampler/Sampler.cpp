@@ -20,6 +20,7 @@
  *
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
@@ -43,11 +44,14 @@
 #include <core/Basics/Song.h>
 #include <core/Basics/Pattern.h>
 #include <core/Basics/PatternList.h>
+#include <core/Helpers/AudioBufferArena.h>
 #include <core/Helpers/Filesystem.h>
 #include <core/EventQueue.h>
 
 #include <core/FX/Effects.h>
+#include <core/Sampler/Resampler.h>
 #include <core/Sampler/Sampler.h>
+#include <core/Sampler/PanLawTable.h>
 
 #include <iostream>
 #include <QDebug>
@@ -67,16 +71,543 @@ static std::shared_ptr<Instrument> createInstrument(int id, const QString& filep
 	return pInstrument;
 }
 
+/** Interpolates a single stereo frame of a sample at the fractional
+ * position @a fSamplePos. Frames outside the sample are treated as
+ * silence. @a fStep is only used by the band-limited
+ * Interpolation::InterpolateMode::Sinc. */
+template <Interpolation::InterpolateMode mode>
+static inline void interpolateFrame( const float* pSample_data_L, const float* pSample_data_R,
+									 int nSampleFrames, double fSamplePos, float fStep,
+									 float* pfVal_L, float* pfVal_R )
+{
+	if ( mode == Interpolation::InterpolateMode::Sinc ) {
+		Resampler::sincInterpolate( pSample_data_L, pSample_data_R, nSampleFrames,
+									fSamplePos, fStep, pfVal_L, pfVal_R );
+		return;
+	}
+
+	int nSamplePos = ( int )fSamplePos;
+	double fDiff = fSamplePos - nSamplePos;
+	if ( ( nSamplePos - 1 ) >= nSampleFrames ) {
+		//we reach the last audioframe.
+		//set this last frame to zero do nothing wrong.
+		*pfVal_L = 0.0;
+		*pfVal_R = 0.0;
+		return;
+	}
+
+	// Gather frame samples
+	float l0, l1, l2, l3, r0, r1, r2, r3;
+	// Short-circuit: the common case is that all required frames are within the sample.
+	if ( nSamplePos >= 1 && nSamplePos + 2 < nSampleFrames ) {
+		l0 = pSample_data_L[ nSamplePos-1 ];
+		l1 = pSample_data_L[ nSamplePos ];
+		l2 = pSample_data_L[ nSamplePos+1 ];
+		l3 = pSample_data_L[ nSamplePos+2 ];
+		r0 = pSample_data_R[ nSamplePos-1 ];
+		r1 = pSample_data_R[ nSamplePos ];
+		r2 = pSample_data_R[ nSamplePos+1 ];
+		r3 = pSample_data_R[ nSamplePos+2 ];
+	} else {
+		l0 = l1 = l2 = l3 = r0 = r1 = r2 = r3 = 0.0;
+		// Some required frames are off the beginning or end of the sample.
+		if ( nSamplePos >= 1 && nSamplePos < nSampleFrames + 1 ) {
+			l0 = pSample_data_L[ nSamplePos-1 ];
+			r0 = pSample_data_R[ nSamplePos-1 ];
+		}
+		// The following frames are treated as silence, which all
+		// render kernels rely on to produce identical output at the
+		// end of a sample.
+		if ( nSamplePos < nSampleFrames ) {
+			l1 = pSample_data_L[ nSamplePos ];
+			r1 = pSample_data_R[ nSamplePos ];
+		}
+	}
+
+	// Interpolate frame values from Sample domain to audio output range
+	switch ( mode ) {
+	case Interpolation::InterpolateMode::Linear:
+		*pfVal_L = l1 * (1 - fDiff ) + l2 * fDiff;
+		*pfVal_R = r1 * (1 - fDiff ) + r2 * fDiff;
+		break;
+	case Interpolation::InterpolateMode::Cosine:
+		*pfVal_L = Interpolation::cosine_Interpolate( l1, l2, fDiff);
+		*pfVal_R = Interpolation::cosine_Interpolate( r1, r2, fDiff);
+		break;
+	case Interpolation::InterpolateMode::Third:
+		*pfVal_L = Interpolation::third_Interpolate( l0, l1, l2, l3, fDiff);
+		*pfVal_R = Interpolation::third_Interpolate( r0, r1, r2, r3, fDiff);
+		break;
+	case Interpolation::InterpolateMode::Cubic:
+		*pfVal_L = Interpolation::cubic_Interpolate( l0, l1, l2, l3, fDiff);
+		*pfVal_R = Interpolation::cubic_Interpolate( r0, r1, r2, r3, fDiff);
+		break;
+	case Interpolation::InterpolateMode::Hermite:
+		*pfVal_L = Interpolation::hermite_Interpolate( l0, l1, l2, l3, fDiff);
+		*pfVal_R = Interpolation::hermite_Interpolate( r0, r1, r2, r3, fDiff);
+		break;
+	case Interpolation::InterpolateMode::Sinc:
+		// Handled above.
+		break;
+	}
+}
+
+/** Runtime counterpart of interpolateFrame<mode>(). */
+static void interpolateFrame( Interpolation::InterpolateMode mode,
+							  const float* pSample_data_L, const float* pSample_data_R,
+							  int nSampleFrames, double fSamplePos, float fStep,
+							  float* pfVal_L, float* pfVal_R )
+{
+#define H2_INTERPOLATE_FRAME( MODE ) \
+	interpolateFrame<MODE>( pSample_data_L, pSample_data_R, nSampleFrames, \
+							fSamplePos, fStep, pfVal_L, pfVal_R )
+
+	switch ( mode ) {
+	case Interpolation::InterpolateMode::Linear:
+		H2_INTERPOLATE_FRAME( Interpolation::InterpolateMode::Linear );
+		break;
+	case Interpolation::InterpolateMode::Cosine:
+		H2_INTERPOLATE_FRAME( Interpolation::InterpolateMode::Cosine );
+		break;
+	case Interpolation::InterpolateMode::Third:
+		H2_INTERPOLATE_FRAME( Interpolation::InterpolateMode::Third );
+		break;
+	case Interpolation::InterpolateMode::Cubic:
+		H2_INTERPOLATE_FRAME( Interpolation::InterpolateMode::Cubic );
+		break;
+	case Interpolation::InterpolateMode::Hermite:
+		H2_INTERPOLATE_FRAME( Interpolation::InterpolateMode::Hermite );
+		break;
+	case Interpolation::InterpolateMode::Sinc:
+		H2_INTERPOLATE_FRAME( Interpolation::InterpolateMode::Sinc );
+		break;
+	}
+#undef H2_INTERPOLATE_FRAME
+}
+
+/** Largest ratio handled by interpolateIntegerRatio(). */
+static constexpr int nMaxIntegerRatio = 8;
+
+/**
+ * Fast path of the resampling for constant integer ratios between
+ * sample and output frames (see Resampler::isIntegerRatio()).
+ *
+ * When upsampling by N, all output frames fall onto N fixed phases
+ * between two sample frames. As all polynomial interpolation modes
+ * are linear in the sample values, their weights are computed once
+ * per phase and block and the position is advanced using integers
+ * instead of accumulating a double. When downsampling by N, all
+ * output frames coincide with sample frames.
+ *
+ * Renders @a nFrames frames into @a pBuffer_L and @a pBuffer_R.
+ *
+ * \return Sample position following the last rendered frame.
+ */
+static double interpolateIntegerRatio( Interpolation::InterpolateMode mode,
+									   const float* pSample_data_L, const float* pSample_data_R,
+									   int nSampleFrames, int nFactor, bool bUpsampling,
+									   int nPosition, int nPhase,
+									   float* pBuffer_L, float* pBuffer_R, int nFrames )
+{
+	assert( mode != Interpolation::InterpolateMode::Sinc );
+	assert( nFactor <= nMaxIntegerRatio );
+
+	if ( ! bUpsampling ) {
+		for ( int i = 0; i < nFrames; ++i ) {
+			if ( nPosition < nSampleFrames ) {
+				pBuffer_L[ i ] = pSample_data_L[ nPosition ];
+				pBuffer_R[ i ] = pSample_data_R[ nPosition ];
+			} else {
+				pBuffer_L[ i ] = 0.0;
+				pBuffer_R[ i ] = 0.0;
+			}
+			nPosition += nFactor;
+		}
+		return nPosition;
+	}
+
+	// Weights of the sample frames at nPosition - 1, nPosition,
+	// nPosition + 1, and nPosition + 2 for each phase. They are
+	// obtained by interpolating unit impulses.
+	float weights[ nMaxIntegerRatio ][ 4 ];
+	for ( int nn = 0; nn < nFactor; ++nn ) {
+		for ( int jj = 0; jj < 4; ++jj ) {
+			float impulse[ 4 ] = { 0.0, 0.0, 0.0, 0.0 };
+			impulse[ jj ] = 1.0;
+			float fUnused;
+			interpolateFrame( mode, impulse, impulse, 4,
+							  1.0 + static_cast<double>( nn ) / nFactor, 0,
+							  &weights[ nn ][ jj ], &fUnused );
+		}
+	}
+
+	for ( int i = 0; i < nFrames; ++i ) {
+		if ( nPosition >= 1 && nPosition + 2 < nSampleFrames ) {
+			const float* pWeights = weights[ nPhase ];
+			pBuffer_L[ i ] = pWeights[ 0 ] * pSample_data_L[ nPosition - 1 ] +
+				pWeights[ 1 ] * pSample_data_L[ nPosition ] +
+				pWeights[ 2 ] * pSample_data_L[ nPosition + 1 ] +
+				pWeights[ 3 ] * pSample_data_L[ nPosition + 2 ];
+			pBuffer_R[ i ] = pWeights[ 0 ] * pSample_data_R[ nPosition - 1 ] +
+				pWeights[ 1 ] * pSample_data_R[ nPosition ] +
+				pWeights[ 2 ] * pSample_data_R[ nPosition + 1 ] +
+				pWeights[ 3 ] * pSample_data_R[ nPosition + 2 ];
+		} else {
+			// Boundaries of the sample.
+			interpolateFrame( mode, pSample_data_L, pSample_data_R, nSampleFrames,
+							  nPosition + static_cast<double>( nPhase ) / nFactor, 0,
+							  &pBuffer_L[ i ], &pBuffer_R[ i ] );
+		}
+
+		if ( ++nPhase == nFactor ) {
+			nPhase = 0;
+			++nPosition;
+		}
+	}
+
+	return nPosition + static_cast<double>( nPhase ) / nFactor;
+}
+
+/** Gains and output buffers a rendered voice is accumulated into. */
+struct VoiceMix {
+	float fCost_L;
+	float fCost_R;
+	float fCostTrack_L;
+	float fCostTrack_R;
+	float* pMainOut_L;
+	float* pMainOut_R;
+	float* pComponentOut_L;
+	float* pComponentOut_R;
+	/** JACK per-track outputs. Might be nullptr. */
+	float* pTrackOut_L;
+	float* pTrackOut_R;
+	float fPeak_L;
+	float fPeak_R;
+};
+
+/** Everything required to render a block of a resampled voice in a
+ * single pass. */
+struct FusedVoice : public VoiceMix {
+	const float* pSample_data_L;
+	const float* pSample_data_R;
+	int nSampleFrames;
+	double fSamplePos;
+	float fStep;
+	/** Constant value of the ADSR envelope. */
+	float fEnvelope;
+	/** LADSPA send buffers and their gains. */
+	int nSends;
+	float* pSend_L[ MAX_FX ];
+	float* pSend_R[ MAX_FX ];
+	float fSendCost_L[ MAX_FX ];
+	float fSendCost_R[ MAX_FX ];
+};
+
+/**
+ * Block size of the specialized render kernels covering frames
+ * [@a nStart, @a nEnd).
+ *
+ * Dedicated instantiations exist for complete periods of the buffer
+ * sizes commonly used by audio drivers. Their loop bounds are known
+ * at compile time, which allows the compiler to unroll and vectorize
+ * them.
+ *
+ * \return One of 32, 64, 128, and 256 or 0 in case the generic
+ *   kernels have to be used.
+ */
+static int fixedBlockSize( int nStart, int nEnd )
+{
+	if ( nStart != 0 ) {
+		return 0;
+	}
+	switch ( nEnd ) {
+	case 32:
+	case 64:
+	case 128:
+	case 256:
+		return nEnd;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Accumulates frames [@a nStart, @a nEnd) of a rendered voice into
+ * all outputs of @a mix and updates its peaks. If @a nBlockSize is
+ * not 0, the frames [0, @a nBlockSize) are processed instead.
+ */
+template <bool bTrackOuts, int nBlockSize>
+static void mixVoice( VoiceMix& mix, const float* pBuffer_L, const float* pBuffer_R,
+					  int nStart, int nEnd )
+{
+	// All buffers are taken from the AudioBufferArena or are aligned
+	// scratch buffers. Complete blocks start at an aligned address.
+	constexpr bool bAligned = nBlockSize > 0;
+	const float* __restrict__ pIn_L = AudioBufferArena::assumeAligned<bAligned>( pBuffer_L );
+	const float* __restrict__ pIn_R = AudioBufferArena::assumeAligned<bAligned>( pBuffer_R );
+	float* __restrict__ pMainOut_L = AudioBufferArena::assumeAligned<bAligned>( mix.pMainOut_L );
+	float* __restrict__ pMainOut_R = AudioBufferArena::assumeAligned<bAligned>( mix.pMainOut_R );
+	float* __restrict__ pComponentOut_L =
+		AudioBufferArena::assumeAligned<bAligned>( mix.pComponentOut_L );
+	float* __restrict__ pComponentOut_R =
+		AudioBufferArena::assumeAligned<bAligned>( mix.pComponentOut_R );
+	const float fCost_L = mix.fCost_L;
+	const float fCost_R = mix.fCost_R;
+	float fPeak_L = mix.fPeak_L;
+	float fPeak_R = mix.fPeak_R;
+	float fVal_L, fVal_R;
+
+	const int nFirst = nBlockSize > 0 ? 0 : nStart;
+	const int nLast = nBlockSize > 0 ? nBlockSize : nEnd;
+
+	for ( int nBufferPos = nFirst; nBufferPos < nLast; ++nBufferPos ) {
+		fVal_L = pIn_L[ nBufferPos ];
+		fVal_R = pIn_R[ nBufferPos ];
+
+		if ( bTrackOuts ) {
+			if ( mix.pTrackOut_L ) {
+				mix.pTrackOut_L[ nBufferPos ] += fVal_L * mix.fCostTrack_L;
+			}
+			if ( mix.pTrackOut_R ) {
+				mix.pTrackOut_R[ nBufferPos ] += fVal_R * mix.fCostTrack_R;
+			}
+		}
+
+		fVal_L = fVal_L * fCost_L;
+		fVal_R = fVal_R * fCost_R;
+
+		if ( fVal_L > fPeak_L ) {
+			fPeak_L = fVal_L;
+		}
+		if ( fVal_R > fPeak_R ) {
+			fPeak_R = fVal_R;
+		}
+
+		pComponentOut_L[ nBufferPos ] += fVal_L;
+		pComponentOut_R[ nBufferPos ] += fVal_R;
+		pMainOut_L[ nBufferPos ] += fVal_L;
+		pMainOut_R[ nBufferPos ] += fVal_R;
+	}
+
+	mix.fPeak_L = fPeak_L;
+	mix.fPeak_R = fPeak_R;
+}
+
+/** Selects the specialization of mixVoice() matching @a nBlockSize
+ * (see fixedBlockSize()) and the outputs used by @a mix. */
+static void mixVoice( VoiceMix& mix, const float* pBuffer_L, const float* pBuffer_R,
+					  int nStart, int nEnd, int nBlockSize )
+{
+	const bool bTrackOuts = mix.pTrackOut_L != nullptr || mix.pTrackOut_R != nullptr;
+
+#define H2_MIX_KERNEL( SIZE ) \
+	if ( bTrackOuts ) { \
+		mixVoice<true, SIZE>( mix, pBuffer_L, pBuffer_R, nStart, nEnd ); \
+	} else { \
+		mixVoice<false, SIZE>( mix, pBuffer_L, pBuffer_R, nStart, nEnd ); \
+	}
+
+	switch ( nBlockSize ) {
+	case 32:
+		H2_MIX_KERNEL( 32 );
+		break;
+	case 64:
+		H2_MIX_KERNEL( 64 );
+		break;
+	case 128:
+		H2_MIX_KERNEL( 128 );
+		break;
+	case 256:
+		H2_MIX_KERNEL( 256 );
+		break;
+	default:
+		H2_MIX_KERNEL( 0 );
+		break;
+	}
+#undef H2_MIX_KERNEL
+}
+
+/**
+ * Renders frames [@a nStart, @a nEnd) of a resampled voice with a
+ * constant envelope and without filter. Interpolation, envelope,
+ * gains, and all accumulations into the output buffers are done
+ * while the frame is kept in registers. Results are identical to the
+ * ones of the multi-pass rendering in Sampler::renderNoteResample().
+ * If @a nBlockSize is not 0, the frames [0, @a nBlockSize) are
+ * rendered instead.
+ */
+template <Interpolation::InterpolateMode mode, bool bTrackOuts, bool bSends, int nBlockSize>
+static void renderFusedResample( FusedVoice& voice, int nStart, int nEnd )
+{
+	const float* __restrict__ pSample_data_L = voice.pSample_data_L;
+	const float* __restrict__ pSample_data_R = voice.pSample_data_R;
+	constexpr bool bAligned = nBlockSize > 0;
+	float* __restrict__ pMainOut_L = AudioBufferArena::assumeAligned<bAligned>( voice.pMainOut_L );
+	float* __restrict__ pMainOut_R = AudioBufferArena::assumeAligned<bAligned>( voice.pMainOut_R );
+	float* __restrict__ pComponentOut_L =
+		AudioBufferArena::assumeAligned<bAligned>( voice.pComponentOut_L );
+	float* __restrict__ pComponentOut_R =
+		AudioBufferArena::assumeAligned<bAligned>( voice.pComponentOut_R );
+	const int nSampleFrames = voice.nSampleFrames;
+	const float fEnvelope = voice.fEnvelope;
+	const bool bApplyEnvelope = fEnvelope != 1.0;
+	const float fCost_L = voice.fCost_L;
+	const float fCost_R = voice.fCost_R;
+	const double fStep = voice.fStep;
+	double fSamplePos = voice.fSamplePos;
+	float fPeak_L = voice.fPeak_L;
+	float fPeak_R = voice.fPeak_R;
+	float fVal_L, fVal_R;
+
+	const int nFirst = nBlockSize > 0 ? 0 : nStart;
+	const int nLast = nBlockSize > 0 ? nBlockSize : nEnd;
+
+	for ( int nBufferPos = nFirst; nBufferPos < nLast; ++nBufferPos ) {
+		interpolateFrame<mode>( pSample_data_L, pSample_data_R, nSampleFrames,
+								fSamplePos, fStep, &fVal_L, &fVal_R );
+		fSamplePos += fStep;
+
+		if ( bApplyEnvelope ) {
+			fVal_L *= fEnvelope;
+			fVal_R *= fEnvelope;
+		}
+
+		if ( bSends ) {
+			for ( int nSend = 0; nSend < voice.nSends; ++nSend ) {
+				voice.pSend_L[ nSend ][ nBufferPos ] += fVal_L * voice.fSendCost_L[ nSend ];
+				voice.pSend_R[ nSend ][ nBufferPos ] += fVal_R * voice.fSendCost_R[ nSend ];
+			}
+		}
+
+		if ( bTrackOuts ) {
+			if ( voice.pTrackOut_L ) {
+				voice.pTrackOut_L[ nBufferPos ] += fVal_L * voice.fCostTrack_L;
+			}
+			if ( voice.pTrackOut_R ) {
+				voice.pTrackOut_R[ nBufferPos ] += fVal_R * voice.fCostTrack_R;
+			}
+		}
+
+		fVal_L = fVal_L * fCost_L;
+		fVal_R = fVal_R * fCost_R;
+
+		if ( fVal_L > fPeak_L ) {
+			fPeak_L = fVal_L;
+		}
+		if ( fVal_R > fPeak_R ) {
+			fPeak_R = fVal_R;
+		}
+
+		pComponentOut_L[ nBufferPos ] += fVal_L;
+		pComponentOut_R[ nBufferPos ] += fVal_R;
+		pMainOut_L[ nBufferPos ] += fVal_L;
+		pMainOut_R[ nBufferPos ] += fVal_R;
+	}
+
+	voice.fSamplePos = fSamplePos;
+	voice.fPeak_L = fPeak_L;
+	voice.fPeak_R = fPeak_R;
+}
+
+/** Selects the instantiation of renderFusedResample() matching
+ * @a nBlockSize (see fixedBlockSize()). The windowed sinc is
+ * dominated by the interpolation itself and always uses the generic
+ * one. */
+template <Interpolation::InterpolateMode mode, bool bTrackOuts, bool bSends>
+static void renderFusedResampleBlock( FusedVoice& voice, int nStart, int nEnd,
+									  int nBlockSize )
+{
+	if constexpr ( mode == Interpolation::InterpolateMode::Sinc ) {
+		renderFusedResample<mode, bTrackOuts, bSends, 0>( voice, nStart, nEnd );
+	} else {
+		switch ( nBlockSize ) {
+		case 32:
+			renderFusedResample<mode, bTrackOuts, bSends, 32>( voice, nStart, nEnd );
+			break;
+		case 64:
+			renderFusedResample<mode, bTrackOuts, bSends, 64>( voice, nStart, nEnd );
+			break;
+		case 128:
+			renderFusedResample<mode, bTrackOuts, bSends, 128>( voice, nStart, nEnd );
+			break;
+		case 256:
+			renderFusedResample<mode, bTrackOuts, bSends, 256>( voice, nStart, nEnd );
+			break;
+		default:
+			renderFusedResample<mode, bTrackOuts, bSends, 0>( voice, nStart, nEnd );
+			break;
+		}
+	}
+}
+
+/** Selects the specialization of renderFusedResample() matching the
+ * features used by @a voice and @a nBlockSize. */
+static void renderFusedResample( Interpolation::InterpolateMode mode, FusedVoice& voice,
+								 int nStart, int nEnd, int nBlockSize )
+{
+	const bool bTrackOuts = voice.pTrackOut_L != nullptr || voice.pTrackOut_R != nullptr;
+	const bool bSends = voice.nSends > 0;
+
+#define H2_FUSED_KERNEL( MODE ) \
+	if ( bTrackOuts ) { \
+		if ( bSends ) { \
+			renderFusedResampleBlock<MODE, true, true>( voice, nStart, nEnd, nBlockSize ); \
+		} else { \
+			renderFusedResampleBlock<MODE, true, false>( voice, nStart, nEnd, nBlockSize ); \
+		} \
+	} else { \
+		if ( bSends ) { \
+			renderFusedResampleBlock<MODE, false, true>( voice, nStart, nEnd, nBlockSize ); \
+		} else { \
+			renderFusedResampleBlock<MODE, false, false>( voice, nStart, nEnd, nBlockSize ); \
+		} \
+	}
+
+	switch ( mode ) {
+	case Interpolation::InterpolateMode::Linear:
+		H2_FUSED_KERNEL( Interpolation::InterpolateMode::Linear );
+		break;
+	case Interpolation::InterpolateMode::Cosine:
+		H2_FUSED_KERNEL( Interpolation::InterpolateMode::Cosine );
+		break;
+	case Interpolation::InterpolateMode::Third:
+		H2_FUSED_KERNEL( Interpolation::InterpolateMode::Third );
+		break;
+	case Interpolation::InterpolateMode::Cubic:
+		H2_FUSED_KERNEL( Interpolation::InterpolateMode::Cubic );
+		break;
+	case Interpolation::InterpolateMode::Hermite:
+		H2_FUSED_KERNEL( Interpolation::InterpolateMode::Hermite );
+		break;
+	case Interpolation::InterpolateMode::Sinc:
+		H2_FUSED_KERNEL( Interpolation::InterpolateMode::Sinc );
+		break;
+	}
+#undef H2_FUSED_KERNEL
+}
+
 Sampler::Sampler()
 		: m_pMainOut_L( nullptr )
 		, m_pMainOut_R( nullptr )
 		, m_pPreviewInstrument( nullptr )
+		, m_fCullingThreshold( 0 )
+		, m_nCulledVoices( 0 )
+		, m_bUseFusedKernels( true )
+		, m_bUseFixedBlockKernels( true )
+		, m_nOffset( 0 )
+		, m_pPanLawTable( nullptr )
 		, m_interpolateMode( Interpolation::InterpolateMode::Linear )
 {
 	
 	
-	m_pMainOut_L = new float[ MAX_BUFFER_SIZE ];
-	m_pMainOut_R = new float[ MAX_BUFFER_SIZE ];
+	m_pMainOut_L = AudioBufferArena::get_instance()->allocate( MAX_BUFFER_SIZE, 2 );
+	m_pMainOut_R = m_pMainOut_L + AudioBufferArena::stride( MAX_BUFFER_SIZE );
+
+	// Tabulate the windowed sinc outside of the realtime thread.
+	Resampler::sincTable();
+
+	m_pVoiceManager = new VoiceManager( Preferences::get_instance()->m_nMaxNotes );
+	m_queuedNoteOffs.reserve( 2 * m_pVoiceManager->getMaxVoices() );
 
 	m_nMaxLayers = InstrumentComponent::getMaxLayers();
 
@@ -96,8 +627,9 @@ Sampler::~Sampler()
 {
 	INFOLOG( "DESTROY" );
 
-	delete[] m_pMainOut_L;
-	delete[] m_pMainOut_R;
+	AudioBufferArena::get_instance()->release( m_pMainOut_L );
+
+	delete m_pVoiceManager;
 
 	m_pPreviewInstrument = nullptr;
 	m_pPlaybackTrackInstrument = nullptr;
@@ -108,37 +640,56 @@ Sampler::~Sampler()
  */
 float const Sampler::K_NORM_DEFAULT = 1.33333333333333;
 
-void Sampler::process( uint32_t nFrames, std::shared_ptr<Song> pSong )
+void Sampler::process( uint32_t nFrames, std::shared_ptr<Song> pSong, uint32_t nOffset )
 {
 	AudioOutput* pAudioOutpout = Hydrogen::get_instance()->getAudioOutput();
 	assert( pAudioOutpout );
 
+	m_nOffset = nOffset;
+
 	memset( m_pMainOut_L, 0, nFrames * sizeof( float ) );
 	memset( m_pMainOut_R, 0, nFrames * sizeof( float ) );
 
 	// Track output queues are zeroed by
 	// audioEngine_process_clearAudioBuffers()
 
-	// Max notes limit
-	int m_nMaxNotes = Preferences::get_instance()->m_nMaxNotes;
-	while ( ( int )m_playingNotesQueue.size() > m_nMaxNotes ) {
-		Note * pOldNote = m_playingNotesQueue[ 0 ];
-		m_playingNotesQueue.erase( m_playingNotesQueue.begin() );
-		pOldNote->get_instrument()->dequeue();
-		delete  pOldNote;	// FIXME: send note-off instead of removing the note from the list?
+	const auto pPref = Preferences::get_instance();
+	m_nCulledVoices = 0;
+	if ( pPref->m_bVoiceCulling ) {
+		m_fCullingThreshold =
+			std::pow( 10.f, pPref->m_fVoiceCullingThreshold / 20.f );
+	} else {
+		m_fCullingThreshold = 0;
+	}
+
+	// Max notes limit. Voices exceeding it are stolen and faded out
+	// in noteOn(). Only if those fade outs pile up, the oldest voices
+	// will be dropped right away. This is done in noteOn() as well
+	// and is only required here in case the limit was lowered.
+	const int nMaxNotes = pPref->m_nMaxNotes;
+	if ( m_pVoiceManager->getMaxVoices() != nMaxNotes ) {
+		m_pVoiceManager->setMaxVoices( nMaxNotes );
+		m_queuedNoteOffs.reserve( 2 * m_pVoiceManager->getMaxVoices() );
+	}
+	while ( m_pVoiceManager->size() > 2 * m_pVoiceManager->getMaxVoices() ) {
+		dropOldestVoice();
 	}
 
 	for ( auto& pComponent : *pSong->getComponents() ) {
 		pComponent->reset_outs(nFrames);
 	}
 
+	m_pPanLawTable = pSong->getPanLawTable();
+
 	// eseguo tutte le note nella lista di note in esecuzione
-	unsigned i = 0;
+	int i = 0;
 	Note* pNote;
-	while ( i < m_playingNotesQueue.size() ) {
-		pNote = m_playingNotesQueue[ i ];		// recupero una nuova nota
-		if ( renderNote( pNote, nFrames, pSong ) ) {	// la nota e' finita
-			m_playingNotesQueue.erase( m_playingNotesQueue.begin() + i );
+	while ( i < m_pVoiceManager->size() ) {
+		pNote = ( *m_pVoiceManager )[ i ].pNote;		// recupero una nuova nota
+		if ( renderNote( ( *m_pVoiceManager )[ i ], nFrames, pSong ) ) {	// la nota e' finita
+			// The last voice takes the place of the finished one
+			// and is rendered next.
+			m_pVoiceManager->remove( i );
 			pNote->get_instrument()->dequeue();
 			m_queuedNoteOffs.push_back( pNote );
 		} else {
@@ -146,15 +697,39 @@ void Sampler::process( uint32_t nFrames, std::shared_ptr<Song> pSong )
 		}
 	}
 
+	// Frame at which the current block ends. Voices stopped within
+	// it, for which the exact frame is unknown, are released there.
+	long long nBlockEnd = 0;
+	MidiOutput* pMidiOut = Hydrogen::get_instance()->getMidiOutput();
+	if ( pMidiOut != nullptr && ! m_queuedNoteOffs.empty() ) {
+		auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+		if ( pAudioEngine->getState() == AudioEngine::State::Playing ||
+			 pAudioEngine->getState() == AudioEngine::State::Testing ) {
+			nBlockEnd = pAudioEngine->getTransportPosition()->getFrame() + nFrames;
+		} else {
+			nBlockEnd = pAudioEngine->getRealtimeFrame() + nFrames;
+		}
+	}
+
 	//Queue midi note off messages for notes that have a length specified for them
 	while ( !m_queuedNoteOffs.empty() ) {
 		pNote =  m_queuedNoteOffs[0];
-		MidiOutput* pMidiOut = Hydrogen::get_instance()->getMidiOutput();
 		
 		if( pMidiOut != nullptr && !pNote->get_instrument()->is_muted() ){
-			pMidiOut->handleQueueNoteOff(	pNote->get_instrument()->get_midi_out_channel(), 
+			long long nNoteOff = nBlockEnd;
+			if ( pNote->get_length() != -1 ) {
+				double fTickMismatch;
+				const long long nNoteLength =
+					TransportPosition::computeFrameFromTick(
+						pNote->get_position() + pNote->get_length(), &fTickMismatch ) -
+					TransportPosition::computeFrameFromTick(
+						pNote->get_position(), &fTickMismatch );
+				nNoteOff = std::min( pNote->getNoteStart() + nNoteLength, nBlockEnd );
+			}
+			pMidiOut->handleQueueNoteOffAt(	pNote->get_instrument()->get_midi_out_channel(), 
 											pNote->get_midi_key(),
-											pNote->get_midi_velocity() );
+											pNote->get_midi_velocity(),
+											nNoteOff );
 		}
 		
 		m_queuedNoteOffs.erase( m_queuedNoteOffs.begin() );
@@ -170,7 +745,7 @@ void Sampler::process( uint32_t nFrames, std::shared_ptr<Song> pSong )
 }
 
 bool Sampler::isRenderingNotes() const {
-	return m_playingNotesQueue.size() > 0;
+	return ! m_pVoiceManager->isEmpty();
 }
 
 void Sampler::noteOn(Note *pNote )
@@ -184,34 +759,54 @@ void Sampler::noteOn(Note *pNote )
 	int nMuteGrp = pInstr->get_mute_group();
 	if ( nMuteGrp != -1 ) {
 		// remove all notes using the same mute group
-		for ( const auto& pNote: m_playingNotesQueue ) {	// delete older note
-			if ( ( pNote->get_instrument() != pInstr )  && ( pNote->get_instrument()->get_mute_group() == nMuteGrp ) ) {
-				pNote->get_adsr()->release();
+		for ( const auto& voice : m_pVoiceManager->getVoices() ) {	// delete older note
+			if ( ( voice.pNote->get_instrument() != pInstr )  && ( voice.pNote->get_instrument()->get_mute_group() == nMuteGrp ) ) {
+				voice.pNote->get_adsr()->release();
 			}
 		}
 	}
 
 	//note off notes
 	if( pNote->get_note_off() ){
-		for ( const auto& pNote: m_playingNotesQueue ) {
-			if ( ( pNote->get_instrument() == pInstr ) ) {
+		for ( const auto& voice : m_pVoiceManager->getVoices() ) {
+			if ( ( voice.pNote->get_instrument() == pInstr ) ) {
 				//ERRORLOG("note_off");
-				pNote->get_adsr()->release();
+				voice.pNote->get_adsr()->release();
 			}
 		}
 	}
 
 	pInstr->enqueue();
 	if( !pNote->get_note_off() ){
-		m_playingNotesQueue.push_back( pNote );
+		// Fade out voices exceeding the global or per-instrument
+		// polyphony limit.
+		const auto pPref = Preferences::get_instance();
+		m_pVoiceManager->makeRoomFor( pNote, pPref->m_voiceStealingPolicy,
+									  pPref->m_nVoiceStealingFadeOut );
+		// Voices still fading out may occupy all reserved slots.
+		// Drop the oldest ones instead of growing the storage in the
+		// audio thread.
+		while ( m_pVoiceManager->isFull() ) {
+			dropOldestVoice();
+		}
+		m_pVoiceManager->add( pNote );
+	}
+}
+
+void Sampler::dropOldestVoice()
+{
+	Note* pOldNote = m_pVoiceManager->dropOldest();
+	if ( pOldNote != nullptr ) {
+		pOldNote->get_instrument()->dequeue();
+		m_queuedNoteOffs.push_back( pOldNote );
 	}
 }
 
 void Sampler::midiKeyboardNoteOff( int key )
 {
-	for ( const auto& pNote: m_playingNotesQueue ) {
-		if ( ( pNote->get_midi_msg() == key) ) {
-			pNote->get_adsr()->release();
+	for ( const auto& voice : m_pVoiceManager->getVoices() ) {
+		if ( ( voice.pNote->get_midi_msg() == key) ) {
+			voice.pNote->get_adsr()->release();
 		}
 	}
 }
@@ -223,9 +818,9 @@ void Sampler::noteOff(Note* pNote )
 {
 	auto pInstr = pNote->get_instrument();
 	// find the notes using the same instrument, and release them
-	for ( const auto& pNote: m_playingNotesQueue ) {
-		if ( pNote->get_instrument() == pInstr ) {
-			pNote->get_adsr()->release();
+	for ( const auto& voice : m_pVoiceManager->getVoices() ) {
+		if ( voice.pNote->get_instrument() == pInstr ) {
+			voice.pNote->get_adsr()->release();
 		}
 	}
 	
@@ -362,60 +957,18 @@ float Sampler::ratioConstKNormPanLaw( float fPan, float k) {
 	}
 }
 
-// function to direct the computation to the selected pan law.
-inline float Sampler::panLaw( float fPan, std::shared_ptr<Song> pSong ) {
-	int nPanLawType = pSong->getPanLawType();
-	if ( nPanLawType == RATIO_STRAIGHT_POLYGONAL ) {
-		return ratioStraightPolygonalPanLaw( fPan );
-	} else if ( nPanLawType == RATIO_CONST_POWER ) {
-		return ratioConstPowerPanLaw( fPan );
-	} else if ( nPanLawType == RATIO_CONST_SUM ) {
-		return ratioConstSumPanLaw( fPan );
-	} else if ( nPanLawType == LINEAR_STRAIGHT_POLYGONAL ) {
-		return linearStraightPolygonalPanLaw( fPan );
-	} else if ( nPanLawType == LINEAR_CONST_POWER ) {
-		return linearConstPowerPanLaw( fPan );
-	} else if ( nPanLawType == LINEAR_CONST_SUM ) {
-		return linearConstSumPanLaw( fPan );
-	} else if ( nPanLawType == POLAR_STRAIGHT_POLYGONAL ) {
-		return polarStraightPolygonalPanLaw( fPan );
-	} else if ( nPanLawType == POLAR_CONST_POWER ) {
-		return polarConstPowerPanLaw( fPan );
-	} else if ( nPanLawType == POLAR_CONST_SUM ) {
-		return polarConstSumPanLaw( fPan );
-	} else if ( nPanLawType == QUADRATIC_STRAIGHT_POLYGONAL ) {
-		return quadraticStraightPolygonalPanLaw( fPan );
-	} else if ( nPanLawType == QUADRATIC_CONST_POWER ) {
-		return quadraticConstPowerPanLaw( fPan );
-	} else if ( nPanLawType == QUADRATIC_CONST_SUM ) {
-		return quadraticConstSumPanLaw( fPan );
-	} else if ( nPanLawType == LINEAR_CONST_K_NORM ) {
-		return linearConstKNormPanLaw( fPan, pSong->getPanLawKNorm() );
-	} else if ( nPanLawType == POLAR_CONST_K_NORM ) {
-		return polarConstKNormPanLaw( fPan, pSong->getPanLawKNorm() );
-	} else if ( nPanLawType == RATIO_CONST_K_NORM ) {
-		return ratioConstKNormPanLaw( fPan, pSong->getPanLawKNorm() );
-	} else if ( nPanLawType == QUADRATIC_CONST_K_NORM ) {
-		return quadraticConstKNormPanLaw( fPan, pSong->getPanLawKNorm() );
-	} else {
-		WARNINGLOG( "Unknown pan law type. Set default." );
-		pSong->setPanLawType( RATIO_STRAIGHT_POLYGONAL );
-		return ratioStraightPolygonalPanLaw( fPan );
-	}
-}
-
 void Sampler::handleTimelineOrTempoChange() {
-	if ( m_playingNotesQueue.size() == 0 ) {
+	if ( m_pVoiceManager->isEmpty() ) {
 		return;
 	}
 
-	for ( auto nnote : m_playingNotesQueue ) {
-		nnote->computeNoteStart();
+	for ( const auto& voice : m_pVoiceManager->getVoices() ) {
+		voice.pNote->computeNoteStart();
 	}
 }
 
 void Sampler::handleSongSizeChange() {
-	if ( m_playingNotesQueue.size() == 0 ) {
+	if ( m_pVoiceManager->isEmpty() ) {
 		return;
 	}
 
@@ -423,7 +976,8 @@ void Sampler::handleSongSizeChange() {
 		static_cast<long>(std::floor(Hydrogen::get_instance()->getAudioEngine()->
 									 getTransportPosition()->getTickOffsetSongSize()));
 	
-	for ( auto nnote : m_playingNotesQueue ) {
+	for ( const auto& voice : m_pVoiceManager->getVoices() ) {
+		auto nnote = voice.pNote;
 		
 		// DEBUGLOG( QString( "pos: %1 -> %2, nTickOffset: %3, note: %4" )
 		// 		  .arg( nnote->get_position() )
@@ -447,10 +1001,12 @@ void Sampler::handleSongSizeChange() {
 /// Render a note
 /// Return false: the note is not ended
 /// Return true: the note is ended
-bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Song> pSong )
+bool Sampler::renderNote( Voice& voice, unsigned nBufferSize, std::shared_ptr<Song> pSong )
 {
 	assert( pSong );
 
+	Note* pNote = voice.pNote;
+
 	auto pInstr = pNote->get_instrument();
 	if ( pInstr == nullptr ) {
 		ERRORLOG( "NULL instrument" );
@@ -526,10 +1082,67 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 	*/
 	float fPan = pInstr->getPan() + pNote->getPan() * ( 1 - fabs( pInstr->getPan() ) );
 	
-	// Pass fPan to the Pan Law
-	float fPan_L = panLaw( fPan, pSong );
-	float fPan_R = panLaw( -fPan, pSong );
+	// Pass fPan to the Pan Law. The resulting gains are cached on the
+	// voice until either the pan or the pan law changes.
+	bool bPanChanged = false;
+	if ( fPan != voice.fCachedPan ||
+		 m_pPanLawTable->getPanLawType() != voice.nCachedPanLawType ||
+		 m_pPanLawTable->getKNorm() != voice.fCachedPanLawKNorm ) {
+		voice.fPanGain_L = m_pPanLawTable->getGain( fPan );
+		voice.fPanGain_R = m_pPanLawTable->getGain( -fPan );
+		voice.fCachedPan = fPan;
+		voice.nCachedPanLawType = m_pPanLawTable->getPanLawType();
+		voice.fCachedPanLawKNorm = m_pPanLawTable->getKNorm();
+		bPanChanged = true;
+	}
 	//---------------------------------------------------------
+
+	/*
+	 *  Is instrument muted?
+	 *
+	 *  This can be the case either if: 
+	 *   - the song or instrument is muted 
+	 *   - if we're in an export session and we're doing per-instruments exports, 
+	 *       but this instrument is not currently being exported.
+	 *   - if at least one instrument is soloed (but not this instrument)
+	 *
+	 *  Muted components are handled separately for each of them.
+	 */
+	const bool isMutedForExport = (pHydrogen->getIsExportSessionActive() && !pInstr->is_currently_exported());
+	const bool bAnyInstrumentIsSoloed = pSong->getInstrumentList()->isAnyInstrumentSoloed();
+	const bool isMutedBecauseOfSolo = (bAnyInstrumentIsSoloed && !pInstr->is_soloed());
+	const bool bIsMuted = isMutedForExport || pInstr->is_muted() ||
+		pSong->getIsMuted() || isMutedBecauseOfSolo;
+
+	// Combine the gains shared by all components of the note. Just
+	// like the pan law gains they are cached on the voice until one
+	// of their inputs changes.
+	const bool bPostFader = Preferences::get_instance()->m_JackTrackOutputMode ==
+		Preferences::JackTrackOutputMode::postFader;
+	const float fVelocity = pInstr->get_apply_velocity() ?
+		pNote->get_velocity() : 1.0f;
+	if ( bPanChanged ||
+		 fVelocity != voice.fCachedVelocity ||
+		 pInstr->get_gain() != voice.fCachedInstrumentGain ||
+		 pInstr->get_volume() != voice.fCachedInstrumentVolume ||
+		 pSong->getVolume() != voice.fCachedSongVolume ||
+		 bIsMuted != voice.bCachedMuted ) {
+		const float fInstrumentGain = fVelocity * pInstr->get_gain() *
+			pInstr->get_volume();
+		voice.fFaderGain_L = voice.fPanGain_L * fInstrumentGain;
+		voice.fFaderGain_R = voice.fPanGain_R * fInstrumentGain;
+		voice.fGain_L = voice.fFaderGain_L * pSong->getVolume();
+		voice.fGain_R = voice.fFaderGain_R * pSong->getVolume();
+		voice.fMixGain_L = bIsMuted ? 0.0f : voice.fGain_L;
+		voice.fMixGain_R = bIsMuted ? 0.0f : voice.fGain_R;
+		voice.fTrackGain_L = bIsMuted ? 0.0f : voice.fFaderGain_L * 2;
+		voice.fTrackGain_R = bIsMuted ? 0.0f : voice.fFaderGain_R * 2;
+		voice.fCachedVelocity = fVelocity;
+		voice.fCachedInstrumentGain = pInstr->get_gain();
+		voice.fCachedInstrumentVolume = pInstr->get_volume();
+		voice.fCachedSongVolume = pSong->getVolume();
+		voice.bCachedMuted = bIsMuted;
+	}
 	auto components = pInstr->get_components();
 	bool nReturnValues[ components->size() ];
 
@@ -539,6 +1152,7 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 
 	int nReturnValueIndex = 0;
 	int nAlreadySelectedLayer = -1;
+	bool bCulled = false;
 
 	for ( const auto& pCompo : *components ) {
 		nReturnValues[nReturnValueIndex] = false;
@@ -599,64 +1213,18 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 			continue;
 		}
 
-		float cost_L = 1.0f;
-		float cost_R = 1.0f;
+		// Gains specific to this component.
+		const float fComponentGain = fLayerGain * pCompo->get_gain() *
+			pMainCompo->get_volume();
+
+		// Gains before muting.
+		float cost_L = voice.fGain_L * fComponentGain;
+		float cost_R = voice.fGain_R * fComponentGain;
 		float cost_track_L = 1.0f;
 		float cost_track_R = 1.0f;
-		
-		bool isMutedForExport = (pHydrogen->getIsExportSessionActive() && !pInstr->is_currently_exported());
-		bool bAnyInstrumentIsSoloed = pSong->getInstrumentList()->isAnyInstrumentSoloed();
-		bool isMutedBecauseOfSolo = (bAnyInstrumentIsSoloed && !pInstr->is_soloed());
-		
-		/*
-		 *  Is instrument muted?
-		 *
-		 *  This can be the case either if: 
-		 *   - the song, instrument or component is muted 
-		 *   - if we're in an export session and we're doing per-instruments exports, 
-		 *       but this instrument is not currently being exported.
-		 *   - if at least one instrument is soloed (but not this instrument)
-		 */
-		if ( isMutedForExport || pInstr->is_muted() || pSong->getIsMuted() || pMainCompo->is_muted() || isMutedBecauseOfSolo) {	
-			cost_L = 0.0;
-			cost_R = 0.0;
-			if ( Preferences::get_instance()->m_JackTrackOutputMode == Preferences::JackTrackOutputMode::postFader ) {
-				cost_track_L = 0.0;
-				cost_track_R = 0.0;
-			}
-
-		} else {	// Precompute some values...
-			if ( pInstr->get_apply_velocity() ) {
-				cost_L = cost_L * pNote->get_velocity();		// note velocity
-				cost_R = cost_R * pNote->get_velocity();		// note velocity
-			}
-
-
-			cost_L *= fPan_L;							// pan
-			cost_L = cost_L * fLayerGain;				// layer gain
-			cost_L = cost_L * pInstr->get_gain();		// instrument gain
-
-			cost_L = cost_L * pCompo->get_gain();		// Component gain
-			cost_L = cost_L * pMainCompo->get_volume(); // Component volument
-
-			cost_L = cost_L * pInstr->get_volume();		// instrument volume
-			if ( Preferences::get_instance()->m_JackTrackOutputMode == Preferences::JackTrackOutputMode::postFader ) {
-				cost_track_L = cost_L * 2;
-			}
-			cost_L = cost_L * pSong->getVolume();	// song volume
-
-			cost_R *= fPan_R;							// pan
-			cost_R = cost_R * fLayerGain;				// layer gain
-			cost_R = cost_R * pInstr->get_gain();		// instrument gain
-
-			cost_R = cost_R * pCompo->get_gain();		// Component gain
-			cost_R = cost_R * pMainCompo->get_volume(); // Component volument
-
-			cost_R = cost_R * pInstr->get_volume();		// instrument volume
-			if ( Preferences::get_instance()->m_JackTrackOutputMode == Preferences::JackTrackOutputMode::postFader ) {
-				cost_track_R = cost_R * 2;
-			}
-			cost_R = cost_R * pSong->getVolume();	// song pan
+		if ( bPostFader ) {
+			cost_track_L = voice.fFaderGain_L * 2 * fComponentGain;
+			cost_track_R = voice.fFaderGain_R * 2 * fComponentGain;
 		}
 
 		// direct track outputs only use velocity
@@ -666,6 +1234,38 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 			cost_track_R = cost_track_L;
 		}
 
+		// Retire components which can not be heard anymore. The gains
+		// are taken before muting, so a voice which is only muted for
+		// a while keeps its tail once being unmuted again.
+		if ( m_fCullingThreshold > 0 ) {
+			float fGain = std::max( cost_L, cost_R );
+			if ( Preferences::get_instance()->m_bJackTrackOuts ) {
+				fGain = std::max( { fGain, cost_track_L, cost_track_R } );
+			}
+			if ( isInaudible( pNote, pSample, pSelectedLayer, fGain ) ) {
+				bCulled = true;
+				nReturnValues[nReturnValueIndex] = true;
+				nReturnValueIndex++;
+				continue;
+			}
+		}
+
+		if ( pMainCompo->is_muted() ) {
+			cost_L = 0.0;
+			cost_R = 0.0;
+			if ( bPostFader ) {
+				cost_track_L = 0.0;
+				cost_track_R = 0.0;
+			}
+		} else {
+			cost_L = voice.fMixGain_L * fComponentGain;
+			cost_R = voice.fMixGain_R * fComponentGain;
+			if ( bPostFader ) {
+				cost_track_L = voice.fTrackGain_L * fComponentGain;
+				cost_track_R = voice.fTrackGain_R * fComponentGain;
+			}
+		}
+
 		// Se non devo fare resample (drumkit) posso evitare di utilizzare i float e gestire il tutto in
 		// maniera ottimizzata
 		//	constant^12 = 2, so constant = 2^(1/12) = 1.059463.
@@ -694,9 +1294,43 @@ bool Sampler::renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Son
 			return false;
 		}
 	}
+
+	if ( bCulled ) {
+		++m_nCulledVoices;
+		m_pVoiceManager->countCulledVoice();
+	}
 	return true;
 }
 
+bool Sampler::isInaudible( Note* pNote, std::shared_ptr<Sample> pSample,
+						   std::shared_ptr<SelectedLayerInfo> pSelectedLayer,
+						   float fGain ) const
+{
+	auto pADSR = pNote->get_adsr();
+	if ( ! pNote->isPartiallyRendered() || pADSR->isAttacking() ||
+		 ! pSample->hasLevelEnvelopes() ) {
+		return false;
+	}
+
+	// Outside of the attack phase the envelope does not increase
+	// anymore and the remaining peak of the sample is an upper bound
+	// for everything still to come.
+	float fLevel = pADSR->getValue() *
+		pSample->getRemainingPeak( static_cast<int>(pSelectedLayer->SamplePosition) );
+
+	if ( pNote->get_instrument()->is_filter_active() ) {
+		// The resonant filter may keep the note ringing after the
+		// sample did end (see Note::filter_sustain()).
+		fLevel = std::max( { fLevel,
+							 std::fabs( pNote->get_lpfb_l() ),
+							 std::fabs( pNote->get_lpfb_r() ),
+							 std::fabs( pNote->get_bpfb_l() ),
+							 std::fabs( pNote->get_bpfb_r() ) } );
+	}
+
+	return fLevel * fGain < m_fCullingThreshold;
+}
+
 bool Sampler::processPlaybackTrack(int nBufferSize)
 {
 	Hydrogen* pHydrogen = Hydrogen::get_instance();
@@ -852,6 +1486,9 @@ bool Sampler::processPlaybackTrack(int nBufferSize)
 								fVal_L = Interpolation::hermite_Interpolate( pSample_data_L[ nSamplePos -1], pSample_data_L[nSamplePos], pSample_data_L[nSamplePos + 1], last_l, fDiff);
 								fVal_R = Interpolation::hermite_Interpolate( pSample_data_R[ nSamplePos -1], pSample_data_R[nSamplePos], pSample_data_R[nSamplePos + 1], last_r, fDiff);
 								break;
+						case Interpolation::InterpolateMode::Sinc:
+								Resampler::sincInterpolate( pSample_data_L, pSample_data_R, nSampleFrames, fSamplePos, fStep, &fVal_L, &fVal_R );
+								break;
 					}
 			}
 			
@@ -935,8 +1572,6 @@ bool Sampler::renderNoteNoResample(
 
 	auto pADSR = pNote->get_adsr();
 	float fADSRValue;
-	float fVal_L;
-	float fVal_R;
 
 #ifdef H2CORE_HAVE_JACK
 	float *		pTrackOutL = nullptr;
@@ -947,12 +1582,18 @@ bool Sampler::renderNoteNoResample(
 		if( pJackAudioDriver ) {
 			pTrackOutL = pJackAudioDriver->getTrackOut_L( pInstrument, pCompo );
 			pTrackOutR = pJackAudioDriver->getTrackOut_R( pInstrument, pCompo );
+			if ( pTrackOutL != nullptr ) {
+				pTrackOutL += m_nOffset;
+			}
+			if ( pTrackOutR != nullptr ) {
+				pTrackOutR += m_nOffset;
+			}
 		}
 	}
 #endif
 
-	float buffer_L[ MAX_BUFFER_SIZE ];
-	float buffer_R[ MAX_BUFFER_SIZE ];
+	alignas( 64 ) float buffer_L[ MAX_BUFFER_SIZE ];
+	alignas( 64 ) float buffer_R[ MAX_BUFFER_SIZE ];
 	int nNoteEnd;
 	if ( nNoteLength == -1) {
 		nNoteEnd = pSelectedLayerInfo->SamplePosition + nTimes + 1;
@@ -976,64 +1617,41 @@ bool Sampler::renderNoteNoResample(
 	if ( pADSR->applyADSR( buffer_L, buffer_R, nTimes, nNoteEnd, 1 ) ) {
 		retValue = true;
 	}
-	bool bFilterIsActive = pInstrument->is_filter_active();
-	// Low pass resonant filter
-
-	if ( bFilterIsActive ) {
-		for ( int nBufferPos = nInitialBufferPos; nBufferPos < nTimes; ++nBufferPos ) {
-
-			fVal_L = buffer_L[ nBufferPos ];
-			fVal_R = buffer_R[ nBufferPos ];
-
-			pNote->compute_lr_values( &fVal_L, &fVal_R );
-
-			buffer_L[ nBufferPos ] = fVal_L;
-			buffer_R[ nBufferPos ] = fVal_R;
-
-		}
+	// Resonant filter
+	if ( pInstrument->is_filter_active() ) {
+		pNote->applyFilter( &buffer_L[ nInitialBufferPos ], &buffer_R[ nInitialBufferPos ],
+							nTimes - nInitialBufferPos, pSelectedLayerInfo );
 	}
 
-	for ( int nBufferPos = nInitialBufferPos; nBufferPos < nTimes; ++nBufferPos ) {
-
-		fVal_L = buffer_L[ nBufferPos ];
-		fVal_R = buffer_R[ nBufferPos ];
-
-
+	VoiceMix mix;
+	mix.fCost_L = cost_L;
+	mix.fCost_R = cost_R;
+	mix.fCostTrack_L = cost_track_L;
+	mix.fCostTrack_R = cost_track_R;
+	mix.pMainOut_L = m_pMainOut_L;
+	mix.pMainOut_R = m_pMainOut_R;
+	mix.pComponentOut_L = pDrumCompo->get_out_L_buffer();
+	mix.pComponentOut_R = pDrumCompo->get_out_R_buffer();
+	mix.pTrackOut_L = nullptr;
+	mix.pTrackOut_R = nullptr;
 #ifdef H2CORE_HAVE_JACK
-		if(  pTrackOutL ) {
-			 pTrackOutL[nBufferPos] += fVal_L * cost_track_L;
-		}
-		if( pTrackOutR ) {
-			pTrackOutR[nBufferPos] += fVal_R * cost_track_R;
-		}
+	mix.pTrackOut_L = pTrackOutL;
+	mix.pTrackOut_R = pTrackOutR;
 #endif
+	mix.fPeak_L = fInstrPeak_L;
+	mix.fPeak_R = fInstrPeak_R;
 
-		fVal_L = fVal_L * cost_L;
-		fVal_R = fVal_R * cost_R;
+	mixVoice( mix, buffer_L, buffer_R, nInitialBufferPos, nTimes,
+			  m_bUseFixedBlockKernels ? fixedBlockSize( nInitialBufferPos, nTimes ) : 0 );
 
-		// update instr peak
-		if ( fVal_L > fInstrPeak_L ) {
-			fInstrPeak_L = fVal_L;
-		}
-		if ( fVal_R > fInstrPeak_R ) {
-			fInstrPeak_R = fVal_R;
-		}
-
-		pDrumCompo->set_outs( nBufferPos, fVal_L, fVal_R );
-
-		// to main mix
-		m_pMainOut_L[nBufferPos] += fVal_L;
-		m_pMainOut_R[nBufferPos] += fVal_R;
-
-	}
 	if ( pInstrument->is_filter_active() && pNote->filter_sustain() ) {
 		// Note is still ringing, do not end.
 		retValue = false;
 	}
 
 	pSelectedLayerInfo->SamplePosition += nAvail_bytes;
-	pInstrument->set_peak_l( fInstrPeak_L );
-	pInstrument->set_peak_r( fInstrPeak_R );
+	pInstrument->set_peak_l( mix.fPeak_L );
+	pInstrument->set_peak_r( mix.fPeak_R );
 
 
 #ifdef H2CORE_HAVE_LADSPA
@@ -1165,146 +1783,154 @@ bool Sampler::renderNoteResample(
 		if( pJackAudioDriver ) {
 			pTrackOutL = pJackAudioDriver->getTrackOut_L( pInstrument, pCompo );
 			pTrackOutR = pJackAudioDriver->getTrackOut_R( pInstrument, pCompo );
+			if ( pTrackOutL != nullptr ) {
+				pTrackOutL += m_nOffset;
+			}
+			if ( pTrackOutR != nullptr ) {
+				pTrackOutR += m_nOffset;
+			}
 		}
 	}
 #endif
 
-	float buffer_L[MAX_BUFFER_SIZE];
-	float buffer_R[MAX_BUFFER_SIZE];
-
-
-	// Main rendering loop.
-	// With some re-work, more of this could likely be vectorised fairly easily.
-	//   - assert no buffer aliasing
-	//   - template and multiple instantiations for is_filter_active x each interpolation method
-	//   - iterate LP IIR filter coefficients to longer IIR filter to fit vector width
-	//
-	for ( int nBufferPos = nInitialBufferPos; nBufferPos < nTimes; ++nBufferPos ) {
-
-		int nSamplePos = ( int )fSamplePos;
-		double fDiff = fSamplePos - nSamplePos;
-		if ( ( nSamplePos - 1 ) >= nSampleFrames ) {
-			//we reach the last audioframe.
-			//set this last frame to zero do nothing wrong.
-			fVal_L = 0.0;
-			fVal_R = 0.0;
-		} else {
-			// Gather frame samples
-			float l0, l1, l2, l3, r0, r1, r2, r3;
-			// Short-circuit: the common case is that all required frames are within the sample.
-			if ( nSamplePos >= 1 && nSamplePos + 2 < nSampleFrames ) {
-				l0 = pSample_data_L[ nSamplePos-1 ];
-				l1 = pSample_data_L[ nSamplePos ];
-				l2 = pSample_data_L[ nSamplePos+1 ];
-				l3 = pSample_data_L[ nSamplePos+2 ];
-				r0 = pSample_data_R[ nSamplePos-1 ];
-				r1 = pSample_data_R[ nSamplePos ];
-				r2 = pSample_data_R[ nSamplePos+1 ];
-				r3 = pSample_data_R[ nSamplePos+2 ];
-			} else {
-				l0 = l1 = l2 = l3 = r0 = r1 = r2 = r3 = 0.0;
-				// Some required frames are off the beginning or end of the sample.
-				if ( nSamplePos >= 1 && nSamplePos < nSampleFrames + 1 ) {
-					l0 = pSample_data_L[ nSamplePos-1 ];
-					r0 = pSample_data_R[ nSamplePos-1 ];
-				}
-				// Each successive frame may be past the end of the sample so check individually.
-				if ( nSamplePos < nSampleFrames ) {
-					l1 = pSample_data_L[ nSamplePos ];
-					r1 = pSample_data_R[ nSamplePos ];
-					if ( nSamplePos+1 < nSamplePos ) {
-						l2 = pSample_data_L[ nSamplePos+1 ];
-						r2 = pSample_data_R[ nSamplePos+1 ];
-						if ( nSamplePos+2 < nSamplePos ) {
-							l3 = pSample_data_L[ nSamplePos+2 ];
-							r3 = pSample_data_R[ nSamplePos+2 ];
-						}
-					}
+	alignas( 64 ) float buffer_L[ MAX_BUFFER_SIZE ];
+	alignas( 64 ) float buffer_R[ MAX_BUFFER_SIZE ];
+
+
+	// Constant integer ratios between sample and output frames are
+	// handled by a dedicated fast path. The windowed sinc on the
+	// other hand is used as is since it has to take the ratio into
+	// account to suppress aliasing.
+	int nRatio, nRatioPosition, nRatioPhase;
+	bool bUpsampling;
+	const bool bIntegerRatio =
+		m_interpolateMode != Interpolation::InterpolateMode::Sinc &&
+		Resampler::isIntegerRatio( fStep, fSamplePos, nMaxIntegerRatio, &nRatio,
+								   &bUpsampling, &nRatioPosition, &nRatioPhase );
+
+	// Complete periods of common buffer sizes are rendered by
+	// kernels using a loop bound known at compile time.
+	const int nBlockSize = m_bUseFixedBlockKernels ?
+		fixedBlockSize( nInitialBufferPos, nTimes ) : 0;
+
+	// Single pass rendering. As long as neither the filter nor a
+	// changing envelope require the whole block to be present at
+	// once, all frames are kept in registers till they are
+	// accumulated in the output buffers.
+	float fEnvelope;
+	if ( m_bUseFusedKernels && ! bIntegerRatio && ! pInstrument->is_filter_active() &&
+		 pADSR->applyConstant( nTimes, nNoteEnd, &fEnvelope ) ) {
+		FusedVoice voice;
+		voice.pSample_data_L = pSample_data_L;
+		voice.pSample_data_R = pSample_data_R;
+		voice.nSampleFrames = nSampleFrames;
+		voice.fSamplePos = fSamplePos;
+		voice.fStep = fStep;
+		voice.fEnvelope = fEnvelope;
+		voice.fCost_L = cost_L;
+		voice.fCost_R = cost_R;
+		voice.fCostTrack_L = cost_track_L;
+		voice.fCostTrack_R = cost_track_R;
+		voice.pMainOut_L = m_pMainOut_L;
+		voice.pMainOut_R = m_pMainOut_R;
+		voice.pComponentOut_L = pDrumCompo->get_out_L_buffer();
+		voice.pComponentOut_R = pDrumCompo->get_out_R_buffer();
+		voice.pTrackOut_L = nullptr;
+		voice.pTrackOut_R = nullptr;
+#ifdef H2CORE_HAVE_JACK
+		voice.pTrackOut_L = pTrackOutL;
+		voice.pTrackOut_R = pTrackOutR;
+#endif
+		voice.nSends = 0;
+#ifdef H2CORE_HAVE_LADSPA
+		if ( ! pInstrument->is_muted() && ! pSong->getIsMuted() ) {
+			for ( unsigned nFX = 0; nFX < MAX_FX; ++nFX ) {
+				LadspaFX *pFX = Effects::get_instance()->getLadspaFX( nFX );
+				float fLevel = pInstrument->get_fx_level( nFX );
+				if ( ( pFX ) && ( fLevel != 0.0 ) ) {
+					fLevel = fLevel * pFX->getVolume();
+					voice.pSend_L[ voice.nSends ] = pFX->m_pBuffer_L;
+					voice.pSend_R[ voice.nSends ] = pFX->m_pBuffer_R;
+					voice.fSendCost_L[ voice.nSends ] = fLevel * pSong->getVolume();
+					voice.fSendCost_R[ voice.nSends ] = fLevel * pSong->getVolume();
+					++voice.nSends;
 				}
 			}
-
-			// Interpolate frame values from Sample domain to audio output range
-			switch ( m_interpolateMode ) {
-			case Interpolation::InterpolateMode::Linear:
-				fVal_L = l1 * (1 - fDiff ) + l2 * fDiff;
-				fVal_R = r1 * (1 - fDiff ) + r2 * fDiff;
-				break;
-			case Interpolation::InterpolateMode::Cosine:
-				fVal_L = Interpolation::cosine_Interpolate( l1, l2, fDiff);
-				fVal_R = Interpolation::cosine_Interpolate( r1, r2, fDiff);
-				break;
-			case Interpolation::InterpolateMode::Third:
-				fVal_L = Interpolation::third_Interpolate( l0, l1, l2, l3, fDiff);
-				fVal_R = Interpolation::third_Interpolate( r0, r1, r2, r3, fDiff);
-				break;
-			case Interpolation::InterpolateMode::Cubic:
-				fVal_L = Interpolation::cubic_Interpolate( l0, l1, l2, l3, fDiff);
-				fVal_R = Interpolation::cubic_Interpolate( r0, r1, r2, r3, fDiff);
-				break;
-			case Interpolation::InterpolateMode::Hermite:
-				fVal_L = Interpolation::hermite_Interpolate( l0, l1, l2, l3, fDiff);
-				fVal_R = Interpolation::hermite_Interpolate( r0, r1, r2, r3, fDiff);
-				break;
-			}
 		}
+#endif
+		voice.fPeak_L = fInstrPeak_L;
+		voice.fPeak_R = fInstrPeak_R;
 
-		buffer_L[nBufferPos] = fVal_L;
-		buffer_R[nBufferPos] = fVal_R;
+		renderFusedResample( m_interpolateMode, voice, nInitialBufferPos, nTimes, nBlockSize );
 
-		fSamplePos += fStep;
+		pSelectedLayerInfo->SamplePosition += nAvail_bytes * fStep;
+		pInstrument->set_peak_l( voice.fPeak_L );
+		pInstrument->set_peak_r( voice.fPeak_R );
+
+		return retValue;
+	}
+
+	// Multi-pass rendering. First, the sample is interpolated into
+	// the intermediate buffers. Afterwards, envelope and filter are
+	// applied and the result is mixed into all outputs.
+	if ( bIntegerRatio ) {
+		fSamplePos = interpolateIntegerRatio( m_interpolateMode, pSample_data_L, pSample_data_R,
+											  nSampleFrames, nRatio, bUpsampling,
+											  nRatioPosition, nRatioPhase,
+											  &buffer_L[ nInitialBufferPos ],
+											  &buffer_R[ nInitialBufferPos ], nAvail_bytes );
+	} else {
+		for ( int nBufferPos = nInitialBufferPos; nBufferPos < nTimes; ++nBufferPos ) {
+			interpolateFrame( m_interpolateMode, pSample_data_L, pSample_data_R,
+							  nSampleFrames, fSamplePos, fStep,
+							  &buffer_L[ nBufferPos ], &buffer_R[ nBufferPos ] );
+			fSamplePos += fStep;
+		}
 	}
 
 	if ( pADSR->applyADSR( buffer_L, buffer_R, nTimes, nNoteEnd, 1 ) ) {
 		retValue = true;
 	}
 
-	// Mix rendered sample buffer to track and mixer output
-	for ( int nBufferPos = nInitialBufferPos; nBufferPos < nTimes; ++nBufferPos ) {
-
-		fVal_L = buffer_L[nBufferPos];
-		fVal_R = buffer_R[nBufferPos];
-
-		// Low pass resonant filter
-		if ( pInstrument->is_filter_active() ) {
-			pNote->compute_lr_values( &fVal_L, &fVal_R );
-		}
+	// Resonant filter
+	if ( pInstrument->is_filter_active() ) {
+		pNote->applyFilter( &buffer_L[ nInitialBufferPos ], &buffer_R[ nInitialBufferPos ],
+							nTimes - nInitialBufferPos, pSelectedLayerInfo );
+	}
 
+	// Mix rendered sample buffer to track and mixer output
+	VoiceMix mix;
+	mix.fCost_L = cost_L;
+	mix.fCost_R = cost_R;
+	mix.fCostTrack_L = cost_track_L;
+	mix.fCostTrack_R = cost_track_R;
+	mix.pMainOut_L = m_pMainOut_L;
+	mix.pMainOut_R = m_pMainOut_R;
+	mix.pComponentOut_L = pDrumCompo->get_out_L_buffer();
+	mix.pComponentOut_R = pDrumCompo->get_out_R_buffer();
+	mix.pTrackOut_L = nullptr;
+	mix.pTrackOut_R = nullptr;
 #ifdef H2CORE_HAVE_JACK
-		if ( pTrackOutL ) {
-			pTrackOutL[nBufferPos] += fVal_L * cost_track_L;
-		}
-		if ( pTrackOutR ) {
-			pTrackOutR[nBufferPos] += fVal_R * cost_track_R;
-		}
+	mix.pTrackOut_L = pTrackOutL;
+	mix.pTrackOut_R = pTrackOutR;
 #endif
+	mix.fPeak_L = fInstrPeak_L;
+	mix.fPeak_R = fInstrPeak_R;
 
-		fVal_L = fVal_L * cost_L;
-		fVal_R = fVal_R * cost_R;
-
-		// update instr peak
-		if ( fVal_L > fInstrPeak_L ) {
-			fInstrPeak_L = fVal_L;
-		}
-		if ( fVal_R > fInstrPeak_R ) {
-			fInstrPeak_R = fVal_R;
-		}
-
-		pDrumCompo->set_outs( nBufferPos, fVal_L, fVal_R );
-
-		// to main mix
-		m_pMainOut_L[nBufferPos] += fVal_L;
-		m_pMainOut_R[nBufferPos] += fVal_R;
-
-	}
+	mixVoice( mix, buffer_L, buffer_R, nInitialBufferPos, nTimes, nBlockSize );
 
 	if ( pInstrument->is_filter_active() && pNote->filter_sustain() ) {
 		// Note is still ringing, do not end.
 		retValue = false;
 	}
 	
-	pSelectedLayerInfo->SamplePosition += nAvail_bytes * fStep;
-	pInstrument->set_peak_l( fInstrPeak_L );
-	pInstrument->set_peak_r( fInstrPeak_R );
+	if ( bIntegerRatio ) {
+		pSelectedLayerInfo->SamplePosition = fSamplePos;
+	} else {
+		pSelectedLayerInfo->SamplePosition += nAvail_bytes * fStep;
+	}
+	pInstrument->set_peak_l( mix.fPeak_L );
+	pInstrument->set_peak_r( mix.fPeak_R );
 
 
 #ifdef H2CORE_HAVE_LADSPA
@@ -1346,24 +1972,24 @@ bool Sampler::renderNoteResample(
 void Sampler::stopPlayingNotes( std::shared_ptr<Instrument> pInstr )
 {
 	if ( pInstr ) { // stop all notes using this instrument
-		for ( unsigned i = 0; i < m_playingNotesQueue.size(); ) {
-			Note *pNote = m_playingNotesQueue[ i ];
+		for ( int i = 0; i < m_pVoiceManager->size(); ) {
+			Note *pNote = ( *m_pVoiceManager )[ i ].pNote;
 			assert( pNote );
 			if ( pNote->get_instrument() == pInstr ) {
+				m_pVoiceManager->remove( i );
 				delete pNote;
 				pInstr->dequeue();
-				m_playingNotesQueue.erase( m_playingNotesQueue.begin() + i );
+			} else {
+				++i;
 			}
-			++i;
 		}
 	} else { // stop all notes
 		// delete all copied notes in the playing notes queue
-		for ( unsigned i = 0; i < m_playingNotesQueue.size(); ++i ) {
-			Note *pNote = m_playingNotesQueue[i];
+		while ( ! m_pVoiceManager->isEmpty() ) {
+			Note *pNote = m_pVoiceManager->remove( m_pVoiceManager->size() - 1 );
 			pNote->get_instrument()->dequeue();
 			delete pNote;
 		}
-		m_playingNotesQueue.clear();
 	}
 }
 
@@ -1411,8 +2037,8 @@ void Sampler::preview_instrument( std::shared_ptr<Instrument> pInstr )
 bool Sampler::isInstrumentPlaying( std::shared_ptr<Instrument> instrument )
 {
 	if ( instrument ) { // stop all notes using this instrument
-		for ( unsigned j = 0; j < m_playingNotesQueue.size(); j++ ) {
-			if ( instrument->get_name() == m_playingNotesQueue[ j ]->get_instrument()->get_name()){
+		for ( const auto& voice : m_pVoiceManager->getVoices() ) {
+			if ( instrument->get_name() == voice.pNote->get_instrument()->get_name()){
 				return true;
 			}
 		}
@@ -27,6 +27,7 @@
 #include <core/Object.h>
 #include <core/Globals.h>
 #include <core/Sampler/Interpolation.h>
+#include <core/Sampler/VoiceManager.h>
 
 #include <inttypes.h>
 #include <vector>
@@ -43,6 +44,7 @@ class Instrument;
 struct SelectedLayerInfo;
 class InstrumentComponent;
 class AudioOutput;
+class PanLawTable;
 
 ///
 /// Waveform based sampler.
@@ -173,7 +175,17 @@ public:
 	Sampler();
 	~Sampler();
 
-	void process( uint32_t nFrames, std::shared_ptr<Song> pSong );
+	/**
+	 * Renders all voices into #m_pMainOut_L and #m_pMainOut_R.
+	 *
+	 * \param nFrames Number of frames to render.
+	 * \param pSong Current song.
+	 * \param nOffset Position of the rendered block within the
+	 * period of the audio driver. It is only required for outputs
+	 * spanning the whole period, like the per-track ports of the
+	 * JackAudioDriver. See AudioEngine::processSubBlocks().
+	 */
+	void process( uint32_t nFrames, std::shared_ptr<Song> pSong, uint32_t nOffset = 0 );
 
 	/**
 	 * @return True, if the #Sampler is still processing notes.
@@ -190,7 +202,20 @@ public:
 	void stopPlayingNotes( std::shared_ptr<Instrument> pInstr = nullptr );
 
 	int getPlayingNotesNumber() {
-		return m_playingNotesQueue.size();
+		return m_pVoiceManager->size();
+	}
+
+	/** \return Bookkeeping of all voices including the counters of
+	 * stolen ones. */
+	const VoiceManager* getVoiceManager() const {
+		return m_pVoiceManager;
+	}
+
+	/** \return Number of voices retired during the last call to
+	 * process() because their remaining level dropped below
+	 * Preferences::m_fVoiceCullingThreshold. */
+	int getCulledVoices() const {
+		return m_nCulledVoices;
 	}
 
 	void preview_sample( std::shared_ptr<Sample> pSample, int length );
@@ -212,6 +237,26 @@ public:
 
 	Interpolation::InterpolateMode getInterpolateMode(){ return m_interpolateMode; }
 
+	/** Whether resampled voices with a constant envelope and without
+	 * filter are rendered in a single pass. Only meant to be turned
+	 * off for benchmarking and testing. */
+	void setUseFusedKernels( bool bUse ) {
+		m_bUseFusedKernels = bUse;
+	}
+	bool getUseFusedKernels() const {
+		return m_bUseFusedKernels;
+	}
+
+	/** Whether complete periods of 32, 64, 128, or 256 frames are
+	 * rendered by kernels specialized for this block size. Only meant
+	 * to be turned off for benchmarking and testing. */
+	void setUseFixedBlockKernels( bool bUse ) {
+		m_bUseFixedBlockKernels = bUse;
+	}
+	bool getUseFixedBlockKernels() const {
+		return m_bUseFixedBlockKernels;
+	}
+
 	/**
 	 * Loading of the playback track.
 	 *
@@ -238,8 +283,12 @@ public:
 	const std::vector<Note*> getPlayingNotesQueue() const;
 	
 private:
-	std::vector<Note*> m_playingNotesQueue;
+	/** All notes currently rendered. */
+	VoiceManager* m_pVoiceManager;
 	std::vector<Note*> m_queuedNoteOffs;
+	/** Removes the oldest voice without fade out and queues its
+	 * note off. */
+	void dropOldestVoice();
 	
 	/// Instrument used for the playback track feature.
 	std::shared_ptr<Instrument> m_pPlaybackTrackInstrument;
@@ -255,16 +304,44 @@ private:
 	int m_nMaxLayers;
 	
 	int m_nPlayBackSamplePosition;
+
+	/** Linear counterpart of Preferences::m_fVoiceCullingThreshold
+	 * updated at the beginning of each process() cycle. 0 if culling
+	 * is disabled. */
+	float m_fCullingThreshold;
+	int m_nCulledVoices;
+
+	bool m_bUseFusedKernels;
+	bool m_bUseFixedBlockKernels;
+
+	/** Offset passed to process(). */
+	uint32_t m_nOffset;
 	
-	/** function to direct the computation to the selected pan law function
-	 */
-	float panLaw( float fPan, std::shared_ptr<Song> pSong );
+	/** Pan law of the current Song. Fetched once per cycle in
+	 * process(). Owned by the Song. */
+	const PanLawTable* m_pPanLawTable;
 
 
 
 	bool processPlaybackTrack(int nBufferSize);
 
-	bool renderNote( Note* pNote, unsigned nBufferSize, std::shared_ptr<Song> pSong );
+	bool renderNote( Voice& voice, unsigned nBufferSize, std::shared_ptr<Song> pSong );
+
+	/**
+	 * Checks whether the remainder of a voice can still be heard.
+	 *
+	 * The level is estimated conservatively using the current value
+	 * of the note's envelope, the peak of the remaining part of @a
+	 * pSample (see Sample::getRemainingPeak()), the energy still
+	 * stored in the resonant filter, and the combined gain @a fGain
+	 * applied by the Sampler.
+	 *
+	 * Notes not started yet or still in their attack phase are never
+	 * considered inaudible.
+	 */
+	bool isInaudible( Note* pNote, std::shared_ptr<Sample> pSample,
+					  std::shared_ptr<SelectedLayerInfo> pSelectedLayer,
+					  float fGain ) const;
 
 	Interpolation::InterpolateMode m_interpolateMode;
 
@@ -301,7 +378,12 @@ private:
 };
 
 inline const std::vector<Note*> Sampler::getPlayingNotesQueue() const {
-	return m_playingNotesQueue;
+	std::vector<Note*> notes;
+	notes.reserve( m_pVoiceManager->size() );
+	for ( const auto& voice : m_pVoiceManager->getVoices() ) {
+		notes.push_back( voice.pNote );
+	}
+	return notes;
 }
 
 } // namespace
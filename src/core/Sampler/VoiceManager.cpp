@@ -0,0 +1,240 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/Sampler/VoiceManager.h>
+
+#include <core/Basics/Adsr.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/Note.h>
+
+#include <cassert>
+
+namespace H2Core
+{
+
+VoiceManager::VoiceManager( int nMaxVoices )
+	: m_nMaxVoices( 0 )
+	, m_nActiveVoices( 0 )
+	, m_nNextSerial( 0 )
+	, m_nStolenVoices( 0 )
+	, m_nDroppedVoices( 0 )
+	, m_nCulledVoices( 0 )
+{
+	setMaxVoices( nMaxVoices );
+}
+
+VoiceManager::~VoiceManager() {
+}
+
+QString VoiceManager::StealingPolicyToQString( StealingPolicy policy ) {
+	switch ( policy ) {
+	case StealingPolicy::Oldest:
+		return "Oldest";
+	case StealingPolicy::Quietest:
+		return "Quietest";
+	case StealingPolicy::SameInstrumentFirst:
+		return "SameInstrumentFirst";
+	case StealingPolicy::LowestVelocity:
+		return "LowestVelocity";
+	default:
+		return QString( "Unknown policy [%1]" ).arg( static_cast<int>(policy) );
+	}
+}
+
+void VoiceManager::setMaxVoices( int nMaxVoices ) {
+	m_nMaxVoices = std::max( nMaxVoices, 1 );
+	// Stolen voices are kept till they faded out. Reserve enough
+	// space for them too.
+	m_voices.reserve( 2 * m_nMaxVoices );
+}
+
+bool VoiceManager::add( Note* pNote ) {
+	assert( pNote );
+	if ( isFull() ) {
+		return false;
+	}
+	m_voices.push_back( { pNote, m_nNextSerial++, false } );
+	++m_nActiveVoices;
+	return true;
+}
+
+Note* VoiceManager::remove( int nIndex ) {
+	assert( nIndex >= 0 && nIndex < size() );
+
+	Note* pNote = m_voices[ nIndex ].pNote;
+	if ( ! m_voices[ nIndex ].bStolen ) {
+		--m_nActiveVoices;
+	}
+
+	if ( nIndex != size() - 1 ) {
+		m_voices[ nIndex ] = m_voices.back();
+	}
+	m_voices.pop_back();
+
+	return pNote;
+}
+
+Note* VoiceManager::dropOldest() {
+	const int nIndex = findVictim( StealingPolicy::Oldest, nullptr, false, true );
+	if ( nIndex == -1 ) {
+		return nullptr;
+	}
+	++m_nDroppedVoices;
+	return remove( nIndex );
+}
+
+int VoiceManager::countActiveVoices( std::shared_ptr<Instrument> pInstrument ) const {
+	if ( pInstrument == nullptr ) {
+		return m_nActiveVoices;
+	}
+
+	int nCount = 0;
+	for ( const auto& voice : m_voices ) {
+		if ( ! voice.bStolen && voice.pNote->get_instrument() == pInstrument ) {
+			++nCount;
+		}
+	}
+	return nCount;
+}
+
+int VoiceManager::findVictim( StealingPolicy policy,
+							  std::shared_ptr<Instrument> pInstrument,
+							  bool bInstrumentOnly,
+							  bool bIncludeStolen ) const {
+	if ( policy == StealingPolicy::SameInstrumentFirst && ! bInstrumentOnly ) {
+		const int nIndex = findVictim( StealingPolicy::Oldest, pInstrument,
+									   true, bIncludeStolen );
+		if ( nIndex != -1 ) {
+			return nIndex;
+		}
+		policy = StealingPolicy::Oldest;
+	}
+
+	int nVictim = -1;
+	float fBest = 0;
+	for ( int ii = 0; ii < size(); ++ii ) {
+		const auto& voice = m_voices[ ii ];
+		if ( voice.bStolen && ! bIncludeStolen ) {
+			continue;
+		}
+		if ( bInstrumentOnly && voice.pNote->get_instrument() != pInstrument ) {
+			continue;
+		}
+
+		// Lower is more likely to be stolen. Ties are resolved by
+		// stealing the older voice.
+		float fCriterion;
+		switch ( policy ) {
+		case StealingPolicy::Quietest:
+			fCriterion = voice.pNote->get_adsr()->getValue();
+			break;
+		case StealingPolicy::LowestVelocity:
+			fCriterion = voice.pNote->get_velocity();
+			break;
+		default:
+			fCriterion = 0;
+		}
+
+		if ( nVictim == -1 || fCriterion < fBest ||
+			 ( fCriterion == fBest &&
+			   voice.nSerial < m_voices[ nVictim ].nSerial ) ) {
+			nVictim = ii;
+			fBest = fCriterion;
+		}
+	}
+
+	return nVictim;
+}
+
+void VoiceManager::steal( int nIndex, int nFadeOutFrames ) {
+	auto& voice = m_voices[ nIndex ];
+	if ( voice.bStolen ) {
+		return;
+	}
+
+	voice.pNote->get_adsr()->fadeOut( std::max( nFadeOutFrames, 1 ) );
+	voice.bStolen = true;
+	--m_nActiveVoices;
+	++m_nStolenVoices;
+}
+
+int VoiceManager::makeRoomFor( Note* pNote, StealingPolicy policy, int nFadeOutFrames ) {
+	auto pInstrument = pNote->get_instrument();
+	int nStolen = 0;
+
+	const int nMaxInstrumentVoices =
+		pInstrument != nullptr ? pInstrument->get_max_voices() : 0;
+	if ( nMaxInstrumentVoices > 0 ) {
+		int nInstrumentVoices = countActiveVoices( pInstrument );
+		while ( nInstrumentVoices >= nMaxInstrumentVoices ) {
+			const int nIndex = findVictim( policy, pInstrument, true );
+			if ( nIndex == -1 ) {
+				break;
+			}
+			steal( nIndex, nFadeOutFrames );
+			--nInstrumentVoices;
+			++nStolen;
+		}
+	}
+
+	while ( m_nActiveVoices >= m_nMaxVoices ) {
+		const int nIndex = findVictim( policy, pInstrument, false );
+		if ( nIndex == -1 ) {
+			break;
+		}
+		steal( nIndex, nFadeOutFrames );
+		++nStolen;
+	}
+
+	return nStolen;
+}
+
+void VoiceManager::resetCounters() {
+	m_nStolenVoices = 0;
+	m_nDroppedVoices = 0;
+	m_nCulledVoices = 0;
+}
+
+QString VoiceManager::toQString( const QString& sPrefix, bool bShort ) const {
+	QString s = Base::sPrintIndention;
+	QString sOutput;
+	if ( ! bShort ) {
+		sOutput = QString( "%1[VoiceManager]\n" ).arg( sPrefix )
+			.append( QString( "%1%2voices: %3\n" ).arg( sPrefix ).arg( s ).arg( size() ) )
+			.append( QString( "%1%2active voices: %3\n" ).arg( sPrefix ).arg( s ).arg( m_nActiveVoices ) )
+			.append( QString( "%1%2max voices: %3\n" ).arg( sPrefix ).arg( s ).arg( m_nMaxVoices ) )
+			.append( QString( "%1%2stolen voices: %3\n" ).arg( sPrefix ).arg( s ).arg( m_nStolenVoices ) )
+			.append( QString( "%1%2dropped voices: %3\n" ).arg( sPrefix ).arg( s ).arg( m_nDroppedVoices ) )
+			.append( QString( "%1%2culled voices: %3\n" ).arg( sPrefix ).arg( s ).arg( m_nCulledVoices ) );
+	} else {
+		sOutput = QString( "[VoiceManager]" )
+			.append( QString( " voices: %1" ).arg( size() ) )
+			.append( QString( ", active voices: %1" ).arg( m_nActiveVoices ) )
+			.append( QString( ", max voices: %1" ).arg( m_nMaxVoices ) )
+			.append( QString( ", stolen voices: %1" ).arg( m_nStolenVoices ) )
+			.append( QString( ", dropped voices: %1" ).arg( m_nDroppedVoices ) )
+			.append( QString( ", culled voices: %1" ).arg( m_nCulledVoices ) );
+	}
+
+	return sOutput;
+}
+
+};
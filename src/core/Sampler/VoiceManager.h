@@ -0,0 +1,288 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_VOICE_MANAGER_H
+#define H2C_VOICE_MANAGER_H
+
+#include <core/Object.h>
+
+#include <memory>
+#include <vector>
+
+namespace H2Core
+{
+
+class Note;
+class Instrument;
+
+/**
+ * A single note currently rendered by the #Sampler.
+ */
+struct Voice {
+	Note* pNote;
+	/** Monotonically increasing number assigned when the voice was
+	 * started. The smaller the number the older the voice. */
+	unsigned long long nSerial;
+	/** Whether the voice was stolen by the VoiceManager and is
+	 * currently fading out. */
+	bool bStolen;
+
+	/** Pan law gains of the left and right channel. They are only
+	 * looked up again by the Sampler once the resulting pan
+	 * #fCachedPan of instrument and note or the pan law itself
+	 * changed. */
+	float fPanGain_L = 1.0f;
+	float fPanGain_R = 1.0f;
+	float fCachedPan = 0.0f;
+	/** -1 until the gains were computed for the first time. */
+	int nCachedPanLawType = -1;
+	float fCachedPanLawKNorm = 0.0f;
+
+	/** Product of the pan law gains, the note velocity, and the
+	 * gain and volume of the instrument. It is shared by all
+	 * components of the note and used for the post fader track
+	 * outputs. */
+	float fFaderGain_L = 0.0f;
+	float fFaderGain_R = 0.0f;
+	/** #fFaderGain_L and #fFaderGain_R times the song volume. */
+	float fGain_L = 0.0f;
+	float fGain_R = 0.0f;
+	/** #fGain_L and #fGain_R or zero in case the song or instrument
+	 * is muted. Used for the main output. */
+	float fMixGain_L = 0.0f;
+	float fMixGain_R = 0.0f;
+	/** Twice #fFaderGain_L and #fFaderGain_R or zero in case the
+	 * song or instrument is muted. Used for the post fader track
+	 * outputs. */
+	float fTrackGain_L = 0.0f;
+	float fTrackGain_R = 0.0f;
+	/** Inputs the gains above were computed from. They are combined
+	 * again by the Sampler as soon as one of them or the pan law
+	 * gains change. -1 until they were computed for the first
+	 * time. */
+	float fCachedVelocity = -1.0f;
+	float fCachedInstrumentGain = -1.0f;
+	float fCachedInstrumentVolume = -1.0f;
+	float fCachedSongVolume = -1.0f;
+	bool bCachedMuted = false;
+};
+
+/**
+ * Bookkeeping of all voices rendered by the #Sampler and enforcement
+ * of both the global (Preferences::m_nMaxNotes) and per-instrument
+ * (Instrument::get_max_voices()) polyphony limits.
+ *
+ * The voices are stored in a contiguous array whose capacity is
+ * reserved ahead of time. Adding a voice appends it and removing one
+ * swaps it with the last element. Both are O(1) and do not allocate
+ * memory in the audio thread. Note that this implies that the order of
+ * the voices is not preserved. Their age is stored in
+ * Voice::nSerial instead.
+ *
+ * Instead of abruptly deleting the note exceeding the limit, the
+ * voice chosen according to the current #StealingPolicy is faded out
+ * within a couple of frames using ADSR::fadeOut(). Only if the fading
+ * voices themselves pile up to twice the global limit, the oldest
+ * ones are dropped immediately. The array never grows beyond this
+ * hard limit, see isFull().
+ *
+ * \ingroup docCore docAudioEngine
+ */
+class VoiceManager : public H2Core::Object<VoiceManager>
+{
+	H2_OBJECT(VoiceManager)
+public:
+
+	/** Determines which voice will be stolen in case the polyphony
+	 * limit is reached. */
+	enum class StealingPolicy {
+		/** The voice started first will be stolen. */
+		Oldest = 0,
+		/** The voice with the lowest current value of its ADSR
+		 * envelope will be stolen. */
+		Quietest = 1,
+		/** A voice of the instrument of the incoming note will be
+		 * stolen first. If there is none, the oldest voice will be
+		 * used instead. */
+		SameInstrumentFirst = 2,
+		/** The voice with the lowest note velocity will be
+		 * stolen. */
+		LowestVelocity = 3
+	};
+	static QString StealingPolicyToQString( StealingPolicy policy );
+
+	/** Default number of frames a stolen voice is faded out in. */
+	static constexpr int nDefaultFadeOutFrames = 256;
+
+	VoiceManager( int nMaxVoices );
+	~VoiceManager();
+
+	/**
+	 * Sets the global polyphony limit and reserves enough slots to
+	 * hold twice as many voices (to account for voices fading out),
+	 * which is the hard limit of the number of voices.
+	 *
+	 * This may allocate memory and should not be called in the audio
+	 * thread unless the limit did actually change.
+	 */
+	void setMaxVoices( int nMaxVoices );
+	int getMaxVoices() const;
+
+	int size() const;
+	bool isEmpty() const;
+	/** Whether the hard limit of twice the global polyphony limit is
+	 * reached. A new voice can then only be added after dropping an
+	 * old one via dropOldest(). */
+	bool isFull() const;
+	Voice& operator[]( int nIndex );
+	const Voice& operator[]( int nIndex ) const;
+	const std::vector<Voice>& getVoices() const;
+
+	/**
+	 * Appends @a pNote as a new voice.
+	 *
+	 * The reserved storage is never grown. In case the manager
+	 * isFull(), the voice is refused.
+	 *
+	 * \return whether @a pNote was added.
+	 */
+	bool add( Note* pNote );
+	/**
+	 * Removes the voice at @a nIndex by swapping it with the last
+	 * one.
+	 *
+	 * \return the note of the removed voice. The caller takes
+	 * ownership of it.
+	 */
+	Note* remove( int nIndex );
+	/**
+	 * Removes the oldest voice without fading it out, regardless of
+	 * whether it was already stolen, and counts it as dropped.
+	 *
+	 * \return the note of the removed voice or nullptr if there is
+	 * none. The caller takes ownership of it.
+	 */
+	Note* dropOldest();
+
+	/**
+	 * Ensures there is room for @a pNote by stealing voices exceeding
+	 * the per-instrument limit of its instrument and the global
+	 * limit. Stolen voices are faded out in @a nFadeOutFrames frames.
+	 *
+	 * Since stolen voices keep their slot till they faded out, the
+	 * manager might still be full afterwards. See isFull().
+	 *
+	 * \return Number of voices stolen.
+	 */
+	int makeRoomFor( Note* pNote, StealingPolicy policy, int nFadeOutFrames );
+
+	/**
+	 * Returns the index of the voice to steal next.
+	 *
+	 * \param policy Criterion to select the voice.
+	 * \param pInstrument Instrument of the incoming note. Used by
+	 * StealingPolicy::SameInstrumentFirst.
+	 * \param bInstrumentOnly Only consider voices of @a pInstrument.
+	 * \param bIncludeStolen Whether voices already fading out are
+	 * considered too.
+	 *
+	 * \return index or -1 in case no suitable voice was found.
+	 */
+	int findVictim( StealingPolicy policy,
+					std::shared_ptr<Instrument> pInstrument,
+					bool bInstrumentOnly,
+					bool bIncludeStolen = false ) const;
+
+	/** Number of voices not currently fading out. O(1) for
+	 * @a pInstrument == nullptr. */
+	int countActiveVoices( std::shared_ptr<Instrument> pInstrument = nullptr ) const;
+
+	/** Number of voices stolen since the last call to resetCounters(). */
+	long long getStolenVoices() const;
+	/** Number of voices dropped without fade out since the last call
+	 * to resetCounters(). */
+	long long getDroppedVoices() const;
+	/** Number of voices retired by the #Sampler because they became
+	 * inaudible since the last call to resetCounters(). */
+	long long getCulledVoices() const;
+	void countCulledVoice();
+	void resetCounters();
+
+	/** Formatted string version for debugging purposes.
+	 * \param sPrefix String prefix which will be added in front of
+	 * every new line
+	 * \param bShort Instead of the whole content of all classes
+	 * stored as members just a single unique identifier will be
+	 * displayed without line breaks.
+	 *
+	 * \return String presentation of current object.*/
+	QString toQString( const QString& sPrefix = "", bool bShort = true ) const override;
+
+private:
+	void steal( int nIndex, int nFadeOutFrames );
+
+	std::vector<Voice> m_voices;
+	int m_nMaxVoices;
+	/** Number of voices in #m_voices which are not stolen. */
+	int m_nActiveVoices;
+	unsigned long long m_nNextSerial;
+	long long m_nStolenVoices;
+	long long m_nDroppedVoices;
+	long long m_nCulledVoices;
+};
+
+inline int VoiceManager::getMaxVoices() const {
+	return m_nMaxVoices;
+}
+inline int VoiceManager::size() const {
+	return static_cast<int>(m_voices.size());
+}
+inline bool VoiceManager::isEmpty() const {
+	return m_voices.empty();
+}
+inline bool VoiceManager::isFull() const {
+	return size() >= 2 * m_nMaxVoices;
+}
+inline Voice& VoiceManager::operator[]( int nIndex ) {
+	return m_voices[ nIndex ];
+}
+inline const Voice& VoiceManager::operator[]( int nIndex ) const {
+	return m_voices[ nIndex ];
+}
+inline const std::vector<Voice>& VoiceManager::getVoices() const {
+	return m_voices;
+}
+inline long long VoiceManager::getStolenVoices() const {
+	return m_nStolenVoices;
+}
+inline long long VoiceManager::getDroppedVoices() const {
+	return m_nDroppedVoices;
+}
+inline long long VoiceManager::getCulledVoices() const {
+	return m_nCulledVoices;
+}
+inline void VoiceManager::countCulledVoice() {
+	++m_nCulledVoices;
+}
+
+};
+
+#endif
@@ -26,8 +26,12 @@
 
 #include <string>
 #include <cstdio>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
+#include <QtCore/QStringList>
+
 #include <core/Smf/SMFEvent.h>
 
 namespace H2Core
@@ -35,6 +39,9 @@ namespace H2Core
 
 class Song;
 class Instrument;
+class InstrumentList;
+class Drumkit;
+class Pattern;
 
 /** \ingroup docCore docMIDI */
 class SMFHeader : public Object<SMFHeader>, public SMFBase
@@ -186,6 +193,156 @@ private:
 };
 
 
+//-------
+
+/**
+ * Reads Standard MIDI Files of format 0 and 1 and turns them into
+ * patterns.
+ *
+ * A file is parsed in a single forward pass over its (memory mapped)
+ * content. Only what is required to create a pattern is retained:
+ * all note on events, the first tempo and time signature, and the
+ * first track name. The note on events of all files read by one
+ * reader are stored in the same contiguous buffer, which is reused
+ * by subsequent calls to read(). Converting a whole library of
+ * grooves therefore neither allocates per event nor per file.
+ */
+/** \ingroup docCore docMIDI */
+class SMFReader : public H2Core::Object<SMFReader>
+{
+	H2_OBJECT(SMFReader)
+public:
+	struct NoteEvent {
+		/** Absolute position in ticks of the file, see getTPQN(). */
+		int nTick;
+		uint8_t nChannel;
+		uint8_t nKey;
+		uint8_t nVelocity;
+	};
+
+	struct ConversionResult {
+		QString sSourceFile;
+		QString sPatternFile;
+		bool bSuccess = false;
+		/** Number of notes in the created pattern. */
+		int nNotes = 0;
+		/** Number of note on events no instrument was found for. */
+		int nUnmapped = 0;
+	};
+
+	SMFReader();
+	~SMFReader();
+
+	/** Reads @a sFilename. In case of an error false is returned
+	 * and the reader holds no notes. */
+	bool read( const QString& sFilename );
+	/** Same as read() but for a file already in memory. */
+	bool parse( const uint8_t* pData, size_t nSize );
+
+	int getFormat() const;
+	int getTPQN() const;
+	/** Tempo of the first Set Tempo event. 120 if there is none. */
+	float getBpm() const;
+	/** Time signature of the first Time Signature event. 4/4 if
+	 * there is none. */
+	int getTimeSignatureNumerator() const;
+	int getTimeSignatureDenominator() const;
+	/** Content of the first Track Name event. */
+	const QString& getName() const;
+	/** Tick of the last End of Track event. */
+	int getEndTick() const;
+	/** Note on events of all tracks ordered by their tick. Events
+	 * of the same tick keep the order of their tracks. */
+	const std::vector<NoteEvent>& getNotes() const;
+
+	/**
+	 * Creates a pattern holding all notes read.
+	 *
+	 * Notes are assigned to the instrument having their key as MIDI
+	 * out note, see InstrumentList::findMidiNote(). For kits
+	 * following the General MIDI drum map this is the GM
+	 * instrument. The position of each note is quantized to
+	 * multiples of @a nQuantize ticks of the pattern, which has a
+	 * resolution of 48 ticks per quarter. Notes of the same
+	 * instrument falling onto the same position are merged keeping
+	 * the highest velocity. The pattern spans all full bars of the
+	 * time signature containing notes or the end of the tracks.
+	 *
+	 * \param pnUnmapped If not nullptr, the number of notes no
+	 *   instrument was found for is stored in here.
+	 *
+	 * \return A new pattern owned by the caller or nullptr if no
+	 *   file was read.
+	 */
+	Pattern* createPattern( std::shared_ptr<InstrumentList> pInstrumentList,
+							const QString& sName, int nQuantize = 1,
+							int* pnUnmapped = nullptr ) const;
+
+	/**
+	 * Converts each of the Standard MIDI Files @a files into a
+	 * pattern for @a pDrumkit stored in @a sTargetDir. The pattern
+	 * is named like the file. Files sharing a name are numbered in
+	 * the order of @a files, e.g. "groove", "groove_2".
+	 *
+	 * \param bBinary Whether the patterns are stored as
+	 *   BinaryDoc. They keep the Filesystem::patterns_ext extension.
+	 *
+	 * \param nThreads Number of files converted at once. If 0,
+	 *   QThread::idealThreadCount() is used.
+	 *
+	 * \return One #ConversionResult per file in the order of @a files.
+	 */
+	static std::vector<ConversionResult> convertFiles( const QStringList& files,
+													   const QString& sTargetDir,
+													   std::shared_ptr<Drumkit> pDrumkit,
+													   int nQuantize = 1,
+													   bool bBinary = false,
+													   int nThreads = 0 );
+
+private:
+	void clear();
+	bool parseTrack( const uint8_t* pData, size_t nSize );
+
+	int m_nFormat;
+	int m_nTPQN;
+	float m_fBpm;
+	int m_nNumerator;
+	int m_nDenominator;
+	bool m_bTempoRead;
+	bool m_bTimeSignatureRead;
+	QString m_sName;
+	int m_nEndTick;
+	std::vector<NoteEvent> m_notes;
+	/** Index of the first event of each track within #m_notes. */
+	std::vector<size_t> m_trackStarts;
+};
+
+inline int SMFReader::getFormat() const {
+	return m_nFormat;
+}
+inline int SMFReader::getTPQN() const {
+	return m_nTPQN;
+}
+inline float SMFReader::getBpm() const {
+	return m_fBpm;
+}
+inline int SMFReader::getTimeSignatureNumerator() const {
+	return m_nNumerator;
+}
+inline int SMFReader::getTimeSignatureDenominator() const {
+	return m_nDenominator;
+}
+inline const QString& SMFReader::getName() const {
+	return m_sName;
+}
+inline int SMFReader::getEndTick() const {
+	return m_nEndTick;
+}
+inline const std::vector<SMFReader::NoteEvent>& SMFReader::getNotes() const {
+	return m_notes;
+}
+
+
 
 };
 
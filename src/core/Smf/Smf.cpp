@@ -27,8 +27,24 @@
 #include <core/Basics/Instrument.h>
 #include <core/Basics/InstrumentList.h>
 #include <core/Basics/AutomationPath.h>
+#include <core/Basics/Drumkit.h>
+#include <core/Helpers/Filesystem.h>
+#include <core/Helpers/Random.h>
+#include <core/Preferences/Preferences.h>
 #include <fstream>
 
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <thread>
+
 namespace H2Core
 {
 
@@ -230,6 +246,11 @@ void SMFWriter::save( const QString& sFilename, std::shared_ptr<Song> pSong )
 	// here writers must prepare to receive pattern events
 	prepareEvents( pSong, pSmf );
 
+	const auto pPref = Preferences::get_instance();
+	Random random( pPref->m_bDeterministicExport ?
+				   static_cast<uint64_t>( pPref->m_nExportSeed ) :
+				   Random::createSeed() );
+
 	auto pInstrumentList = pSong->getInstrumentList();
 	// ogni pattern sara' una diversa traccia
 	int nTick = 1;
@@ -256,8 +277,7 @@ void SMFWriter::save( const QString& sFilename, std::shared_ptr<Song> pSong )
 				FOREACH_NOTE_CST_IT_BOUND(notes,it,nNote) {
 					Note *pNote = it->second;
 					if ( pNote ) {
-						float rnd = (float)rand()/(float)RAND_MAX;
-						if ( pNote->get_probability() < rnd ) {
+						if ( pNote->get_probability() < random.uniform() ) {
 							continue;
 						}
 
@@ -550,4 +570,464 @@ void SMF0Writer::packEvents( std::shared_ptr<Song> pSong, SMF* pSmf )
 }
 
 
+// :::::::::::::::::::...
+
+/** Resolution of a #Pattern in ticks per quarter. */
+constexpr int PATTERN_TPQN = 48;
+
+namespace {
+
+/** Forward-only cursor over the bytes of a file. All read functions
+ * return false instead of reading past the end. */
+class SMFCursor
+{
+public:
+	SMFCursor( const uint8_t* pData, size_t nSize )
+		: m_pPos( pData )
+		, m_pEnd( pData + nSize ) {
+	}
+
+	bool atEnd() const {
+		return m_pPos >= m_pEnd;
+	}
+	size_t remaining() const {
+		return m_pEnd - m_pPos;
+	}
+	const uint8_t* position() const {
+		return m_pPos;
+	}
+
+	bool readByte( uint8_t* pnValue ) {
+		if ( m_pPos >= m_pEnd ) {
+			return false;
+		}
+		*pnValue = *m_pPos++;
+		return true;
+	}
+	bool readWord( uint32_t* pnValue ) {
+		if ( remaining() < 2 ) {
+			return false;
+		}
+		*pnValue = ( m_pPos[ 0 ] << 8 ) | m_pPos[ 1 ];
+		m_pPos += 2;
+		return true;
+	}
+	bool readDWord( uint32_t* pnValue ) {
+		if ( remaining() < 4 ) {
+			return false;
+		}
+		*pnValue = ( static_cast<uint32_t>( m_pPos[ 0 ] ) << 24 ) |
+			( m_pPos[ 1 ] << 16 ) | ( m_pPos[ 2 ] << 8 ) | m_pPos[ 3 ];
+		m_pPos += 4;
+		return true;
+	}
+	/** Variable-length quantity of at most four bytes. */
+	bool readVarLen( uint32_t* pnValue ) {
+		*pnValue = 0;
+		for ( int ii = 0; ii < 4; ++ii ) {
+			uint8_t nByte;
+			if ( ! readByte( &nByte ) ) {
+				return false;
+			}
+			*pnValue = ( *pnValue << 7 ) | ( nByte & 0x7F );
+			if ( ( nByte & 0x80 ) == 0 ) {
+				return true;
+			}
+		}
+		return false;
+	}
+	bool skip( size_t nBytes ) {
+		if ( remaining() < nBytes ) {
+			return false;
+		}
+		m_pPos += nBytes;
+		return true;
+	}
+
+private:
+	const uint8_t* m_pPos;
+	const uint8_t* m_pEnd;
+};
+
+}
+
+SMFReader::SMFReader()
+{
+	clear();
+}
+
+SMFReader::~SMFReader()
+{
+}
+
+void SMFReader::clear()
+{
+	m_nFormat = 0;
+	m_nTPQN = 0;
+	m_fBpm = 120;
+	m_nNumerator = 4;
+	m_nDenominator = 4;
+	m_bTempoRead = false;
+	m_bTimeSignatureRead = false;
+	m_sName = "";
+	m_nEndTick = 0;
+	// Keeps the capacity for the next file.
+	m_notes.clear();
+	m_trackStarts.clear();
+}
+
+bool SMFReader::read( const QString& sFilename )
+{
+	clear();
+
+	QFile file( sFilename );
+	if ( ! file.open( QIODevice::ReadOnly ) ) {
+		ERRORLOG( QString( "Unable to open [%1] for reading" ).arg( sFilename ) );
+		return false;
+	}
+
+	bool bSuccess;
+	const qint64 nSize = file.size();
+	if ( uchar* pData = file.map( 0, nSize ) ) {
+		bSuccess = parse( pData, nSize );
+		file.unmap( pData );
+	} else {
+		const QByteArray data = file.readAll();
+		bSuccess = parse( reinterpret_cast<const uint8_t*>( data.constData() ),
+						  data.size() );
+	}
+
+	if ( ! bSuccess ) {
+		ERRORLOG( QString( "[%1] is not a valid Standard MIDI File of format 0 or 1" )
+				  .arg( sFilename ) );
+	}
+	return bSuccess;
+}
+
+bool SMFReader::parse( const uint8_t* pData, size_t nSize )
+{
+	clear();
+
+	SMFCursor cursor( pData, nSize );
+	uint32_t nChunkId, nHeaderLength, nFormat, nTracks, nDivision;
+	if ( ! cursor.readDWord( &nChunkId ) || nChunkId != 1297377380 || // MThd
+		 ! cursor.readDWord( &nHeaderLength ) || nHeaderLength < 6 ||
+		 ! cursor.readWord( &nFormat ) || ! cursor.readWord( &nTracks ) ||
+		 ! cursor.readWord( &nDivision ) || ! cursor.skip( nHeaderLength - 6 ) ) {
+		ERRORLOG( "Invalid header" );
+		return false;
+	}
+	if ( nFormat > 1 ) {
+		ERRORLOG( QString( "Unsupported format [%1]" ).arg( nFormat ) );
+		return false;
+	}
+	if ( ( nDivision & 0x8000 ) != 0 || nDivision == 0 ) {
+		ERRORLOG( QString( "Unsupported time division [%1]" ).arg( nDivision ) );
+		return false;
+	}
+	m_nFormat = nFormat;
+	m_nTPQN = nDivision;
+
+	// The number of tracks stated in the header is not trusted. All
+	// track chunks present are read, other chunks are skipped.
+	while ( cursor.remaining() >= 8 ) {
+		uint32_t nLength = 0;
+		cursor.readDWord( &nChunkId );
+		cursor.readDWord( &nLength );
+		if ( nLength > cursor.remaining() ) {
+			WARNINGLOG( "Chunk exceeds file. It is truncated." );
+			nLength = cursor.remaining();
+		}
+		if ( nChunkId == 1297379947 ) { // MTrk
+			m_trackStarts.push_back( m_notes.size() );
+			if ( ! parseTrack( cursor.position(), nLength ) ) {
+				clear();
+				return false;
+			}
+		}
+		cursor.skip( nLength );
+	}
+
+	if ( m_trackStarts.empty() ) {
+		ERRORLOG( "No track found" );
+		clear();
+		return false;
+	}
+
+	// Each track is ordered already. Merge them pairwise.
+	const size_t nMergedTracks = m_trackStarts.size();
+	m_trackStarts.push_back( m_notes.size() );
+	auto byTick = []( const NoteEvent& a, const NoteEvent& b ) {
+		return a.nTick < b.nTick;
+	};
+	for ( size_t nWidth = 1; nWidth < nMergedTracks; nWidth *= 2 ) {
+		for ( size_t ii = 0; ii + nWidth < nMergedTracks; ii += 2 * nWidth ) {
+			std::inplace_merge( m_notes.begin() + m_trackStarts[ ii ],
+								m_notes.begin() + m_trackStarts[ ii + nWidth ],
+								m_notes.begin() +
+								m_trackStarts[ std::min( ii + 2 * nWidth, nMergedTracks ) ],
+								byTick );
+		}
+	}
+	m_trackStarts.pop_back();
+
+	return true;
+}
+
+bool SMFReader::parseTrack( const uint8_t* pData, size_t nSize )
+{
+	// A note on takes at least two bytes using running status plus
+	// one byte of delta time.
+	if ( m_notes.capacity() < m_notes.size() + nSize / 3 ) {
+		m_notes.reserve( m_notes.size() + nSize / 3 );
+	}
+
+	SMFCursor cursor( pData, nSize );
+	int64_t nTick = 0;
+	uint8_t nRunningStatus = 0;
+	while ( ! cursor.atEnd() ) {
+		uint32_t nDelta;
+		uint8_t nStatus;
+		if ( ! cursor.readVarLen( &nDelta ) || ! cursor.readByte( &nStatus ) ) {
+			ERRORLOG( "Truncated event" );
+			return false;
+		}
+		nTick += nDelta;
+		if ( nTick > std::numeric_limits<int>::max() ) {
+			ERRORLOG( "Track too long" );
+			return false;
+		}
+
+		uint8_t nData1 = 0, nData2 = 0;
+		if ( nStatus < 0x80 ) {
+			// Data byte. Running status applies.
+			if ( nRunningStatus == 0 ) {
+				ERRORLOG( "Data byte without status" );
+				return false;
+			}
+			nData1 = nStatus;
+			nStatus = nRunningStatus;
+		}
+		else if ( nStatus < 0xF0 ) {
+			nRunningStatus = nStatus;
+			if ( ! cursor.readByte( &nData1 ) ) {
+				ERRORLOG( "Truncated event" );
+				return false;
+			}
+		}
+
+		if ( nStatus < 0xF0 ) {
+			const uint8_t nType = nStatus & 0xF0;
+			// Program change and channel pressure have a single
+			// data byte.
+			if ( nType != 0xC0 && nType != 0xD0 &&
+				 ! cursor.readByte( &nData2 ) ) {
+				ERRORLOG( "Truncated event" );
+				return false;
+			}
+			if ( nType == NOTE_ON && nData2 > 0 ) {
+				m_notes.push_back( { static_cast<int>( nTick ),
+									 static_cast<uint8_t>( nStatus & 0x0F ),
+									 static_cast<uint8_t>( nData1 & 0x7F ),
+									 static_cast<uint8_t>( nData2 & 0x7F ) } );
+			}
+			continue;
+		}
+
+		// System exclusive and meta events cancel running status.
+		nRunningStatus = 0;
+		uint32_t nLength;
+		if ( nStatus == 0xF0 || nStatus == 0xF7 ) {
+			if ( ! cursor.readVarLen( &nLength ) || ! cursor.skip( nLength ) ) {
+				ERRORLOG( "Truncated system exclusive event" );
+				return false;
+			}
+			continue;
+		}
+		if ( nStatus != 0xFF ) {
+			ERRORLOG( QString( "Unexpected status [%1]" ).arg( nStatus, 0, 16 ) );
+			return false;
+		}
+
+		uint8_t nMetaType;
+		if ( ! cursor.readByte( &nMetaType ) || ! cursor.readVarLen( &nLength ) ||
+			 cursor.remaining() < nLength ) {
+			ERRORLOG( "Truncated meta event" );
+			return false;
+		}
+		const uint8_t* pMeta = cursor.position();
+		cursor.skip( nLength );
+
+		if ( nMetaType == END_OF_TRACK ) {
+			m_nEndTick = std::max( m_nEndTick, static_cast<int>( nTick ) );
+			return true;
+		}
+		else if ( nMetaType == SET_TEMPO && nLength == 3 && ! m_bTempoRead ) {
+			m_bTempoRead = true;
+			const uint32_t nMicroseconds = ( pMeta[ 0 ] << 16 ) | ( pMeta[ 1 ] << 8 ) |
+				pMeta[ 2 ];
+			if ( nMicroseconds > 0 ) {
+				m_fBpm = 60000000.0 / nMicroseconds;
+			}
+		}
+		else if ( nMetaType == TIME_SIGNATURE && nLength >= 2 &&
+				  ! m_bTimeSignatureRead ) {
+			m_bTimeSignatureRead = true;
+			if ( pMeta[ 0 ] > 0 && pMeta[ 1 ] <= 6 ) {
+				m_nNumerator = pMeta[ 0 ];
+				m_nDenominator = 1 << pMeta[ 1 ];
+			}
+		}
+		else if ( nMetaType == TRACK_NAME && m_sName.isEmpty() ) {
+			m_sName = QString::fromUtf8( reinterpret_cast<const char*>( pMeta ),
+										 nLength ).trimmed();
+		}
+	}
+
+	// Missing End of Track events are tolerated.
+	m_nEndTick = std::max( m_nEndTick, static_cast<int>( nTick ) );
+	return true;
+}
+
+Pattern* SMFReader::createPattern( std::shared_ptr<InstrumentList> pInstrumentList,
+								   const QString& sName, int nQuantize,
+								   int* pnUnmapped ) const
+{
+	if ( m_nTPQN <= 0 ) {
+		ERRORLOG( "No file read yet" );
+		return nullptr;
+	}
+	nQuantize = std::max( nQuantize, 1 );
+
+	// Resolve all keys once instead of searching the list per note.
+	std::array<std::shared_ptr<Instrument>, 128> instruments;
+	for ( int nKey = 0; nKey < 128; ++nKey ) {
+		instruments[ nKey ] = pInstrumentList->findMidiNote( nKey );
+	}
+
+	// Rounds to the nearest multiple of nQuantize pattern ticks.
+	const int64_t nDivisor = 2 * static_cast<int64_t>( m_nTPQN ) * nQuantize;
+	auto toPatternTick = [&]( int nTick ) {
+		return static_cast<int>( ( static_cast<int64_t>( nTick ) * PATTERN_TPQN * 2 +
+								   m_nTPQN * static_cast<int64_t>( nQuantize ) ) /
+								 nDivisor ) * nQuantize;
+	};
+
+	// The length is determined without quantization. Otherwise a
+	// note shortly before the end of the last bar could add another
+	// one.
+	const int nBarLength =
+		std::max( 4 * PATTERN_TPQN * m_nNumerator / m_nDenominator, 1 );
+	int nEnd = m_nEndTick;
+	if ( ! m_notes.empty() ) {
+		nEnd = std::max( nEnd, m_notes.back().nTick + 1 );
+	}
+	nEnd = static_cast<int>( ( static_cast<int64_t>( nEnd ) * PATTERN_TPQN +
+							   m_nTPQN - 1 ) / m_nTPQN );
+	const int nLength = std::max( ( nEnd + nBarLength - 1 ) / nBarLength, 1 ) * nBarLength;
+
+	Pattern* pPattern = new Pattern( sName, "", "not_categorized", nLength,
+									 m_nDenominator );
+
+	int nUnmapped = 0;
+	for ( const auto& event : m_notes ) {
+		const auto& pInstrument = instruments[ event.nKey ];
+		if ( pInstrument == nullptr ) {
+			++nUnmapped;
+			continue;
+		}
+
+		// Notes quantized onto the end of the pattern belong to the
+		// first beat of the next repetition.
+		const int nPosition = toPatternTick( event.nTick ) % nLength;
+		const float fVelocity = event.nVelocity / 127.0f;
+		Note* pNote = pPattern->find_note( nPosition, -1, pInstrument );
+		if ( pNote != nullptr ) {
+			pNote->set_velocity( std::max( pNote->get_velocity(), fVelocity ) );
+			continue;
+		}
+		pPattern->insert_note( new Note( pInstrument, nPosition, fVelocity,
+										 0.f, -1, 0 ) );
+	}
+
+	if ( pnUnmapped != nullptr ) {
+		*pnUnmapped = nUnmapped;
+	}
+	return pPattern;
+}
+
+std::vector<SMFReader::ConversionResult> SMFReader::convertFiles( const QStringList& files,
+																 const QString& sTargetDir,
+																 std::shared_ptr<Drumkit> pDrumkit,
+																 int nQuantize,
+																 bool bBinary,
+																 int nThreads )
+{
+	std::vector<ConversionResult> results( files.size() );
+	if ( ! Filesystem::path_usable( sTargetDir, true, false ) ) {
+		for ( int ii = 0; ii < files.size(); ++ii ) {
+			results[ ii ].sSourceFile = files[ ii ];
+		}
+		return results;
+	}
+
+	// Files of the same name in different folders would overwrite
+	// each other's pattern. Duplicate names are numbered.
+	QStringList names;
+	QSet<QString> usedNames;
+	for ( const auto& sFile : files ) {
+		const QString sName = QFileInfo( sFile ).completeBaseName();
+		QString sUniqueName = sName;
+		int nSuffix = 2;
+		while ( usedNames.contains( sUniqueName ) ) {
+			sUniqueName = QString( "%1_%2" ).arg( sName ).arg( nSuffix++ );
+		}
+		usedNames.insert( sUniqueName );
+		names << sUniqueName;
+	}
+
+	std::atomic<int> nNextFile( 0 );
+	auto work = [&]() {
+		// One reader, and thus one event buffer, per thread.
+		SMFReader reader;
+		int nFile;
+		while ( ( nFile = nNextFile++ ) < files.size() ) {
+			ConversionResult& result = results[ nFile ];
+			result.sSourceFile = files[ nFile ];
+			if ( ! reader.read( result.sSourceFile ) ) {
+				continue;
+			}
+
+			const QString& sName = names[ nFile ];
+			Pattern* pPattern = reader.createPattern( pDrumkit->get_instruments(), sName,
+													  nQuantize, &result.nUnmapped );
+			result.nNotes = pPattern->get_notes()->size();
+			// Binary patterns share the extension and are told
+			// apart by their magic (see BinaryDoc::isBinary()).
+			result.sPatternFile = QDir( sTargetDir ).filePath(
+				sName + Filesystem::patterns_ext );
+			result.bSuccess = pPattern->save_file( pDrumkit->get_name(),
+												   pDrumkit->get_author(),
+												   pDrumkit->get_license(),
+												   result.sPatternFile, true, bBinary );
+			delete pPattern;
+		}
+	};
+
+	nThreads = nThreads > 0 ? nThreads : std::max( QThread::idealThreadCount(), 1 );
+	nThreads = std::min( nThreads, static_cast<int>( files.size() ) );
+
+	// The calling thread is one of the workers.
+	std::vector<std::thread> threads;
+	for ( int ii = 1; ii < nThreads; ++ii ) {
+		threads.emplace_back( work );
+	}
+	work();
+	for ( auto& thread : threads ) {
+		thread.join();
+	}
+
+	return results;
+}
+
 };
@@ -0,0 +1,333 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <core/SoundLibrary/DrumkitBatch.h>
+#include <core/config.h>
+
+#include <core/Basics/Drumkit.h>
+#include <core/Basics/Sample.h>
+#include <core/CoreActionController.h>
+#include <core/Helpers/Archive.h>
+#include <core/Helpers/Filesystem.h>
+#include <core/Helpers/Xml.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QSet>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace H2Core
+{
+
+static bool isCompressedDrumkit( const QFileInfo& info )
+{
+	return "." + info.suffix() == Filesystem::drumkit_ext;
+}
+
+static void collectDrumkits( const QString& sDir, QStringList* pDrumkits )
+{
+	const QDir dir( sDir );
+	for ( const auto& info : dir.entryInfoList( QDir::Dirs | QDir::Files |
+												QDir::NoDotAndDotDot, QDir::Name ) ) {
+		const QString sPath = info.absoluteFilePath();
+		if ( info.isDir() ) {
+			if ( Filesystem::drumkit_valid( sPath ) ) {
+				*pDrumkits << sPath;
+			}
+			else if ( ! info.isSymLink() ) {
+				// Symbolic links are not followed to avoid cycles.
+				collectDrumkits( sPath, pDrumkits );
+			}
+		}
+		else if ( isCompressedDrumkit( info ) ) {
+			*pDrumkits << sPath;
+		}
+	}
+}
+
+QStringList DrumkitBatch::findDrumkits( const QStringList& paths )
+{
+	QStringList drumkits;
+	for ( const auto& sPath : paths ) {
+		const QFileInfo info( sPath );
+		if ( info.isDir() && ! Filesystem::drumkit_valid( sPath ) ) {
+			collectDrumkits( sPath, &drumkits );
+		}
+		else {
+			// Paths being neither a drumkit nor a folder are kept to
+			// show up as failures in the results.
+			drumkits << sPath;
+		}
+	}
+
+	return drumkits;
+}
+
+std::vector<DrumkitBatch::Result> DrumkitBatch::run( Action action, const QStringList& drumkits,
+													 const Options& options,
+													 ResultCallback callback )
+{
+	// Each kit upgraded into the target folder gets a subfolder of
+	// its own. Duplicate names are numbered.
+	QStringList targetDirs;
+	if ( action == Action::Upgrade && ! options.sTargetDir.isEmpty() ) {
+		QSet<QString> usedNames;
+		for ( const auto& sPath : drumkits ) {
+			const QFileInfo info( sPath );
+			QString sName;
+			if ( info.isDir() ) {
+				sName = info.fileName();
+			} else if ( info.fileName() == Filesystem::drumkit_xml() ) {
+				sName = info.dir().dirName();
+			} else {
+				sName = info.completeBaseName();
+			}
+
+			QString sUniqueName = sName;
+			int nSuffix = 2;
+			while ( usedNames.contains( sUniqueName ) ) {
+				sUniqueName = QString( "%1_%2" ).arg( sName ).arg( nSuffix++ );
+			}
+			usedNames.insert( sUniqueName );
+			targetDirs << QDir( options.sTargetDir ).filePath( sUniqueName );
+		}
+	}
+
+	std::vector<Result> results( drumkits.size() );
+	std::atomic<int> nNextKit( 0 );
+	std::mutex callbackMutex;
+	auto work = [&]() {
+		int nKit;
+		while ( ( nKit = nNextKit++ ) < drumkits.size() ) {
+			results[ nKit ] = process( action, drumkits[ nKit ],
+									   targetDirs.isEmpty() ? "" : targetDirs[ nKit ],
+									   options );
+			if ( callback ) {
+				std::lock_guard<std::mutex> lock( callbackMutex );
+				callback( results[ nKit ] );
+			}
+		}
+	};
+
+	int nThreads = options.nThreads > 0 ? options.nThreads :
+		std::max( QThread::idealThreadCount(), 1 );
+	nThreads = std::min( nThreads, static_cast<int>( drumkits.size() ) );
+
+	// The calling thread is one of the workers.
+	std::vector<std::thread> threads;
+	for ( int ii = 1; ii < nThreads; ++ii ) {
+		threads.emplace_back( work );
+	}
+	work();
+	for ( auto& thread : threads ) {
+		thread.join();
+	}
+
+	return results;
+}
+
+DrumkitBatch::Result DrumkitBatch::process( Action action, const QString& sPath,
+											const QString& sTargetDir,
+											const Options& options )
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	Result result;
+	result.sPath = sPath;
+	validate( &result, options.bLoadSamples );
+	const bool bSamplesOk = result.missingSamples.isEmpty() &&
+		result.brokenSamples.isEmpty();
+
+	if ( action == Action::Validate ) {
+		result.bSuccess = result.sError.isEmpty() && result.bValid && bSamplesOk;
+	}
+	else if ( result.sError.isEmpty() ) {
+		// Kits already complying with the XSD are only touched in
+		// case they have to be copied to the target folder.
+		if ( ! result.bValid || ! sTargetDir.isEmpty() ) {
+			CoreActionController controller;
+			if ( controller.upgradeDrumkit( sPath, sTargetDir ) ) {
+				result.bUpgraded = true;
+			} else {
+				result.sError = "Upgrade failed";
+			}
+		}
+		result.bSuccess = result.sError.isEmpty() && bSamplesOk;
+	}
+
+	result.fElapsedMs = timer.nsecsElapsed() / 1000000.0;
+
+	return result;
+}
+
+void DrumkitBatch::validate( Result* pResult, bool bLoadSamples )
+{
+	const QFileInfo info( pResult->sPath );
+
+	// Holds the content of a compressed kit.
+	std::unique_ptr<QTemporaryDir> pTmpDir;
+	// Absolute paths of all files within a compressed kit of which
+	// only the drumkit.xml was extracted.
+	QSet<QString> archiveFiles;
+	bool bUseArchiveFiles = false;
+
+	QString sDrumkitDir;
+	if ( info.isDir() ) {
+		sDrumkitDir = info.absoluteFilePath();
+	}
+	else if ( info.fileName() == Filesystem::drumkit_xml() ) {
+		sDrumkitDir = info.absolutePath();
+	}
+	else if ( isCompressedDrumkit( info ) ) {
+		pTmpDir = std::make_unique<QTemporaryDir>( Filesystem::tmp_dir() + "/XXXXXX" );
+		if ( ! pTmpDir->isValid() ) {
+			pResult->sError = "Unable to create temporary folder";
+			return;
+		}
+#ifdef H2CORE_HAVE_LIBARCHIVE
+		const QDir tmpDir( pTmpDir->path() );
+		QStringList entries;
+		auto filter = [&]( const QString& sEntry ) {
+			entries << sEntry;
+			return bLoadSamples || QFileInfo( sEntry ).fileName() == Filesystem::drumkit_xml();
+		};
+		if ( ! Archive::extract( pResult->sPath, tmpDir.path(), nullptr, filter ) ) {
+			pResult->sError = "Unable to extract archive";
+			return;
+		}
+		if ( ! bLoadSamples ) {
+			bUseArchiveFiles = true;
+			for ( const auto& sEntry : entries ) {
+				archiveFiles.insert( QDir::cleanPath( tmpDir.filePath( sEntry ) ) );
+			}
+		}
+#else
+		if ( ! Drumkit::install( pResult->sPath, pTmpDir->path(), true ) ) {
+			pResult->sError = "Unable to extract archive";
+			return;
+		}
+#endif
+		// Same requirement as in CoreActionController::retrieveDrumkit().
+		const QStringList folders =
+			QDir( pTmpDir->path() ).entryList( QDir::Dirs | QDir::NoDotAndDotDot );
+		if ( folders.size() != 1 ) {
+			pResult->sError = "Archive does not contain a single folder";
+			return;
+		}
+		sDrumkitDir = pTmpDir->path() + "/" + folders[ 0 ];
+	}
+	else {
+		pResult->sError = "Neither a drumkit folder, drumkit.xml, nor .h2drumkit file";
+		return;
+	}
+
+	if ( ! Filesystem::drumkit_valid( sDrumkitDir ) ) {
+		pResult->sError = "No drumkit.xml found";
+		return;
+	}
+
+	const QString sDrumkitFile = Filesystem::drumkit_file( sDrumkitDir );
+	XMLDoc doc;
+	pResult->bValid = doc.read( sDrumkitFile, Filesystem::drumkit_xsd_path(), true );
+	if ( ! pResult->bValid && ! doc.read( sDrumkitFile, "", true ) ) {
+		pResult->sError = "Unable to parse drumkit.xml";
+		return;
+	}
+
+	XMLNode root = doc.firstChildElement( "drumkit_info" );
+	if ( root.isNull() ) {
+		pResult->sError = "'drumkit_info' node not found";
+		return;
+	}
+	pResult->sName = root.read_string( "name", "", false, false, true );
+
+	// All formats, legacy ones included, store the path of the
+	// samples in "filename" nodes.
+	const QDomNodeList filenameNodes = doc.elementsByTagName( "filename" );
+	const QDir drumkitDir( sDrumkitDir );
+	for ( int ii = 0; ii < filenameNodes.size(); ++ii ) {
+		const QString sFilename = filenameNodes.at( ii ).toElement().text();
+		if ( sFilename.isEmpty() ) {
+			continue;
+		}
+		++pResult->nSamples;
+
+		const bool bRelative = ! QDir::isAbsolutePath( sFilename );
+		const QString sSamplePath = bRelative ? drumkitDir.filePath( sFilename ) : sFilename;
+		const bool bExists = bUseArchiveFiles && bRelative ?
+			archiveFiles.contains( QDir::cleanPath( sSamplePath ) ) :
+			QFileInfo::exists( sSamplePath );
+		if ( ! bExists ) {
+			pResult->missingSamples << sFilename;
+		}
+		else if ( bLoadSamples && Sample::load( sSamplePath ) == nullptr ) {
+			pResult->brokenSamples << sFilename;
+		}
+	}
+}
+
+QByteArray DrumkitBatch::toJson( Action action, const std::vector<Result>& results,
+								 double fElapsedMs )
+{
+	QJsonArray kits;
+	int nFailed = 0;
+	for ( const auto& result : results ) {
+		QJsonObject kit;
+		kit.insert( "path", result.sPath );
+		kit.insert( "name", result.sName );
+		kit.insert( "success", result.bSuccess );
+		kit.insert( "valid", result.bValid );
+		kit.insert( "upgraded", result.bUpgraded );
+		kit.insert( "samples", result.nSamples );
+		kit.insert( "missingSamples", QJsonArray::fromStringList( result.missingSamples ) );
+		kit.insert( "brokenSamples", QJsonArray::fromStringList( result.brokenSamples ) );
+		kit.insert( "error", result.sError );
+		kit.insert( "elapsedMs", result.fElapsedMs );
+		kits.append( kit );
+
+		if ( ! result.bSuccess ) {
+			++nFailed;
+		}
+	}
+
+	QJsonObject report;
+	report.insert( "action", action == Action::Validate ? "validate" : "upgrade" );
+	report.insert( "total", static_cast<int>( results.size() ) );
+	report.insert( "failed", nFailed );
+	report.insert( "elapsedMs", fElapsedMs );
+	report.insert( "kits", kits );
+
+	return QJsonDocument( report ).toJson();
+}
+
+};
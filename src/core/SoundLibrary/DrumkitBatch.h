@@ -0,0 +1,127 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef H2C_DRUMKIT_BATCH_H
+#define H2C_DRUMKIT_BATCH_H
+
+#include <core/Object.h>
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <functional>
+#include <vector>
+
+namespace H2Core
+{
+
+/**
+ * Validates or upgrades a whole library of drumkits in parallel.
+ *
+ * In contrast to CoreActionController::validateDrumkit() neither a
+ * #Hydrogen instance is required nor are the samples loaded or, in
+ * case of a .h2drumkit, extracted. Only the drumkit.xml is validated
+ * against the XSD and the sample files it references are looked up
+ * on disk or in the archive. Loading the samples is optional.
+ */
+/** \ingroup docCore*/
+class DrumkitBatch : public H2Core::Object<DrumkitBatch>
+{
+		H2_OBJECT(DrumkitBatch)
+	public:
+		enum class Action {
+			Validate,
+			/** Kits which do not comply with the XSD are upgraded
+			 * using CoreActionController::upgradeDrumkit(). */
+			Upgrade
+		};
+
+		struct Options {
+			/** Number of kits processed at once. If 0,
+			 * QThread::idealThreadCount() is used. */
+			int nThreads = 0;
+			/** Whether all samples are loaded to check they can be
+			 * decoded. Compressed kits have to be extracted for
+			 * this. */
+			bool bLoadSamples = false;
+			/** If set, each upgraded kit is stored in a subfolder,
+			 * named like the kit, of this one. Otherwise, kits are
+			 * upgraded in place. */
+			QString sTargetDir;
+		};
+
+		struct Result {
+			QString sPath;
+			QString sName;
+			bool bSuccess = false;
+			/** Whether the drumkit.xml complied with the XSD prior
+			 * to any upgrade. */
+			bool bValid = false;
+			bool bUpgraded = false;
+			int nSamples = 0;
+			/** Referenced sample files not present in the kit. */
+			QStringList missingSamples;
+			/** Samples which could not be loaded. Only checked if
+			 * Options::bLoadSamples is set. */
+			QStringList brokenSamples;
+			QString sError;
+			double fElapsedMs = 0;
+		};
+
+		/**
+		 * Called once for every kit processed by run(). Calls are
+		 * made from the worker threads but never concurrently.
+		 */
+		typedef std::function<void(const Result&)> ResultCallback;
+
+		/**
+		 * Collects all drumkits in @a paths.
+		 *
+		 * Each path can either be a drumkit itself - a folder
+		 * containing a drumkit.xml, a drumkit.xml, or a .h2drumkit
+		 * file - or a folder, which is searched recursively for
+		 * drumkits.
+		 */
+		static QStringList findDrumkits( const QStringList& paths );
+
+		/**
+		 * Applies @a action to all @a drumkits.
+		 *
+		 * \return One #Result per kit in the order of @a drumkits.
+		 */
+		static std::vector<Result> run( Action action, const QStringList& drumkits,
+										const Options& options,
+										ResultCallback callback = nullptr );
+
+		/** Machine-readable report, JSON, of the results of run(). */
+		static QByteArray toJson( Action action, const std::vector<Result>& results,
+								  double fElapsedMs );
+
+	private:
+		/** Validates the kit at Result::sPath. */
+		static void validate( Result* pResult, bool bLoadSamples );
+		static Result process( Action action, const QString& sPath,
+							   const QString& sTargetDir, const Options& options );
+};
+
+};
+
+#endif // H2C_DRUMKIT_BATCH_H
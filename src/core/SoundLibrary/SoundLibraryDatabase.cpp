@@ -86,6 +86,10 @@ void SoundLibraryDatabase::updateDrumkits( bool bTriggerEvent ) {
 		drumkitPaths << 
 			Filesystem::absolute_path( Filesystem::sys_drumkits_dir() + sDrumkitName );
 	}
+	// System drumkits are read-only. They can not be upgraded in case
+	// they do not validate and there is no need to wait for it.
+	const int nSystemDrumkits = drumkitPaths.size();
+	
 	// user drumkits
 	for ( const auto& sDrumkitName : Filesystem::usr_drumkit_list() ) {
 		drumkitPaths <<
@@ -98,8 +102,10 @@ void SoundLibraryDatabase::updateDrumkits( bool bTriggerEvent ) {
 		}
 	}
 
-	for ( const auto& sDrumkitPath : drumkitPaths ) {
-		auto pDrumkit = Drumkit::load( sDrumkitPath );
+	for ( int ii = 0; ii < drumkitPaths.size(); ++ii ) {
+		const QString& sDrumkitPath = drumkitPaths[ ii ];
+		auto pDrumkit = Drumkit::load( sDrumkitPath, true, false,
+									   ii < nSystemDrumkits );
 		if ( pDrumkit != nullptr ) {
 			if ( m_drumkitDatabase.find( sDrumkitPath ) !=
 				 m_drumkitDatabase.end() ) {
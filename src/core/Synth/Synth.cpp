@@ -24,6 +24,7 @@
 #include <core/Synth/Synth.h>
 #include <core/Basics/Note.h>
 #include <core/Globals.h>
+#include <core/Helpers/AudioBufferArena.h>
 
 #include <cassert>
 #include <cmath>
@@ -36,8 +37,8 @@ Synth::Synth()
 {
 	
 
-	m_pOut_L = new float[ MAX_BUFFER_SIZE ];
-	m_pOut_R = new float[ MAX_BUFFER_SIZE ];
+	m_pOut_L = AudioBufferArena::get_instance()->allocate( MAX_BUFFER_SIZE, 2 );
+	m_pOut_R = m_pOut_L + AudioBufferArena::stride( MAX_BUFFER_SIZE );
 
 	m_fTheta = 0.0;
 
@@ -49,8 +50,7 @@ Synth::Synth()
 Synth::~Synth()
 {
 	INFOLOG( "DESTROY" );
-	delete[] m_pOut_L;
-	delete[] m_pOut_R;
+	AudioBufferArena::get_instance()->release( m_pOut_L );
 }
 
 
@@ -27,6 +27,7 @@
 
 
 #include "HydrogenApp.h"
+#include "RefreshScheduler.h"
 
 #include <core/Basics/Pattern.h>
 #include <core/Basics/PatternList.h>
@@ -51,8 +52,11 @@ AudioEngineInfoForm::AudioEngineInfoForm(QWidget* parent)
 
 	updateInfo();
 
-	m_pTimer = new QTimer(this);
-	connect(m_pTimer, SIGNAL(timeout()), this, SLOT(updateInfo()));
+	// Not called while the form is hidden.
+	HydrogenApp::get_instance()->getRefreshScheduler()->addClient(
+		this, 200, [=]( const AudioEngine::Snapshot& snapshot ) {
+			updateInfo( snapshot );
+		} );
 
 	HydrogenApp::get_instance()->addEventListener( this );
 	updateAudioEngineState();
@@ -74,29 +78,24 @@ AudioEngineInfoForm::~AudioEngineInfoForm()
 void AudioEngineInfoForm::showEvent ( QShowEvent* )
 {
 	updateInfo();
-	m_pTimer->start(200);
 }
 
 
-/**
- * hide event
- */
-void AudioEngineInfoForm::hideEvent ( QHideEvent* )
+void AudioEngineInfoForm::updateInfo()
 {
-	m_pTimer->stop();
+	updateInfo( Hydrogen::get_instance()->getAudioEngine()->getSnapshot() );
 }
 
-
-void AudioEngineInfoForm::updateInfo()
+void AudioEngineInfoForm::updateInfo( const AudioEngine::Snapshot& snapshot )
 {
 	Hydrogen *pHydrogen = Hydrogen::get_instance();
-	AudioEngine* pAudioEngine = pHydrogen->getAudioEngine();;
+	AudioEngine* pAudioEngine = pHydrogen->getAudioEngine();
 	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 
 	// Song position
 	QString sColumn = "N/A";
-	if ( pAudioEngine->getTransportPosition()->getColumn() != -1 ) {
-		sColumn = QString::number( pAudioEngine->getTransportPosition()->getColumn() );
+	if ( snapshot.nColumn != -1 ) {
+		sColumn = QString::number( snapshot.nColumn );
 	}
 	m_pSongPositionLbl->setText( sColumn );
 
@@ -106,10 +105,10 @@ void AudioEngineInfoForm::updateInfo()
 
 	// Process time
 	int perc = 0;
-	if ( pAudioEngine->getMaxProcessTime() != 0.0 ) {
-		perc= (int)( pAudioEngine->getProcessTime() / ( pAudioEngine->getMaxProcessTime() / 100.0 ) );
+	if ( snapshot.fMaxProcessTime != 0.0 ) {
+		perc= (int)( snapshot.fProcessTime / ( snapshot.fMaxProcessTime / 100.0 ) );
 	}
-	sprintf(tmp, "%#.2f / %#.2f  (%d%%)", pAudioEngine->getProcessTime(), pAudioEngine->getMaxProcessTime(), perc );
+	sprintf(tmp, "%#.2f / %#.2f  (%d%%)", snapshot.fProcessTime, snapshot.fMaxProcessTime, perc );
 	processTimeLbl->setText(tmp);
 
 	// Song state
@@ -126,7 +125,7 @@ void AudioEngineInfoForm::updateInfo()
 	}
 
 	// tick number
-	sprintf(tmp, "%03d", (int)pAudioEngine->getTransportPosition()->getPatternTickPosition() );
+	sprintf(tmp, "%03d", (int)snapshot.nPatternTickPosition );
 	nTicksLbl->setText(tmp);
 
 
@@ -149,7 +148,7 @@ void AudioEngineInfoForm::updateInfo()
 		sampleRateLbl->setText(QString(tmp));
 
 		// Number of frames
-		sprintf(tmp, "%d", static_cast<int>( pAudioEngine->getTransportPosition()->getFrame() ) );
+		sprintf(tmp, "%d", static_cast<int>( snapshot.nFrame ) );
 		nFramesLbl->setText(tmp);
 	}
 	else {
@@ -159,7 +158,7 @@ void AudioEngineInfoForm::updateInfo()
 		sampleRateLbl->setText( "N/A" );
 		nFramesLbl->setText( "N/A" );
 	}
-	nRealtimeFramesLbl->setText( QString( "%1" ).arg( pAudioEngine->getRealtimeFrame() ) );
+	nRealtimeFramesLbl->setText( QString( "%1" ).arg( snapshot.nRealtimeFrame ) );
 
 
 	// Midi driver info
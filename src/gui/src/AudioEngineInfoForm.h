@@ -42,8 +42,6 @@ class AudioEngineInfoForm :  public QWidget, public Ui_AudioEngineInfoForm_UI, p
     H2_OBJECT(AudioEngineInfoForm)
 	Q_OBJECT
 	private:
-		QTimer* m_pTimer;
-
 		// EventListener implementation
 	virtual void stateChangedEvent( H2Core::AudioEngine::State state) override;
 	virtual void playingPatternsChangedEvent() override;
@@ -55,12 +53,12 @@ class AudioEngineInfoForm :  public QWidget, public Ui_AudioEngineInfoForm_UI, p
 		~AudioEngineInfoForm();
 
 		void showEvent ( QShowEvent *ev ) override;
-		void hideEvent ( QHideEvent *ev ) override;
 
 	public slots:
 		void updateInfo();
 
 	private:
+		void updateInfo( const H2Core::AudioEngine::Snapshot& snapshot );
 		void updateAudioEngineState();
 };
 
@@ -102,26 +102,14 @@ void SampleWaveDisplay::updateDisplay( QString filename )
 //		INFOLOG( "[updateDisplay] sample: " + m_sSampleName  );
 
 		int nSampleLength = pNewSample->get_frames();
-		float nScaleFactor = nSampleLength / width();
+		int nScaleFactor = nSampleLength / width();
 
 		float fGain = height() / 2.0 * 1.0;
 
-		auto pSampleData = pNewSample->get_data_l();
-
-		int nSamplePos =0;
-		int nVal;
 		for ( int i = 0; i < width(); ++i ){
-			nVal = 0;
-			for ( int j = 0; j < nScaleFactor; ++j ) {
-				if ( j < nSampleLength ) {
-					int newVal = static_cast<int>( pSampleData[ nSamplePos ] * fGain );
-					if ( newVal > nVal ) {
-						nVal = newVal;
-					}
-				}
-				++nSamplePos;
-			}
-			m_pPeakData[ i ] = nVal;
+			const auto range = pNewSample->getWaveformRange(
+				0, i * nScaleFactor, ( i + 1 ) * nScaleFactor );
+			m_pPeakData[ i ] = std::max( 0, static_cast<int>( range.fMax * fGain ) );
 		}
 	}
 
@@ -77,6 +77,9 @@ static int interpolateModeToComboBoxIndex(Interpolation::InterpolateMode interpo
 		case Interpolation::InterpolateMode::Hermite:
 			Index = 4;
 			break;
+		case Interpolation::InterpolateMode::Sinc:
+			Index = 5;
+			break;
 	}
 	
 	return Index;
@@ -782,6 +785,9 @@ void ExportSongDialog::setResamplerMode(int index)
 	case 4:
 		m_pHydrogen->getAudioEngine()->getSampler()->setInterpolateMode( Interpolation::InterpolateMode::Hermite );
 		break;
+	case 5:
+		m_pHydrogen->getAudioEngine()->getSampler()->setInterpolateMode( Interpolation::InterpolateMode::Sinc );
+		break;
 	}
 }
 
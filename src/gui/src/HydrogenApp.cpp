@@ -38,6 +38,7 @@
 #include "LadspaFXProperties.h"
 #include "InstrumentRack.h"
 #include "Director.h"
+#include "RefreshScheduler.h"
 
 #include "PatternEditor/PatternEditorPanel.h"
 #include "PatternEditor/PatternEditorRuler.h"
@@ -82,9 +83,12 @@ HydrogenApp::HydrogenApp( MainForm *pMainForm )
 {
 	m_pInstance = this;
 
-	m_pEventQueueTimer = new QTimer(this);
-	connect( m_pEventQueueTimer, SIGNAL( timeout() ), this, SLOT( onEventQueueTimer() ) );
-	m_pEventQueueTimer->start( QUEUE_TIMER_PERIOD );
+	// Has to be created before any of the widgets registering
+	// their periodic updates.
+	m_pRefreshScheduler = new RefreshScheduler( this );
+	m_pRefreshScheduler->addClient( this, QUEUE_TIMER_PERIOD,
+									[=]( const AudioEngine::Snapshot& ) {
+										onEventQueueTimer(); } );
 
 	// Wait for m_nPreferenceUpdateTimeout milliseconds of no update
 	// signal before propagating the update. Else importing/resetting a
@@ -191,7 +195,7 @@ WindowProperties HydrogenApp::getWindowProperties( QWidget *pWindow ) {
 HydrogenApp::~HydrogenApp()
 {
 	INFOLOG( "[~HydrogenApp]" );
-	m_pEventQueueTimer->stop();
+	m_pRefreshScheduler->removeClient( this );
 
 
 	//delete the undo tmp directory
@@ -69,6 +69,7 @@ class PlaylistDialog;
 class SampleEditor;
 class Director;
 class InfoBar;
+class RefreshScheduler;
 class CommonStrings;
 
 /** \ingroup docGUI*/
@@ -123,6 +124,7 @@ class HydrogenApp :  public QObject, public EventListener,  public H2Core::Objec
 		SampleEditor*			getSampleEditor();
 		PatternEditorPanel*		getPatternEditorPanel();
 		PlayerControl*			getPlayerControl();
+		RefreshScheduler*		getRefreshScheduler();
 		InstrumentRack*			getInstrumentRack();
 	std::shared_ptr<CommonStrings>			getCommonStrings();
 		InfoBar *			addInfoBar();
@@ -168,8 +170,9 @@ signals:
 
 	public slots:
 		/**
-		 * Function called every #QUEUE_TIMER_PERIOD
-		 * millisecond to pop all Events from the EventQueue
+		 * Function called by the #RefreshScheduler every
+		 * #QUEUE_TIMER_PERIOD millisecond to pop all Events from
+		 * the EventQueue
 		 * and invoke the corresponding functions.
 		 *
 		 * In addition, all MIDI notes in
@@ -208,7 +211,7 @@ private slots:
 		PlaylistDialog *			m_pPlaylistDialog;
 		SampleEditor *				m_pSampleEditor;
 		Director *					m_pDirector;
-		QTimer *					m_pEventQueueTimer;
+		RefreshScheduler *			m_pRefreshScheduler;
 		std::vector<EventListener*> 	m_EventListeners;
 		QTabWidget *				m_pTab;
 		QSplitter *					m_pSplitter;
@@ -311,6 +314,11 @@ inline PlayerControl* HydrogenApp::getPlayerControl()
 	return m_pPlayerControl;
 }
 
+inline RefreshScheduler* HydrogenApp::getRefreshScheduler()
+{
+	return m_pRefreshScheduler;
+}
+
 inline InstrumentRack* HydrogenApp::getInstrumentRack()
 {
 	return m_pInstrumentRack;
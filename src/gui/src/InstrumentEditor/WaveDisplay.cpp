@@ -135,27 +135,16 @@ void WaveDisplay::updateDisplay( std::shared_ptr<H2Core::InstrumentLayer> pLayer
 
 		//INFOLOG( "[updateDisplay] sample: " + m_sSampleName  );
 
-		int nSampleLength = pLayer->get_sample()->get_frames();
+		auto pSample = pLayer->get_sample();
+		int nSampleLength = pSample->get_frames();
 		int nScaleFactor = nSampleLength / m_nCurrentWidth;
 
 		float fGain = height() / 2.0 * pLayer->get_gain();
 
-		auto pSampleData = pLayer->get_sample()->get_data_l();
-
-		int nSamplePos =0;
-		int nVal;
 		for ( int i = 0; i < width(); ++i ){
-			nVal = 0;
-			for ( int j = 0; j < nScaleFactor; ++j ) {
-				if ( j < nSampleLength ) {
-					int newVal = (int)( pSampleData[ nSamplePos ] * fGain );
-					if ( newVal > nVal ) {
-						nVal = newVal;
-					}
-				}
-				++nSamplePos;
-			}
-			m_pPeakData[ i ] = nVal;
+			const auto range = pSample->getWaveformRange(
+				0, i * nScaleFactor, ( i + 1 ) * nScaleFactor );
+			m_pPeakData[ i ] = std::max( 0, (int)( range.fMax * fGain ) );
 		}
 	}
 	else {
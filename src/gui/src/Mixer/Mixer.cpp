@@ -25,6 +25,7 @@
 
 #include "../CommonStrings.h"
 #include "../HydrogenApp.h"
+#include "../RefreshScheduler.h"
 #include "../LadspaFXProperties.h"
 #include "../InstrumentEditor/InstrumentEditorPanel.h"
 #include "../Widgets/Button.h"
@@ -155,9 +156,9 @@ Mixer::Mixer( QWidget* pParent )
 	this->setLayout( pLayout );
 
 
-	m_pUpdateTimer = new QTimer( this );
-	connect( m_pUpdateTimer, SIGNAL( timeout() ), this, SLOT( updateMixer() ) );
-	m_pUpdateTimer->start(50);
+	HydrogenApp::get_instance()->getRefreshScheduler()->addClient(
+		this, 50, [=]( const AudioEngine::Snapshot& snapshot ) {
+			updateMixer( snapshot ); } );
 
 	connect( HydrogenApp::get_instance(), &HydrogenApp::preferencesChanged, this, &Mixer::onPreferencesChanged );
 
@@ -167,7 +168,6 @@ Mixer::Mixer( QWidget* pParent )
 
 Mixer::~Mixer()
 {
-	m_pUpdateTimer->stop();
 }
 
 MixerLine* Mixer::createMixerLine( int nInstr )
@@ -400,7 +400,7 @@ void Mixer::masterVolumeChanged(MasterMixerLine* ref)
 
 
 
-void Mixer::updateMixer()
+void Mixer::updateMixer( const AudioEngine::Snapshot& snapshot )
 {
 	if ( ! isVisible() ) {
 		// Skip redundant updates if mixer is not visible.
@@ -612,10 +612,10 @@ void Mixer::updateMixer()
 
 	// update MasterPeak
 	float fOldPeak_L = m_pMasterLine->getPeak_L();
-	float fNewPeak_L = pAudioEngine->getMasterPeak_L();
+	float fNewPeak_L = snapshot.fMasterPeak_L;
 	pAudioEngine->setMasterPeak_L(0.0);
 	float fOldPeak_R = m_pMasterLine->getPeak_R();
-	float fNewPeak_R = pAudioEngine->getMasterPeak_R();
+	float fNewPeak_R = snapshot.fMasterPeak_R;
 	pAudioEngine->setMasterPeak_R(0.0);
 
 	if (!bShowPeaks) {
@@ -681,7 +681,7 @@ void Mixer::updateMixer()
 void Mixer::showEvent ( QShowEvent *ev )
 {
 	UNUSED( ev );
-	updateMixer();
+	updateMixer( Hydrogen::get_instance()->getAudioEngine()->getSnapshot() );
 }
 
 
@@ -28,6 +28,7 @@
 #include <QtWidgets>
 
 #include <core/Object.h>
+#include <core/AudioEngine/AudioEngine.h>
 #include <core/Preferences/Preferences.h>
 #include <core/Globals.h>
 #include "../EventListener.h"
@@ -70,7 +71,8 @@ class Mixer :  public QWidget, public EventListener,  public H2Core::Object<Mixe
 		void masterVolumeChanged(MasterMixerLine*);
 		void nameClicked(MixerLine* ref);
 		void nameSelected(MixerLine* ref);
-		void updateMixer();
+		/** Called by the #RefreshScheduler. */
+		void updateMixer( const H2Core::AudioEngine::Snapshot& snapshot );
 		void showFXPanelClicked();
 		void showPeaksBtnClicked();
 		void openMixerSettingsDialog();
@@ -96,8 +98,6 @@ class Mixer :  public QWidget, public EventListener,  public H2Core::Object<Mixe
 
 		PixmapWidget *			m_pFXFrame;
 
-		QTimer *				m_pUpdateTimer;
-
 		uint					findMixerLineByRef(MixerLine* ref);
 		uint					findCompoMixerLineByRef(ComponentMixerLine* ref);
 		MixerLine*				createMixerLine( int );
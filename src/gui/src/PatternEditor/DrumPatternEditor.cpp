@@ -49,6 +49,7 @@
 
 #include <math.h>
 #include <cassert>
+#include <cstdlib>
 #include <algorithm>
 #include <stack>
 
@@ -1087,11 +1088,6 @@ void DrumPatternEditor::paste()
 ///
 void DrumPatternEditor::drawPattern(QPainter& painter)
 {
-	auto pPref = H2Core::Preferences::get_instance();
-
-	std::shared_ptr<Song> pSong = Hydrogen::get_instance()->getSong();
-	auto  pInstrList = pSong->getInstrumentList();
-
 	/*
 		BUGFIX
 
@@ -1102,88 +1098,113 @@ void DrumPatternEditor::drawPattern(QPainter& painter)
 	updatePatternInfo();
 	validateSelection();
 
+	drawNoteLayers( painter );
+}
+
+size_t DrumPatternEditor::noteLayerState() const
+{
+	// The row of a note is given by the position of its instrument.
+	auto pInstrList = Hydrogen::get_instance()->getSong()->getInstrumentList();
+	size_t nHash = 0;
+	for ( int ii = 0; ii < pInstrList->size(); ++ii ) {
+		nHash = nHash * 31 + std::hash<Instrument*>()( pInstrList->get( ii ).get() );
+	}
+	return nHash;
+}
 
-	for ( Pattern *pPattern : getPatternsToShow() ) {
-		const Pattern::notes_t *pNotes = pPattern->get_notes();
-		if ( pNotes->size() == 0 ) {
-			continue;
-		}
-		bool bIsForeground = ( pPattern == m_pPattern );
+///
+/// Draws all notes of a pattern within the rendered part of the editor
+///
+void DrumPatternEditor::drawNoteLayer( QPainter& painter, Pattern* pPattern, bool bIsForeground )
+{
+	auto pPref = H2Core::Preferences::get_instance();
+
+	const Pattern::notes_t *pNotes = pPattern->get_notes();
+	if ( pNotes->size() == 0 ) {
+		return;
+	}
 
-		std::vector< int > noteCount; // instrument_id -> count
-		std::stack<std::shared_ptr<Instrument>> instruments;
+	auto pInstrList = Hydrogen::get_instance()->getSong()->getInstrumentList();
+	std::map< const Instrument*, int > rows;
+	for ( int ii = 0; ii < pInstrList->size(); ++ii ) {
+		rows[ pInstrList->get( ii ).get() ] = ii;
+	}
 
-		// Process notes in batches by note position, counting the notes at each instrument so we can display
-		// markers for instruments which have more than one note in the same position (a chord or genuine
-		// duplicates)
-		for ( auto posIt = pNotes->begin(); posIt != pNotes->end(); ) {
-			int nPosition = posIt->second->get_position();
+	// Rows outside the rendered part are skipped. Selected notes
+	// being moved are drawn shifted by the moving offset as well.
+	int nRowPadding = 1;
+	if ( m_selection.isMoving() ) {
+		nRowPadding += std::abs( movingGridOffset().y() );
+	}
+	const int nFirstRow = m_renderedRect.top() / static_cast<int>(m_nGridHeight) - nRowPadding;
+	const int nLastRow = m_renderedRect.bottom() / static_cast<int>(m_nGridHeight) + nRowPadding;
 
-			// Process all notes at this position
-			auto noteIt = posIt;
-			while ( noteIt != pNotes->end() && noteIt->second->get_position() == nPosition ) {
-				Note *pNote = noteIt->second;
+	QFont font( pPref->getApplicationFontFamily(), getPointSize( pPref->getFontSize() ) );
+	painter.setFont( font );
 
-				int nInstrumentID = pNote->get_instrument_id();
-				if ( nInstrumentID >= noteCount.size() ) {
-					noteCount.resize( nInstrumentID+1, 0 );
-				}
+	std::vector< int > noteCount; // row -> count
+	std::stack< int > usedRows;
 
-				if ( ++noteCount[ nInstrumentID ] == 1) {
-					instruments.push( pNote->get_instrument() );
-				}
+	// Process notes in batches by note position, counting the notes at each instrument so we can display
+	// markers for instruments which have more than one note in the same position (a chord or genuine
+	// duplicates)
+	const auto endIt = pNotes->upper_bound( renderedEndTick() );
+	for ( auto posIt = pNotes->begin(); posIt != endIt; ) {
+		int nPosition = posIt->second->get_position();
 
-				drawNote( pNote, painter, bIsForeground );
-				++noteIt;
+		// Process all notes at this position
+		auto noteIt = posIt;
+		while ( noteIt != endIt && noteIt->second->get_position() == nPosition ) {
+			Note *pNote = noteIt->second;
+			++noteIt;
+
+			if ( ! isNoteRendered( pNote ) ) {
+				continue;
 			}
 
-			// Go through used instruments list, drawing markers for superimposed notes and zero'ing the
-			// counts.
-			while ( ! instruments.empty() ) {
-				auto pInstrument = instruments.top();
-				int nInstrumentID = pInstrument->get_id();
-				if ( noteCount[ nInstrumentID ] >  1 ) {
-					// Draw "2x" text to the left of the note
-					int nInstrument = pInstrList->index( pInstrument );
-					int x = PatternEditor::nMargin + (nPosition * m_fGridWidth);
-					int y = ( nInstrument * m_nGridHeight);
-					const int boxWidth = 128;
-
-					QFont font( pPref->getApplicationFontFamily(), getPointSize( pPref->getFontSize() ) );
-					painter.setFont( font );
-					painter.setPen( QColor( 0, 0, 0 ) );
-
-					painter.drawText( QRect( x-boxWidth-6, y, boxWidth, m_nGridHeight),
-									  Qt::AlignRight | Qt::AlignVCenter,
-									  ( QString( "%1" ) + QChar( 0x00d7 )).arg( noteCount[ nInstrumentID ] ) );
-				}
-				noteCount[ nInstrumentID ] = 0;
-				instruments.pop();
+			auto rowIt = rows.find( pNote->get_instrument().get() );
+			if ( rowIt == rows.end() ) {
+				ERRORLOG( "Instrument not found..skipping note" );
+				continue;
+			}
+			const int nRow = rowIt->second;
+			if ( nRow < nFirstRow || nRow > nLastRow ) {
+				continue;
 			}
 
-			posIt = noteIt;
-		}
-	}
-}
+			if ( nRow >= static_cast<int>(noteCount.size()) ) {
+				noteCount.resize( nRow + 1, 0 );
+			}
+			if ( ++noteCount[ nRow ] == 1) {
+				usedRows.push( nRow );
+			}
 
+			QPoint pos ( PatternEditor::nMargin + nPosition * m_fGridWidth,
+						 ( nRow * m_nGridHeight) + (m_nGridHeight / 2) - 3 );
+			drawNoteSymbol( painter, pos, pNote, bIsForeground );
+		}
 
+		// Go through used rows, drawing markers for superimposed notes and zero'ing the
+		// counts.
+		while ( ! usedRows.empty() ) {
+			const int nRow = usedRows.top();
+			if ( noteCount[ nRow ] >  1 ) {
+				// Draw "2x" text to the left of the note
+				int x = PatternEditor::nMargin + (nPosition * m_fGridWidth);
+				int y = ( nRow * m_nGridHeight);
+				const int boxWidth = 128;
+
+				painter.setPen( QColor( 0, 0, 0 ) );
+				painter.drawText( QRect( x-boxWidth-6, y, boxWidth, m_nGridHeight),
+								  Qt::AlignRight | Qt::AlignVCenter,
+								  ( QString( "%1" ) + QChar( 0x00d7 )).arg( noteCount[ nRow ] ) );
+			}
+			noteCount[ nRow ] = 0;
+			usedRows.pop();
+		}
 
-///
-/// Draws a note
-///
-void DrumPatternEditor::drawNote( Note *note, QPainter& p, bool bIsForeground )
-{
-	auto pInstrList = Hydrogen::get_instance()->getSong()->getInstrumentList();
-	int nInstrument = pInstrList->index( note->get_instrument() );
-	if ( nInstrument == -1 ) {
-		ERRORLOG( "Instrument not found..skipping note" );
-		return;
+		posIt = noteIt;
 	}
-
-	QPoint pos ( PatternEditor::nMargin + note->get_position() * m_fGridWidth,
-				 ( nInstrument * m_nGridHeight) + (m_nGridHeight / 2) - 3 );
-
-	drawNoteSymbol( p, pos, note, bIsForeground );
 }
 
 void DrumPatternEditor::drawBackground( QPainter& p)
@@ -1291,7 +1312,8 @@ void DrumPatternEditor::createBackground() {
 	QPainter painter( m_pBackgroundPixmap );
 
 	drawBackground( painter );
-	
+
+	updateRenderedRect();
 	drawPattern( painter );
 }
 
@@ -1304,7 +1326,8 @@ void DrumPatternEditor::paintEvent( QPaintEvent* ev )
 	auto pPref = Preferences::get_instance();
 	
 	qreal pixelRatio = devicePixelRatio();
-	if ( pixelRatio != m_pBackgroundPixmap->devicePixelRatio() || m_bBackgroundInvalid ) {
+	if ( pixelRatio != m_pBackgroundPixmap->devicePixelRatio() || m_bBackgroundInvalid ||
+		 isOutsideRenderedRect( ev->rect() ) ) {
 		createBackground();
 	}
 	
@@ -134,8 +134,10 @@ class DrumPatternEditor : public PatternEditor, protected WidgetWithScalableFont
 
 	private:
 	void createBackground() override;
-		void drawNote( H2Core::Note* note, QPainter& painter, bool bIsForeground = true );
 		void drawPattern( QPainter& painter );
+		virtual void drawNoteLayer( QPainter& painter, H2Core::Pattern* pPattern,
+									bool bIsForeground ) override;
+		virtual size_t noteLayerState() const override;
 		void drawBackground( QPainter& pointer );
 		void drawFocus( QPainter& painter );
 
@@ -886,7 +886,8 @@ void NotePropertiesRuler::paintEvent( QPaintEvent *ev)
 	auto pPref = Preferences::get_instance();
 	
 	qreal pixelRatio = devicePixelRatio();
-	if ( pixelRatio != m_pBackgroundPixmap->devicePixelRatio() || m_bBackgroundInvalid ) {
+	if ( pixelRatio != m_pBackgroundPixmap->devicePixelRatio() || m_bBackgroundInvalid ||
+		 isOutsideRenderedRect( ev->rect() ) ) {
 		createBackground();
 	}
 
@@ -1080,10 +1081,17 @@ void NotePropertiesRuler::createNormalizedBackground(QPixmap *pixmap)
 		QPen selectedPen( selectedNoteColor() );
 		selectedPen.setWidth( 2 );
 
+		// All notes sharing a position are drawn side by side in a
+		// single pass. Positions outside the rendered part of the
+		// ruler are skipped.
 		const Pattern::notes_t* notes = m_pPattern->get_notes();
-		FOREACH_NOTE_CST_IT_BEGIN_END(notes,it) {
+		const auto endIt = notes->upper_bound( renderedEndTick() );
+		for ( auto it = notes->begin(); it != endIt; it = notes->upper_bound( it->first ) ) {
 			Note *pposNote = it->second;
 			assert( pposNote );
+			if ( ! isNoteRendered( pposNote ) ) {
+				continue;
+			}
 			uint pos = pposNote->get_position();
 			int xoffset = 0;
 			FOREACH_NOTE_CST_IT_BOUND(notes,coit,pos) {
@@ -1175,10 +1183,17 @@ void NotePropertiesRuler::createCenteredBackground(QPixmap *pixmap)
 		QPen selectedPen( selectedNoteColor() );
 		selectedPen.setWidth( 2 );
 
+		// All notes sharing a position are drawn side by side in a
+		// single pass. Positions outside the rendered part of the
+		// ruler are skipped.
 		const Pattern::notes_t* notes = m_pPattern->get_notes();
-		FOREACH_NOTE_CST_IT_BEGIN_END(notes,it) {
+		const auto endIt = notes->upper_bound( renderedEndTick() );
+		for ( auto it = notes->begin(); it != endIt; it = notes->upper_bound( it->first ) ) {
 			Note *pposNote = it->second;
 			assert( pposNote );
+			if ( ! isNoteRendered( pposNote ) ) {
+				continue;
+			}
 			uint pos = pposNote->get_position();
 			int xoffset = 0;
 			FOREACH_NOTE_CST_IT_BOUND(notes,coit,pos) {
@@ -1330,11 +1345,13 @@ void NotePropertiesRuler::createNoteKeyBackground(QPixmap *pixmap)
 		selectedPen.setWidth( 2 );
 
 		const Pattern::notes_t* notes = m_pPattern->get_notes();
-		FOREACH_NOTE_CST_IT_BEGIN_END(notes,it) {
+		for ( auto it = notes->begin(), end = notes->upper_bound( renderedEndTick() );
+			  it != end; ++it ) {
 			Note *pNote = it->second;
 			assert( pNote );
-			if ( pNote->get_instrument() != pSelectedInstrument
-				 && !m_selection.isSelected( pNote ) ) {
+			if ( ( pNote->get_instrument() != pSelectedInstrument
+				   && !m_selection.isSelected( pNote ) ) ||
+				 ! isNoteRendered( pNote ) ) {
 				continue;
 			}
 			if ( !pNote->get_note_off() ) {
@@ -1427,6 +1444,7 @@ void NotePropertiesRuler::updateEditor( bool )
 void NotePropertiesRuler::createBackground()
 {
 	resize( m_nEditorWidth, height() );
+	updateRenderedRect();
 	
 	qreal pixelRatio = devicePixelRatio();
 	if ( m_pBackgroundPixmap->width() != m_nEditorWidth ||
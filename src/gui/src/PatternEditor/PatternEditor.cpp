@@ -45,6 +45,9 @@
 #include <core/AudioEngine/AudioEngine.h>
 #include <core/Helpers/Xml.h>
 
+#include <cstdlib>
+#include <functional>
+
 
 using namespace std;
 using namespace H2Core;
@@ -107,6 +110,10 @@ PatternEditor::~PatternEditor()
 
 void PatternEditor::onPreferencesChanged( H2Core::Preferences::Changes changes )
 {
+	if ( changes & ( H2Core::Preferences::Changes::Colors |
+					 H2Core::Preferences::Changes::Font ) ) {
+		clearNoteLayers();
+	}
 	if ( changes & H2Core::Preferences::Changes::Colors ) {
 		
 		update( 0, 0, width(), height() );
@@ -255,10 +262,7 @@ void PatternEditor::drawNoteSymbol( QPainter &p, QPoint pos, H2Core::Note *pNote
 
 		// Draw tail
 		if ( pNote->get_length() != -1 ) {
-			float fNotePitch = pNote->get_octave() * 12 + pNote->get_key();
-			float fStep = Note::pitchToFrequency( ( double )fNotePitch );
-			width = m_fGridWidth * pNote->get_length() / fStep;
-			width = width - 1;	// lascio un piccolo spazio tra una nota ed un altra
+			width = noteTailWidth( pNote );
 
 			if ( bSelected ) {
 				p.drawRoundedRect( x_pos-2, y_pos, width+4, 3+4, 4, 4 );
@@ -836,6 +840,133 @@ void PatternEditor::invalidateBackground() {
 void PatternEditor::createBackground() {
 }
 
+/** Mixes the hash of @a value into @a nSeed. */
+template<typename T>
+static void hashCombine( size_t& nSeed, const T& value ) {
+	nSeed ^= std::hash<T>()( value ) + 0x9e3779b9 + ( nSeed << 6 ) + ( nSeed >> 2 );
+}
+
+void PatternEditor::updateRenderedRect() {
+	QRect visible = visibleRegion().boundingRect();
+	if ( visible.isEmpty() ) {
+		visible = rect();
+	}
+	visible.adjust( -visible.width() / 2, -visible.height() / 2,
+					visible.width() / 2, visible.height() / 2 );
+	m_renderedRect = visible.intersected( rect() );
+}
+
+int PatternEditor::renderedEndTick() const {
+	int nEndTick = static_cast<int>( ( m_renderedRect.right() + nNoteLayerPadding -
+									   PatternEditor::nMargin ) / m_fGridWidth ) + 1;
+	if ( m_selection.isMoving() ) {
+		nEndTick += std::abs( movingGridOffset().x() );
+	}
+	return nEndTick;
+}
+
+bool PatternEditor::isNoteRendered( Note* pNote ) const {
+	int nPadding = nNoteLayerPadding;
+	if ( m_selection.isMoving() ) {
+		nPadding += std::abs( movingGridOffset().x() ) * m_fGridWidth;
+	}
+	const int nX = PatternEditor::nMargin + pNote->get_position() * m_fGridWidth;
+	return nX - nPadding <= m_renderedRect.right() &&
+		nX + noteTailWidth( pNote ) + nPadding >= m_renderedRect.left();
+}
+
+int PatternEditor::noteTailWidth( Note* pNote ) const {
+	if ( pNote->get_length() == -1 ) {
+		return 0;
+	}
+	float fNotePitch = pNote->get_octave() * 12 + pNote->get_key();
+	float fStep = Note::pitchToFrequency( ( double )fNotePitch );
+	int nWidth = m_fGridWidth * pNote->get_length() / fStep;
+	return nWidth - 1;	// lascio un piccolo spazio tra una nota ed un altra
+}
+
+void PatternEditor::drawNoteLayer( QPainter&, Pattern*, bool ) {
+}
+
+size_t PatternEditor::noteLayerState() const {
+	return 0;
+}
+
+size_t PatternEditor::hashNoteLayer( const Pattern* pPattern, bool bIsForeground ) const {
+	size_t nHash = noteLayerState();
+	hashCombine( nHash, bIsForeground );
+	hashCombine( nHash, hasFocus() );
+	hashCombine( nHash, m_nActiveWidth );
+	hashCombine( nHash, m_fGridWidth );
+	hashCombine( nHash, m_nGridHeight );
+
+	const bool bMoving = m_selection.isMoving();
+	const QPoint movingOffset = bMoving ? movingGridOffset() : QPoint();
+
+	const Pattern::notes_t* pNotes = pPattern->get_notes();
+	for ( auto it = pNotes->begin(), end = pNotes->upper_bound( renderedEndTick() );
+		  it != end; ++it ) {
+		Note* pNote = it->second;
+		if ( ! isNoteRendered( pNote ) ) {
+			continue;
+		}
+		hashCombine( nHash, pNote->get_position() );
+		hashCombine( nHash, pNote->get_instrument().get() );
+		hashCombine( nHash, pNote->get_velocity() );
+		hashCombine( nHash, pNote->getPan() );
+		hashCombine( nHash, pNote->get_lead_lag() );
+		hashCombine( nHash, pNote->get_probability() );
+		hashCombine( nHash, pNote->get_length() );
+		hashCombine( nHash, static_cast<int>( pNote->get_key() ) );
+		hashCombine( nHash, static_cast<int>( pNote->get_octave() ) );
+		hashCombine( nHash, pNote->get_note_off() );
+
+		const bool bSelected = m_selection.isSelected( pNote );
+		hashCombine( nHash, bSelected );
+		if ( bSelected && bMoving ) {
+			hashCombine( nHash, movingOffset.x() );
+			hashCombine( nHash, movingOffset.y() );
+		}
+	}
+
+	return nHash;
+}
+
+void PatternEditor::drawNoteLayers( QPainter& p ) {
+	const qreal fPixelRatio = devicePixelRatio();
+	std::map<const Pattern*, NoteLayer> layers;
+
+	for ( Pattern *pPattern : getPatternsToShow() ) {
+		const bool bIsForeground = ( pPattern == m_pPattern );
+		const size_t nHash = hashNoteLayer( pPattern, bIsForeground );
+
+		NoteLayer& layer = layers[ pPattern ];
+		auto it = m_noteLayers.find( pPattern );
+		if ( it != m_noteLayers.end() ) {
+			layer = std::move( it->second );
+		}
+
+		if ( layer.pixmap.isNull() || layer.nHash != nHash ||
+			 layer.rect != m_renderedRect ||
+			 layer.pixmap.devicePixelRatio() != fPixelRatio ) {
+			layer.nHash = nHash;
+			layer.rect = m_renderedRect;
+			layer.pixmap = QPixmap( m_renderedRect.size() * fPixelRatio );
+			layer.pixmap.setDevicePixelRatio( fPixelRatio );
+			layer.pixmap.fill( Qt::transparent );
+
+			QPainter layerPainter( &layer.pixmap );
+			layerPainter.translate( -m_renderedRect.topLeft() );
+			drawNoteLayer( layerPainter, pPattern, bIsForeground );
+		}
+
+		p.drawPixmap( m_renderedRect.topLeft(), layer.pixmap );
+	}
+
+	// Layers of patterns not shown anymore are dropped.
+	m_noteLayers.swap( layers );
+}
+
 //! Get notes to show in pattern editor.
 //! This may include "background" notes that are in currently-playing patterns
 //! rather than the current pattern.
@@ -28,6 +28,8 @@
 #include <core/Object.h>
 #include <core/Preferences/Preferences.h>
 
+#include <map>
+
 #include <QtGui>
 #if QT_VERSION >= 0x050000
 #  include <QtWidgets>
@@ -276,6 +278,71 @@ protected:
 	QPixmap *m_pBackgroundPixmap;
 	bool m_bBackgroundInvalid;
 
+	//! @name Note layers
+	//!
+	//! The notes of each pattern returned by getPatternsToShow() are
+	//! drawn into a transparent pixmap of their own covering
+	//! #m_renderedRect only. A layer is redrawn when the digest of
+	//! the notes it shows - or of the editor state they depend on -
+	//! changed or when the widget was scrolled beyond it. Else the
+	//! cached pixmap is composited as it is.
+	//! @{
+	struct NoteLayer {
+		QPixmap pixmap;
+		size_t nHash = 0;
+		QRect rect;
+	};
+	std::map<const H2Core::Pattern*, NoteLayer> m_noteLayers;
+
+	//! Part of the widget the note layers were rendered for.
+	QRect m_renderedRect;
+
+	//! Space around a note symbol which may be covered by its
+	//! selection outline or, in the DrumPatternEditor, by the count
+	//! of notes sharing its position.
+	static constexpr int nNoteLayerPadding = 140;
+
+	//! Visible part of the widget padded by half a viewport in each
+	//! direction. Stored in #m_renderedRect.
+	void updateRenderedRect();
+
+	//! Whether the area exposed in a paint event was not covered
+	//! by the last rendering of the note layers.
+	bool isOutsideRenderedRect( const QRect& rect ) const {
+		return ! m_renderedRect.contains( rect );
+	}
+
+	//! Last tick whose notes can overlap #m_renderedRect.
+	int renderedEndTick() const;
+
+	//! Whether the symbol of @a pNote, including its tail, can
+	//! overlap #m_renderedRect horizontally.
+	bool isNoteRendered( H2Core::Note* pNote ) const;
+
+	//! Width in pixels of the tail of @a pNote. 0 for notes without
+	//! a custom length.
+	int noteTailWidth( H2Core::Note* pNote ) const;
+
+	//! Composites the layers of all patterns to show, rendering
+	//! only those which changed.
+	void drawNoteLayers( QPainter& p );
+
+	//! Draws the notes of @a pPattern overlapping #m_renderedRect
+	//! using widget coordinates.
+	virtual void drawNoteLayer( QPainter& p, H2Core::Pattern* pPattern,
+								bool bIsForeground );
+
+	//! Digest of editor specific state the layers depend on, like
+	//! the order of the instruments.
+	virtual size_t noteLayerState() const;
+
+	size_t hashNoteLayer( const H2Core::Pattern* pPattern,
+						  bool bIsForeground ) const;
+	void clearNoteLayers() {
+		m_noteLayers.clear();
+	}
+	//! @}
+
 	/** Indicates whether the mouse pointer entered the widget.*/
 	bool m_bEntered;
 	virtual void enterEvent( QEvent *ev ) override;
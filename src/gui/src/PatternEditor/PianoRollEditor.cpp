@@ -26,6 +26,7 @@
 #include "PatternEditorInstrumentList.h"
 #include "UndoActions.h"
 #include <cassert>
+#include <cstdlib>
 
 #include <core/Hydrogen.h>
 #include <core/Basics/Instrument.h>
@@ -163,6 +164,10 @@ void PianoRollEditor::paintEvent(QPaintEvent *ev)
 	if ( m_bNeedsUpdate ) {
 		finishUpdateEditor();
 	}
+	if ( isOutsideRenderedRect( ev->rect() ) ) {
+		// Scrolled beyond the part the notes were drawn for.
+		drawPattern();
+	}
 	painter.drawPixmap( ev->rect(), *m_pTemp,
 						QRectF( pixelRatio * ev->rect().x(),
 								pixelRatio * ev->rect().y(),
@@ -375,27 +380,49 @@ void PianoRollEditor::drawPattern()
 								pixelRatio * rect().width(),
 								pixelRatio * rect().height() ) );
 
-	// for each note...
-	for ( Pattern *pPattern : getPatternsToShow() ) {
-		bool bIsForeground = ( pPattern == m_pPattern );
-		const Pattern::notes_t* notes = pPattern->get_notes();
-		FOREACH_NOTE_CST_IT_BEGIN_END( notes, it ) {
-			Note *note = it->second;
-			assert( note );
-			drawNote( note, &p, bIsForeground );
-		}
-	}
+	updateRenderedRect();
+	drawNoteLayers( p );
+}
 
+
+size_t PianoRollEditor::noteLayerState() const
+{
+	// Only the notes of the selected instrument are shown.
+	return std::hash<Instrument*>()( Hydrogen::get_instance()->getSelectedInstrument().get() );
 }
 
 
-void PianoRollEditor::drawNote( Note *pNote, QPainter *pPainter, bool bIsForeground )
+void PianoRollEditor::drawNoteLayer( QPainter& p, Pattern* pPattern, bool bIsForeground )
 {
-	Hydrogen *pHydrogen = Hydrogen::get_instance();
-	if ( pNote->get_instrument() == pHydrogen->getSelectedInstrument() ) {
+	auto pSelectedInstrument = Hydrogen::get_instance()->getSelectedInstrument();
+	if ( pSelectedInstrument == nullptr ) {
+		return;
+	}
+
+	// Pitch lines outside the rendered part are skipped.
+	int nLinePadding = 1;
+	if ( m_selection.isMoving() ) {
+		nLinePadding += std::abs( movingGridOffset().y() );
+	}
+	const int nFirstLine = m_renderedRect.top() / static_cast<int>(m_nGridHeight) - nLinePadding;
+	const int nLastLine = m_renderedRect.bottom() / static_cast<int>(m_nGridHeight) + nLinePadding;
+
+	const Pattern::notes_t* notes = pPattern->get_notes();
+	for ( auto it = notes->begin(), end = notes->upper_bound( renderedEndTick() );
+		  it != end; ++it ) {
+		Note *pNote = it->second;
+		assert( pNote );
+		if ( pNote->get_instrument() != pSelectedInstrument ||
+			 ! isNoteRendered( pNote ) ) {
+			continue;
+		}
+		const int nLine = pitchToLine( pNote->get_notekey_pitch() );
+		if ( nLine < nFirstLine || nLine > nLastLine ) {
+			continue;
+		}
 		QPoint pos ( PatternEditor::nMargin + pNote->get_position() * m_fGridWidth,
-					 m_nGridHeight * pitchToLine( pNote->get_notekey_pitch() ) + 1);
-		drawNoteSymbol( *pPainter, pos, pNote, bIsForeground );
+					 m_nGridHeight * nLine + 1);
+		drawNoteSymbol( p, pos, pNote, bIsForeground );
 	}
 }
 
@@ -98,7 +98,9 @@ class PianoRollEditor: public PatternEditor, protected WidgetWithScalableFont<7,
 		void createBackground() override;
 		void drawPattern();
 		void drawFocus( QPainter& painter );
-		void drawNote( H2Core::Note *pNote, QPainter *pPainter, bool bIsForeground );
+		virtual void drawNoteLayer( QPainter& p, H2Core::Pattern* pPattern,
+									bool bIsForeground ) override;
+		virtual size_t noteLayerState() const override;
 
 		void addOrRemoveNote( int nColumn, int nRealColumn, int nLine,
 							  int nNotekey, int nOctave,
@@ -27,6 +27,7 @@ https://www.gnu.org/licenses
 #include "PlayerControl.h"
 #include "InstrumentRack.h"
 #include "HydrogenApp.h"
+#include "RefreshScheduler.h"
 
 #include "Widgets/ClickableLabel.h"
 #include "Widgets/LCDDisplay.h"
@@ -496,9 +497,11 @@ PlayerControl::PlayerControl(QWidget *parent)
 
 	hbox->addStretch( 1000 );	// this must be the last widget in the HBOX!!
 
-	QTimer *timer = new QTimer( this );
-	connect(timer, SIGNAL(timeout()), this, SLOT(updatePlayerControl()));
-	timer->start(100);	// update player control at 10 fps
+	// update player control at 10 fps
+	HydrogenApp::get_instance()->getRefreshScheduler()->addClient(
+		this, 100, [=]( const H2Core::AudioEngine::Snapshot& snapshot ) {
+			updatePlayerControl( snapshot );
+		} );
 	
 	connect( HydrogenApp::get_instance(), &HydrogenApp::preferencesChanged,
 			 this, &PlayerControl::onPreferencesChanged );
@@ -515,6 +518,11 @@ PlayerControl::~PlayerControl() {
 
 
 void PlayerControl::updatePlayerControl()
+{
+	updatePlayerControl( m_pHydrogen->getAudioEngine()->getSnapshot() );
+}
+
+void PlayerControl::updatePlayerControl( const H2Core::AudioEngine::Snapshot& snapshot )
 {
 	Preferences *pPref = Preferences::get_instance();
 	HydrogenApp *pH2App = HydrogenApp::get_instance();
@@ -526,7 +534,7 @@ void PlayerControl::updatePlayerControl()
 		m_pShowInstrumentRackBtn->setChecked( pH2App->getInstrumentRack()->isVisible() );
 	}
 
-	auto state = m_pHydrogen->getAudioEngine()->getState();
+	const auto state = snapshot.state;
 	if ( ! m_pPlayBtn->isDown() && ! m_pStopBtn->isDown() &&
 		 ! m_pFfwdBtn->isDown() && ! m_pRwdBtn->isDown() ) {
 		if ( state == H2Core::AudioEngine::State::Playing ) {
@@ -548,7 +556,7 @@ void PlayerControl::updatePlayerControl()
 
 	if ( ! m_pLCDBPMSpinbox->hasFocus() &&
 		 ! m_pLCDBPMSpinbox->getIsHovered() ) {
-		m_pLCDBPMSpinbox->setValue( m_pHydrogen->getAudioEngine()->getTransportPosition()->getBpm() );
+		m_pLCDBPMSpinbox->setValue( snapshot.fBpm );
 	}
 
 	//beatcounter
@@ -574,7 +582,7 @@ void PlayerControl::updatePlayerControl()
 	//~ beatcounter
 
 	// time
-	float fSeconds = m_pHydrogen->getAudioEngine()->getElapsedTime();
+	const float fSeconds = snapshot.fElapsedTime;
 	
 	int nMSec = (int)( (fSeconds - (int)fSeconds) * 1000.0 );
 	int nSeconds = ( (int)fSeconds ) % 60;
@@ -29,6 +29,7 @@
 
 #include "EventListener.h"
 #include <core/Object.h>
+#include <core/AudioEngine/AudioEngine.h>
 #include <core/Preferences/Preferences.h>
 #include "Widgets/WidgetWithScalableFont.h"
 
@@ -171,6 +172,11 @@ private:
 	Button *m_pShowInstrumentRackBtn;
 
 	StatusMessageDisplay *m_pStatusLabel;
+
+	/** Called by the RefreshScheduler. Transport related state is
+		taken from @a snapshot instead of the audio engine.*/
+	void updatePlayerControl( const H2Core::AudioEngine::Snapshot& snapshot );
+
 	/** Used to turn off the LED #m_pMidiActivityLED indicating an
 		incoming MIDI event after #m_midiActivityTimeout
 		milliseconds.*/ 
@@ -889,6 +889,9 @@ void PreferencesDialog::on_okBtn_clicked()
 		case 4:
 			Hydrogen::get_instance()->getAudioEngine()->getSampler()->setInterpolateMode( Interpolation::InterpolateMode::Hermite );
 			break;
+		case 5:
+			Hydrogen::get_instance()->getAudioEngine()->getSampler()->setInterpolateMode( Interpolation::InterpolateMode::Sinc );
+			break;
 		}
 		bAudioOptionAltered = true;
 	}
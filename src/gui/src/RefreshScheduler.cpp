@@ -0,0 +1,137 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#include "RefreshScheduler.h"
+
+#include <core/Hydrogen.h>
+
+#include <algorithm>
+
+RefreshScheduler::RefreshScheduler( QObject* pParent )
+	: QObject( pParent )
+	, m_bDispatching( false )
+{
+	qreal fRefreshRate = nMaxFrameRate;
+	QScreen* pScreen = QGuiApplication::primaryScreen();
+	if ( pScreen != nullptr && pScreen->refreshRate() > 1 ) {
+		fRefreshRate = std::min( pScreen->refreshRate(),
+								 static_cast<qreal>( nMaxFrameRate ) );
+	}
+	m_nFrameInterval = std::max( static_cast<int>( 1000 / fRefreshRate ), 1 );
+
+	m_pTimer = new QTimer( this );
+	m_pTimer->setTimerType( Qt::PreciseTimer );
+	m_pTimer->setInterval( m_nFrameInterval );
+	connect( m_pTimer, &QTimer::timeout, this, &RefreshScheduler::onFrame );
+
+	m_clock.start();
+}
+
+RefreshScheduler::~RefreshScheduler() {
+	m_pTimer->stop();
+}
+
+void RefreshScheduler::addClient( QObject* pOwner, int nInterval, Callback callback ) {
+	if ( pOwner == nullptr || ! callback ) {
+		ERRORLOG( "Invalid client" );
+		return;
+	}
+
+	Client client;
+	client.pOwner = pOwner;
+	client.nInterval = std::max( nInterval, m_nFrameInterval );
+	client.nNextCall = m_clock.elapsed() + client.nInterval;
+	client.callback = std::move( callback );
+	m_clients.push_back( std::move( client ) );
+
+	if ( ! m_pTimer->isActive() ) {
+		m_pTimer->start();
+	}
+}
+
+void RefreshScheduler::removeClient( QObject* pOwner ) {
+	for ( auto& client : m_clients ) {
+		if ( client.pOwner == pOwner ) {
+			client.pOwner = nullptr;
+		}
+	}
+	if ( ! m_bDispatching ) {
+		purgeClients();
+	}
+}
+
+void RefreshScheduler::purgeClients() {
+	m_clients.erase( std::remove_if( m_clients.begin(), m_clients.end(),
+									 []( const Client& client ) {
+										 return client.pOwner.isNull(); } ),
+					 m_clients.end() );
+	if ( m_clients.empty() ) {
+		m_pTimer->stop();
+	}
+}
+
+bool RefreshScheduler::isHidden( QObject* pOwner ) {
+	auto pWidget = qobject_cast<QWidget*>( pOwner );
+	if ( pWidget == nullptr ) {
+		return false;
+	}
+	return ! pWidget->isVisible() || pWidget->window()->isMinimized();
+}
+
+void RefreshScheduler::onFrame() {
+	const qint64 nNow = m_clock.elapsed();
+
+	// Retrieved at most once per frame and only if some client is
+	// due.
+	bool bHasSnapshot = false;
+	H2Core::AudioEngine::Snapshot snapshot;
+
+	m_bDispatching = true;
+	// Callbacks may register further clients. Iterate by index.
+	for ( size_t ii = 0; ii < m_clients.size(); ++ii ) {
+		if ( m_clients[ ii ].pOwner.isNull() ||
+			 nNow < m_clients[ ii ].nNextCall ||
+			 isHidden( m_clients[ ii ].pOwner ) ) {
+			continue;
+		}
+
+		// Tolerate half a frame of jitter. Else an interval being a
+		// multiple of the frame interval would be served one frame
+		// too late every other time. After a stall, the client is
+		// called once and not once per missed interval.
+		m_clients[ ii ].nNextCall = nNow + m_clients[ ii ].nInterval -
+			m_nFrameInterval / 2;
+
+		if ( ! bHasSnapshot ) {
+			snapshot = H2Core::Hydrogen::get_instance()->getAudioEngine()->getSnapshot();
+			bHasSnapshot = true;
+		}
+
+		// The callback might add clients and thus invalidate
+		// references into #m_clients.
+		auto callback = m_clients[ ii ].callback;
+		callback( snapshot );
+	}
+	m_bDispatching = false;
+
+	purgeClients();
+}
@@ -0,0 +1,111 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#ifndef REFRESH_SCHEDULER_H
+#define REFRESH_SCHEDULER_H
+
+#include <core/Object.h>
+#include <core/AudioEngine/AudioEngine.h>
+
+#include <functional>
+#include <vector>
+
+#include <QtGui>
+#include <QtWidgets>
+
+/**
+ * Drives all periodic updates of the GUI.
+ *
+ * Instead of a timer per widget each polling the audio engine on its
+ * own, there is a single timer ticking once per display frame. On
+ * each frame the H2Core::AudioEngine::Snapshot is read once - without
+ * locking the engine - and handed to all clients which are due.
+ * Clients owned by a widget which is hidden or part of a minimized
+ * window are skipped altogether and get called as soon as they are
+ * shown again. Since all due clients are served within the same
+ * event loop iteration, the repaints they request via
+ * QWidget::update() are coalesced by Qt into a single paint pass per
+ * window.
+ *
+ * Qt widgets do not expose the vertical sync of the display.
+ * Instead, the refresh rate of the primary screen - capped at
+ * #nMaxFrameRate - is used as frame rate of a precise timer.
+ */
+/** \ingroup docGUI*/
+class RefreshScheduler : public QObject, public H2Core::Object<RefreshScheduler>
+{
+	H2_OBJECT(RefreshScheduler)
+	Q_OBJECT
+
+public:
+	typedef std::function<void( const H2Core::AudioEngine::Snapshot& )> Callback;
+
+	static constexpr int nMaxFrameRate = 60;
+
+	explicit RefreshScheduler( QObject* pParent );
+	~RefreshScheduler();
+
+	/**
+	 * Calls @a callback about every @a nInterval milliseconds for as
+	 * long as @a pOwner exists.
+	 *
+	 * The interval is rounded to full frames. In case @a pOwner is a
+	 * QWidget, @a callback is not called while the widget is not
+	 * visible.
+	 */
+	void addClient( QObject* pOwner, int nInterval, Callback callback );
+	/** Removes all callbacks registered for @a pOwner. */
+	void removeClient( QObject* pOwner );
+
+	/** \return Duration of a frame in milliseconds. */
+	int getFrameInterval() const {
+		return m_nFrameInterval;
+	}
+
+private slots:
+	void onFrame();
+
+private:
+	struct Client {
+		QPointer<QObject> pOwner;
+		int nInterval;
+		/** Time of the next call in milliseconds since the start of
+		 * #m_clock. */
+		qint64 nNextCall;
+		Callback callback;
+	};
+
+	static bool isHidden( QObject* pOwner );
+
+	/** Drops clients whose owners were removed or destroyed. */
+	void purgeClients();
+
+	QTimer* m_pTimer;
+	QElapsedTimer m_clock;
+	int m_nFrameInterval;
+	std::vector<Client> m_clients;
+	/** Set while the clients are called. Removals are deferred till
+	 * the end of the frame. */
+	bool m_bDispatching;
+};
+
+#endif // REFRESH_SCHEDULER_H
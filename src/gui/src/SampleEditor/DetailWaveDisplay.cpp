@@ -31,8 +31,7 @@ using namespace H2Core;
 DetailWaveDisplay::DetailWaveDisplay(QWidget* pParent )
  : QWidget( pParent )
  , m_sSampleName( "" )
- , m_pPeakDatal( nullptr )
- , m_pPeakDatar( nullptr )  
+ , m_pSample( nullptr )
 {
 //	setAttribute(Qt::WA_OpaquePaintEvent);
 
@@ -58,8 +57,6 @@ DetailWaveDisplay::DetailWaveDisplay(QWidget* pParent )
 DetailWaveDisplay::~DetailWaveDisplay()
 {
 	//INFOLOG( "DESTROY" );
-	delete[] m_pPeakDatal;
-	delete[] m_pPeakDatar;
 }
 
 
@@ -84,10 +81,21 @@ void DetailWaveDisplay::paintEvent(QPaintEvent *ev)
 //	int imagedetailframes = m_pnormalimagedetailframes / m_pzoomFactor;
 	int startpos = m_pDetailSamplePosition  - m_pNormalImageDetailFrames / 2 ;
 
+	// One frame per pixel. The zoom factor only scales the amplitude.
+	const float* pSampleDatal = nullptr;
+	const float* pSampleDatar = nullptr;
+	int nSampleLength = 0;
+	if ( m_pSample != nullptr ) {
+		pSampleDatal = m_pSample->get_data_l();
+		pSampleDatar = m_pSample->get_data_r();
+		nSampleLength = m_pSample->get_frames();
+	}
+	const float fGain = height() / 4.0 * m_pZoomFactor;
+
 	for ( int x = 0; x < width() ; x++ ) {
-		if ( (startpos) > 0 ){
-			painter.drawLine( x, (-m_pPeakDatal[startpos -1] *m_pZoomFactor) +VCenterl, x, (-m_pPeakDatal[startpos ] *m_pZoomFactor)+VCenterl );
-			painter.drawLine( x, (-m_pPeakDatar[startpos -1] *m_pZoomFactor) +VCenterr, x, (-m_pPeakDatar[startpos ] *m_pZoomFactor)+VCenterr );
+		if ( (startpos) > 0 && startpos < nSampleLength ){
+			painter.drawLine( x, -pSampleDatal[startpos -1] *fGain +VCenterl, x, -pSampleDatal[startpos ] *fGain +VCenterl );
+			painter.drawLine( x, -pSampleDatar[startpos -1] *fGain +VCenterr, x, -pSampleDatar[startpos ] *fGain +VCenterr );
 			//ERRORLOG( QString("startpos: %1").arg(startpos) )
 		}
 		else
@@ -120,36 +128,8 @@ void DetailWaveDisplay::paintEvent(QPaintEvent *ev)
 
 
 
-void DetailWaveDisplay::updateDisplay( QString filename )
+void DetailWaveDisplay::updateDisplay( std::shared_ptr<H2Core::Sample> pSample )
 {
-
-	auto pNewSample = Sample::load( filename );
-
-	if ( pNewSample != nullptr ) {
-
-		int mSampleLength = pNewSample->get_frames();
-
-		m_pPeakDatal = new int[ mSampleLength + m_pNormalImageDetailFrames /2 ];
-		m_pPeakDatar = new int[ mSampleLength + m_pNormalImageDetailFrames /2 ];
-
-		for ( int i = 0 ; i < mSampleLength + m_pNormalImageDetailFrames /2 ; i++){
-			m_pPeakDatal[ i ] = 0;
-			m_pPeakDatar[ i ] = 0;
-		}
-
-		float fGain = height() / 4.0 * 1.0;
-
-		auto pSampleDatal = pNewSample->get_data_l();
-		auto pSampleDatar = pNewSample->get_data_r();
-
-		for ( int i = 0; i < mSampleLength; i++ ){
-			m_pPeakDatal[ i ] = static_cast<int>( pSampleDatal[ i ] * fGain );
-			m_pPeakDatar[ i ] = static_cast<int>( pSampleDatar[ i ] * fGain );
-		}
-
-
-	}
+	m_pSample = pSample;
+	update();
 }
-
-
-
@@ -26,6 +26,8 @@
 #include <QtGui>
 #include <QtWidgets>
 
+#include <memory>
+
 #include <core/Object.h>
 
 namespace H2Core
@@ -43,7 +45,7 @@ class DetailWaveDisplay :  public QWidget,  public H2Core::Object<DetailWaveDisp
 		explicit DetailWaveDisplay(QWidget* pParent);
 		~DetailWaveDisplay();
 
-		void updateDisplay( QString filename );
+		void updateDisplay( std::shared_ptr<H2Core::Sample> pSample );
 
 		virtual void paintEvent(QPaintEvent *ev) override;
 		void setDetailSamplePosition( unsigned posi, float zoomfactor, QString type);
@@ -51,8 +53,7 @@ class DetailWaveDisplay :  public QWidget,  public H2Core::Object<DetailWaveDisp
 	private:
 		QPixmap m_background;
 		QString m_sSampleName;
-		int *m_pPeakDatal;
-		int *m_pPeakDatar;
+		std::shared_ptr<H2Core::Sample> m_pSample;
 		int m_pDetailSamplePosition;
 		int m_pNormalImageDetailFrames;
 		float m_pZoomFactor;
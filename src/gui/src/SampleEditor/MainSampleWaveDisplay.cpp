@@ -23,6 +23,7 @@
 #include <core/Basics/Sample.h>
 #include <core/Basics/Song.h>
 #include <core/Basics/Instrument.h>
+#include <core/Basics/Sample.h>
 #include "HydrogenApp.h"
 #include "SampleEditor.h"
 using namespace H2Core;
@@ -168,48 +169,34 @@ void MainSampleWaveDisplay::updateDisplayPointer()
 
 
 
-void MainSampleWaveDisplay::updateDisplay( const QString& filename )
+/** \return the extremum of @a range which is farther away from zero
+ * scaled by @a fGain. This way the trace keeps its sign. */
+static int signedPeak( const WaveformPeaks::Range& range, float fGain )
 {
+	const float fPeak = std::fabs( range.fMax ) >= std::fabs( range.fMin ) ?
+		range.fMax : range.fMin;
+	return static_cast<int>( fPeak * fGain );
+}
 
-	auto pNewSample = Sample::load( filename );
-	
-	if ( pNewSample ) {
+void MainSampleWaveDisplay::updateDisplay( std::shared_ptr<H2Core::Sample> pSample )
+{
+	if ( pSample ) {
 
-		int nSampleLength = pNewSample->get_frames();
+		int nSampleLength = pSample->get_frames();
 		m_nSampleLength = nSampleLength;
-		float nScaleFactor = nSampleLength / (width() -50);
+		int nScaleFactor = nSampleLength / (width() -50);
 		if ( nScaleFactor < 1 ){
 			nScaleFactor = 1;
 		}
 
 		float fGain = height() / 4.0 * 1.0;
 
-		auto pSampleDatal = pNewSample->get_data_l();
-		auto pSampleDatar = pNewSample->get_data_r();
-
-		unsigned nSamplePos = 0;
-		int nVall = 0;
-		int nValr = 0;
-		int newVall = 0;
-		int newValr = 0;
 		for ( int i = 0; i < width(); ++i ){
-			for ( int j = 0; j < nScaleFactor; ++j ) {
-				if ( j < nSampleLength && nSamplePos < nSampleLength) {
-					if ( pSampleDatal[ nSamplePos ] && pSampleDatar[ nSamplePos ] ){
-						newVall = static_cast<int>( pSampleDatal[ nSamplePos ] * fGain );
-						newValr = static_cast<int>( pSampleDatar[ nSamplePos ] * fGain );
-						nVall = newVall;
-						nValr = newValr;
-					}else
-					{
-						nVall = 0;	
-						nValr = 0;
-					}
-				}
-				++nSamplePos;
-			}
-			m_pPeakDatal[ i ] = nVall;
-			m_pPeakDatar[ i ] = nValr;
+			const int nStart = i * nScaleFactor;
+			m_pPeakDatal[ i ] = signedPeak(
+				pSample->getWaveformRange( 0, nStart, nStart + nScaleFactor ), fGain );
+			m_pPeakDatar[ i ] = signedPeak(
+				pSample->getWaveformRange( 1, nStart, nStart + nScaleFactor ), fGain );
 		}
 	}
 	update();
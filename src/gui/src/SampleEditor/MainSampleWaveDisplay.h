@@ -26,6 +26,8 @@
 #include <QtGui>
 #include <QtWidgets>
 
+#include <memory>
+
 #include <core/Object.h>
 #include "SampleEditor.h"
 class SampleEditor;
@@ -48,7 +50,7 @@ class MainSampleWaveDisplay :  public QWidget,  public H2Core::Object<MainSample
 		explicit MainSampleWaveDisplay(QWidget* pParent);
 		~MainSampleWaveDisplay();
 
-		void updateDisplay( const QString& filename );
+		void updateDisplay( std::shared_ptr<H2Core::Sample> pSample );
 		void updateDisplayPointer();
 
 		void paintLocatorEvent( int pos, bool last_event);
@@ -341,10 +341,10 @@ void SampleEditor::openDisplays()
 {
 	// wavedisplays
 	m_divider = m_pSampleFromFile->get_frames() / 574.0F;
-	m_pMainSampleWaveDisplay->updateDisplay( m_sSampleName );
+	m_pMainSampleWaveDisplay->updateDisplay( m_pSampleFromFile );
 	m_pMainSampleWaveDisplay->move( 1, 1 );
 
-	m_pSampleAdjustView->updateDisplay( m_sSampleName );
+	m_pSampleAdjustView->updateDisplay( m_pSampleFromFile );
 	m_pSampleAdjustView->move( 1, 1 );
 
 	m_pTargetSampleView->move( 1, 1 );
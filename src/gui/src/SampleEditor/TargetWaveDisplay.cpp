@@ -210,42 +210,20 @@ void TargetWaveDisplay::updateDisplay( std::shared_ptr<H2Core::InstrumentLayer>
 {
 	if ( pLayer && pLayer->get_sample() ) {
 
-		int nSampleLength = pLayer->get_sample()->get_frames();
-		float nScaleFactor = nSampleLength / width();
+		auto pSample = pLayer->get_sample();
+		int nSampleLength = pSample->get_frames();
+		int nScaleFactor = nSampleLength / width();
 
 		float fGain = (height() - 8) / 2.0 * pLayer->get_gain();
 
-		auto pSampleDatal = pLayer->get_sample()->get_data_l();
-		auto pSampleDatar = pLayer->get_sample()->get_data_r();
-		int nSamplePos = 0;
-		int nVall;
-		int nValr;
 		for ( int i = 0; i < width(); ++i ){
-			nVall = 0;
-			nValr = 0;
-			for ( int j = 0; j < nScaleFactor; ++j ) {
-				if ( j < nSampleLength ) {
-					if ( pSampleDatal[ nSamplePos ] < 0 ){
-						int newVal = static_cast<int>( pSampleDatal[ nSamplePos ] * -fGain );
-						nVall = newVal;
-					}else
-					{
-						int newVal = static_cast<int>( pSampleDatal[ nSamplePos ] * fGain );
-						nVall = newVal;
-					}
-					if ( pSampleDatar[ nSamplePos ] > 0 ){
-						int newVal = static_cast<int>( pSampleDatar[ nSamplePos ] * -fGain );
-						nValr = newVal;
-					}else
-					{
-						int newVal = static_cast<int>( pSampleDatar[ nSamplePos ] * fGain );
-						nValr = newVal;
-					}
-				}
-				++nSamplePos;
-			}
-			m_pPeakData_Left[ i ] = nVall;
-			m_pPeakData_Right[ i ] = nValr;
+			const int nStart = i * nScaleFactor;
+			const auto rangeL = pSample->getWaveformRange( 0, nStart, nStart + nScaleFactor );
+			const auto rangeR = pSample->getWaveformRange( 1, nStart, nStart + nScaleFactor );
+			m_pPeakData_Left[ i ] = static_cast<int>(
+				std::max( rangeL.fMax, -rangeL.fMin ) * fGain );
+			m_pPeakData_Right[ i ] = static_cast<int>(
+				std::max( rangeR.fMax, -rangeR.fMin ) * -fGain );
 		}
 	}
 
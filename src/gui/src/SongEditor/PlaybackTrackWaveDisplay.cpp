@@ -133,9 +133,9 @@ void PlaybackTrackWaveDisplay::updateDisplay( std::shared_ptr<H2Core::Instrument
 		m_pLayer = pLayer;
 		m_sSampleName = m_pLayer->get_sample()->get_filename();
 		
-		auto	pSampleData = pLayer->get_sample()->get_data_l();
-		int		nSampleLength = m_pLayer->get_sample()->get_frames();
-		float	fLengthOfPlaybackTrackInSecs = ( float )( nSampleLength / (float) m_pLayer->get_sample()->get_sample_rate() );
+		auto	pSample = pLayer->get_sample();
+		int		nSampleLength = pSample->get_frames();
+		float	fLengthOfPlaybackTrackInSecs = ( float )( nSampleLength / (float) pSample->get_sample_rate() );
 		float	fRemainingLengthOfPlaybackTrack = fLengthOfPlaybackTrackInSecs;		
 		float	fGain = height() / 2.0 * pLayer->get_gain();
 		int		nSamplePos = 0;
@@ -183,25 +183,14 @@ void PlaybackTrackWaveDisplay::updateDisplay( std::shared_ptr<H2Core::Instrument
 				float nScaleFactor = fLengthOfCurrentPatternInSecs / fLengthOfPlaybackTrackInSecs;
 				int nSamplesToRender = nScaleFactor * nSampleLength;
 				
-				int nVal = 0;
-				
 				for ( int i = nRenderStartPosition; i < nRenderStartPosition + nSongEditorGridWith ; ++i ) {
 					if( i < m_nCurrentWidth ) {
-						nVal = 0;
-						
 						int nSamplesToRenderInThisStep =  (nSamplesToRender / nSongEditorGridWith);
-						for ( int j = 0; j < nSamplesToRenderInThisStep; ++j ) {
-							if ( nSamplePos < nSampleLength ) {
-								int newVal = (int)( pSampleData[ nSamplePos ] * fGain );
-								if ( newVal > nVal ) {
-									nVal = newVal;
-								}
-							}
-							
-							++nSamplePos;
-						}
-					
-						m_pPeakData[ i ] = nVal;
+						const auto range = pSample->getWaveformRange(
+							0, nSamplePos, nSamplePos + nSamplesToRenderInThisStep );
+						nSamplePos += nSamplesToRenderInThisStep;
+
+						m_pPeakData[ i ] = std::max( 0, (int)( range.fMax * fGain ) );
 					}
 				}
 				
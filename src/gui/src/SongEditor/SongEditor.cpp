@@ -49,6 +49,7 @@ using namespace H2Core;
 #include "SoundLibrary/SoundLibraryPanel.h"
 #include "../PatternEditor/PatternEditorPanel.h"
 #include "../HydrogenApp.h"
+#include "../RefreshScheduler.h"
 #include "../CommonStrings.h"
 #include "../InstrumentRack.h"
 #include "../PatternPropertiesDialog.h"
@@ -79,8 +80,6 @@ SongEditor::SongEditor( QWidget *parent, QScrollArea *pScrollView, SongEditorPan
  , m_pHydrogen( nullptr )
  , m_pAudioEngine( nullptr )
  , m_bEntered( false )
- , m_pBackgroundPixmap( nullptr )
- , m_pSequencePixmap( nullptr )
 {
 	m_pHydrogen = Hydrogen::get_instance();
 	m_pAudioEngine = m_pHydrogen->getAudioEngine();
@@ -107,7 +106,7 @@ SongEditor::SongEditor( QWidget *parent, QScrollArea *pScrollView, SongEditorPan
 
 	this->resize( QSize( nInitialWidth, nInitialHeight ) );
 
-	createBackground();	// create m_backgroundPixmap pixmap
+	createBackground();
 
 	// Popup context menu
 	m_pPopupMenu = new QMenu( this );
@@ -126,12 +125,6 @@ SongEditor::SongEditor( QWidget *parent, QScrollArea *pScrollView, SongEditorPan
 
 SongEditor::~SongEditor()
 {
-	if ( m_pBackgroundPixmap ) {
-		delete m_pBackgroundPixmap;
-	}
-	if ( m_pSequencePixmap ) {
-		delete m_pSequencePixmap;
-	}
 }
 
 
@@ -1005,7 +998,35 @@ void SongEditor::paintEvent( QPaintEvent *ev )
 	auto pPref = Preferences::get_instance();
 
 	QPainter painter(this);
-	painter.drawPixmap( ev->rect(), *m_pSequencePixmap, ev->rect() );
+
+	// Only tiles not rendered yet or touched by a change since the
+	// last paint event are drawn.
+	const QRect rect = ev->rect();
+	if ( static_cast<int>(m_tiles.size()) >= nMaxTiles ) {
+		// Keep the memory bounded on large songs by dropping the
+		// tiles which are out of view.
+		for ( auto it = m_tiles.begin(); it != m_tiles.end(); ) {
+			if ( ! rect.intersects( QRect( it->first * nTileSize,
+										   QSize( nTileSize, nTileSize ) ) ) ) {
+				it = m_tiles.erase( it );
+			} else {
+				++it;
+			}
+		}
+	}
+	for ( int nTileX = rect.left() / nTileSize; nTileX <= rect.right() / nTileSize; ++nTileX ) {
+		for ( int nTileY = rect.top() / nTileSize; nTileY <= rect.bottom() / nTileSize; ++nTileY ) {
+			const QPoint tile( nTileX, nTileY );
+			auto it = m_tiles.find( tile );
+			if ( it == m_tiles.end() ) {
+				it = m_tiles.emplace( tile, QPixmap( nTileSize, nTileSize ) ).first;
+				drawTile( &it->second, tile );
+			}
+			const QRect tileRect( tile * nTileSize, QSize( nTileSize, nTileSize ) );
+			const QRect target = tileRect.intersected( rect );
+			painter.drawPixmap( target, it->second, target.translated( -tileRect.topLeft() ) );
+		}
+	}
 
 	// Draw moving selected cells
 	QColor patternColor( 0, 0, 0 );
@@ -1098,38 +1119,37 @@ void SongEditor::leaveEvent( QEvent *ev ) {
 void SongEditor::createBackground()
 {
 	m_bBackgroundInvalid = false;
+	std::shared_ptr<Song> pSong = m_pHydrogen->getSong();
+
+	int nNewHeight = m_nGridHeight * pSong->getPatternList()->size();
+	if ( nNewHeight == 0 ) {
+		nNewHeight = 1;	// the widget should not be empty
+	}
+	if ( nNewHeight != height() ) {
+		this->resize( QSize( width(), nNewHeight ) );
+	}
+
+	// Grid size, row highlighting, or colors changed. All tiles have
+	// to be rendered again.
+	m_tiles.clear();
+	m_bSequenceChanged = true;
+}
+
+void SongEditor::drawBackground( QPainter& p, const QRect& rect )
+{
 	auto pPref = H2Core::Preferences::get_instance();
 	std::shared_ptr<Song> pSong = m_pHydrogen->getSong();
 
-	uint nPatterns = pSong->getPatternList()->size();
+	int nPatterns = pSong->getPatternList()->size();
 	int nSelectedPatternNumber = m_pHydrogen->getSelectedPatternNumber();
 	int nMaxPatternSequence = pPref->getMaxBars();
 
-	static int nOldHeight = -1;
-	int nNewHeight = m_nGridHeight * nPatterns;
-
-	if (nOldHeight != nNewHeight) {
-		// cambiamento di dimensioni...
-		if (nNewHeight == 0) {
-			nNewHeight = 1;	// the pixmap should not be empty
-		}
-		if ( m_pBackgroundPixmap ) {
-			delete m_pBackgroundPixmap;
-		}
-		if ( m_pSequencePixmap ) {
-			delete m_pSequencePixmap;
-		}
-		m_pBackgroundPixmap = new QPixmap( width(), nNewHeight );	// initialize the pixmap
-		m_pSequencePixmap = new QPixmap( width(), nNewHeight );	// initialize the pixmap
-		this->resize( QSize( width(), nNewHeight ) );
-	}
-
-	
-	m_pBackgroundPixmap->fill( pPref->getColorTheme()->m_songEditor_backgroundColor );
+	p.fillRect( rect, pPref->getColorTheme()->m_songEditor_backgroundColor );
 
-	QPainter p( m_pBackgroundPixmap );
+	const int nFirstRow = std::max( rect.top() / static_cast<int>(m_nGridHeight), 0 );
+	const int nLastRow = std::min( rect.bottom() / static_cast<int>(m_nGridHeight), nPatterns );
 	
-	for ( int ii = 0; ii < nPatterns + 1; ii++) {
+	for ( int ii = nFirstRow; ii <= nLastRow; ii++) {
 		if ( ( ii % 2 ) == 0 &&
 			 ii != nSelectedPatternNumber ) {
 			continue;
@@ -1150,21 +1170,64 @@ void SongEditor::createBackground()
 					Qt::SolidLine ) );
 
 	// vertical lines
-	for ( float ii = 0; ii <= nMaxPatternSequence + 1; ii++) {
+	const int nFirstColumn = std::max(
+		( rect.left() - SongEditor::nMargin ) / static_cast<int>(m_nGridWidth) - 1, 0 );
+	const int nLastColumn = std::min(
+		( rect.right() - SongEditor::nMargin ) / static_cast<int>(m_nGridWidth) + 1,
+		nMaxPatternSequence + 1 );
+	for ( float ii = nFirstColumn; ii <= nLastColumn; ii++) {
 		float x = SongEditor::nMargin + ii * m_nGridWidth;
 		p.drawLine( x, 0, x, m_nGridHeight * nPatterns );
 	}
 	
 	// horizontal lines
-	for (uint i = 0; i < nPatterns; i++) {
+	for ( int i = nFirstRow; i <= nLastRow && i < nPatterns; i++ ) {
 		uint y = m_nGridHeight * i;
 
 		p.drawLine( 0, y, (nMaxPatternSequence * m_nGridWidth), y );
 	}
+}
 
-	//~ celle
-	m_bSequenceChanged = true;
+void SongEditor::drawTile( QPixmap* pPixmap, const QPoint& tile )
+{
+	const QRect rect( tile * nTileSize, QSize( nTileSize, nTileSize ) );
 
+	QPainter p( pPixmap );
+	p.translate( -rect.topLeft() );
+	drawBackground( p, rect );
+
+	// The border of a pattern reaches one pixel into the neighbouring
+	// cells. So, the cells surrounding the tile have to be drawn too.
+	const QPoint first = xyToColumnRow( rect.topLeft() ) - QPoint( 1, 1 );
+	const QPoint last = xyToColumnRow( rect.bottomRight() ) + QPoint( 1, 1 );
+
+	// We draw all selected patterns in a second run to ensure their
+	// border does have the proper color (else the bottom and left one
+	// could be overwritten by an adjecent, unselected pattern).
+	for ( bool bSelected : { false, true } ) {
+		for ( int nColumn = first.x(); nColumn <= last.x(); ++nColumn ) {
+			for ( auto it = m_drawnCells.lower_bound( QPoint( nColumn, first.y() ) );
+				  it != m_drawnCells.end() && it->first.x() == nColumn &&
+					  it->first.y() <= last.y(); ++it ) {
+				if ( it->second.m_bSelected == bSelected ) {
+					drawPattern( p, it->first.x(), it->first.y(),
+								 it->second.m_cell.m_bDrawnVirtual,
+								 it->second.m_cell.m_fWidth, bSelected );
+				}
+			}
+		}
+	}
+}
+
+void SongEditor::invalidateTiles( const QRect& rect )
+{
+	for ( int nTileX = std::max( rect.left(), 0 ) / nTileSize;
+		  nTileX <= rect.right() / nTileSize; ++nTileX ) {
+		for ( int nTileY = std::max( rect.top(), 0 ) / nTileSize;
+			  nTileY <= rect.bottom() / nTileSize; ++nTileY ) {
+			m_tiles.erase( QPoint( nTileX, nTileY ) );
+		}
+	}
 }
 
 void SongEditor::invalidateBackground() {
@@ -1219,37 +1282,39 @@ QPoint SongEditor::movingGridOffset( ) const {
 
 void SongEditor::drawSequence()
 {
-	QPainter p;
-
-	p.begin( m_pSequencePixmap );
-	p.drawPixmap( rect(), *m_pBackgroundPixmap, rect() );
-	p.end();
-
 	updateGridCells();
 
-	// Draw using GridCells representation
-	for ( auto it : m_gridCells ) {
-		if ( ! m_selection.isSelected( QPoint( it.first.x(), it.first.y() ) ) ) {
-			drawPattern( it.first.x(), it.first.y(),
-						 it.second.m_bDrawnVirtual, it.second.m_fWidth );
+	std::map< QPoint, DrawnCell > drawnCells;
+	for ( const auto& it : m_gridCells ) {
+		drawnCells[ it.first ] = { it.second, m_selection.isSelected( it.first ) };
+	}
+
+	// Only the tiles covering cells which were added, removed, or
+	// altered have to be rendered again.
+	auto invalidateCell = [&]( const QPoint& cell ) {
+		invalidateTiles( QRect( columnRowToXy( cell ),
+								QSize( m_nGridWidth, m_nGridHeight ) )
+						 .adjusted( -1, -1, 1, 1 ) );
+	};
+	for ( const auto& it : m_drawnCells ) {
+		auto newIt = drawnCells.find( it.first );
+		if ( newIt == drawnCells.end() || ! ( newIt->second == it.second ) ) {
+			invalidateCell( it.first );
 		}
 	}
-	// We draw all selected patterns in a second run to ensure their
-	// border does have the proper color (else the bottom and left one
-	// could be overwritten by an adjecent, unselected pattern).
-	for ( auto it : m_gridCells ) {
-		if ( m_selection.isSelected( QPoint( it.first.x(), it.first.y() ) ) ) {
-			drawPattern( it.first.x(), it.first.y(),
-						 it.second.m_bDrawnVirtual, it.second.m_fWidth );
+	for ( const auto& it : drawnCells ) {
+		if ( m_drawnCells.find( it.first ) == m_drawnCells.end() ) {
+			invalidateCell( it.first );
 		}
 	}
+
+	m_drawnCells.swap( drawnCells );
 }
 
 
 
-void SongEditor::drawPattern( int nPos, int nNumber, bool bInvertColour, double fWidth )
+void SongEditor::drawPattern( QPainter& p, int nPos, int nNumber, bool bInvertColour, double fWidth, bool bIsSelected )
 {
-	QPainter p( m_pSequencePixmap );
 	/*
 	 * The default color of the cubes in rgb is 97,167,251.
 	 */
@@ -1288,8 +1353,6 @@ void SongEditor::drawPattern( int nPos, int nNumber, bool bInvertColour, double
 		patternColor = patternColor.darker(200);
 	}
 
-	bool bIsSelected = m_selection.isSelected( QPoint( nPos, nNumber ) );
-
 	if ( bIsSelected ) {
 		patternColor = patternColor.darker( 130 );
 	}
@@ -2447,20 +2510,17 @@ SongEditorPositionRuler::SongEditorPositionRuler( QWidget *parent )
 	createBackground();	// create m_backgroundPixmap pixmap
 	update();
 
-	m_pTimer = new QTimer(this);
-	connect(m_pTimer, &QTimer::timeout, [=]() {
-		if ( H2Core::Hydrogen::get_instance()->getAudioEngine()->getState() ==
-			 H2Core::AudioEngine::State::Playing ) {
-			updatePosition();
-		}
-	});
-	m_pTimer->start(200);
+	HydrogenApp::get_instance()->getRefreshScheduler()->addClient(
+		this, 200, [=]( const H2Core::AudioEngine::Snapshot& snapshot ) {
+			if ( snapshot.state == H2Core::AudioEngine::State::Playing ) {
+				updatePosition();
+			}
+		} );
 }
 
 
 
 SongEditorPositionRuler::~SongEditorPositionRuler() {
-	m_pTimer->stop();
 	if ( m_pBackgroundPixmap ) {
 		delete m_pBackgroundPixmap;
 	}
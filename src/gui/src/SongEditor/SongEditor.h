@@ -78,6 +78,19 @@ class SongEditor : public QWidget
 			bool m_bDrawnVirtual;
 			float m_fWidth;
 		};
+
+		//! State of a grid cell as it is drawn onto the tiles.
+		struct DrawnCell {
+			GridCell m_cell;
+			bool m_bSelected;
+
+			bool operator==( const DrawnCell& other ) const {
+				return m_cell.m_bActive == other.m_cell.m_bActive &&
+					m_cell.m_bDrawnVirtual == other.m_cell.m_bDrawnVirtual &&
+					m_cell.m_fWidth == other.m_cell.m_fWidth &&
+					m_bSelected == other.m_bSelected;
+			}
+		};
 	
 	public:
 		SongEditor( QWidget *parent, QScrollArea *pScrollView, SongEditorPanel *pSongEditorPanel );
@@ -146,16 +159,28 @@ class SongEditor : public QWidget
 		bool m_bBackgroundInvalid;
 
 
-		//! @name Background pixmap caching
+		//! @name Tiled sequence caching
 		//!
-		//! To make painting the song editor sequence grid more efficient, the drawing uses multiple levels of lazy painting.
-		//!   * The grid background pixmap is only updated when the size of the pattern grid changes.
-		//!   * The sequence pixmap are only updated when cells are added/removed or selections change
-		//!       * the cached grid background pixmap is used when repainting the pattern
-		//!   * selections and moving cells are painted on top of the cached sequence pixmap
+		//! To make painting the song editor sequence grid more efficient, the grid is split into square tiles
+		//! of #nTileSize pixels, each cached in its own pixmap.
+		//!   * A tile is only rendered when it is painted for the first time, so only the visible part of a
+		//!     large song is drawn.
+		//!   * When cells are added/removed or selections change, the new cells are compared to
+		//!     #m_drawnCells and only the tiles covering a changed cell are dropped.
+		//!   * A change of the grid size, row highlighting, or colors drops all tiles.
+		//!   * selections and moving cells are painted on top of the cached tiles
 		//! @{
-		QPixmap *				m_pBackgroundPixmap;
-		QPixmap *				m_pSequencePixmap;
+		static constexpr int nTileSize = 256;
+		//! Once this many tiles are cached, those out of view are dropped.
+		static constexpr int nMaxTiles = 128;
+		std::map< QPoint, QPixmap > m_tiles;
+		std::map< QPoint, DrawnCell > m_drawnCells;
+		//! Drops all tiles intersecting @a rect (in widget coordinates).
+		void invalidateTiles( const QRect& rect );
+		//! Renders the tile with index @a tile into @a pPixmap.
+		void drawTile( QPixmap* pPixmap, const QPoint& tile );
+		//! Draws the grid background of all rows and columns intersecting @a rect.
+		void drawBackground( QPainter& p, const QRect& rect );
 		//! @}
 
 		//! @name Position of the keyboard input cursor
@@ -207,7 +232,7 @@ class SongEditor : public QWidget
 
 		void drawSequence();
   
-		void drawPattern( int pos, int number, bool invertColour, double width );
+		void drawPattern( QPainter& p, int pos, int number, bool invertColour, double width, bool bIsSelected );
 		void drawFocus( QPainter& painter );
 
 		std::map< QPoint, GridCell > m_gridCells;
@@ -389,7 +414,6 @@ class SongEditorPositionRuler :  public QWidget, protected WidgetWithScalableFon
 	private:
 		H2Core::Hydrogen* 		m_pHydrogen;
 		H2Core::AudioEngine* 	m_pAudioEngine;
-		QTimer *			m_pTimer;
 		uint				m_nGridWidth;
 		static constexpr uint	m_nHeight = 50;
 
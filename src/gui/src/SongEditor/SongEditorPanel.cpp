@@ -24,6 +24,7 @@
 
 #include "../AudioFileBrowser/AudioFileBrowser.h"
 #include "../HydrogenApp.h"
+#include "../RefreshScheduler.h"
 #include "../PatternPropertiesDialog.h"
 #include "../SongPropertiesDialog.h"
 #include "../Skin.h"
@@ -411,32 +412,28 @@ SongEditorPanel::SongEditorPanel(QWidget *pParent)
 
 	HydrogenApp::get_instance()->addEventListener( this );
 
-	m_pTimer = new QTimer(this);
-	
-	connect(m_pTimer, SIGNAL(timeout()), this, SLOT( updatePlayHeadPosition() ) );
-	connect(m_pTimer, SIGNAL(timeout()), this, SLOT( updatePlaybackFaderPeaks() ) );
-	
-	m_pTimer->start(100);
+	HydrogenApp::get_instance()->getRefreshScheduler()->addClient(
+		this, 100, [=]( const H2Core::AudioEngine::Snapshot& snapshot ) {
+			updatePlayHeadPosition( snapshot );
+			updatePlaybackFaderPeaks();
+		} );
 }
 
 
 
 SongEditorPanel::~SongEditorPanel()
 {
-	m_pTimer->stop();
 }
 
 
 
-void SongEditorPanel::updatePlayHeadPosition()
+void SongEditorPanel::updatePlayHeadPosition( const H2Core::AudioEngine::Snapshot& snapshot )
 {
 	auto pHydrogen = H2Core::Hydrogen::get_instance();
-	auto pAudioEngine = pHydrogen->getAudioEngine();
-	std::shared_ptr<Song> pSong = pHydrogen->getSong();
 
 	if ( Preferences::get_instance()->m_bFollowPlayhead &&
 		 pHydrogen->getMode() == Song::Mode::Song ) {
-		if ( pAudioEngine->getState() != H2Core::AudioEngine::State::Playing ) {
+		if ( snapshot.state != H2Core::AudioEngine::State::Playing ) {
 			return;
 		}
 
@@ -450,8 +447,7 @@ void SongEditorPanel::updatePlayHeadPosition()
 		QPoint pos = m_pPositionRuler->pos();
 		int x = -pos.x();
 
-		int nPlayHeadPosition = pAudioEngine->getTransportPosition()->getColumn() *
-			m_pSongEditor->getGridWidth();
+		int nPlayHeadPosition = snapshot.nColumn * m_pSongEditor->getGridWidth();
 
 		int value = m_pEditorScrollView->horizontalScrollBar()->value();
 
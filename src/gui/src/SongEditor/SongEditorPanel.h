@@ -26,6 +26,7 @@
 
 #include "../EventListener.h"
 #include <core/Object.h>
+#include <core/AudioEngine/AudioEngine.h>
 #include <core/Basics/Pattern.h>
 
 #include <QtGui>
@@ -129,7 +130,7 @@ class SongEditorPanel :  public QWidget, public EventListener,  public H2Core::O
 		void clearSequence();
 		
 		void updatePlaybackFaderPeaks();
-		void updatePlayHeadPosition();
+		void updatePlayHeadPosition( const H2Core::AudioEngine::Snapshot& snapshot );
 
 		void timelineBtnClicked();
 		void viewTimelineBtnClicked();
@@ -188,7 +189,6 @@ class SongEditorPanel :  public QWidget, public EventListener,  public H2Core::O
 		Button *			m_pPatternEditorLockedBtn;
 		Button *			m_pPatternEditorUnlockedBtn;
 
-		QTimer*						m_pTimer;
 		
 		AutomationPathView *		m_pAutomationPathView;
 		LCDCombo*					m_pAutomationCombo;
@@ -26,11 +26,15 @@
 #include <core/AudioEngine/AudioEngine.h>
 
 #include "../HydrogenApp.h"
+#include "../RefreshScheduler.h"
+
+#include <cmath>
 
 CpuLoadWidget::CpuLoadWidget( QWidget *pParent )
  : QWidget( pParent )
  , m_fValue( 0 )
  , m_nXRunValue( 0 )
+ , m_fPeak( 0 )
  , m_size( QSize( 96, 10 ) )
 {
 	setAttribute(Qt::WA_OpaquePaintEvent);
@@ -43,9 +47,11 @@ CpuLoadWidget::CpuLoadWidget( QWidget *pParent )
 		ii = 0;
 	}
 
-	QTimer* pTimer = new QTimer(this);
-	connect( pTimer, SIGNAL( timeout() ), this, SLOT( updateCpuLoadWidget() ) );
-	pTimer->start( 100 );	// update player control at 10 fps
+	// update player control at 10 fps
+	HydrogenApp::get_instance()->getRefreshScheduler()->addClient(
+		this, 100, [=]( const H2Core::AudioEngine::Snapshot& snapshot ) {
+			updateCpuLoadWidget( snapshot );
+		} );
 
 	HydrogenApp::get_instance()->addEventListener( this );
 
@@ -65,11 +71,6 @@ void CpuLoadWidget::paintEvent( QPaintEvent*)
 
 	QPainter painter(this);
 
-	float fSum = 0;
-	for ( auto ii : m_recentValues ) {
-		fSum += ii;
-	}
-	float fPeak = static_cast<float>( m_size.width() ) * fSum / static_cast<float>( m_recentValues.size() );
 	float fBorderWidth = 2;
 
 	QColor colorGradientGreen( Qt::green );
@@ -88,7 +89,7 @@ void CpuLoadWidget::paintEvent( QPaintEvent*)
 
 	painter.fillRect( QRect( 0, 0, m_size.width(), m_size.height() ),
 					  H2Core::Preferences::get_instance()->getColorTheme()->m_midLightColor );
-	painter.fillRect( QRectF( fBorderWidth / 2, fBorderWidth / 2, fPeak, m_size.height() - fBorderWidth ), QBrush( gradient ) );
+	painter.fillRect( QRectF( fBorderWidth / 2, fBorderWidth / 2, m_fPeak, m_size.height() - fBorderWidth ), QBrush( gradient ) );
 		
 	QPen pen;
 	if ( m_nXRunValue > 0 ) {
@@ -115,13 +116,12 @@ void CpuLoadWidget::paintEvent( QPaintEvent*)
 	}
 }
 
-void CpuLoadWidget::updateCpuLoadWidget()
+void CpuLoadWidget::updateCpuLoadWidget( const H2Core::AudioEngine::Snapshot& snapshot )
 {
 	// Process time
-	H2Core::AudioEngine *pAudioEngine = H2Core::Hydrogen::get_instance()->getAudioEngine();
 	float fPercentage = 0;
-	if ( pAudioEngine->getMaxProcessTime() != 0.0 ) {
-		fPercentage = ( pAudioEngine->getProcessTime() / pAudioEngine->getMaxProcessTime() );
+	if ( snapshot.fMaxProcessTime != 0.0 ) {
+		fPercentage = ( snapshot.fProcessTime / snapshot.fMaxProcessTime );
 	}
 
 	if ( fPercentage > 1.0 ) {
@@ -135,11 +135,28 @@ void CpuLoadWidget::updateCpuLoadWidget()
 	}
 	m_recentValues[ 0 ] = fPercentage;
 
+	float fSum = 0;
+	for ( auto ii : m_recentValues ) {
+		fSum += ii;
+	}
+	const float fPeak = static_cast<float>( m_size.width() ) * fSum /
+		static_cast<float>( m_recentValues.size() );
+
+	// Only repaint in case the meter moves by at least a pixel or
+	// the XRun highlighting of the border ends.
+	bool bUpdate = std::round( fPeak ) != std::round( m_fPeak );
+	m_fPeak = fPeak;
+
 	if ( m_nXRunValue > 0 ){
 		m_nXRunValue--;
+		if ( m_nXRunValue == 0 ) {
+			bUpdate = true;
+		}
 	}
 
-	update();
+	if ( bUpdate ) {
+		update();
+	}
 }
 
 
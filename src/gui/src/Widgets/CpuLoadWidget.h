@@ -28,6 +28,7 @@
 
 #include "../EventListener.h"
 #include <core/Object.h>
+#include <core/AudioEngine/AudioEngine.h>
 
 #include <QtGui>
 #include <QtWidgets>
@@ -55,13 +56,14 @@ public:
 	explicit CpuLoadWidget( QWidget *pParent );
 	~CpuLoadWidget();
 
-private slots:
-	void updateCpuLoadWidget();
-
 private:
+	void updateCpuLoadWidget( const H2Core::AudioEngine::Snapshot& snapshot );
+
 	std::vector<float> m_recentValues;
 	float m_fValue;
 	uint m_nXRunValue;
+	/** Width of the meter in pixels averaged over #m_recentValues. */
+	float m_fPeak;
 	QSize m_size;
 	
 	virtual void paintEvent( QPaintEvent *ev ) override;
@@ -28,8 +28,12 @@
 #include <core/AudioEngine/AudioEngine.h>
 #include <core/AudioEngine/TransportPosition.h>
 #include <core/Basics/InstrumentList.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/Note.h>
 #include <core/Basics/InstrumentComponent.h>
 #include <core/Basics/PatternList.h>
+#include <core/Preferences/Preferences.h>
+#include <core/Sampler/Sampler.h>
 #include "TestHelper.h"
 #include "AudioBenchmark.h"
 
@@ -130,6 +134,67 @@ static void timeADSR() {
 	qDebug() << "ADSR time: " << showTimes( times, nFrames );
 }
 
+static void timeFilter() {
+	const int nFrames = 4096;
+	float data_L[nFrames], data_R[nFrames];
+	auto pInstrument = std::make_shared<Instrument>();
+	pInstrument->set_filter_active( true );
+	pInstrument->set_filter_cutoff( 0.3 );
+	pInstrument->set_filter_resonance( 0.8 );
+
+	auto fillBuffers = [&]() {
+		for ( int i = 0; i < nFrames; i++ ) {
+			data_L[i] = data_R[i] = ( i % 64 ) / 32.0 - 1.0;
+		}
+	};
+
+	// Former per-frame code path
+	std::vector< clock_t > times;
+	for ( int i = 0; i < 100; i++ ) {
+		fillBuffers();
+		Note note( pInstrument, 0, 1.0, 0.f, -1, 0 );
+
+		std::clock_t start = std::clock();
+		for ( int j = 0; j < nFrames; j++ ) {
+			note.compute_lr_values( &data_L[j], &data_R[j] );
+		}
+		std::clock_t end = std::clock();
+
+		times.push_back( end - start );
+	}
+	qDebug() << "Filter (per frame) time: " << showTimes( times, nFrames );
+
+	for ( const auto& type : { Filter::Type::Legacy, Filter::Type::LowPass,
+							   Filter::Type::HighPass, Filter::Type::BandPass } ) {
+		pInstrument->setFilterType( type );
+		for ( bool bRamp : { false, true } ) {
+			times.clear();
+			for ( int i = 0; i < 100; i++ ) {
+				fillBuffers();
+				Note note( pInstrument, 0, 1.0, 0.f, -1, 0 );
+				auto pSelectedLayer = std::make_shared<SelectedLayerInfo>();
+				// Initialize the coefficients used in the previous
+				// block.
+				note.applyFilter( data_L, data_R, 1, pSelectedLayer );
+				if ( bRamp ) {
+					pInstrument->set_filter_cutoff( i % 2 == 0 ? 0.5 : 0.3 );
+				}
+
+				std::clock_t start = std::clock();
+				note.applyFilter( data_L, data_R, nFrames, pSelectedLayer );
+				std::clock_t end = std::clock();
+
+				times.push_back( end - start );
+			}
+			pInstrument->set_filter_cutoff( 0.3 );
+			qDebug() << QString( "Filter (block, %1%2) time: " )
+				.arg( Filter::TypeToQString( type ) )
+				.arg( bRamp ? ", ramped" : "" )
+					 << showTimes( times, nFrames );
+		}
+	}
+}
+
 static void timeExport( int nSampleRate ) {
 	auto outFile = Filesystem::tmp_file_path("test.wav");
 	Hydrogen *pHydrogen = Hydrogen::get_instance();
@@ -174,6 +239,9 @@ void AudioBenchmark::audioBenchmark(void)
 	qDebug() << "Benchmark ADSR method:";
 	timeADSR();
 
+	qDebug() << "Benchmark filter:";
+	timeFilter();
+
 	auto songFile = H2TEST_FILE("functional/test.h2song");
 	auto songADSRFile = H2TEST_FILE("functional/test_adsr.h2song");
 
@@ -197,6 +265,42 @@ void AudioBenchmark::audioBenchmark(void)
 	timeExport( 44100 );
 	timeExport( 48000 );
 
+	// At 48kHz the 44.1kHz samples of the test kit are resampled and
+	// rendered by the fused single-pass kernels. Compare them with
+	// the multi-pass rendering.
+	auto pSampler = pHydrogen->getAudioEngine()->getSampler();
+	qDebug() << "Without fused kernels";
+	pSampler->setUseFusedKernels( false );
+	timeExport( 48000 );
+	pSampler->setUseFusedKernels( true );
+
+	// Constant integer ratio between sample and driver rate.
+	timeExport( 88200 );
+
+	// Periods of 32, 64, 128, and 256 frames are rendered by kernels
+	// specialized for the block size. 200 frames always use the
+	// generic ones.
+	auto pPref = Preferences::get_instance();
+	const int nOldBufferSize = pPref->m_nBufferSize;
+	for ( const int nBufferSize : { 32, 64, 128, 200, 256 } ) {
+		pPref->m_nBufferSize = nBufferSize;
+		for ( const bool bFixedBlock : { true, false } ) {
+			qDebug() << "Buffer size" << nBufferSize
+					 << ( bFixedBlock ? "with" : "without" ) << "fixed block kernels";
+			pSampler->setUseFixedBlockKernels( bFixedBlock );
+			timeExport( 44100 );
+			timeExport( 48000 );
+		}
+	}
+	pSampler->setUseFixedBlockKernels( true );
+	pPref->m_nBufferSize = nOldBufferSize;
+
+	qDebug() << "With windowed sinc";
+	const auto interpolateMode = pSampler->getInterpolateMode();
+	pSampler->setInterpolateMode( Interpolation::InterpolateMode::Sinc );
+	timeExport( 48000 );
+	pSampler->setInterpolateMode( interpolateMode );
+
 
 	qDebug() << "Now with ADSR";
 	pSong = Song::load( songADSRFile );
@@ -0,0 +1,130 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/Basics/DrumkitComponent.h>
+#include <core/Helpers/AudioBufferArena.h>
+#include <core/Hydrogen.h>
+#include <core/IO/AudioOutput.h>
+#include <core/Sampler/Sampler.h>
+
+#include <memory>
+#include <vector>
+
+using namespace H2Core;
+
+class AudioBufferArenaTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( AudioBufferArenaTest );
+	CPPUNIT_TEST( testAllocate );
+	CPPUNIT_TEST( testRelease );
+	CPPUNIT_TEST( testEngineBuffers );
+	CPPUNIT_TEST_SUITE_END();
+
+	public:
+
+	void testAllocate()
+	{
+		auto pArena = AudioBufferArena::get_instance();
+
+		for ( const size_t nFrames : { 1, 33, 200, 256, 1000 } ) {
+			const size_t nStride = AudioBufferArena::stride( nFrames );
+			CPPUNIT_ASSERT( nStride >= nFrames );
+			CPPUNIT_ASSERT( nStride * sizeof( float ) % AudioBufferArena::nAlignment == 0 );
+
+			float* pBuffer = pArena->allocate( nFrames, 3 );
+			for ( int nChannel = 0; nChannel < 3; ++nChannel ) {
+				const float* pChannel = pBuffer + nChannel * nStride;
+				CPPUNIT_ASSERT( AudioBufferArena::isAligned( pChannel ) );
+				for ( size_t ii = 0; ii < nFrames; ++ii ) {
+					CPPUNIT_ASSERT_EQUAL( 0.0f, pChannel[ ii ] );
+				}
+			}
+			pArena->release( pBuffer );
+		}
+
+		// Buffers allocated one after another are adjacent.
+		float* pFirst = pArena->allocate( 256, 2 );
+		float* pSecond = pArena->allocate( 256, 2 );
+		CPPUNIT_ASSERT( pSecond == pFirst + 2 * AudioBufferArena::stride( 256 ) );
+		pArena->release( pFirst );
+		pArena->release( pSecond );
+
+		// Larger than a slab.
+		const size_t nLargeFrames = AudioBufferArena::nSlabSize / sizeof( float ) + 1;
+		float* pLarge = pArena->allocate( nLargeFrames );
+		CPPUNIT_ASSERT( AudioBufferArena::isAligned( pLarge ) );
+		pLarge[ nLargeFrames - 1 ] = 1.0;
+		pArena->release( pLarge );
+	}
+
+	void testRelease()
+	{
+		auto pArena = AudioBufferArena::get_instance();
+		const size_t nAllocatedBytes = pArena->getAllocatedBytes();
+
+		std::vector<float*> buffers;
+		for ( int ii = 0; ii < 16; ++ii ) {
+			buffers.push_back( pArena->allocate( 1024, 2 ) );
+			buffers.back()[ 0 ] = 1.0;
+		}
+		const size_t nSlabs = pArena->getSlabCount();
+
+		// Release every other buffer first to fragment the free
+		// ranges, which have to be merged again afterwards.
+		for ( int ii = 0; ii < 16; ii += 2 ) {
+			pArena->release( buffers[ ii ] );
+		}
+		for ( int ii = 1; ii < 16; ii += 2 ) {
+			pArena->release( buffers[ ii ] );
+		}
+		CPPUNIT_ASSERT_EQUAL( nAllocatedBytes, pArena->getAllocatedBytes() );
+
+		// The memory is reused and handed out zero-initialized.
+		float* pBuffer = pArena->allocate( 16 * 1024, 2 );
+		CPPUNIT_ASSERT_EQUAL( nSlabs, pArena->getSlabCount() );
+		for ( size_t ii = 0; ii < 2 * AudioBufferArena::stride( 16 * 1024 ); ++ii ) {
+			CPPUNIT_ASSERT_EQUAL( 0.0f, pBuffer[ ii ] );
+		}
+		pArena->release( pBuffer );
+
+		pArena->release( nullptr );
+	}
+
+	void testEngineBuffers()
+	{
+		// The fixed block kernels of the Sampler rely on all output
+		// buffers being aligned.
+		auto pAudioEngine = Hydrogen::get_instance()->getAudioEngine();
+		auto pSampler = pAudioEngine->getSampler();
+		CPPUNIT_ASSERT( AudioBufferArena::isAligned( pSampler->m_pMainOut_L ) );
+		CPPUNIT_ASSERT( AudioBufferArena::isAligned( pSampler->m_pMainOut_R ) );
+
+		auto pDriver = pAudioEngine->getAudioDriver();
+		CPPUNIT_ASSERT( pDriver != nullptr );
+		CPPUNIT_ASSERT( AudioBufferArena::isAligned( pDriver->getOut_L() ) );
+		CPPUNIT_ASSERT( AudioBufferArena::isAligned( pDriver->getOut_R() ) );
+
+		auto pComponent = std::make_shared<DrumkitComponent>( 0, "aligned" );
+		CPPUNIT_ASSERT( AudioBufferArena::isAligned( pComponent->get_out_L_buffer() ) );
+		CPPUNIT_ASSERT( AudioBufferArena::isAligned( pComponent->get_out_R_buffer() ) );
+	}
+};
@@ -0,0 +1,142 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Sampler/Filter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace H2Core;
+
+class FilterTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( FilterTest );
+	CPPUNIT_TEST( testLowPass );
+	CPPUNIT_TEST( testHighPass );
+	CPPUNIT_TEST( testStereoLockstep );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** Cutoff frequency in units of the sample rate used throughout
+	 * the tests (1 kHz at 48 kHz). */
+	static constexpr double fCutoffFrequency = 1.0 / 48;
+
+	/** Cutoff parameter as stored in the #Instrument. */
+	static float cutoff() {
+		return static_cast<float>( 2 * std::sin( M_PI * fCutoffFrequency ) );
+	}
+
+	/**
+	 * Filters a sine of @a fFrequency (in units of the sample rate)
+	 * and returns the ratio of the output and input RMS once the
+	 * filter settled.
+	 *
+	 * The signal is processed in blocks of varying size to ensure
+	 * the filter state is properly carried over.
+	 */
+	static float gain( Filter::Type type, double fFrequency ) {
+		const int nFrames = 48000;
+		const int nSettle = nFrames / 2;
+		std::vector<float> left( nFrames ), right( nFrames );
+		double fInput = 0;
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			left[ ii ] = static_cast<float>( std::sin( 2 * M_PI * fFrequency * ii ) );
+			right[ ii ] = left[ ii ];
+			if ( ii >= nSettle ) {
+				fInput += left[ ii ] * left[ ii ];
+			}
+		}
+
+		float fBand[ 2 ] = { 0, 0 };
+		float fLow[ 2 ] = { 0, 0 };
+		int nBlockSize = 64;
+		for ( int ii = 0; ii < nFrames; ii += nBlockSize ) {
+			nBlockSize = ( nBlockSize * 7 ) % 509 + 1;
+			Filter::process( type, &left[ ii ], &right[ ii ],
+							 std::min( nBlockSize, nFrames - ii ),
+							 cutoff(), 0.0, cutoff(), 0.0, fBand, fLow );
+		}
+
+		double fOutput = 0;
+		for ( int ii = nSettle; ii < nFrames; ++ii ) {
+			fOutput += left[ ii ] * left[ ii ];
+		}
+		return static_cast<float>( std::sqrt( fOutput / fInput ) );
+	}
+
+	public:
+
+	void testLowPass()
+	{
+		// Pass band
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(
+			1.0, gain( Filter::Type::LowPass, fCutoffFrequency / 16 ), 0.01 );
+		// Without resonance (Q = 0.5) the response at the cutoff is
+		// -6 dB. Due to the prewarping this holds exactly.
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(
+			0.5, gain( Filter::Type::LowPass, fCutoffFrequency ), 0.01 );
+		// Two-pole roll-off of 12 dB per octave.
+		CPPUNIT_ASSERT( gain( Filter::Type::LowPass, fCutoffFrequency * 8 ) < 1.0 / 50 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(
+			0.0, gain( Filter::Type::LowPass, 0.5 - 1.0 / 4800 ), 0.001 );
+	}
+
+	void testHighPass()
+	{
+		CPPUNIT_ASSERT( gain( Filter::Type::HighPass, fCutoffFrequency / 8 ) < 1.0 / 50 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(
+			0.5, gain( Filter::Type::HighPass, fCutoffFrequency ), 0.01 );
+		// Pass band
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(
+			1.0, gain( Filter::Type::HighPass, fCutoffFrequency * 16 ), 0.01 );
+	}
+
+	/** Both channels have to be filtered independently. */
+	void testStereoLockstep()
+	{
+		const int nFrames = 256;
+		for ( const auto type : { Filter::Type::Legacy, Filter::Type::LowPass,
+								  Filter::Type::HighPass, Filter::Type::BandPass } ) {
+			std::vector<float> left( nFrames ), right( nFrames, 0.0f );
+			std::vector<float> mono( nFrames );
+			for ( int ii = 0; ii < nFrames; ++ii ) {
+				left[ ii ] = ii % 16 < 8 ? 1.0f : -1.0f;
+				mono[ ii ] = left[ ii ];
+			}
+			float fBand[ 2 ] = { 0, 0 };
+			float fLow[ 2 ] = { 0, 0 };
+			Filter::process( type, left.data(), right.data(), nFrames,
+							 0.2, 0.5, 0.4, 0.7, fBand, fLow );
+
+			float fMonoBand[ 2 ] = { 0, 0 };
+			float fMonoLow[ 2 ] = { 0, 0 };
+			std::vector<float> unused( nFrames, 0.0f );
+			Filter::process( type, unused.data(), mono.data(), nFrames,
+							 0.2, 0.5, 0.4, 0.7, fMonoBand, fMonoLow );
+
+			for ( int ii = 0; ii < nFrames; ++ii ) {
+				CPPUNIT_ASSERT_EQUAL( 0.0f, right[ ii ] );
+				CPPUNIT_ASSERT_EQUAL( mono[ ii ], left[ ii ] );
+			}
+		}
+	}
+};
@@ -41,6 +41,9 @@
 #include <core/Basics/Song.h>
 #include <core/Basics/Playlist.h>
 #include <core/Smf/SMF.h>
+#include <core/Sampler/Sampler.h>
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/Preferences/Preferences.h>
 #include "TestHelper.h"
 #include "assertions/File.h"
 #include "assertions/AudioFile.h"
@@ -60,6 +63,10 @@ class FunctionalTest : public CppUnit::TestCase {
 	CPPUNIT_TEST( testExportVelocityAutomationAudio );
 	CPPUNIT_TEST( testExportVelocityAutomationMIDISMF0 );
 	CPPUNIT_TEST( testExportVelocityAutomationMIDISMF1 );
+	CPPUNIT_TEST( testFusedKernels );
+	CPPUNIT_TEST( testFixedBlockKernels );
+	CPPUNIT_TEST( testDeterministicExport );
+	CPPUNIT_TEST( testSubBlockRendering );
 	// CPPUNIT_TEST( testPrintMessages ); // MANUAL
 	CPPUNIT_TEST_SUITE_END();
 	
@@ -160,6 +167,148 @@ public:
 		Filesystem::rm( outFile );
 	}
 
+	void testFusedKernels()
+	{
+		// Single-pass and multi-pass rendering of resampled voices
+		// must yield identical results.
+		auto songFile = H2TEST_FILE("functional/test.h2song");
+		auto outFileFused = Filesystem::tmp_file_path("test-fused.wav");
+		auto outFile = Filesystem::tmp_file_path("test-multi-pass.wav");
+
+		auto pHydrogen = Hydrogen::get_instance();
+		auto pSong = Song::load( songFile );
+		CPPUNIT_ASSERT( pSong != nullptr );
+		pHydrogen->setSong( pSong );
+
+		// Pitching all layers enforces resampling.
+		for ( const auto& pInstrument : *pSong->getInstrumentList() ) {
+			for ( const auto& pComponent : *pInstrument->get_components() ) {
+				for ( const auto& pLayer : *pComponent ) {
+					if ( pLayer != nullptr ) {
+						pLayer->set_pitch( 1.5 );
+					}
+				}
+			}
+		}
+
+		auto pSampler = pHydrogen->getAudioEngine()->getSampler();
+		TestHelper::exportSong( outFileFused );
+		pSampler->setUseFusedKernels( false );
+		TestHelper::exportSong( outFile );
+		pSampler->setUseFusedKernels( true );
+
+		H2TEST_ASSERT_AUDIO_FILES_EQUAL( outFile, outFileFused );
+		Filesystem::rm( outFileFused );
+		Filesystem::rm( outFile );
+	}
+
+	void testFixedBlockKernels()
+	{
+		// Rendering complete periods of a fixed size using the
+		// specialized kernels must not alter the result, neither for
+		// plain nor for resampled voices.
+		auto songFile = H2TEST_FILE("functional/test.h2song");
+		auto outFileFixed = Filesystem::tmp_file_path("test-fixed-block.wav");
+		auto outFile = Filesystem::tmp_file_path("test-generic-block.wav");
+
+		auto pHydrogen = Hydrogen::get_instance();
+		auto pPref = Preferences::get_instance();
+		auto pSampler = pHydrogen->getAudioEngine()->getSampler();
+		const int nOldBufferSize = pPref->m_nBufferSize;
+
+		for ( const int nBufferSize : { 64, 256 } ) {
+			for ( const bool bResample : { false, true } ) {
+				auto pSong = Song::load( songFile );
+				CPPUNIT_ASSERT( pSong != nullptr );
+				pHydrogen->setSong( pSong );
+
+				if ( bResample ) {
+					for ( const auto& pInstrument : *pSong->getInstrumentList() ) {
+						for ( const auto& pComponent : *pInstrument->get_components() ) {
+							for ( const auto& pLayer : *pComponent ) {
+								if ( pLayer != nullptr ) {
+									pLayer->set_pitch( 1.5 );
+								}
+							}
+						}
+					}
+				}
+
+				pPref->m_nBufferSize = nBufferSize;
+				TestHelper::exportSong( outFileFixed );
+				pSampler->setUseFixedBlockKernels( false );
+				TestHelper::exportSong( outFile );
+				pSampler->setUseFixedBlockKernels( true );
+				pPref->m_nBufferSize = nOldBufferSize;
+
+				H2TEST_ASSERT_AUDIO_FILES_EQUAL( outFile, outFileFixed );
+				Filesystem::rm( outFileFixed );
+				Filesystem::rm( outFile );
+			}
+		}
+	}
+
+	void testDeterministicExport()
+	{
+		// Two exports of a humanized song using the same seed must be
+		// identical.
+		auto songFile = H2TEST_FILE("functional/test.h2song");
+		auto outFile1 = Filesystem::tmp_file_path("test-seed-1.wav");
+		auto outFile2 = Filesystem::tmp_file_path("test-seed-2.wav");
+
+		auto pHydrogen = Hydrogen::get_instance();
+		auto pPref = Preferences::get_instance();
+		auto pSong = Song::load( songFile );
+		CPPUNIT_ASSERT( pSong != nullptr );
+		pHydrogen->setSong( pSong );
+
+		pSong->setHumanizeTimeValue( 0.5 );
+		pSong->setHumanizeVelocityValue( 0.5 );
+		for ( const auto& pInstrument : *pSong->getInstrumentList() ) {
+			pInstrument->set_random_pitch_factor( 0.5 );
+			pInstrument->set_sample_selection_alg( Instrument::RANDOM );
+		}
+
+		const bool bOldDeterministicExport = pPref->m_bDeterministicExport;
+		const int nOldExportSeed = pPref->m_nExportSeed;
+		pPref->m_bDeterministicExport = true;
+		pPref->m_nExportSeed = 4242;
+
+		TestHelper::exportSong( outFile1 );
+		TestHelper::exportSong( outFile2 );
+
+		pPref->m_bDeterministicExport = bOldDeterministicExport;
+		pPref->m_nExportSeed = nOldExportSeed;
+
+		H2TEST_ASSERT_AUDIO_FILES_EQUAL( outFile1, outFile2 );
+		Filesystem::rm( outFile1 );
+		Filesystem::rm( outFile2 );
+	}
+
+	void testSubBlockRendering()
+	{
+		// Splitting the periods at note starts must not alter the
+		// rendered audio of a song without tempo changes.
+		auto songFile = H2TEST_FILE("functional/test.h2song");
+		auto outFile = Filesystem::tmp_file_path("test-sub-blocks.wav");
+		auto refFile = H2TEST_FILE("functional/test.ref.flac");
+
+		auto pPref = Preferences::get_instance();
+		const bool bOldSubBlockRendering = pPref->m_bSubBlockRendering;
+		const int nOldMinSubBlockSize = pPref->m_nMinSubBlockSize;
+
+		for ( const int nMinSubBlockSize : { 1, 64 } ) {
+			pPref->m_bSubBlockRendering = true;
+			pPref->m_nMinSubBlockSize = nMinSubBlockSize;
+			TestHelper::exportSong( songFile, outFile );
+			pPref->m_bSubBlockRendering = bOldSubBlockRendering;
+			pPref->m_nMinSubBlockSize = nOldMinSubBlockSize;
+
+			H2TEST_ASSERT_AUDIO_FILES_EQUAL( refFile, outFile );
+			Filesystem::rm( outFile );
+		}
+	}
+
 	void testExportMIDISMF1Single()
 	{
 		auto songFile = H2TEST_FILE("functional/test.h2song");
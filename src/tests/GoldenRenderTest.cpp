@@ -0,0 +1,228 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include "GoldenRenderTest.h"
+#include "TestHelper.h"
+
+#include <core/Helpers/Filesystem.h>
+#include <core/Preferences/Preferences.h>
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <sndfile.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace H2Core;
+
+bool GoldenRenderTest::bUpdateReferences = false;
+
+/** Seed used for all golden renders. */
+static constexpr int nGoldenSeed = 0;
+/** Number of frames the RMS is computed over. */
+static constexpr int nRmsBlockSize = 4410;
+/** Maximum deviation of the RMS of a block. */
+static constexpr double fRmsTolerance = 1e-3;
+/** Maximum difference in length of the rendered audio. Its end is
+ * determined by silence detection within a buffer. */
+static constexpr long long nFrameTolerance = 1024;
+
+struct RenderSummary {
+	long long nFrames = 0;
+	QString sChecksum;
+	std::vector<double> rms_L;
+	std::vector<double> rms_R;
+
+	QJsonObject toJson() const {
+		QJsonArray rmsL, rmsR;
+		for ( const auto fRms : rms_L ) {
+			rmsL.append( fRms );
+		}
+		for ( const auto fRms : rms_R ) {
+			rmsR.append( fRms );
+		}
+		QJsonObject object;
+		object.insert( "frames", nFrames );
+		object.insert( "checksum", sChecksum );
+		object.insert( "rmsBlockSize", nRmsBlockSize );
+		object.insert( "rms_L", rmsL );
+		object.insert( "rms_R", rmsR );
+		return object;
+	}
+
+	static RenderSummary fromJson( const QJsonObject& object ) {
+		RenderSummary summary;
+		summary.nFrames = static_cast<long long>( object.value( "frames" ).toDouble() );
+		summary.sChecksum = object.value( "checksum" ).toString();
+		for ( const auto& value : object.value( "rms_L" ).toArray() ) {
+			summary.rms_L.push_back( value.toDouble() );
+		}
+		for ( const auto& value : object.value( "rms_R" ).toArray() ) {
+			summary.rms_R.push_back( value.toDouble() );
+		}
+		return summary;
+	}
+};
+
+/** Reads back an exported stereo file. */
+static RenderSummary summarize( const QString& sFileName ) {
+	SF_INFO info = {0};
+	std::unique_ptr<SNDFILE, decltype(&sf_close)>
+		file{ sf_open( sFileName.toLocal8Bit().data(), SFM_READ, &info ), sf_close };
+	CPPUNIT_ASSERT( file != nullptr );
+	CPPUNIT_ASSERT_EQUAL( 2, info.channels );
+
+	RenderSummary summary;
+	summary.nFrames = info.frames;
+
+	// FNV-1a over the interleaved samples.
+	uint64_t nHash = 0xcbf29ce484222325ULL;
+	std::vector<short> buffer( nRmsBlockSize * 2 );
+	sf_count_t nRead;
+	while ( ( nRead = sf_readf_short( file.get(), buffer.data(), nRmsBlockSize ) ) > 0 ) {
+		double fSum_L = 0, fSum_R = 0;
+		for ( sf_count_t ii = 0; ii < nRead; ++ii ) {
+			for ( int nChannel = 0; nChannel < 2; ++nChannel ) {
+				const uint16_t nSample =
+					static_cast<uint16_t>( buffer[ ii * 2 + nChannel ] );
+				nHash = ( nHash ^ ( nSample & 0xff ) ) * 0x100000001b3ULL;
+				nHash = ( nHash ^ ( nSample >> 8 ) ) * 0x100000001b3ULL;
+			}
+			const double fL = buffer[ ii * 2 ] / 32768.0;
+			const double fR = buffer[ ii * 2 + 1 ] / 32768.0;
+			fSum_L += fL * fL;
+			fSum_R += fR * fR;
+		}
+		summary.rms_L.push_back( std::sqrt( fSum_L / nRead ) );
+		summary.rms_R.push_back( std::sqrt( fSum_R / nRead ) );
+	}
+	summary.sChecksum = QString::number( nHash, 16 );
+
+	return summary;
+}
+
+/** \return Description of the first deviation or an empty string if
+ * @a actual is within the tolerances of @a reference. */
+static QString compare( const RenderSummary& reference, const RenderSummary& actual ) {
+	if ( reference.sChecksum == actual.sChecksum &&
+		 reference.nFrames == actual.nFrames ) {
+		return "";
+	}
+
+	if ( std::llabs( reference.nFrames - actual.nFrames ) > nFrameTolerance ) {
+		return QString( "length [%1] instead of [%2] frames" )
+			.arg( actual.nFrames ).arg( reference.nFrames );
+	}
+
+	// The last block may differ in length.
+	const size_t nBlocks = std::min( reference.rms_L.size(), actual.rms_L.size() );
+	for ( size_t ii = 0; ii + 1 < nBlocks; ++ii ) {
+		const double fDiff = std::max(
+			std::abs( reference.rms_L[ ii ] - actual.rms_L[ ii ] ),
+			std::abs( reference.rms_R[ ii ] - actual.rms_R[ ii ] ) );
+		if ( fDiff > fRmsTolerance ) {
+			return QString( "RMS differs by [%1] in block [%2] starting at frame [%3]" )
+				.arg( fDiff ).arg( ii ).arg( ii * nRmsBlockSize );
+		}
+	}
+
+	return "";
+}
+
+void GoldenRenderTest::setUp() {
+	auto pPref = Preferences::get_instance();
+	m_bOldDeterministicExport = pPref->m_bDeterministicExport;
+	m_nOldExportSeed = pPref->m_nExportSeed;
+	pPref->m_bDeterministicExport = true;
+	pPref->m_nExportSeed = nGoldenSeed;
+}
+
+void GoldenRenderTest::tearDown() {
+	auto pPref = Preferences::get_instance();
+	pPref->m_bDeterministicExport = m_bOldDeterministicExport;
+	pPref->m_nExportSeed = m_nOldExportSeed;
+}
+
+void GoldenRenderTest::testGoldenRenders() {
+	const QDir testDataDir( TestHelper::get_instance()->getTestDataDir() );
+	const QDir goldenDir( testDataDir.filePath( "golden" ) );
+	if ( bUpdateReferences ) {
+		testDataDir.mkpath( "golden" );
+	}
+
+	QStringList failures;
+	int nSongs = 0;
+
+	QDirIterator it( testDataDir.absolutePath(), QStringList() << "*.h2song",
+					 QDir::Files, QDirIterator::Subdirectories );
+	while ( it.hasNext() ) {
+		const QString sSongFile = it.next();
+		if ( sSongFile.contains( ".autosave." ) ) {
+			continue;
+		}
+		++nSongs;
+		const QString sName = testDataDir.relativeFilePath( sSongFile )
+			.replace( '/', '_' ).replace( ".h2song", "" );
+		const QString sReferenceFile = goldenDir.filePath( sName + ".json" );
+		const QString sOutFile = Filesystem::tmp_file_path( sName + ".wav" );
+
+		TestHelper::exportSong( sSongFile, sOutFile );
+		const auto actual = summarize( sOutFile );
+		Filesystem::rm( sOutFile );
+
+		if ( bUpdateReferences ) {
+			QFile file( sReferenceFile );
+			CPPUNIT_ASSERT( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+			file.write( QJsonDocument( actual.toJson() ).toJson() );
+			qDebug().noquote() << QString( "Updated golden reference [%1]" ).arg( sReferenceFile );
+			continue;
+		}
+
+		QFile file( sReferenceFile );
+		if ( ! file.open( QIODevice::ReadOnly ) ) {
+			failures << QString( "[%1]: no golden reference [%2]. Run the tests with --update-golden to create it." )
+				.arg( sName ).arg( sReferenceFile );
+			continue;
+		}
+		const auto reference = RenderSummary::fromJson(
+			QJsonDocument::fromJson( file.readAll() ).object() );
+
+		const QString sError = compare( reference, actual );
+		if ( ! sError.isEmpty() ) {
+			failures << QString( "[%1]: %2" ).arg( sName ).arg( sError );
+		}
+	}
+
+	CPPUNIT_ASSERT( nSongs > 0 );
+	if ( ! failures.isEmpty() ) {
+		CPPUNIT_FAIL( failures.join( "\n" ).toStdString() );
+	}
+}
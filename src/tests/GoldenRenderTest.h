@@ -0,0 +1,69 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef GOLDEN_RENDER_TEST_H
+#define GOLDEN_RENDER_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <QString>
+
+/**
+ * Renders all songs in the test data folder using the deterministic
+ * export mode and compares the results against the references stored
+ * in data/golden.
+ *
+ * A reference holds a checksum of the 16 bit PCM data as well as the
+ * RMS of consecutive blocks of both channels. If the checksum does
+ * not match, e.g. due to changes in the floating point arithmetic of
+ * an optimized Sampler, the RMS values have to be within a tolerance.
+ *
+ * Run the tests with `--update-golden` to (re)create the references
+ * after an intended change of the rendered audio. This is the only
+ * way to create them. A song without a reference fails the test.
+ *
+ * Until the references are committed, the test is registered in the
+ * separate "GoldenRender" registry and only run along with
+ * `--update-golden`.
+ */
+class GoldenRenderTest : public CppUnit::TestFixture {
+	CPPUNIT_TEST_SUITE( GoldenRenderTest );
+	CPPUNIT_TEST( testGoldenRenders );
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+	void setUp();
+	void tearDown();
+
+	void testGoldenRenders();
+
+	static void setUpdateReferences( bool bUpdate ) {
+		bUpdateReferences = bUpdate;
+	}
+
+private:
+	static bool bUpdateReferences;
+
+	bool m_bOldDeterministicExport;
+	int m_nOldExportSeed;
+};
+
+#endif
@@ -0,0 +1,217 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/IO/MidiEventQueue.h>
+
+#include <memory>
+#include <vector>
+
+using namespace H2Core;
+
+class MidiEventQueueTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( MidiEventQueueTest );
+	CPPUNIT_TEST( testJitter );
+	CPPUNIT_TEST( testOrdering );
+	CPPUNIT_TEST( testOverdue );
+	CPPUNIT_TEST( testWrapAround );
+	CPPUNIT_TEST( testOverflow );
+	CPPUNIT_TEST( testClear );
+	CPPUNIT_TEST_SUITE_END();
+
+	struct Written {
+		uint32_t nOffset;
+		uint8_t nStatus;
+		uint8_t nKey;
+	};
+
+	/** Runs a single cycle and collects all written messages. */
+	static std::vector<Written> runCycle( MidiEventQueue& queue, uint32_t nCycleStart,
+										  uint32_t nFrames ) {
+		std::vector<Written> written;
+		queue.dispatch( nCycleStart, nFrames,
+						[&]( uint32_t nOffset, const uint8_t* pData, uint8_t nLength ) {
+							CPPUNIT_ASSERT( nOffset < nFrames );
+							CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 3 ), nLength );
+							written.push_back( { nOffset, pData[ 0 ], pData[ 1 ] } );
+							return true;
+						} );
+		return written;
+	}
+
+	static void pushNoteOn( MidiEventQueue& queue, uint32_t nFrame, uint8_t nKey ) {
+		const uint8_t data[] = { 0x90, nKey, 100 };
+		CPPUNIT_ASSERT( queue.pushRealtime( nFrame, data, 3 ) );
+	}
+
+	public:
+
+	/** Notes scheduled at arbitrary frames, some of them several
+	 * cycles ahead, have to land at exactly their frame. */
+	void testJitter()
+	{
+		auto pQueue = std::make_unique<MidiEventQueue>();
+		const uint32_t nFrames = 256;
+		const uint32_t nStart = 1000;
+
+		std::vector<uint32_t> frames;
+		for ( uint32_t nFrame = nStart; nFrame < nStart + 20 * nFrames; nFrame += 37 ) {
+			frames.push_back( nFrame );
+		}
+
+		size_t nNext = 0;
+		int nReceived = 0;
+		for ( uint32_t nCycle = nStart; nCycle < nStart + 24 * nFrames; nCycle += nFrames ) {
+			// Emulate the audio engine which is ahead of the MIDI
+			// driver by up to two periods.
+			while ( nNext < frames.size() && frames[ nNext ] < nCycle + 2 * nFrames ) {
+				pushNoteOn( *pQueue, frames[ nNext ], nNext % 128 );
+				++nNext;
+			}
+
+			for ( const auto& written : runCycle( *pQueue, nCycle, nFrames ) ) {
+				const uint32_t nExpected = frames[ nReceived ];
+				CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( nReceived % 128 ), written.nKey );
+				CPPUNIT_ASSERT_EQUAL( nExpected - nCycle, written.nOffset );
+				++nReceived;
+			}
+		}
+		CPPUNIT_ASSERT_EQUAL( static_cast<int>( frames.size() ), nReceived );
+		CPPUNIT_ASSERT_EQUAL( 0, pQueue->getDroppedMessages() );
+	}
+
+	/** Messages pushed out of order are written in chronological
+	 * order while those sharing a frame keep their order. Control
+	 * messages come first. */
+	void testOrdering()
+	{
+		auto pQueue = std::make_unique<MidiEventQueue>();
+		pushNoteOn( *pQueue, 50, 1 );
+		pushNoteOn( *pQueue, 10, 2 );
+		const uint8_t noteOff[] = { 0x80, 3, 0 };
+		CPPUNIT_ASSERT( pQueue->pushRealtime( 10, noteOff, 3 ) );
+		pushNoteOn( *pQueue, 10, 3 );
+		const uint8_t cc[] = { 0xB0, 7, 64 };
+		CPPUNIT_ASSERT( pQueue->pushControl( cc, 3 ) );
+
+		auto written = runCycle( *pQueue, 0, 64 );
+		CPPUNIT_ASSERT_EQUAL( static_cast<size_t>( 5 ), written.size() );
+		CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 0xB0 ), written[ 0 ].nStatus );
+		CPPUNIT_ASSERT_EQUAL( 0u, written[ 0 ].nOffset );
+		CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 2 ), written[ 1 ].nKey );
+		CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 0x80 ), written[ 2 ].nStatus );
+		CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 0x90 ), written[ 3 ].nStatus );
+		CPPUNIT_ASSERT_EQUAL( 10u, written[ 3 ].nOffset );
+		CPPUNIT_ASSERT_EQUAL( 50u, written[ 4 ].nOffset );
+		for ( size_t ii = 1; ii < written.size(); ++ii ) {
+			CPPUNIT_ASSERT( written[ ii - 1 ].nOffset <= written[ ii ].nOffset );
+		}
+	}
+
+	/** Messages arriving too late are sent as early as possible. */
+	void testOverdue()
+	{
+		auto pQueue = std::make_unique<MidiEventQueue>();
+		pushNoteOn( *pQueue, 100, 1 );
+		pushNoteOn( *pQueue, 300, 2 );
+
+		auto written = runCycle( *pQueue, 256, 256 );
+		CPPUNIT_ASSERT_EQUAL( static_cast<size_t>( 2 ), written.size() );
+		CPPUNIT_ASSERT_EQUAL( 0u, written[ 0 ].nOffset );
+		CPPUNIT_ASSERT_EQUAL( 44u, written[ 1 ].nOffset );
+	}
+
+	/** The 32 bit JACK clock overflows after about a day at
+	 * 48kHz. */
+	void testWrapAround()
+	{
+		auto pQueue = std::make_unique<MidiEventQueue>();
+		const uint32_t nCycle = 0xFFFFFF80u;
+		pushNoteOn( *pQueue, 0x10u, 2 );
+		pushNoteOn( *pQueue, 0xFFFFFFF0u, 1 );
+
+		auto written = runCycle( *pQueue, nCycle, 256 );
+		CPPUNIT_ASSERT_EQUAL( static_cast<size_t>( 2 ), written.size() );
+		CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 1 ), written[ 0 ].nKey );
+		CPPUNIT_ASSERT_EQUAL( 0x70u, written[ 0 ].nOffset );
+		CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 2 ), written[ 1 ].nKey );
+		CPPUNIT_ASSERT_EQUAL( 0x90u, written[ 1 ].nOffset );
+	}
+
+	void testOverflow()
+	{
+		auto pQueue = std::make_unique<MidiEventQueue>();
+		const uint8_t data[] = { 0x90, 1, 100 };
+		for ( int ii = 0; ii < MidiEventQueue::nCapacity; ++ii ) {
+			CPPUNIT_ASSERT( pQueue->pushRealtime( 0, data, 3 ) );
+		}
+		CPPUNIT_ASSERT( ! pQueue->pushRealtime( 0, data, 3 ) );
+		CPPUNIT_ASSERT_EQUAL( 1, pQueue->getDroppedMessages() );
+
+		// A full output buffer drops the remaining messages.
+		int nAccepted = 0;
+		pQueue->dispatch( 0, 64, [&]( uint32_t, const uint8_t*, uint8_t ) {
+			return ++nAccepted <= 10;
+		} );
+		CPPUNIT_ASSERT_EQUAL( 1 + MidiEventQueue::nCapacity - 10,
+							  pQueue->getDroppedMessages() );
+		CPPUNIT_ASSERT( runCycle( *pQueue, 64, 64 ).empty() );
+	}
+
+	/** Clearing the queue, e.g. on stop, drops all notes not started
+	 * yet but sends the note offs of the others right away. */
+	void testClear()
+	{
+		auto pQueue = std::make_unique<MidiEventQueue>();
+		const uint8_t noteOff1[] = { 0x80, 1, 0 };
+		const uint8_t noteOff2[] = { 0x90, 2, 0 };
+		pushNoteOn( *pQueue, 10, 1 );
+		CPPUNIT_ASSERT( pQueue->pushRealtime( 400, noteOff1, 3 ) );
+		pushNoteOn( *pQueue, 300, 3 );
+		CPPUNIT_ASSERT( pQueue->pushRealtime( 200, noteOff2, 3 ) );
+		CPPUNIT_ASSERT_EQUAL( static_cast<size_t>( 1 ), runCycle( *pQueue, 0, 64 ).size() );
+
+		// Messages still in the lock-free queue are covered too while
+		// those pushed after clearing are kept.
+		pushNoteOn( *pQueue, 500, 4 );
+		CPPUNIT_ASSERT( pQueue->pushClear() );
+		pushNoteOn( *pQueue, 100, 6 );
+		const uint8_t cc[] = { 0xB0, 123, 0 };
+		CPPUNIT_ASSERT( pQueue->pushControl( cc, 3 ) );
+
+		auto written = runCycle( *pQueue, 64, 64 );
+		CPPUNIT_ASSERT_EQUAL( static_cast<size_t>( 4 ), written.size() );
+		CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 0xB0 ), written[ 0 ].nStatus );
+		CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 0x90 ), written[ 1 ].nStatus );
+		CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 2 ), written[ 1 ].nKey );
+		CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 0x80 ), written[ 2 ].nStatus );
+		CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 1 ), written[ 2 ].nKey );
+		CPPUNIT_ASSERT_EQUAL( 0u, written[ 2 ].nOffset );
+		CPPUNIT_ASSERT_EQUAL( static_cast<uint8_t>( 6 ), written[ 3 ].nKey );
+		CPPUNIT_ASSERT_EQUAL( 36u, written[ 3 ].nOffset );
+
+		// Scheduling continues as usual afterwards.
+		pushNoteOn( *pQueue, 140, 5 );
+		CPPUNIT_ASSERT( runCycle( *pQueue, 128, 256 ).size() == 1 );
+		CPPUNIT_ASSERT( runCycle( *pQueue, 384, 256 ).empty() );
+		CPPUNIT_ASSERT_EQUAL( 0, pQueue->getDroppedMessages() );
+	}
+};
@@ -0,0 +1,102 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Basics/Song.h>
+#include <core/Sampler/PanLawTable.h>
+#include <core/Sampler/Sampler.h>
+
+#include <cmath>
+
+using namespace H2Core;
+
+class PanLawTableTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( PanLawTableTest );
+	CPPUNIT_TEST( testAccuracy );
+	CPPUNIT_TEST( testSongUpdate );
+	CPPUNIT_TEST_SUITE_END();
+
+	public:
+
+	/** The tabulated gains of all laws have to match the exact ones. */
+	void testAccuracy()
+	{
+		for ( int nType = Sampler::RATIO_STRAIGHT_POLYGONAL;
+			  nType <= Sampler::QUADRATIC_CONST_K_NORM; ++nType ) {
+			PanLawTable table( nType, Sampler::K_NORM_DEFAULT );
+			for ( int ii = 0; ii <= 10000; ++ii ) {
+				const float fPan = -1.0f + 2.0f * ii / 10000;
+				const float fExact = PanLawTable::evaluate(
+					nType, Sampler::K_NORM_DEFAULT, fPan );
+				CPPUNIT_ASSERT_DOUBLES_EQUAL( fExact, table.getGain( fPan ), 1e-3 );
+			}
+			// Grid points are exact and values outside of [-1, 1]
+			// are clamped.
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(
+				PanLawTable::evaluate( nType, Sampler::K_NORM_DEFAULT, 0.0f ),
+				table.getGain( 0.0f ), 1e-6 );
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( table.getGain( 1.0f ),
+										  table.getGain( 1.5f ), 1e-6 );
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( table.getGain( -1.0f ),
+										  table.getGain( -1.5f ), 1e-6 );
+		}
+	}
+
+	/** Changing the pan law of a Song has to replace its table. */
+	void testSongUpdate()
+	{
+		auto pSong = std::make_shared<Song>( "test", "test", 120, 1.0 );
+		auto pTable = pSong->getPanLawTable();
+		CPPUNIT_ASSERT( pTable != nullptr );
+		CPPUNIT_ASSERT_EQUAL( pSong->getPanLawType(), pTable->getPanLawType() );
+
+		pSong->setPanLawType( Sampler::QUADRATIC_CONST_K_NORM );
+		CPPUNIT_ASSERT_EQUAL( static_cast<int>( Sampler::QUADRATIC_CONST_K_NORM ),
+							  pSong->getPanLawTable()->getPanLawType() );
+
+		pSong->setPanLawKNorm( 3.0f );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 3.0f, pSong->getPanLawTable()->getKNorm(), 1e-6 );
+
+		// Unchanged parameters keep the current table.
+		pTable = pSong->getPanLawTable();
+		pSong->setPanLawKNorm( 3.0f );
+		CPPUNIT_ASSERT( pTable == pSong->getPanLawTable() );
+
+		pSong->setPanLawType( 1000 );
+		CPPUNIT_ASSERT_EQUAL( static_cast<int>( Sampler::RATIO_STRAIGHT_POLYGONAL ),
+							  pSong->getPanLawType() );
+		CPPUNIT_ASSERT_EQUAL( static_cast<int>( Sampler::RATIO_STRAIGHT_POLYGONAL ),
+							  pSong->getPanLawTable()->getPanLawType() );
+
+		// The table handed out last must stay valid while the law is
+		// changed, as it might be used by the audio thread.
+		pTable = pSong->getPanLawTable();
+		for ( int ii = Sampler::RATIO_STRAIGHT_POLYGONAL;
+			  ii <= Sampler::QUADRATIC_CONST_K_NORM; ++ii ) {
+			pSong->setPanLawType( ii );
+		}
+		CPPUNIT_ASSERT_EQUAL( static_cast<int>( Sampler::RATIO_STRAIGHT_POLYGONAL ),
+							  pTable->getPanLawType() );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(
+			PanLawTable::evaluate( Sampler::RATIO_STRAIGHT_POLYGONAL, pTable->getKNorm(), 0.5f ),
+			pTable->getGain( 0.5f ), 1e-3 );
+	}
+};
@@ -0,0 +1,96 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Helpers/Random.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace H2Core;
+
+class RandomTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( RandomTest );
+	CPPUNIT_TEST( testSeed );
+	CPPUNIT_TEST( testUniform );
+	CPPUNIT_TEST( testGaussian );
+	CPPUNIT_TEST_SUITE_END();
+
+	public:
+
+	void testSeed()
+	{
+		Random random1( 42 ), random2( 42 ), random3( 43 );
+		bool bDiffers = false;
+		for ( int ii = 0; ii < 1000; ++ii ) {
+			const uint64_t nValue = random1.next();
+			CPPUNIT_ASSERT_EQUAL( nValue, random2.next() );
+			bDiffers = bDiffers || nValue != random3.next();
+		}
+		CPPUNIT_ASSERT( bDiffers );
+
+		// Reseeding restarts the sequence.
+		random1.seed( 42 );
+		random2.seed( 42 );
+		for ( int ii = 0; ii < 1000; ++ii ) {
+			CPPUNIT_ASSERT_EQUAL( random1.gaussian(), random2.gaussian() );
+		}
+	}
+
+	void testUniform()
+	{
+		Random random( 1 );
+		const int nMax = 7;
+		const int nDraws = 70000;
+		std::vector<int> histogram( nMax, 0 );
+		for ( int ii = 0; ii < nDraws; ++ii ) {
+			const int nValue = random.uniformInt( nMax );
+			CPPUNIT_ASSERT( nValue >= 0 && nValue < nMax );
+			++histogram[ nValue ];
+
+			const float fValue = random.uniform();
+			CPPUNIT_ASSERT( fValue >= 0.0f && fValue < 1.0f );
+		}
+		for ( const auto nCount : histogram ) {
+			CPPUNIT_ASSERT( std::abs( nCount - nDraws / nMax ) < 500 );
+		}
+	}
+
+	void testGaussian()
+	{
+		Random random( 2 );
+		const int nDraws = 1000000;
+		double fSum = 0, fSumSquares = 0;
+		int nTail = 0;
+		for ( int ii = 0; ii < nDraws; ++ii ) {
+			const double fValue = random.gaussian();
+			fSum += fValue;
+			fSumSquares += fValue * fValue;
+			if ( std::abs( fValue ) > 3 ) {
+				++nTail;
+			}
+		}
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, fSum / nDraws, 0.01 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 1.0, fSumSquares / nDraws, 0.01 );
+		// P( |x| > 3 ) = 0.27%
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0027, static_cast<double>( nTail ) / nDraws, 0.0005 );
+	}
+};
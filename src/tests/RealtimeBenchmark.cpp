@@ -0,0 +1,309 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <core/CoreActionController.h>
+#include <core/Hydrogen.h>
+#include <core/Timeline.h>
+#include <core/AudioEngine/AudioEngine.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentList.h>
+#include <core/Basics/Note.h>
+#include <core/Basics/Pattern.h>
+#include <core/Basics/PatternList.h>
+#include <core/Basics/Song.h>
+#include <core/FX/Effects.h>
+#include <core/IO/BenchmarkDriver.h>
+#include <core/Preferences/Preferences.h>
+#include <core/Sampler/Sampler.h>
+#include "TestHelper.h"
+#include "RealtimeBenchmark.h"
+
+#include <functional>
+#include <iostream>
+#include <memory>
+
+using namespace H2Core;
+
+bool RealtimeBenchmark::bEnabled = false;
+std::vector<int> RealtimeBenchmark::periods = { 64, 256, 1024 };
+int RealtimeBenchmark::nSampleRate = 48000;
+QString RealtimeBenchmark::sOutputFile = "";
+
+CPPUNIT_TEST_SUITE_REGISTRATION( RealtimeBenchmark );
+
+/** Amount of audio rendered per scenario and period. */
+static const double fScenarioSeconds = 2.0;
+
+struct Scenario {
+	QString sName;
+	/** Prepares the freshly loaded song. Returns false if the
+	 * scenario is not available in this build. */
+	std::function<bool( std::shared_ptr<Song> )> setup;
+	std::function<void()> tearDown;
+};
+
+/** Puts a note of every instrument on every 16th of every
+ * pattern. Each position gets @a nLayers notes of different
+ * pitch. */
+static void fillPatterns( std::shared_ptr<Song> pSong, int nLayers ) {
+	auto pInstrumentList = pSong->getInstrumentList();
+	for ( auto& pPattern : *pSong->getPatternList() ) {
+		for ( int nPos = 0; nPos < pPattern->get_length(); nPos += 12 ) {
+			for ( int ii = 0; ii < pInstrumentList->size(); ++ii ) {
+				for ( int nLayer = 0; nLayer < nLayers; ++nLayer ) {
+					pPattern->insert_note( new Note( pInstrumentList->get( ii ), nPos,
+													 0.8f, 0.f, -1, nLayer * 0.5f ) );
+				}
+			}
+		}
+	}
+}
+
+static std::vector<Scenario> createScenarios() {
+	auto pSampler = Hydrogen::get_instance()->getAudioEngine()->getSampler();
+	auto pPref = Preferences::get_instance();
+	auto noTearDown = [](){};
+
+	std::vector<Scenario> scenarios;
+	scenarios.push_back( { "baseline", []( std::shared_ptr<Song> ) { return true; },
+						   noTearDown } );
+	scenarios.push_back( { "dense",
+						   []( std::shared_ptr<Song> pSong ) {
+							   fillPatterns( pSong, 1 );
+							   return true; }, noTearDown } );
+	scenarios.push_back( { "layering",
+						   []( std::shared_ptr<Song> pSong ) {
+							   fillPatterns( pSong, 4 );
+							   return true; }, noTearDown } );
+	scenarios.push_back( { "filter",
+						   []( std::shared_ptr<Song> pSong ) {
+							   fillPatterns( pSong, 1 );
+							   auto pInstrumentList = pSong->getInstrumentList();
+							   for ( int ii = 0; ii < pInstrumentList->size(); ++ii ) {
+								   auto pInstrument = pInstrumentList->get( ii );
+								   pInstrument->set_filter_active( true );
+								   pInstrument->set_filter_cutoff( 0.4 );
+								   pInstrument->set_filter_resonance( 0.6 );
+							   }
+							   return true; }, noTearDown } );
+
+	const auto interpolateMode = pSampler->getInterpolateMode();
+	for ( const auto& mode : { Interpolation::InterpolateMode::Linear,
+							   Interpolation::InterpolateMode::Cosine,
+							   Interpolation::InterpolateMode::Third,
+							   Interpolation::InterpolateMode::Cubic,
+							   Interpolation::InterpolateMode::Hermite,
+							   Interpolation::InterpolateMode::Sinc } ) {
+		scenarios.push_back( { QString( "interpolation_%1" ).arg( static_cast<int>( mode ) ),
+							   [=]( std::shared_ptr<Song> pSong ) {
+								   fillPatterns( pSong, 1 );
+								   // Pitch all instruments to force resampling.
+								   auto pInstrumentList = pSong->getInstrumentList();
+								   for ( int ii = 0; ii < pInstrumentList->size(); ++ii ) {
+									   pInstrumentList->get( ii )->set_pitch_offset( 0.3 );
+								   }
+								   pSampler->setInterpolateMode( mode );
+								   return true; },
+							   [=]() { pSampler->setInterpolateMode( interpolateMode ); } } );
+	}
+
+	scenarios.push_back( { "humanize",
+						   []( std::shared_ptr<Song> pSong ) {
+							   fillPatterns( pSong, 1 );
+							   pSong->setHumanizeTimeValue( 1.0 );
+							   pSong->setHumanizeVelocityValue( 1.0 );
+							   pSong->setSwingFactor( 0.5 );
+							   return true; }, noTearDown } );
+	scenarios.push_back( { "tempo_changes",
+						   []( std::shared_ptr<Song> pSong ) {
+							   fillPatterns( pSong, 1 );
+							   pSong->setIsTimelineActivated( true );
+							   auto pTimeline = pSong->getTimeline();
+							   const int nColumns = pSong->getPatternGroupVector()->size();
+							   for ( int nColumn = 0; nColumn < nColumns; ++nColumn ) {
+								   pTimeline->addTempoMarker( nColumn, nColumn % 2 == 0 ? 150 : 90 );
+							   }
+							   return true; }, noTearDown } );
+
+	// Without a JackAudioDriver there are no per-track buffers
+	// to write into. But the per-track gains are still computed.
+	const bool bJackTrackOuts = pPref->m_bJackTrackOuts;
+	scenarios.push_back( { "track_outs",
+						   [=]( std::shared_ptr<Song> pSong ) {
+							   fillPatterns( pSong, 1 );
+							   pPref->m_bJackTrackOuts = true;
+							   return true; },
+						   [=]() { pPref->m_bJackTrackOuts = bJackTrackOuts; } } );
+
+	scenarios.push_back( { "ladspa",
+						   []( std::shared_ptr<Song> pSong ) {
+#ifdef H2CORE_HAVE_LADSPA
+							   fillPatterns( pSong, 1 );
+							   auto pEffects = Effects::get_instance();
+							   int nFX = 0;
+							   for ( const auto& pInfo : pEffects->getPluginList() ) {
+								   if ( nFX >= MAX_FX ) {
+									   break;
+								   }
+								   if ( pInfo->m_nIAPorts != 2 || pInfo->m_nOAPorts != 2 ) {
+									   continue;
+								   }
+								   auto pFX = LadspaFX::load( pInfo->m_sFilename, pInfo->m_sLabel,
+															  RealtimeBenchmark::getSampleRate() );
+								   if ( pFX == nullptr ) {
+									   continue;
+								   }
+								   pFX->setEnabled( true );
+								   pEffects->setLadspaFX( pFX, nFX );
+								   ++nFX;
+							   }
+
+							   auto pInstrumentList = pSong->getInstrumentList();
+							   for ( int ii = 0; ii < pInstrumentList->size(); ++ii ) {
+								   for ( int nSend = 0; nSend < nFX; ++nSend ) {
+									   pInstrumentList->get( ii )->set_fx_level( 0.5, nSend );
+								   }
+							   }
+							   return nFX > 0;
+#else
+							   return false;
+#endif
+						   },
+						   []() {
+#ifdef H2CORE_HAVE_LADSPA
+							   for ( int nFX = 0; nFX < MAX_FX; ++nFX ) {
+								   Effects::get_instance()->setLadspaFX( nullptr, nFX );
+							   }
+							   Hydrogen::get_instance()->restartLadspaFX();
+#endif
+						   } } );
+
+	return scenarios;
+}
+
+static QJsonObject toJson( const QString& sScenario, const BenchmarkDriver::Statistics& stats ) {
+	QJsonObject result;
+	result.insert( "scenario", sScenario );
+	result.insert( "period", static_cast<int>( stats.nBufferSize ) );
+	result.insert( "sample_rate", static_cast<int>( stats.nSampleRate ) );
+	result.insert( "cycles", stats.nCycles );
+	result.insert( "deadline_us", stats.fDeadline );
+	result.insert( "mean_us", stats.fMean );
+	result.insert( "p50_us", stats.fMedian );
+	result.insert( "p99_us", stats.fP99 );
+	result.insert( "max_us", stats.fMax );
+	result.insert( "deadline_misses", stats.nDeadlineMisses );
+	result.insert( "voices_per_second", stats.fVoicesPerSecond );
+	return result;
+}
+
+void RealtimeBenchmark::realtimeBenchmark(void)
+{
+	if ( !bEnabled ) {
+		return;
+	}
+
+	auto pHydrogen = Hydrogen::get_instance();
+	auto pPref = Preferences::get_instance();
+	auto pCoreActionController = pHydrogen->getCoreActionController();
+	const QString sFormerDriver = pPref->m_sAudioDriver;
+	const int nFormerBufferSize = pPref->m_nBufferSize;
+	const int nFormerSampleRate = pPref->m_nSampleRate;
+
+	const auto sSongFile = H2TEST_FILE( "functional/test.h2song" );
+	const auto scenarios = createScenarios();
+
+	QJsonArray results;
+	QJsonArray skipped;
+	for ( const int nPeriod : periods ) {
+		CPPUNIT_ASSERT( nPeriod >= 32 && nPeriod <= 2048 );
+		pPref->m_sAudioDriver = "Benchmark";
+		pPref->m_nBufferSize = nPeriod;
+		pPref->m_nSampleRate = nSampleRate;
+		pHydrogen->restartDrivers();
+
+		auto pDriver = dynamic_cast<BenchmarkDriver*>( pHydrogen->getAudioOutput() );
+		CPPUNIT_ASSERT( pDriver != nullptr );
+		const int nCycles = static_cast<int>( fScenarioSeconds * nSampleRate / nPeriod );
+
+		for ( const auto& scenario : scenarios ) {
+			auto pSong = Song::load( sSongFile );
+			CPPUNIT_ASSERT( pSong != nullptr );
+			pSong->setMode( Song::Mode::Song );
+			pSong->setLoopMode( Song::LoopMode::Enabled );
+
+			if ( ! scenario.setup( pSong ) ) {
+				scenario.tearDown();
+				if ( nPeriod == periods.front() ) {
+					skipped.append( scenario.sName );
+				}
+				continue;
+			}
+			pHydrogen->setSong( pSong );
+			pHydrogen->restartLadspaFX();
+
+			pCoreActionController->locateToColumn( 0 );
+			pHydrogen->sequencer_play();
+
+			// Warm up caches and let the engine start transport.
+			pDriver->run( 16, false );
+			const auto stats = pDriver->run( nCycles, true );
+
+			pHydrogen->sequencer_stop();
+			pDriver->run( 4, false );
+			scenario.tearDown();
+
+			qDebug() << QString( "%1 (%2 frames): p50 %3us, p99 %4us, max %5us, deadline %6us, misses %7" )
+				.arg( scenario.sName ).arg( nPeriod )
+				.arg( stats.fMedian, 0, 'f', 1 ).arg( stats.fP99, 0, 'f', 1 )
+				.arg( stats.fMax, 0, 'f', 1 ).arg( stats.fDeadline, 0, 'f', 1 )
+				.arg( stats.nDeadlineMisses );
+			results.append( toJson( scenario.sName, stats ) );
+		}
+	}
+
+	QJsonObject report;
+	report.insert( "benchmark", "realtime" );
+	report.insert( "sample_rate", nSampleRate );
+	report.insert( "results", results );
+	report.insert( "skipped", skipped );
+	const QByteArray json = QJsonDocument( report ).toJson();
+
+	if ( sOutputFile.isEmpty() ) {
+		std::cout << json.constData() << std::endl;
+	} else {
+		QFile file( sOutputFile );
+		CPPUNIT_ASSERT( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+		file.write( json );
+		file.close();
+	}
+
+	pPref->m_sAudioDriver = sFormerDriver;
+	pPref->m_nBufferSize = nFormerBufferSize;
+	pPref->m_nSampleRate = nFormerSampleRate;
+	pHydrogen->restartDrivers();
+}
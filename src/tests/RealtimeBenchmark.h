@@ -0,0 +1,54 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#ifndef REALTIME_BENCHMARK_H
+#define REALTIME_BENCHMARK_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <QString>
+#include <vector>
+
+/**
+ * Replays a set of load scenarios using the BenchmarkDriver at
+ * different period sizes and reports the per-cycle processing times
+ * as JSON.
+ */
+class RealtimeBenchmark : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE(RealtimeBenchmark);
+	CPPUNIT_TEST(realtimeBenchmark);
+	CPPUNIT_TEST_SUITE_END();
+	static bool bEnabled;
+	static std::vector<int> periods;
+	static int nSampleRate;
+	static QString sOutputFile;
+ public:
+	void realtimeBenchmark(void);
+	static void enable() { bEnabled = true; }
+	/** Period sizes (32 - 2048 frames) to benchmark. */
+	static void setPeriods( const std::vector<int>& newPeriods ) { periods = newPeriods; }
+	static void setSampleRate( int nNewSampleRate ) { nSampleRate = nNewSampleRate; }
+	static int getSampleRate() { return nSampleRate; }
+	/** File the JSON report is written to. If empty, it is printed
+	 * to stdout. */
+	static void setOutputFile( const QString& sFile ) { sOutputFile = sFile; }
+};
+
+#endif
@@ -25,9 +25,15 @@
 
 #include <core/Basics/Sample.h>
 
+#include <algorithm>
+#include <cmath>
+
 class SampleTest : public CppUnit::TestCase {
 	CPPUNIT_TEST_SUITE( SampleTest );
 	CPPUNIT_TEST( testLoadInvalidSample );
+	CPPUNIT_TEST( testLevelEnvelopes );
+	CPPUNIT_TEST( testConvertSampleRate );
+	CPPUNIT_TEST( testWaveformRange );
 
 	CPPUNIT_TEST_SUITE_END();
 
@@ -45,4 +51,137 @@ class SampleTest : public CppUnit::TestCase {
 		pSample = H2Core::Sample::load( H2TEST_FILE("drumkits/baseKit/drumkit.xml") );
 		CPPUNIT_ASSERT(pSample == nullptr);
 	}
+
+	void testLevelEnvelopes()
+	{
+		// A loud first block followed by two quiet ones.
+		const int nBlockSize = H2Core::Sample::nLevelEnvelopeBlockSize;
+		const int nFrames = 3 * nBlockSize;
+		float* pData_L = new float[ nFrames ];
+		float* pData_R = new float[ nFrames ];
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			const float fValue = ii < nBlockSize ? 0.5 : 0.01;
+			pData_L[ ii ] = ii % 2 == 0 ? fValue : -fValue;
+			pData_R[ ii ] = 0;
+		}
+		pData_R[ 2 * nBlockSize + 1 ] = -0.1;
+
+		auto pSample = std::make_shared<H2Core::Sample>(
+			"/tmp/levelEnvelopes.wav", H2Core::License(), nFrames, 44100,
+			pData_L, pData_R );
+		CPPUNIT_ASSERT( pSample->hasLevelEnvelopes() );
+
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5, pSample->getPeak( 0 ), 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.01, pSample->getPeak( nBlockSize ), 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.1, pSample->getPeak( nFrames - 1 ), 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, pSample->getPeak( nFrames ), 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5 / std::sqrt( 2 ), pSample->getRms( 10 ), 1e-6 );
+
+		// The remaining peak must cover everything still to come.
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5, pSample->getRemainingPeak( 0 ), 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.1, pSample->getRemainingPeak( nBlockSize ), 1e-6 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.1, pSample->getRemainingPeak( 2 * nBlockSize ), 1e-6 );
+
+		// Copies share the same envelopes.
+		auto pCopy = std::make_shared<H2Core::Sample>( pSample );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.1, pCopy->getRemainingPeak( nBlockSize ), 1e-6 );
+
+		pSample->unload();
+		CPPUNIT_ASSERT( ! pSample->hasLevelEnvelopes() );
+	}
+
+	void testConvertSampleRate()
+	{
+		auto createSine = []( double fFrequency, int nSampleRate, int nFrames ) {
+			float* pData_L = new float[ nFrames ];
+			float* pData_R = new float[ nFrames ];
+			for ( int ii = 0; ii < nFrames; ++ii ) {
+				pData_L[ ii ] = std::sin( 2 * M_PI * fFrequency * ii / nSampleRate );
+				pData_R[ ii ] = 0.5 * pData_L[ ii ];
+			}
+			return std::make_shared<H2Core::Sample>(
+				"/tmp/convertSampleRate.wav", H2Core::License(), nFrames,
+				nSampleRate, pData_L, pData_R );
+		};
+
+		// Upsampling reconstructs the waveform.
+		auto pSample = createSine( 1000, 22050, 4410 );
+		CPPUNIT_ASSERT( pSample->convertSampleRate( 44100 ) );
+		CPPUNIT_ASSERT_EQUAL( 44100, pSample->get_sample_rate() );
+		CPPUNIT_ASSERT_EQUAL( 8820, pSample->get_frames() );
+		CPPUNIT_ASSERT( pSample->hasLevelEnvelopes() );
+		for ( int ii = 1000; ii < 7000; ++ii ) {
+			const double fExpected = std::sin( 2 * M_PI * 1000 * ii / 44100 );
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( fExpected, pSample->get_data_l()[ ii ], 1e-4 );
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.5 * fExpected, pSample->get_data_r()[ ii ], 1e-4 );
+		}
+		CPPUNIT_ASSERT( ! pSample->convertSampleRate( 44100 ) );
+
+		// Content above the new Nyquist frequency must not alias
+		// into the audible range.
+		pSample = createSine( 20000, 44100, 8820 );
+		CPPUNIT_ASSERT( pSample->convertSampleRate( 22050 ) );
+		CPPUNIT_ASSERT_EQUAL( 4410, pSample->get_frames() );
+		for ( int ii = 500; ii < 3900; ++ii ) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL( 0.0, pSample->get_data_l()[ ii ], 1e-3 );
+		}
+	}
+
+	void testWaveformRange()
+	{
+		// Not a multiple of the block size to get a partial last
+		// block.
+		const int nFrames = 100 * H2Core::WaveformPeaks::nBlockSize + 17;
+		float* pData_L = new float[ nFrames ];
+		float* pData_R = new float[ nFrames ];
+		for ( int ii = 0; ii < nFrames; ++ii ) {
+			pData_L[ ii ] = std::sin( 0.05 * ii ) * ( 1 + ii % 7 ) / 8;
+			pData_R[ ii ] = -0.5 * pData_L[ ii ];
+		}
+		auto pSample = std::make_shared<H2Core::Sample>(
+			"/tmp/waveformRange.wav", H2Core::License(), nFrames, 44100,
+			pData_L, pData_R );
+
+		auto pPeaks = pSample->getWaveformPeaks();
+		CPPUNIT_ASSERT( pPeaks != nullptr );
+		CPPUNIT_ASSERT_EQUAL( nFrames, pPeaks->getFrames() );
+		CPPUNIT_ASSERT_EQUAL( 101, pPeaks->getBlocks() );
+
+		const std::vector<std::pair<int, int>> ranges = {
+			{ 0, nFrames }, { 0, 1 }, { 5, 60 }, { 63, 65 }, { 64, 128 },
+			{ 100, 3000 }, { 1234, 5678 }, { nFrames - 20, nFrames },
+			{ nFrames - 100, nFrames + 100 }, { -10, 10 } };
+		for ( const auto& [ nStart, nEnd ] : ranges ) {
+			for ( int nChannel = 0; nChannel < 2; ++nChannel ) {
+				const float* pData = nChannel == 0 ? pData_L : pData_R;
+				const int nFirst = std::max( nStart, 0 );
+				const int nLast = std::min( nEnd, nFrames );
+				float fMin = pData[ nFirst ];
+				float fMax = pData[ nFirst ];
+				double fSumSquares = 0;
+				for ( int ii = nFirst; ii < nLast; ++ii ) {
+					fMin = std::min( fMin, pData[ ii ] );
+					fMax = std::max( fMax, pData[ ii ] );
+					fSumSquares += pData[ ii ] * pData[ ii ];
+				}
+
+				const auto range = pSample->getWaveformRange( nChannel, nStart, nEnd );
+				CPPUNIT_ASSERT_EQUAL( nLast - nFirst, range.nFrames );
+				CPPUNIT_ASSERT_EQUAL( fMin, range.fMin );
+				CPPUNIT_ASSERT_EQUAL( fMax, range.fMax );
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(
+					std::sqrt( fSumSquares / ( nLast - nFirst ) ), range.getRms(), 1e-6 );
+			}
+		}
+		CPPUNIT_ASSERT_EQUAL( 0, pSample->getWaveformRange( 0, 10, 10 ).nFrames );
+		CPPUNIT_ASSERT_EQUAL( 0, pSample->getWaveformRange( 2, 0, 10 ).nFrames );
+
+		// Altering the data replaces the pyramid.
+		CPPUNIT_ASSERT( pSample->convertSampleRate( 48000 ) );
+		CPPUNIT_ASSERT_EQUAL( pSample->get_frames(),
+							  pSample->getWaveformPeaks()->getFrames() );
+
+		pSample->unload();
+		CPPUNIT_ASSERT( pSample->getWaveformPeaks() == nullptr );
+	}
 };
@@ -0,0 +1,112 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Helpers/SeqLock.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace H2Core;
+
+class SeqLockTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( SeqLockTest );
+	CPPUNIT_TEST( testStoreLoad );
+	CPPUNIT_TEST( testConcurrentReaders );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** Odd size to cover a partially used last word. */
+	struct Value {
+		long long nFrame;
+		double fTick;
+		int nCheck;
+		float fBpm;
+		bool bPlaying;
+	};
+
+	static Value createValue( long long nIndex ) {
+		Value value;
+		value.nFrame = nIndex;
+		value.fTick = nIndex * 0.5;
+		value.nCheck = static_cast<int>( nIndex * 7 );
+		value.fBpm = static_cast<float>( nIndex % 1000 );
+		value.bPlaying = nIndex % 2 == 0;
+		return value;
+	}
+
+	static bool isConsistent( const Value& value ) {
+		return value.fTick == value.nFrame * 0.5 &&
+			value.nCheck == static_cast<int>( value.nFrame * 7 ) &&
+			value.fBpm == static_cast<float>( value.nFrame % 1000 ) &&
+			value.bPlaying == ( value.nFrame % 2 == 0 );
+	}
+
+	public:
+
+	void testStoreLoad()
+	{
+		SeqLock<Value> lock;
+		const size_t nVersion = lock.getVersion();
+		lock.store( createValue( 42 ) );
+		CPPUNIT_ASSERT_EQUAL( nVersion + 1, lock.getVersion() );
+
+		const Value value = lock.load();
+		CPPUNIT_ASSERT_EQUAL( 42LL, value.nFrame );
+		CPPUNIT_ASSERT( isConsistent( value ) );
+	}
+
+	/** Readers racing a writer must never see a torn value and the
+	 * values they see must not go back in time. */
+	void testConcurrentReaders()
+	{
+		SeqLock<Value> lock;
+		lock.store( createValue( 0 ) );
+		std::atomic<bool> bDone( false );
+		std::atomic<int> nErrors( 0 );
+
+		std::vector<std::thread> readers;
+		for ( int ii = 0; ii < 3; ++ii ) {
+			readers.emplace_back( [&]() {
+				long long nLast = 0;
+				while ( ! bDone.load() ) {
+					const Value value = lock.load();
+					if ( ! isConsistent( value ) || value.nFrame < nLast ) {
+						++nErrors;
+					}
+					nLast = value.nFrame;
+				}
+			} );
+		}
+
+		for ( long long nn = 1; nn <= 200000; ++nn ) {
+			lock.store( createValue( nn ) );
+		}
+		bDone = true;
+		for ( auto& reader : readers ) {
+			reader.join();
+		}
+
+		CPPUNIT_ASSERT_EQUAL( 0, nErrors.load() );
+		CPPUNIT_ASSERT_EQUAL( 200000LL, lock.load().nFrame );
+	}
+};
@@ -0,0 +1,277 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <core/Basics/Drumkit.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/InstrumentList.h>
+#include <core/Basics/Note.h>
+#include <core/Basics/Pattern.h>
+#include <core/Basics/PatternList.h>
+#include <core/Basics/Song.h>
+#include <core/Helpers/Filesystem.h>
+#include <core/Smf/SMF.h>
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include "TestHelper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+using namespace H2Core;
+
+class SmfReaderTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( SmfReaderTest );
+	CPPUNIT_TEST( testReadFormats );
+	CPPUNIT_TEST( testCreatePattern );
+	CPPUNIT_TEST( testInvalidFiles );
+	CPPUNIT_TEST( testConvertFiles );
+	CPPUNIT_TEST( testReadThroughput );
+	CPPUNIT_TEST_SUITE_END();
+
+	/** Notes of @a reader ordered by tick and key. The order of
+	 * simultaneous notes depends on the writer. */
+	static std::vector<std::tuple<int, int, int>> sortedNotes( const SMFReader& reader ) {
+		std::vector<std::tuple<int, int, int>> notes;
+		for ( const auto& note : reader.getNotes() ) {
+			notes.push_back( { note.nTick, note.nKey, note.nVelocity } );
+		}
+		std::sort( notes.begin(), notes.end() );
+		return notes;
+	}
+
+	/** Format 1 file of @a nTracks tracks, each holding @a nNotes
+	 * note on/off pairs of a different key. */
+	static QByteArray createFile( int nTracks, int nNotes ) {
+		QByteArray data( "MThd\0\0\0\x06\0\x01", 10 );
+		data.append( static_cast<char>( nTracks >> 8 ) );
+		data.append( static_cast<char>( nTracks ) );
+		data.append( "\0\x60", 2 ); // 96 ticks per quarter
+
+		for ( int nTrack = 0; nTrack < nTracks; ++nTrack ) {
+			QByteArray track;
+			const char nKey = 36 + nTrack;
+			for ( int ii = 0; ii < nNotes; ++ii ) {
+				// Note on using running status for the note off.
+				track.append( "\x06\x99", 2 );
+				track.append( nKey );
+				track.append( static_cast<char>( 100 ) );
+				track.append( static_cast<char>( 6 ) );
+				track.append( nKey );
+				track.append( '\0' );
+			}
+			track.append( "\0\xff\x2f\0", 4 );
+
+			data.append( "MTrk" );
+			const int nSize = track.size();
+			for ( int nShift = 24; nShift >= 0; nShift -= 8 ) {
+				data.append( static_cast<char>( nSize >> nShift ) );
+			}
+			data.append( track );
+		}
+		return data;
+	}
+
+	public:
+
+	void testReadFormats()
+	{
+		SMFReader reader;
+		CPPUNIT_ASSERT( reader.read( H2TEST_FILE( "functional/smf0.test.ref.mid" ) ) );
+		CPPUNIT_ASSERT_EQUAL( 0, reader.getFormat() );
+		CPPUNIT_ASSERT_EQUAL( 192, reader.getTPQN() );
+		CPPUNIT_ASSERT_EQUAL( 120.0f, reader.getBpm() );
+		CPPUNIT_ASSERT_EQUAL( 4, reader.getTimeSignatureNumerator() );
+		CPPUNIT_ASSERT_EQUAL( 4, reader.getTimeSignatureDenominator() );
+		CPPUNIT_ASSERT( reader.getName() == "Untitled Song" );
+		CPPUNIT_ASSERT_EQUAL( static_cast<size_t>( 13 ), reader.getNotes().size() );
+		const auto notes = sortedNotes( reader );
+
+		// The same song exported in format 1 has to yield the same
+		// notes with the tracks merged by tick.
+		for ( const auto& sFile : { "functional/smf1single.test.ref.mid",
+									"functional/smf1multi.test.ref.mid" } ) {
+			CPPUNIT_ASSERT( reader.read( H2TEST_FILE( sFile ) ) );
+			CPPUNIT_ASSERT_EQUAL( 1, reader.getFormat() );
+			CPPUNIT_ASSERT( std::is_sorted( reader.getNotes().begin(), reader.getNotes().end(),
+											[]( const SMFReader::NoteEvent& a,
+												const SMFReader::NoteEvent& b ) {
+												return a.nTick < b.nTick; } ) );
+			CPPUNIT_ASSERT( sortedNotes( reader ) == notes );
+		}
+	}
+
+	void testCreatePattern()
+	{
+		auto pSong = Song::load( H2TEST_FILE( "functional/test.h2song" ) );
+		CPPUNIT_ASSERT( pSong != nullptr );
+		auto pInstrumentList = pSong->getInstrumentList();
+		Pattern* pOriginal = pSong->getPatternList()->get( 0 );
+
+		SMFReader reader;
+		CPPUNIT_ASSERT( reader.read( H2TEST_FILE( "functional/smf0.test.ref.mid" ) ) );
+
+		int nUnmapped = -1;
+		Pattern* pPattern = reader.createPattern( pInstrumentList, "imported", 1, &nUnmapped );
+		CPPUNIT_ASSERT_EQUAL( 0, nUnmapped );
+		CPPUNIT_ASSERT( pPattern->get_name() == "imported" );
+		CPPUNIT_ASSERT_EQUAL( pOriginal->get_length(), pPattern->get_length() );
+		CPPUNIT_ASSERT_EQUAL( pOriginal->get_notes()->size(), pPattern->get_notes()->size() );
+		for ( const auto& [ nPosition, pNote ] : *pOriginal->get_notes() ) {
+			Note* pImported = pPattern->find_note( nPosition, -1, pNote->get_instrument() );
+			CPPUNIT_ASSERT( pImported != nullptr );
+			CPPUNIT_ASSERT( std::fabs( pImported->get_velocity() - pNote->get_velocity() ) < 0.01 );
+		}
+		delete pPattern;
+
+		// Quantizing to half notes merges notes of the same
+		// instrument. The ones at the end wrap around.
+		pPattern = reader.createPattern( pInstrumentList, "quantized", 96 );
+		CPPUNIT_ASSERT_EQUAL( pOriginal->get_length(), pPattern->get_length() );
+		CPPUNIT_ASSERT( pPattern->get_notes()->size() < pOriginal->get_notes()->size() );
+		for ( const auto& [ nPosition, pNote ] : *pPattern->get_notes() ) {
+			CPPUNIT_ASSERT( nPosition == 0 || nPosition == 96 );
+		}
+		delete pPattern;
+
+		pPattern = reader.createPattern( std::make_shared<InstrumentList>(), "empty", 1,
+										 &nUnmapped );
+		CPPUNIT_ASSERT_EQUAL( 13, nUnmapped );
+		CPPUNIT_ASSERT( pPattern->get_notes()->empty() );
+		delete pPattern;
+	}
+
+	void testInvalidFiles()
+	{
+		QFile file( H2TEST_FILE( "functional/smf0.test.ref.mid" ) );
+		CPPUNIT_ASSERT( file.open( QIODevice::ReadOnly ) );
+		const QByteArray data = file.readAll();
+		auto parse = [&]( const QByteArray& content ) {
+			SMFReader reader;
+			return reader.parse( reinterpret_cast<const uint8_t*>( content.constData() ),
+								 content.size() );
+		};
+		CPPUNIT_ASSERT( parse( data ) );
+
+		// Truncated in the middle of an event.
+		CPPUNIT_ASSERT( ! parse( data.left( 40 ) ) );
+		// Not a MIDI file.
+		CPPUNIT_ASSERT( ! parse( QByteArray( "RIFF\0\0\0\x06\0\0\0\x01\0\xc0", 14 ) ) );
+		// Format 2
+		QByteArray format2( data );
+		format2[ 9 ] = 2;
+		CPPUNIT_ASSERT( ! parse( format2 ) );
+		// SMPTE time division
+		QByteArray smpte( data );
+		smpte[ 12 ] = static_cast<char>( 0xE7 );
+		CPPUNIT_ASSERT( ! parse( smpte ) );
+	}
+
+	void testConvertFiles()
+	{
+		auto pDrumkit = Drumkit::load( Filesystem::sys_drumkits_dir() + "GMRockKit",
+									   false, true );
+		CPPUNIT_ASSERT( pDrumkit != nullptr );
+
+		QTemporaryDir sourceDir( Filesystem::tmp_dir() + "-XXXXXX" );
+		QTemporaryDir targetDir( Filesystem::tmp_dir() + "-XXXXXX" );
+		const int nFiles = 200;
+		QStringList files;
+		for ( int ii = 0; ii < nFiles; ++ii ) {
+			const QString sFile = QString( "%1/groove%2.mid" ).arg( sourceDir.path() ).arg( ii );
+			CPPUNIT_ASSERT( QFile::copy( H2TEST_FILE( "functional/smf1multi.test.ref.mid" ),
+										 sFile ) );
+			files << sFile;
+		}
+		// Same name as the first file but in a different folder.
+		CPPUNIT_ASSERT( QDir( sourceDir.path() ).mkdir( "other" ) );
+		const QString sDuplicate = sourceDir.path() + "/other/groove0.mid";
+		CPPUNIT_ASSERT( QFile::copy( H2TEST_FILE( "functional/smf1multi.test.ref.mid" ),
+									 sDuplicate ) );
+		files << sDuplicate;
+		files << sourceDir.path() + "/nonExistent.mid";
+
+		QElapsedTimer timer;
+		timer.start();
+		const auto results = SMFReader::convertFiles( files, targetDir.path(), pDrumkit );
+		const double fSeconds = std::max( timer.nsecsElapsed() / 1e9, 1e-9 );
+		std::cout << "\nSMF import: " << static_cast<int>( nFiles / fSeconds ) <<
+			" files/s into .h2pattern" << std::endl;
+
+		CPPUNIT_ASSERT_EQUAL( static_cast<size_t>( nFiles + 2 ), results.size() );
+		for ( int ii = 0; ii <= nFiles; ++ii ) {
+			CPPUNIT_ASSERT( results[ ii ].bSuccess );
+			CPPUNIT_ASSERT( results[ ii ].sSourceFile == files[ ii ] );
+			CPPUNIT_ASSERT_EQUAL( 13, results[ ii ].nNotes );
+			CPPUNIT_ASSERT_EQUAL( 0, results[ ii ].nUnmapped );
+		}
+		CPPUNIT_ASSERT( ! results.back().bSuccess );
+		CPPUNIT_ASSERT( results[ nFiles ].sPatternFile != results[ 0 ].sPatternFile );
+		CPPUNIT_ASSERT( QFileInfo( results[ nFiles ].sPatternFile ).fileName() ==
+						"groove0_2" + Filesystem::patterns_ext );
+
+		Pattern* pPattern = Pattern::load_file( results[ 0 ].sPatternFile,
+												pDrumkit->get_instruments() );
+		CPPUNIT_ASSERT( pPattern != nullptr );
+		CPPUNIT_ASSERT( pPattern->get_name() == "groove0" );
+		CPPUNIT_ASSERT_EQUAL( static_cast<size_t>( 13 ), pPattern->get_notes()->size() );
+		delete pPattern;
+	}
+
+	void testReadThroughput()
+	{
+		const int nTracks = 8;
+		const int nNotes = 125000;
+		const QByteArray data = createFile( nTracks, nNotes );
+		const int nRuns = 10;
+
+		SMFReader reader;
+		QElapsedTimer timer;
+		timer.start();
+		for ( int ii = 0; ii < nRuns; ++ii ) {
+			CPPUNIT_ASSERT( reader.parse( reinterpret_cast<const uint8_t*>( data.constData() ),
+										  data.size() ) );
+		}
+		const double fSeconds = std::max( timer.nsecsElapsed() / 1e9, 1e-9 ) / nRuns;
+		std::cout << "\nSMF import: " <<
+			static_cast<int>( nTracks * nNotes / fSeconds / 1e6 ) << " M notes/s, " <<
+			static_cast<int>( data.size() / fSeconds / 1e6 ) << " MB/s" << std::endl;
+
+		const auto& notes = reader.getNotes();
+		CPPUNIT_ASSERT_EQUAL( static_cast<size_t>( nTracks * nNotes ), notes.size() );
+		// Merged in track order.
+		for ( int ii = 0; ii < nTracks; ++ii ) {
+			CPPUNIT_ASSERT_EQUAL( 6, notes[ ii ].nTick );
+			CPPUNIT_ASSERT_EQUAL( 36 + ii, static_cast<int>( notes[ ii ].nKey ) );
+		}
+		CPPUNIT_ASSERT_EQUAL( nNotes * 12 - 6, notes.back().nTick );
+		CPPUNIT_ASSERT_EQUAL( nNotes * 12, reader.getEndTick() );
+	}
+};
@@ -263,6 +263,21 @@ void TransportTest::testNoteEnqueuingTimeline() {
 	}
 }		
 
+void TransportTest::testSubBlockMidiTiming() {
+	auto pHydrogen = Hydrogen::get_instance();
+	auto pSong = Song::load( QString( H2TEST_FILE( "song/AE_noteEnqueuingTimeline.h2song" ) ) );
+
+	CPPUNIT_ASSERT( pSong != nullptr );
+
+	pHydrogen->getCoreActionController()->openSong( pSong );
+
+	std::vector<int> indices{ 0, 5, 7 };
+	for ( auto ii : indices ) {
+		TestHelper::varyAudioDriverConfig( ii );
+		perform( &AudioEngineTests::testSubBlockMidiTiming );
+	}
+}
+
 void TransportTest::perform( std::function<void()> func ) {
 	try {
 		func();
@@ -40,6 +40,7 @@ class TransportTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST( testSampleConsistency );
 	CPPUNIT_TEST( testNoteEnqueuing );
 	CPPUNIT_TEST( testNoteEnqueuingTimeline );
+	CPPUNIT_TEST( testSubBlockMidiTiming );
 	CPPUNIT_TEST_SUITE_END();
 private:
 	void perform( std::function<void()> func );
@@ -68,4 +69,9 @@ public:
 	 * Sampler is consistent on tempo change.
 	 */
 	void testNoteEnqueuingTimeline();
+	/**
+	 * Checks the offsets of the MIDI notes sent while rendering in
+	 * sub-blocks a song containing tempo changes.
+	 */
+	void testSubBlockMidiTiming();
 };
@@ -0,0 +1,171 @@
+/*
+ * Hydrogen
+ * Copyright(c) 2008-2022 The hydrogen development team [hydrogen-devel@lists.sourceforge.net]
+ *
+ * http://www.hydrogen-music.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY, without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see https://www.gnu.org/licenses
+ *
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <core/Basics/Adsr.h>
+#include <core/Basics/Instrument.h>
+#include <core/Basics/Note.h>
+#include <core/Sampler/VoiceManager.h>
+
+#include <vector>
+
+using namespace H2Core;
+
+class VoiceManagerTest : public CppUnit::TestCase {
+	CPPUNIT_TEST_SUITE( VoiceManagerTest );
+	CPPUNIT_TEST( testAddRemove );
+	CPPUNIT_TEST( testStealingPolicies );
+	CPPUNIT_TEST( testInstrumentLimit );
+	CPPUNIT_TEST( testHardLimit );
+	CPPUNIT_TEST_SUITE_END();
+
+	std::shared_ptr<Instrument> m_pKick;
+	std::shared_ptr<Instrument> m_pSnare;
+
+	static void clear( VoiceManager& voices ) {
+		while ( ! voices.isEmpty() ) {
+			delete voices.remove( 0 );
+		}
+	}
+
+	public:
+	void setUp() override {
+		m_pKick = std::make_shared<Instrument>( 0, "Kick", nullptr );
+		m_pSnare = std::make_shared<Instrument>( 1, "Snare", nullptr );
+	}
+
+	void testAddRemove()
+	{
+		VoiceManager voices( 4 );
+		Note* pNote0 = new Note( m_pKick, 0, 1.0f, 0.f, -1, 0 );
+		Note* pNote1 = new Note( m_pKick, 0, 1.0f, 0.f, -1, 0 );
+		Note* pNote2 = new Note( m_pKick, 0, 1.0f, 0.f, -1, 0 );
+		voices.add( pNote0 );
+		voices.add( pNote1 );
+		voices.add( pNote2 );
+		CPPUNIT_ASSERT_EQUAL( 3, voices.size() );
+		CPPUNIT_ASSERT_EQUAL( 3, voices.countActiveVoices() );
+
+		// The last voice takes the place of the removed one.
+		CPPUNIT_ASSERT( voices.remove( 0 ) == pNote0 );
+		CPPUNIT_ASSERT( voices[ 0 ].pNote == pNote2 );
+		CPPUNIT_ASSERT( voices[ 1 ].pNote == pNote1 );
+		CPPUNIT_ASSERT_EQUAL( 2, voices.countActiveVoices() );
+
+		delete pNote0;
+		clear( voices );
+	}
+
+	void testStealingPolicies()
+	{
+		VoiceManager voices( 3 );
+		Note* pOld = new Note( m_pKick, 0, 0.8f, 0.f, -1, 0 );
+		Note* pSoft = new Note( m_pSnare, 0, 0.2f, 0.f, -1, 0 );
+		Note* pQuiet = new Note( m_pKick, 0, 0.9f, 0.f, -1, 0 );
+		for ( auto pNote : { pOld, pSoft, pQuiet } ) {
+			pNote->get_adsr()->attack();
+			voices.add( pNote );
+		}
+		// Make pQuiet the voice with the lowest envelope value.
+		float fL = 1.0, fR = 1.0;
+		pOld->get_adsr()->applyADSR( &fL, &fR, 1, 2, 1 );
+		pSoft->get_adsr()->applyADSR( &fL, &fR, 1, 2, 1 );
+		pQuiet->get_adsr()->fadeOut( 1 );
+		pQuiet->get_adsr()->applyADSR( &fL, &fR, 1, 2, 1 );
+
+		auto victim = [&]( VoiceManager::StealingPolicy policy,
+						   std::shared_ptr<Instrument> pInstr ) {
+			return voices[ voices.findVictim( policy, pInstr, false ) ].pNote;
+		};
+
+		CPPUNIT_ASSERT( victim( VoiceManager::StealingPolicy::Oldest, m_pKick ) == pOld );
+		CPPUNIT_ASSERT( victim( VoiceManager::StealingPolicy::Quietest, m_pKick ) == pQuiet );
+		CPPUNIT_ASSERT( victim( VoiceManager::StealingPolicy::LowestVelocity, m_pKick ) == pSoft );
+		CPPUNIT_ASSERT( victim( VoiceManager::StealingPolicy::SameInstrumentFirst, m_pSnare ) == pSoft );
+
+		// Reaching the limit steals exactly one voice which keeps on
+		// fading out.
+		Note* pNew = new Note( m_pSnare, 0, 1.0f, 0.f, -1, 0 );
+		CPPUNIT_ASSERT_EQUAL( 1, voices.makeRoomFor( pNew, VoiceManager::StealingPolicy::Oldest,
+													 VoiceManager::nDefaultFadeOutFrames ) );
+		voices.add( pNew );
+		CPPUNIT_ASSERT_EQUAL( 4, voices.size() );
+		CPPUNIT_ASSERT_EQUAL( 3, voices.countActiveVoices() );
+		CPPUNIT_ASSERT_EQUAL( 1LL, voices.getStolenVoices() );
+		CPPUNIT_ASSERT( pOld->get_adsr()->isReleased() );
+
+		clear( voices );
+	}
+
+	void testInstrumentLimit()
+	{
+		VoiceManager voices( 16 );
+		m_pKick->set_max_voices( 2 );
+		for ( int ii = 0; ii < 5; ++ii ) {
+			Note* pNote = new Note( m_pKick, 0, 1.0f, 0.f, -1, 0 );
+			voices.makeRoomFor( pNote, VoiceManager::StealingPolicy::Oldest,
+								VoiceManager::nDefaultFadeOutFrames );
+			voices.add( pNote );
+		}
+		CPPUNIT_ASSERT_EQUAL( 2, voices.countActiveVoices( m_pKick ) );
+		CPPUNIT_ASSERT_EQUAL( 3LL, voices.getStolenVoices() );
+
+		// Other instruments are not affected.
+		Note* pSnare = new Note( m_pSnare, 0, 1.0f, 0.f, -1, 0 );
+		CPPUNIT_ASSERT_EQUAL( 0, voices.makeRoomFor( pSnare, VoiceManager::StealingPolicy::Oldest,
+													 VoiceManager::nDefaultFadeOutFrames ) );
+		voices.add( pSnare );
+
+		clear( voices );
+	}
+
+	void testHardLimit()
+	{
+		VoiceManager voices( 2 );
+		const auto nCapacity = voices.getVoices().capacity();
+		std::vector<Note*> notes;
+		for ( int ii = 0; ii < 4; ++ii ) {
+			Note* pNote = new Note( m_pKick, 0, 1.0f, 0.f, -1, 0 );
+			pNote->get_adsr()->attack();
+			voices.makeRoomFor( pNote, VoiceManager::StealingPolicy::Oldest,
+								VoiceManager::nDefaultFadeOutFrames );
+			CPPUNIT_ASSERT( voices.add( pNote ) );
+			notes.push_back( pNote );
+		}
+		// Two voices are still fading out and occupy the remaining
+		// slots.
+		CPPUNIT_ASSERT( voices.isFull() );
+		CPPUNIT_ASSERT_EQUAL( 2, voices.countActiveVoices() );
+
+		Note* pNew = new Note( m_pKick, 0, 1.0f, 0.f, -1, 0 );
+		CPPUNIT_ASSERT( ! voices.add( pNew ) );
+		CPPUNIT_ASSERT_EQUAL( 4, voices.size() );
+
+		// The oldest voice is dropped to make room.
+		CPPUNIT_ASSERT( voices.dropOldest() == notes[ 0 ] );
+		CPPUNIT_ASSERT_EQUAL( 1LL, voices.getDroppedVoices() );
+		CPPUNIT_ASSERT( voices.add( pNew ) );
+		CPPUNIT_ASSERT_EQUAL( nCapacity, voices.getVoices().capacity() );
+
+		delete notes[ 0 ];
+		clear( voices );
+	}
+};
@@ -23,9 +23,15 @@
 #include "XmlTest.h"
 
 #include <unistd.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
 
 #include <core/Basics/Drumkit.h>
 #include <core/Basics/Pattern.h>
+#include <core/Basics/PatternList.h>
+#include <core/Basics/Song.h>
 #include <core/Basics/Instrument.h>
 #include <core/Basics/InstrumentList.h>
 #include <core/Basics/InstrumentLayer.h>
@@ -34,13 +40,22 @@
 #include <core/Basics/Playlist.h>
 #include <core/Hydrogen.h>
 #include <core/License.h>
+#include <core/config.h>
 #include <core/CoreActionController.h>
 
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QTemporaryDir>
 
+#include <core/Helpers/Archive.h>
+#include <core/Helpers/BinaryDoc.h>
 #include <core/Helpers/Filesystem.h>
 #include <core/Helpers/Xml.h>
+#include <core/SoundLibrary/DrumkitBatch.h>
 #include "TestHelper.h"
 #include "assertions/File.h"
 
@@ -368,6 +383,364 @@ void XmlTest::testPattern()
 	delete pPatternNew;
 }
 
+void XmlTest::testStreamedPatternList()
+{
+	for ( const QString& sSong : { QString( "song/AE_noteEnqueuingTimeline.h2song" ),
+								   QString( "song/test_song_0.9.6.h2song" ) } ) {
+		// Uses the streaming reader.
+		auto pSong = H2Core::Song::load( H2TEST_FILE( sSong ), true );
+		CPPUNIT_ASSERT( pSong != nullptr );
+
+		H2Core::XMLDoc doc;
+		CPPUNIT_ASSERT( doc.read( H2TEST_FILE( sSong ) ) );
+		H2Core::XMLNode songNode = doc.firstChildElement( "song" );
+		auto pPatternList = H2Core::PatternList::load_from(
+			&songNode, pSong->getInstrumentList(), true );
+		CPPUNIT_ASSERT( pPatternList != nullptr );
+
+		auto pStreamedList = pSong->getPatternList();
+		CPPUNIT_ASSERT_EQUAL( pPatternList->size(), pStreamedList->size() );
+		for ( int ii = 0; ii < pPatternList->size(); ++ii ) {
+			auto pPattern = pPatternList->get( ii );
+			auto pStreamed = pStreamedList->get( ii );
+			CPPUNIT_ASSERT( pPattern->get_name() == pStreamed->get_name() );
+			CPPUNIT_ASSERT( pPattern->get_info() == pStreamed->get_info() );
+			CPPUNIT_ASSERT( pPattern->get_category() == pStreamed->get_category() );
+			CPPUNIT_ASSERT_EQUAL( pPattern->get_length(), pStreamed->get_length() );
+			CPPUNIT_ASSERT_EQUAL( pPattern->get_denominator(),
+								  pStreamed->get_denominator() );
+			CPPUNIT_ASSERT_EQUAL( pPattern->get_notes()->size(),
+								  pStreamed->get_notes()->size() );
+
+			auto it = pPattern->get_notes()->cbegin();
+			auto itStreamed = pStreamed->get_notes()->cbegin();
+			for ( ; it != pPattern->get_notes()->cend(); ++it, ++itStreamed ) {
+				auto pNote = it->second;
+				auto pNoteStreamed = itStreamed->second;
+				CPPUNIT_ASSERT_EQUAL( pNote->get_position(), pNoteStreamed->get_position() );
+				CPPUNIT_ASSERT( pNote->get_instrument() == pNoteStreamed->get_instrument() );
+				CPPUNIT_ASSERT_EQUAL( pNote->get_velocity(), pNoteStreamed->get_velocity() );
+				CPPUNIT_ASSERT_EQUAL( pNote->getPan(), pNoteStreamed->getPan() );
+				CPPUNIT_ASSERT_EQUAL( pNote->get_length(), pNoteStreamed->get_length() );
+				CPPUNIT_ASSERT_EQUAL( pNote->get_pitch(), pNoteStreamed->get_pitch() );
+				CPPUNIT_ASSERT_EQUAL( pNote->get_lead_lag(), pNoteStreamed->get_lead_lag() );
+				CPPUNIT_ASSERT( pNote->get_key() == pNoteStreamed->get_key() );
+				CPPUNIT_ASSERT( pNote->get_octave() == pNoteStreamed->get_octave() );
+				CPPUNIT_ASSERT_EQUAL( pNote->get_note_off(), pNoteStreamed->get_note_off() );
+				CPPUNIT_ASSERT_EQUAL( pNote->get_probability(),
+									  pNoteStreamed->get_probability() );
+			}
+		}
+
+		delete pPatternList;
+	}
+}
+
+void XmlTest::testBinaryFormat()
+{
+	const QString sXmlPath = H2Core::Filesystem::tmp_dir() + "binary-xml.h2song";
+	const QString sBinaryPath = H2Core::Filesystem::tmp_dir() + "binary-bin.h2song";
+	const QString sXmlResavedPath = H2Core::Filesystem::tmp_dir() + "binary-xml2.h2song";
+	const QString sBinaryResavedPath = H2Core::Filesystem::tmp_dir() + "binary-bin2.h2song";
+	const QString sConvertedPath = H2Core::Filesystem::tmp_dir() + "binary-conv.h2song";
+
+	auto pSong = H2Core::Song::load( H2TEST_FILE( "song/AE_noteEnqueuingTimeline.h2song" ), true );
+	CPPUNIT_ASSERT( pSong != nullptr );
+	CPPUNIT_ASSERT( pSong->save( sXmlPath, true ) );
+	CPPUNIT_ASSERT( pSong->save( sBinaryPath, true, true ) );
+	CPPUNIT_ASSERT( ! H2Core::BinaryDoc::isBinary( sXmlPath ) );
+	CPPUNIT_ASSERT( H2Core::BinaryDoc::isBinary( sBinaryPath ) );
+
+	// Both formats have to yield the same song.
+	auto pXmlSong = H2Core::Song::load( sXmlPath, true );
+	auto pBinarySong = H2Core::Song::load( sBinaryPath, true );
+	CPPUNIT_ASSERT( pXmlSong != nullptr );
+	CPPUNIT_ASSERT( pBinarySong != nullptr );
+	CPPUNIT_ASSERT( pXmlSong->save( sXmlResavedPath, true ) );
+	CPPUNIT_ASSERT( pBinarySong->save( sBinaryResavedPath, true ) );
+	H2TEST_ASSERT_FILES_EQUAL( sXmlResavedPath, sBinaryResavedPath );
+
+	// Converting the documents without loading them.
+	H2Core::XMLDoc xmlDoc, binaryDoc, convertedDoc;
+	CPPUNIT_ASSERT( xmlDoc.read( sXmlPath ) );
+	CPPUNIT_ASSERT( binaryDoc.read( sBinaryPath ) );
+	CPPUNIT_ASSERT( xmlDoc.toString() == binaryDoc.toString() );
+
+	CPPUNIT_ASSERT( H2Core::BinaryDoc::convert( sXmlPath, sConvertedPath, true ) );
+	CPPUNIT_ASSERT( H2Core::BinaryDoc::isBinary( sConvertedPath ) );
+	CPPUNIT_ASSERT( H2Core::BinaryDoc::convert( sConvertedPath, sConvertedPath, false ) );
+	CPPUNIT_ASSERT( ! H2Core::BinaryDoc::isBinary( sConvertedPath ) );
+	CPPUNIT_ASSERT( convertedDoc.read( sConvertedPath ) );
+	CPPUNIT_ASSERT( xmlDoc.toString() == convertedDoc.toString() );
+
+	// Pattern
+	const QString sPatternPath = H2Core::Filesystem::tmp_dir() + "binary.h2pattern";
+	auto pDrumkit = H2Core::Drumkit::load( H2TEST_FILE( "/drumkits/baseKit" ) );
+	CPPUNIT_ASSERT( pDrumkit != nullptr );
+	auto pPattern = H2Core::Pattern::load_file( H2TEST_FILE( "/pattern/pat.h2pattern" ),
+												pDrumkit->get_instruments() );
+	CPPUNIT_ASSERT( pPattern != nullptr );
+	CPPUNIT_ASSERT( pPattern->save_file( "dk_name", "author", H2Core::License(),
+										 sPatternPath, true, true ) );
+	CPPUNIT_ASSERT( H2Core::BinaryDoc::isBinary( sPatternPath ) );
+	H2Core::XMLDoc patternDoc;
+	CPPUNIT_ASSERT( patternDoc.read( sPatternPath, H2Core::Filesystem::pattern_xsd_path() ) );
+	auto pPatternReloaded = H2Core::Pattern::load_file( sPatternPath, pDrumkit->get_instruments() );
+	CPPUNIT_ASSERT( pPatternReloaded != nullptr );
+	CPPUNIT_ASSERT( pPattern->get_name() == pPatternReloaded->get_name() );
+	CPPUNIT_ASSERT_EQUAL( pPattern->get_notes()->size(),
+						  pPatternReloaded->get_notes()->size() );
+	auto it = pPattern->get_notes()->cbegin();
+	auto itReloaded = pPatternReloaded->get_notes()->cbegin();
+	for ( ; it != pPattern->get_notes()->cend(); ++it, ++itReloaded ) {
+		CPPUNIT_ASSERT_EQUAL( it->second->get_position(), itReloaded->second->get_position() );
+		CPPUNIT_ASSERT( it->second->get_instrument() == itReloaded->second->get_instrument() );
+		CPPUNIT_ASSERT_EQUAL( it->second->get_velocity(), itReloaded->second->get_velocity() );
+		CPPUNIT_ASSERT( it->second->get_key() == itReloaded->second->get_key() );
+		CPPUNIT_ASSERT( it->second->get_octave() == itReloaded->second->get_octave() );
+	}
+	delete pPatternReloaded;
+
+	// Notes with a key or octave unknown to Note are rejected.
+	const QString sCorruptPath = H2Core::Filesystem::tmp_dir() + "binary-corrupt.h2pattern";
+	for ( const bool bKey : { true, false } ) {
+		QFile patternFile( sPatternPath );
+		CPPUNIT_ASSERT( patternFile.open( QIODevice::ReadOnly ) );
+		QByteArray data = patternFile.readAll();
+		patternFile.close();
+		H2Core::BinaryDoc::Header header;
+		std::memcpy( &header, data.constData(), sizeof( header ) );
+		bool bCorrupted = false;
+		for ( uint32_t ii = 0; ii < header.nSections; ++ii ) {
+			H2Core::BinaryDoc::Section section;
+			std::memcpy( &section, data.constData() + sizeof( header ) +
+						 ii * sizeof( section ), sizeof( section ) );
+			if ( section.nId == H2Core::BinaryDoc::NoteSection && section.nSize > 0 ) {
+				data[ static_cast<int>( section.nOffset ) + ( bKey ?
+					offsetof( H2Core::BinaryDoc::NoteRecord, nKey ) :
+					offsetof( H2Core::BinaryDoc::NoteRecord, nOctave ) ) ] = 42;
+				bCorrupted = true;
+			}
+		}
+		CPPUNIT_ASSERT( bCorrupted );
+		QFile corruptFile( sCorruptPath );
+		CPPUNIT_ASSERT( corruptFile.open( QIODevice::WriteOnly ) );
+		CPPUNIT_ASSERT_EQUAL( static_cast<qint64>( data.size() ), corruptFile.write( data ) );
+		corruptFile.close();
+
+		H2Core::BinaryDoc corruptDoc;
+		CPPUNIT_ASSERT( ! corruptDoc.read( sCorruptPath ) );
+		CPPUNIT_ASSERT( H2Core::Pattern::load_file(
+							sCorruptPath, pDrumkit->get_instruments() ) == nullptr );
+	}
+	delete pPattern;
+
+	// Drumkit
+	const QString sDrumkitPath = H2Core::Filesystem::tmp_dir() + "dk-binary";
+	CPPUNIT_ASSERT( pDrumkit->save( sDrumkitPath, -1, true, true, true ) );
+	CPPUNIT_ASSERT( H2Core::BinaryDoc::isBinary(
+						H2Core::Filesystem::drumkit_file( sDrumkitPath ) ) );
+	auto pDrumkitReloaded = H2Core::Drumkit::load( sDrumkitPath );
+	CPPUNIT_ASSERT( pDrumkitReloaded != nullptr );
+	CPPUNIT_ASSERT( pDrumkit->get_name() == pDrumkitReloaded->get_name() );
+	CPPUNIT_ASSERT_EQUAL( pDrumkit->get_instruments()->size(),
+						  pDrumkitReloaded->get_instruments()->size() );
+	for ( int ii = 0; ii < pDrumkit->get_instruments()->size(); ++ii ) {
+		CPPUNIT_ASSERT( pDrumkit->get_instruments()->get( ii )->get_name() ==
+						pDrumkitReloaded->get_instruments()->get( ii )->get_name() );
+	}
+
+	H2Core::Filesystem::rm( sDrumkitPath, true );
+	for ( const auto& sPath : { sXmlPath, sBinaryPath, sXmlResavedPath,
+								sBinaryResavedPath, sConvertedPath, sPatternPath,
+								sCorruptPath } ) {
+		H2Core::Filesystem::rm( sPath );
+	}
+}
+
+void XmlTest::testValidationCache()
+{
+	const QString sValid = H2TEST_FILE( "/pattern/pat.h2pattern" );
+	// A drumkit does not comply with the pattern schema.
+	const QString sInvalid = H2TEST_FILE( "/drumkits/baseKit/drumkit.xml" );
+	const QString sSchema = H2Core::Filesystem::pattern_xsd_path();
+
+	H2Core::XMLDoc::clearValidationCache();
+	for ( int ii = 0; ii < 2; ++ii ) {
+		H2Core::XMLDoc doc;
+		CPPUNIT_ASSERT( doc.read( sValid, sSchema, true ) );
+		CPPUNIT_ASSERT( ! doc.read( sInvalid, sSchema, true ) );
+	}
+	CPPUNIT_ASSERT( QFileInfo( H2Core::Filesystem::cache_dir() +
+							   "validated_documents" ).size() > 0 );
+
+	// Documents are parsed right away.
+	H2Core::XMLDoc::clearValidationCache();
+	H2Core::XMLDoc deferredDoc;
+	CPPUNIT_ASSERT( deferredDoc.read( sInvalid, sSchema, true,
+									  H2Core::XMLDoc::Validation::Deferred ) );
+	CPPUNIT_ASSERT( ! deferredDoc.firstChildElement( "drumkit_info" ).isNull() );
+	CPPUNIT_ASSERT( deferredDoc.read( sValid, sSchema, true,
+									  H2Core::XMLDoc::Validation::Deferred ) );
+	H2Core::XMLDoc::waitForDeferredValidation();
+
+	H2Core::XMLDoc doc;
+	CPPUNIT_ASSERT( doc.read( sValid, sSchema, true ) );
+	CPPUNIT_ASSERT( ! doc.read( sInvalid, sSchema, true ) );
+}
+
+void XmlTest::testDrumkitArchive()
+{
+	const QString sKitPath = H2TEST_FILE( "/drumkits/baseKit" );
+	auto pDrumkit = H2Core::Drumkit::load( sKitPath, false, true );
+	CPPUNIT_ASSERT( pDrumkit != nullptr );
+
+	QTemporaryDir exportDir( H2Core::Filesystem::tmp_dir() + "-XXXXXX" );
+	std::vector<float> progress;
+	CPPUNIT_ASSERT( pDrumkit->exportTo( exportDir.path(), "", true, true,
+										[&]( float fProgress ) {
+											progress.push_back( fProgress );
+											return true; } ) );
+	const QString sArchive = exportDir.path() + "/" + pDrumkit->get_name() +
+		H2Core::Filesystem::drumkit_ext;
+	CPPUNIT_ASSERT( QFile::exists( sArchive ) );
+
+	QTemporaryDir extractDir( H2Core::Filesystem::tmp_dir() + "-XXXXXX" );
+	CPPUNIT_ASSERT( H2Core::Drumkit::install( sArchive, extractDir.path(), true ) );
+	const QStringList extractedFolders =
+		QDir( extractDir.path() ).entryList( QDir::Dirs | QDir::NoDotAndDotDot );
+	CPPUNIT_ASSERT( extractedFolders.size() == 1 );
+	const QDir extractedKit( extractDir.path() + "/" + extractedFolders[ 0 ] );
+	CPPUNIT_ASSERT( extractedKit.exists( H2Core::Filesystem::drumkit_xml() ) );
+	for ( const auto& sFile : extractedKit.entryList( QDir::Files ) ) {
+		H2TEST_ASSERT_FILES_EQUAL( sKitPath + "/" + sFile, extractedKit.filePath( sFile ) );
+	}
+
+#ifdef H2CORE_HAVE_LIBARCHIVE
+	CPPUNIT_ASSERT( ! progress.empty() );
+	CPPUNIT_ASSERT( std::is_sorted( progress.begin(), progress.end() ) );
+	CPPUNIT_ASSERT( progress.back() == 1.0f );
+
+	// Cancelling must not leave partial results behind.
+	QTemporaryDir cancelDir( H2Core::Filesystem::tmp_dir() + "-XXXXXX" );
+	CPPUNIT_ASSERT( ! H2Core::Drumkit::install( sArchive, cancelDir.path(), true,
+												[]( float ) { return false; } ) );
+	CPPUNIT_ASSERT( QDir( cancelDir.path() )
+					.entryList( QDir::AllEntries | QDir::NoDotAndDotDot ).isEmpty() );
+
+	QFile::remove( sArchive );
+	CPPUNIT_ASSERT( ! pDrumkit->exportTo( exportDir.path(), "", true, true,
+										  []( float ) { return false; } ) );
+	CPPUNIT_ASSERT( ! QFile::exists( sArchive ) );
+
+	// Content spanning several blocks compressed in parallel.
+	const QString sLargeFile = exportDir.path() + "/large.raw";
+	QByteArray data;
+	for ( int ii = 0; ii < 3 * H2Core::Archive::nBlockSize + 123; ++ii ) {
+		data.append( static_cast<char>( ( ii * 7919 ) >> 7 ) );
+	}
+	QFile largeFile( sLargeFile );
+	CPPUNIT_ASSERT( largeFile.open( QIODevice::WriteOnly ) );
+	CPPUNIT_ASSERT( largeFile.write( data ) == data.size() );
+	largeFile.close();
+
+	const QString sLargeArchive = exportDir.path() + "/large" +
+		H2Core::Filesystem::drumkit_ext;
+	CPPUNIT_ASSERT( H2Core::Archive::create( sLargeArchive,
+											 { { sLargeFile, "large/large.raw" } },
+											 nullptr, 4 ) );
+	QTemporaryDir largeDir( H2Core::Filesystem::tmp_dir() + "-XXXXXX" );
+	CPPUNIT_ASSERT( H2Core::Archive::extract( sLargeArchive, largeDir.path() ) );
+	H2TEST_ASSERT_FILES_EQUAL( sLargeFile, largeDir.path() + "/large/large.raw" );
+#endif
+}
+
+void XmlTest::testDrumkitBatch()
+{
+	using H2Core::DrumkitBatch;
+
+	const QString sBaseKit = QDir( H2TEST_FILE( "/drumkits/baseKit" ) ).absolutePath();
+	const QString sLegacyKit = QDir( H2TEST_FILE( "/drumkits/legacyKits" ) )
+		.absoluteFilePath( "Boss_DR-110.h2drumkit" );
+
+	const QStringList drumkits =
+		DrumkitBatch::findDrumkits( { H2TEST_FILE( "/drumkits" ) } );
+	CPPUNIT_ASSERT( drumkits.contains( sBaseKit ) );
+	CPPUNIT_ASSERT( drumkits.contains( sLegacyKit ) );
+
+	// Kit lacking one of its samples.
+	QTemporaryDir incompleteDir( H2Core::Filesystem::tmp_dir() + "-XXXXXX" );
+	const QString sIncompleteKit = incompleteDir.path() + "/incompleteKit";
+	CPPUNIT_ASSERT( QDir().mkpath( sIncompleteKit ) );
+	for ( const auto& sFile : QDir( sBaseKit ).entryList( QDir::Files ) ) {
+		if ( sFile != "kick.wav" ) {
+			CPPUNIT_ASSERT( H2Core::Filesystem::file_copy(
+								sBaseKit + "/" + sFile, sIncompleteKit + "/" + sFile,
+								false, true ) );
+		}
+	}
+
+	DrumkitBatch::Options options;
+	options.nThreads = 4;
+	int nCallbacks = 0;
+	const auto results =
+		DrumkitBatch::run( DrumkitBatch::Action::Validate,
+						   { sBaseKit, sLegacyKit, sIncompleteKit,
+							 sBaseKit + "/nonExistent" }, options,
+						   [&]( const DrumkitBatch::Result& ) { ++nCallbacks; } );
+	CPPUNIT_ASSERT( results.size() == 4 );
+	CPPUNIT_ASSERT( nCallbacks == 4 );
+
+	CPPUNIT_ASSERT( results[ 0 ].bSuccess );
+	CPPUNIT_ASSERT( results[ 0 ].bValid );
+	CPPUNIT_ASSERT( results[ 0 ].nSamples == 5 );
+	CPPUNIT_ASSERT( results[ 0 ].missingSamples.isEmpty() );
+
+	// Only the drumkit.xml of the archive is extracted but its
+	// samples must be found nevertheless.
+	CPPUNIT_ASSERT( ! results[ 1 ].bSuccess );
+	CPPUNIT_ASSERT( ! results[ 1 ].bValid );
+	CPPUNIT_ASSERT( results[ 1 ].sError.isEmpty() );
+	CPPUNIT_ASSERT( results[ 1 ].nSamples > 0 );
+	CPPUNIT_ASSERT( results[ 1 ].missingSamples.isEmpty() );
+
+	CPPUNIT_ASSERT( ! results[ 2 ].bSuccess );
+	CPPUNIT_ASSERT( results[ 2 ].bValid );
+	CPPUNIT_ASSERT( results[ 2 ].missingSamples == QStringList( "kick.wav" ) );
+
+	CPPUNIT_ASSERT( ! results[ 3 ].bSuccess );
+	CPPUNIT_ASSERT( ! results[ 3 ].sError.isEmpty() );
+
+	const auto report = QJsonDocument::fromJson(
+		DrumkitBatch::toJson( DrumkitBatch::Action::Validate, results, 1.0 ) ).object();
+	CPPUNIT_ASSERT( report[ "failed" ].toInt() == 3 );
+	CPPUNIT_ASSERT( report[ "kits" ].toArray().size() == 4 );
+	CPPUNIT_ASSERT( report[ "kits" ].toArray()[ 2 ].toObject()
+					[ "missingSamples" ].toArray().size() == 1 );
+
+	// Upgrading into a target folder must neither touch the original
+	// kits nor mix up kits of the same name.
+	QTemporaryDir targetDir( H2Core::Filesystem::tmp_dir() + "-XXXXXX" );
+	options.sTargetDir = targetDir.path();
+	const auto upgradeResults =
+		DrumkitBatch::run( DrumkitBatch::Action::Upgrade,
+						   { sBaseKit, sBaseKit, sLegacyKit }, options );
+	for ( const auto& result : upgradeResults ) {
+		CPPUNIT_ASSERT( result.bSuccess );
+		CPPUNIT_ASSERT( result.bUpgraded );
+	}
+	CPPUNIT_ASSERT( H2Core::Filesystem::drumkit_valid( targetDir.path() + "/baseKit" ) );
+	CPPUNIT_ASSERT( H2Core::Filesystem::drumkit_valid( targetDir.path() + "/baseKit_2" ) );
+
+	const auto upgradedResults =
+		DrumkitBatch::run( DrumkitBatch::Action::Validate,
+						   DrumkitBatch::findDrumkits( { targetDir.path() } ), options );
+	CPPUNIT_ASSERT( upgradedResults.size() == 3 );
+	for ( const auto& result : upgradedResults ) {
+		CPPUNIT_ASSERT( result.bSuccess );
+	}
+}
+
 void XmlTest::checkTestPatterns()
 {
 	H2Core::XMLDoc doc;
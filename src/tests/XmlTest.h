@@ -32,6 +32,11 @@ class XmlTest : public CppUnit::TestCase {
 	CPPUNIT_TEST(testDrumkitUpgrade);
 	CPPUNIT_TEST(testPattern);
 	CPPUNIT_TEST(testPlaylist);
+	CPPUNIT_TEST(testStreamedPatternList);
+	CPPUNIT_TEST(testBinaryFormat);
+	CPPUNIT_TEST(testValidationCache);
+	CPPUNIT_TEST(testDrumkitArchive);
+	CPPUNIT_TEST(testDrumkitBatch);
 	CPPUNIT_TEST(testShippedDrumkits);
 	CPPUNIT_TEST(checkTestPatterns);
 	CPPUNIT_TEST_SUITE_END();
@@ -44,6 +49,23 @@ class XmlTest : public CppUnit::TestCase {
 		void testDrumkitUpgrade();
 		void testPattern();
 		void testPlaylist();
+		// Patterns of songs loaded via XMLDoc::readStreamed() have
+		// to match the ones read from the DOM.
+		void testStreamedPatternList();
+		// Songs, patterns, and drumkits have to survive a round trip
+		// through the binary format without loss.
+		void testBinaryFormat();
+		// Neither caching nor deferring validation must let an
+		// invalid document pass XMLDoc::read().
+		void testValidationCache();
+		// Drumkits have to survive export and installation via
+		// Archive unchanged and cancelling either of them must not
+		// leave partial results behind.
+		void testDrumkitArchive();
+		// Batch validation has to report the same findings as
+		// loading each kit individually and upgraded kits have to be
+		// valid afterwards.
+		void testDrumkitBatch();
 		// Check whether the drumkits provided alongside this repo can
 		// be validated against the drumkit XSD.
 		void testShippedDrumkits();
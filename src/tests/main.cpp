@@ -36,6 +36,7 @@
 #include "utils/AppveyorTestListener.h"
 #include "utils/AppveyorRestClient.h"
 #include "AudioBenchmark.h"
+#include "RealtimeBenchmark.h"
 #include <chrono>
 
 #ifdef HAVE_EXECINFO_H
@@ -94,10 +95,20 @@ int main( int argc, char **argv)
 	QCommandLineOption verboseOption( QStringList() << "V" << "verbose", "Level, if present, may be None, Error, Warning, Info, Debug or 0xHHHH","Level");
 	QCommandLineOption appveyorOption( QStringList() << "appveyor", "Report test progress to AppVeyor build worker" );
 	QCommandLineOption benchmarkOption( QStringList() << "b" << "benchmark", "Run audio system benchmark" );
+	QCommandLineOption realtimeBenchmarkOption( QStringList() << "r" << "realtime-benchmark", "Run realtime benchmark scenarios" );
+	QCommandLineOption periodsOption( QStringList() << "periods", "Comma separated period sizes (32 - 2048 frames) of the realtime benchmark", "Periods" );
+	QCommandLineOption sampleRateOption( QStringList() << "sample-rate", "Sample rate of the realtime benchmark", "Rate" );
+	QCommandLineOption jsonOption( QStringList() << "json", "Write the realtime benchmark report to this file", "File" );
+	QCommandLineOption updateGoldenOption( QStringList() << "update-golden", "Overwrite the references of the golden render test" );
 	parser.addHelpOption();
 	parser.addOption( verboseOption );
 	parser.addOption( appveyorOption );
 	parser.addOption( benchmarkOption );
+	parser.addOption( realtimeBenchmarkOption );
+	parser.addOption( periodsOption );
+	parser.addOption( sampleRateOption );
+	parser.addOption( jsonOption );
+	parser.addOption( updateGoldenOption );
 	parser.process(app);
 	QString sVerbosityString = parser.value( verboseOption );
 	unsigned logLevelOpt = H2Core::Logger::None;
@@ -124,10 +135,34 @@ int main( int argc, char **argv)
 	if ( parser.isSet( benchmarkOption ) ) {
 		AudioBenchmark::enable();
 	}
+
+	if ( parser.isSet( realtimeBenchmarkOption ) ) {
+		RealtimeBenchmark::enable();
+		if ( parser.isSet( periodsOption ) ) {
+			std::vector<int> periods;
+			for ( const auto& sPeriod : parser.value( periodsOption ).split( ',' ) ) {
+				periods.push_back( sPeriod.toInt() );
+			}
+			RealtimeBenchmark::setPeriods( periods );
+		}
+		if ( parser.isSet( sampleRateOption ) ) {
+			RealtimeBenchmark::setSampleRate( parser.value( sampleRateOption ).toInt() );
+		}
+		if ( parser.isSet( jsonOption ) ) {
+			RealtimeBenchmark::setOutputFile( parser.value( jsonOption ) );
+		}
+	}
 	
+	if ( parser.isSet( updateGoldenOption ) ) {
+		GoldenRenderTest::setUpdateReferences( true );
+	}
+
 	CppUnit::TextUi::TestRunner runner;
 	CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
 	runner.addTest( registry.makeTest() );
+	if ( parser.isSet( updateGoldenOption ) ) {
+		runner.addTest( CppUnit::TestFactoryRegistry::getRegistry( "GoldenRender" ).makeTest() );
+	}
 	
 	std::unique_ptr<AppVeyor::BuildWorkerApiClient> appveyorApiClient;
 	std::unique_ptr<AppVeyorTestListener> avtl;
@@ -23,41 +23,62 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "AdsrTest.h"
+#include "AudioBufferArenaTest.cpp"
 #include "AutomationPathSerializerTest.cpp"
 #include "AutomationPathTest.cpp"
 #include "CoreActionControllerTest.h"
 #include "FilesystemTest.h"
+#include "FilterTest.cpp"
 #include "FunctionalTests.cpp"
+#include "GoldenRenderTest.h"
 #include "InstrumentListTest.cpp"
 #include "LicenseTest.h"
 #include "MemoryLeakageTest.h"
+#include "MidiEventQueueTest.cpp"
 #include "MidiNoteTest.cpp"
 #include "NoteTest.cpp"
 #include "OscServerTest.h"
+#include "PanLawTableTest.cpp"
 #include "PatternTest.h"
+#include "RandomTest.cpp"
 #include "SampleTest.cpp"
+#include "SeqLockTest.cpp"
+#include "SmfReaderTest.cpp"
 #include "TimeTest.h"
 #include "Translations.cpp"
 #include "TransportTest.h"
+#include "VoiceManagerTest.cpp"
 #include "XmlTest.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION( ADSRTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( AudioBufferArenaTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( AutomationPathSerializerTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( AutomationPathTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( CoreActionControllerTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( FilesystemTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( FilterTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( FunctionalTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( InstrumentListTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( LicenseTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( MemoryLeakageTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( MidiEventQueueTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( MidiNoteTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( NoteTest );
 #ifdef H2CORE_HAVE_OSC
 CPPUNIT_TEST_SUITE_REGISTRATION( OscServerTest );
 #endif
+CPPUNIT_TEST_SUITE_REGISTRATION( PanLawTableTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( PatternTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( RandomTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( SampleTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( SeqLockTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( SmfReaderTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( TimeTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( TransportTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( UITranslationTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( VoiceManagerTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( XmlTest );
+
+// Not part of the regular run until the references in
+// data/golden have been created using `--update-golden`.
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( GoldenRenderTest, "GoldenRender" );